@@ -102,6 +102,15 @@ extern u8 HUART_u8SendSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buff
  * Return: Error Status (u8)  */
 extern u8 HUART_u8ReceiveSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u8 Copy_u8Size, u32 Copy_u32Time);
 
+/*Description: This API will be used to receive a byte stream using interrupts, every byte (zeros included) is passed to the callback
+ * Parameters: Desired UART (struct), Pointer to byte callback function
+ * Return: Error Status (u8)  */
+extern u8 HUART_u8StartStreamReceive(UART_GPIO_t Copy_u32PeripheralNumber, RXByteCallback_t Copy_RXByteCallbackFunction);
+/*Description: This API will be used to stop the byte stream started by HUART_u8StartStreamReceive
+ * Parameters: Desired UART (struct)
+ * Return: None  */
+extern void HUART_voidStopStreamReceive(UART_GPIO_t Copy_u32PeripheralNumber);
+
 /*Description: This function can be used to terminate async receiving (Warning!: Don't use it unless you know what you are doing)
  * Parameters: Desired UART Peripheral address (u32)
  * return: None*/
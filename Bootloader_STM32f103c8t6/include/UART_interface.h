@@ -25,6 +25,7 @@
 /*Callback functions pointers*/
 typedef void(*TXCallback_t)(void);
 typedef void(*RXCallback_t)(void);
+typedef void(*RXByteCallback_t)(u8);
 /*********************************************************************************/
 /************Warning: Don't change anything in this section***********************/
 /*Base Addresses*/
@@ -108,6 +109,16 @@ extern u8 UART_u8SetTXCallBack(TXCallback_t Copy_TXCallbackFunction, u32 Copy_u3
  * Return:Error Status */
 extern u8 UART_u8SetRXCallBack(RXCallback_t Copy_RXCallbackFunction, u32 Copy_u32DesiredUART);
 
+/*Description: This API will start stream receiving, every received byte (zeros included) is passed to the byte callback from the IRQ
+ * till the stream is stopped, it can't be used while an async receive is ongoing
+ * Parameters: Desired UART Peripheral (u32), Pointer to byte callback function
+ * Return:Error Status */
+extern u8 UART_u8StartStreamReceive(u32 Copy_u32UARTAddress, RXByteCallback_t Copy_RXByteCallbackFunction);
+/*Description: This API will stop stream receiving and disable the RX interrupt
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: None */
+extern void UART_voidStopStreamReceive(u32 Copy_u32UARTAddress);
+
 /*Description: This function will be used to trigger sending data synchronously without using interrupts
  * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u8), required delay in ms (u32)
  * Return: void  */
@@ -53,6 +53,7 @@ u8 		FLASH_src_buffer_1K[FLASH_RX_LEN]=  {0};
 #define BL_SYSTEM_RESET					0X5D	/**/
 #define BL_EXISTING_APPS				0x5E	/**/
 #define BL_SAVE_APP_INFO				0x61	/*Set app info*/
+#define BL_MEM_WRITE_WINDOWED			0x64	/*Write an image streamed in numbered frames, acknowledged cumulatively*/
 
 /*ACK and NACK bytes*/
 #define BL_ACK							0xA5
@@ -80,6 +81,36 @@ u8 		FLASH_src_buffer_1K[FLASH_RX_LEN]=  {0};
 #define RAM_SIZE                        20*1024 		/*20K*/
 #define RAM_END                         (RAM_START+RAM_SIZE-1)
 
+/*Windowed write macros*/
+#define BL_WINDOW_MIN					4U
+#define BL_WINDOW_MAX					16U
+#define BL_WINDOW_SLOTS					(BL_WINDOW_MAX+1)		/*One slot is always left empty to tell a full ring from an empty one*/
+#define BL_WINDOW_FRAME_SOF				0x7E
+#define BL_WINDOW_FRAME_PAYLOAD			128U					/*Multiple of 4, flash is programmed and verified in words*/
+#define BL_WINDOW_IDLE_TIMEOUT_MS		2000U					/*Stream is given up if no frame arrives for this long*/
+#define BL_WINDOW_END					0xE0					/*Last reply of the stream, followed by the status*/
+/*Windowed write status*/
+#define BL_WINDOW_OK					0U
+#define BL_WINDOW_ADDR_INVALID			1U
+#define BL_WINDOW_ERASE_FAIL			2U
+#define BL_WINDOW_VERIFY_FAIL			3U
+#define BL_WINDOW_TIMEOUT				4U
+/*States of the frame receiver*/
+#define BL_WINDOW_RX_SOF				0U
+#define BL_WINDOW_RX_SEQ				1U
+#define BL_WINDOW_RX_LEN				2U
+#define BL_WINDOW_RX_PAYLOAD			3U
+#define BL_WINDOW_RX_CRC				4U
+
+/*Data frame : SOF, sequence number, payload length, payload, CRC32 of (sequence number, length, payload)*/
+typedef struct
+{
+	u32 payload[BL_WINDOW_FRAME_PAYLOAD/4];
+	u32 crc;
+	u8  seq;
+	u8  len;
+}BL_WindowFrame_t;
+
 
 /*Commands handle functions prototypes*/
 void bootloader_handle_getver_cmd				(u8* bl_rx_buffer);
@@ -99,6 +130,7 @@ void bootloader_handle_read_sectors_status_cmd	(u8* bl_rx_buffer);
 void bootloader_handle_system_reset_cmd			(u8* bl_rx_buffer);
 void bootloader_handle_existing_apps_cmd		(u8* bl_rx_buffer);
 void bootloader_handle_save_app_info_cmd		(u8* bl_rx_buffer);
+void bootloader_handle_mem_write_windowed_cmd	(u8* bl_rx_buffer);
 
 
 
@@ -110,6 +142,9 @@ u8   bootloader_verify_crc(u8* pData, u32 len, u32 crc_host);
 u8   verify_address(u32 go_address);
 void char2hex(u8* inBuffer, u8* outBuffer, u16 NumOfBytesToBeConverted );
 void hex2char(u8* inBuffer, u8* outBuffer, u16 NumOfBytesToBeConverted );
+void bootloader_window_rx_byte(u8 byte);
+void bootloader_window_send(u8 type, u8 value);
+u32  bootloader_window_frame_crc(BL_WindowFrame_t* frame);
 u8   supported_commands[] = {
 							BL_GET_VER				,
 							BL_GET_HELP				,
@@ -127,10 +162,19 @@ u8   supported_commands[] = {
 							BL_PROTECTION_STATUS    ,
 							BL_SYSTEM_RESET		    ,
 							BL_EXISTING_APPS		,
-							BL_SAVE_APP_INFO
+							BL_SAVE_APP_INFO		,
+							BL_MEM_WRITE_WINDOWED
 							};
 
 
+/*Frames are written in these slots by the UART stream callback and programmed from them by the windowed write handler
+ * (single producer, single consumer : only the callback moves head and only the handler moves tail)*/
+static BL_WindowFrame_t static_WindowSlots[BL_WINDOW_SLOTS];
+static volatile u8 static_u8WindowHead=0;
+static volatile u8 static_u8WindowTail=0;
+static u8  static_u8WindowRxState=BL_WINDOW_RX_SOF;
+static u16 static_u16WindowRxIndex=0;
+
 /******************* Implementation of Boot-loader application functions **********************/
 u8 i=0;
 /*This iterator will be used for initializing the data array*/
@@ -395,6 +439,9 @@ extern void bootloader_voidUARTReadData (void)
 			case BL_SAVE_APP_INFO:
 				bootloader_handle_save_app_info_cmd(bl_rx_buffer);
 				break;
+			case BL_MEM_WRITE_WINDOWED:
+				bootloader_handle_mem_write_windowed_cmd(bl_rx_buffer);
+				break;
 			default:
 				printmsg1("BL_DEBUG_MSG: Invalid command code received from host \r\n");
 				break;
@@ -1116,8 +1163,193 @@ void bootloader_handle_save_app_info_cmd		(u8* bl_rx_buffer)
     //
 	//FLASH_Lock();
 }
+/* Handle function to handle BL_MEM_WRITE_WINDOWED command
+ * Command: address (8 chars), size (8 chars), window (1 byte), CRC (8 chars) ; the destination pages are erased first
+ * Reply  : ack, status, accepted window. Then the host streams data frames without waiting, keeping up to (window) frames
+ * unacknowledged. Every frame programmed in order is answered with (BL_ACK, next expected sequence number), a corrupted or
+ * out of order frame with (BL_NACK, next expected sequence number) so the host goes back to it. (BL_WINDOW_END, status) ends the stream*/
+void bootloader_handle_mem_write_windowed_cmd	(u8* bl_rx_buffer)
+{
+	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
+	u32 command_length_without_crc = command_packet-8;      /*Length to be sent to (bl_verify_crc) function*/
+	u32 crc_host;
+	u8  Local_u8FinalHostCRC[4];
+	u8  Local_u8Field[4];
+	u32 destination_address;
+	u32 image_size;
+	u32 bytes_done  = 0;
+	u32 idle_ms     = 0;
+	u8  window;
+	u8  expected_seq= 0;
+	u8  nack_sent   = 0;
+	u8  reply[2];
+	u8  status      = BL_WINDOW_OK;
+	BL_WindowFrame_t* frame;
+
+	char2hex(&bl_rx_buffer[command_length_without_crc], Local_u8FinalHostCRC, 4);
+	crc_host= *((u32*)Local_u8FinalHostCRC);     /*Extract the CRC32 sent by host*/
+
+	printmsg1("------------------------------------------------\r\nBL_DEBUG_MSG: bootloader_handle_mem_write_windowed_cmd \r\n");
+	if(bootloader_verify_crc(bl_rx_buffer, command_length_without_crc, crc_host))
+	{
+		printmsg1("BL_DEBUG_MSG: checksum fail !! \r\n");
+		bootloader_send_nack();
+		return;
+	}
+
+	char2hex(&bl_rx_buffer[2],Local_u8Field,4);
+	destination_address = *((u32*)Local_u8Field);
+	char2hex(&bl_rx_buffer[10],Local_u8Field,4);
+	image_size = *((u32*)Local_u8Field);
+	window = bl_rx_buffer[18];
+	if(window < BL_WINDOW_MIN) window = BL_WINDOW_MIN;
+	if(window > BL_WINDOW_MAX) window = BL_WINDOW_MAX;
+
+	/*Whole pages are erased up front, so only half word programming (shorter than a character time) runs while frames arrive*/
+	if( (destination_address & 0x3FF) || image_size == 0 || destination_address < FLASH_USR_APP_BASE_ADDRESS ||
+		(destination_address+image_size-1) > FLASH_END )
+	{
+		status = BL_WINDOW_ADDR_INVALID;
+	}
+	else
+	{
+		FLASH_Unlock();
+		if(FLASH_MultiplePageErase(destination_address, (image_size+1023)/1024) != STD_TYPES_ERROR_OK)
+			status = BL_WINDOW_ERASE_FAIL;
+	}
+
+	/*Receiver is armed before the reply, the host starts streaming as soon as it reads it*/
+	static_u8WindowHead    = 0;
+	static_u8WindowTail    = 0;
+	static_u8WindowRxState = BL_WINDOW_RX_SOF;
+	if(status == BL_WINDOW_OK)
+		HUART_u8StartStreamReceive(HUART_USART2, bootloader_window_rx_byte);
+
+	bootloader_send_ack(2);
+	reply[0] = status;
+	reply[1] = window;
+	HUART_u8SendSync(HUART_USART2,reply,2,1);
+
+	while(status == BL_WINDOW_OK && bytes_done < image_size)
+	{
+		if(static_u8WindowTail == static_u8WindowHead)
+		{
+			delay_ms(1);
+			if(++idle_ms >= BL_WINDOW_IDLE_TIMEOUT_MS) status = BL_WINDOW_TIMEOUT;
+			continue;
+		}
+		idle_ms = 0;
+		frame   = &static_WindowSlots[static_u8WindowTail];
+
+		if(bootloader_window_frame_crc(frame) == frame->crc && frame->seq == expected_seq && frame->len <= ((image_size-bytes_done+3)&~3))
+		{
+			GPIO_Pin_Write(&OnBoard_Led,LOW);
+			if(FLASH_WriteProgram(frame->payload, (void*)(destination_address+bytes_done), frame->len) != STD_TYPES_ERROR_OK)
+			{
+				status = BL_WINDOW_VERIFY_FAIL;
+			}
+			else
+			{
+				bytes_done += frame->len;
+				expected_seq++;
+				nack_sent = 0;
+				bootloader_window_send(BL_ACK, expected_seq);
+			}
+			GPIO_Pin_Write(&OnBoard_Led,HIGH);
+		}
+		else if(!nack_sent)
+		{
+			/*First frame of a gap, the following ones of the old window are dropped quietly till the host goes back*/
+			nack_sent = 1;
+			bootloader_window_send(BL_NACK, expected_seq);
+		}
+		static_u8WindowTail = (static_u8WindowTail+1) % BL_WINDOW_SLOTS;
+	}
+
+	HUART_voidStopStreamReceive(HUART_USART2);
+	FLASH_Lock();
+	if(status != BL_WINDOW_ADDR_INVALID && status != BL_WINDOW_ERASE_FAIL)
+		bootloader_window_send(BL_WINDOW_END, status);
+	printmsg1("BL_DEBUG_MSG: windowed write done, status %d, %d bytes\r\n", status, bytes_done);
+}
+
 /******************* Implementation Helper functions prototypes **********************************************/
 
+/*UART stream callback of the windowed write : rebuilds data frames byte by byte into the free slot
+ * A frame that finds the ring full is dropped, the host sends it again after going back*/
+void bootloader_window_rx_byte(u8 byte)
+{
+	BL_WindowFrame_t* frame = &static_WindowSlots[static_u8WindowHead];
+
+	switch(static_u8WindowRxState)
+	{
+	case BL_WINDOW_RX_SOF:
+		if(byte == BL_WINDOW_FRAME_SOF) static_u8WindowRxState = BL_WINDOW_RX_SEQ;
+		break;
+	case BL_WINDOW_RX_SEQ:
+		frame->seq = byte;
+		static_u8WindowRxState = BL_WINDOW_RX_LEN;
+		break;
+	case BL_WINDOW_RX_LEN:
+		if(byte == 0 || byte > BL_WINDOW_FRAME_PAYLOAD || (byte & 3) ||
+		   ((static_u8WindowHead+1) % BL_WINDOW_SLOTS) == static_u8WindowTail)
+		{
+			static_u8WindowRxState = BL_WINDOW_RX_SOF;
+		}
+		else
+		{
+			frame->len = byte;
+			static_u16WindowRxIndex = 0;
+			static_u8WindowRxState  = BL_WINDOW_RX_PAYLOAD;
+		}
+		break;
+	case BL_WINDOW_RX_PAYLOAD:
+		((u8*)frame->payload)[static_u16WindowRxIndex++] = byte;
+		if(static_u16WindowRxIndex == frame->len)
+		{
+			static_u16WindowRxIndex = 0;
+			static_u8WindowRxState  = BL_WINDOW_RX_CRC;
+		}
+		break;
+	case BL_WINDOW_RX_CRC:
+		((u8*)&frame->crc)[static_u16WindowRxIndex++] = byte;
+		if(static_u16WindowRxIndex == 4)
+		{
+			static_u8WindowHead    = (static_u8WindowHead+1) % BL_WINDOW_SLOTS;
+			static_u8WindowRxState = BL_WINDOW_RX_SOF;
+		}
+		break;
+	}
+}
+
+/*CRC32 of a data frame, every byte of (sequence number, length, payload) is fed as one word like the command packets*/
+u32 bootloader_window_frame_crc(BL_WindowFrame_t* frame)
+{
+	u32 iData;
+	u32 crc_value;
+	u8  index;
+
+	CRC_ResetDR();
+	iData     = frame->seq;
+	crc_value = CRC_CalcBlockCRC(&iData, 1);
+	iData     = frame->len;
+	crc_value = CRC_CalcBlockCRC(&iData, 1);
+	for(index=0; index<frame->len; index++)
+	{
+		iData     = ((u8*)frame->payload)[index];
+		crc_value = CRC_CalcBlockCRC(&iData, 1);
+	}
+	return crc_value;
+}
+
+/*Sends one two bytes reply of the windowed write (type, value)*/
+void bootloader_window_send(u8 type, u8 value)
+{
+	u8 reply[2]={type,value};
+	HUART_u8SendSync(HUART_USART2,reply,2,1);
+}
+
+
 void bootloader_send_ack(u8 follow_len)
 {
 	//here we send 2 bytes .. first byte is ack and the second byte is the length of the following
@@ -294,6 +294,22 @@ u8 HUART_u8ReceiveSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer,
 	 	return Local_u8Status;
 }
 
+/*Description: This API will be used to receive a byte stream using interrupts, every byte (zeros included) is passed to the callback
+ * Parameters: Desired UART (struct), Pointer to byte callback function
+ * Return: Error Status (u8)  */
+u8 HUART_u8StartStreamReceive(UART_GPIO_t Copy_u32PeripheralNumber, RXByteCallback_t Copy_RXByteCallbackFunction)
+{
+	return UART_u8StartStreamReceive(Copy_u32PeripheralNumber.BaseAddress, Copy_RXByteCallbackFunction);
+}
+
+/*Description: This API will be used to stop the byte stream started by HUART_u8StartStreamReceive
+ * Parameters: Desired UART (struct)
+ * Return: None  */
+void HUART_voidStopStreamReceive(UART_GPIO_t Copy_u32PeripheralNumber)
+{
+	UART_voidStopStreamReceive(Copy_u32PeripheralNumber.BaseAddress);
+}
+
 /*Description: This function can be used to terminate async receiving (Warning!: Don't use it unless you know what you are doing)
  * Parameters: Desired UART Peripheral address (u32)
  * return: None*/
@@ -31,6 +31,10 @@ static TXCallback_t TXCallbackFunctionUART3 = NULL;
 static RXCallback_t RXCallbackFunctionUART1 = NULL;
 static RXCallback_t RXCallbackFunctionUART2 = NULL;
 static RXCallback_t RXCallbackFunctionUART3 = NULL;
+/*Byte callbacks are only set while stream receiving is on*/
+static RXByteCallback_t RXByteCallbackFunctionUART1 = NULL;
+static RXByteCallback_t RXByteCallbackFunctionUART2 = NULL;
+static RXByteCallback_t RXByteCallbackFunctionUART3 = NULL;
 
 
 #define STATUS_BUSY				(u8)2
@@ -338,6 +342,60 @@ u8 UART_u8SetRXCallBack(RXCallback_t Copy_RXCallbackFunction, u32 Copy_u32Desire
 	return STATUS_OK ;
 }/*End of SetRXCallBack*/
 
+/*Description: This API will start stream receiving, every received byte (zeros included) is passed to the byte callback from the IRQ
+ * Parameters: Desired UART Peripheral (u32), Pointer to byte callback function
+ * Return:Error Status */
+u8 UART_u8StartStreamReceive(u32 Copy_u32UARTAddress, RXByteCallback_t Copy_RXByteCallbackFunction)
+{
+	/*This local variable holds the status which will be returned at the end*/
+	u8 Local_u8Status = STATUS_NOK;
+
+	if (Copy_RXByteCallbackFunction != NULL)
+	{
+		if (Copy_u32UARTAddress == UART_USART1_BASE_ADDRESS && rxBufferUART1.bufferState == STATUS_IDLE)
+		{
+			RXByteCallbackFunctionUART1 = Copy_RXByteCallbackFunction;
+			Local_u8Status = STATUS_OK;
+		}
+		else if (Copy_u32UARTAddress == UART_USART2_BASE_ADDRESS && rxBufferUART2.bufferState == STATUS_IDLE)
+		{
+			RXByteCallbackFunctionUART2 = Copy_RXByteCallbackFunction;
+			Local_u8Status = STATUS_OK;
+		}
+		else if (Copy_u32UARTAddress == UART_USART3_BASE_ADDRESS && rxBufferUART3.bufferState == STATUS_IDLE)
+		{
+			RXByteCallbackFunctionUART3 = Copy_RXByteCallbackFunction;
+			Local_u8Status = STATUS_OK;
+		}
+	}
+	/*Callback is in place before the first byte can fire the interrupt*/
+	if (Local_u8Status == STATUS_OK)
+	{
+		UART_u8EnableInterrupt(Copy_u32UARTAddress, UART_RX_NOT_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_ENABLE_MASK);
+	}
+	return Local_u8Status;
+}/*End of StartStreamReceive*/
+
+/*Description: This API will stop stream receiving and disable the RX interrupt
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: None */
+void UART_voidStopStreamReceive(u32 Copy_u32UARTAddress)
+{
+	UART_u8EnableInterrupt(Copy_u32UARTAddress, UART_RX_NOT_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_DISABLE_MASK);
+	if (Copy_u32UARTAddress == UART_USART1_BASE_ADDRESS)
+	{
+		RXByteCallbackFunctionUART1 = NULL;
+	}
+	else if (Copy_u32UARTAddress == UART_USART2_BASE_ADDRESS)
+	{
+		RXByteCallbackFunctionUART2 = NULL;
+	}
+	else if (Copy_u32UARTAddress == UART_USART3_BASE_ADDRESS)
+	{
+		RXByteCallbackFunctionUART3 = NULL;
+	}
+}/*End of StopStreamReceive*/
+
 /*Description: This function can be used to terminate async receiving (Warning!: Don't use it unless you know what you are doing)
  * Parameters: Desired UART Peripheral address (u32)
  * return: None*/
@@ -413,6 +471,12 @@ void UART_voidTerminateSending (u32 Copy_u32DesiredUARTBaseAddress)
 
 /*Interrupt Handler Implementation*/
 void USART1_IRQHandler(void) {
+	/*In stream mode the received byte is read once (SR then DR) and passed to the byte callback, zeros included*/
+	if ((RXByteCallbackFunctionUART1 != NULL) && ((*((u32*) (UART_USART1_BASE_ADDRESS + UART_SR ))) & UART_RX_NOT_EMPTY_MASK))
+	{
+		RXByteCallbackFunctionUART1((u8)(*((u32*) (UART_USART1_BASE_ADDRESS + UART_DR ))));
+		return;
+	}
 	/*Check which flag fired the interrupt request*/
 	u32 volatile Local_u32RXFlag = *((u32*) (UART_USART1_BASE_ADDRESS + UART_DR )) & 0xFFFFFFFF;
 	u32 volatile Local_u32TXFlag = *((u32*) (UART_USART1_BASE_ADDRESS + UART_SR )) & UART_TX_EMPTY_MASK;
@@ -494,6 +558,12 @@ void USART1_IRQHandler(void) {
 
 /*Interrupt Handler Implementation*/
 void USART2_IRQHandler(void) {
+	/*In stream mode the received byte is read once (SR then DR) and passed to the byte callback, zeros included*/
+	if ((RXByteCallbackFunctionUART2 != NULL) && ((*((u32*) (UART_USART2_BASE_ADDRESS + UART_SR ))) & UART_RX_NOT_EMPTY_MASK))
+	{
+		RXByteCallbackFunctionUART2((u8)(*((u32*) (UART_USART2_BASE_ADDRESS + UART_DR ))));
+		return;
+	}
 	/*Check which flag fired the interrupt request*/
 	u32 volatile Local_u32RXFlag = *((u32*) (UART_USART2_BASE_ADDRESS + UART_DR )) & 0xFFFFFFFF;
 	u32 volatile Local_u32TXFlag = *((u32*) (UART_USART2_BASE_ADDRESS + UART_SR )) & UART_TX_EMPTY_MASK;
@@ -574,6 +644,12 @@ void USART2_IRQHandler(void) {
 
 /*Interrupt Handler Implementation*/
 void USART3_IRQHandler(void) {
+	/*In stream mode the received byte is read once (SR then DR) and passed to the byte callback, zeros included*/
+	if ((RXByteCallbackFunctionUART3 != NULL) && ((*((u32*) (UART_USART3_BASE_ADDRESS + UART_SR ))) & UART_RX_NOT_EMPTY_MASK))
+	{
+		RXByteCallbackFunctionUART3((u8)(*((u32*) (UART_USART3_BASE_ADDRESS + UART_DR ))));
+		return;
+	}
 	/*Check which flag fired the interrupt request*/
 	u32 volatile Local_u32RXFlag = *((u32*) (UART_USART3_BASE_ADDRESS + UART_DR )) & 0xFFFFFFFF;
 	u32 volatile Local_u32TXFlag = *((u32*) (UART_USART3_BASE_ADDRESS + UART_SR )) & UART_TX_EMPTY_MASK;
@@ -0,0 +1,80 @@
+/*
+ * APPINFO_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/* Applications information table, kept as an append-only log over two flash pages.
+ * Every change to an application record is appended as a new record carrying a sequence number,
+ * the newest sequence of each slot wins. When the active page is full, the latest record of every
+ * slot is copied to the other page (compaction) and the old page is erased.
+ * An index holding the flash address of the newest record of every slot is built once in RAM by (APPINFO_u8Init)*/
+
+#ifndef APPINFO_INTERFACE_H_
+#define APPINFO_INTERFACE_H_
+
+#include "STD_TYPES.h"
+#include "Flash.h"
+
+/*Macros*/
+/*Pages of the region (BLMETA) that the linker script (mem.ld) keeps out of the bootloader image*/
+#define		APPINFO_LOG_PAGE_A							FLASH_MEMORY_PAGE_29
+#define		APPINFO_LOG_PAGE_B							FLASH_MEMORY_PAGE_30
+
+/*Maximum number of applications, limited by the reply of (BL_EXISTING_APPS) which must fit in 256 bytes*/
+#define		APPINFO_MAX_APPS							(u8)15
+/*Size of application info sent to host: base address (4), size in bytes (4), name (8)*/
+#define		APPINFO_PUBLIC_RECORD_SIZE					(u8)16
+#define		APPINFO_NAME_SIZE							(u8)8
+/*Image CRC of records that were saved without one (the range was not a valid image), such images are not checked at boot*/
+#define		APPINFO_NO_IMAGE_CRC						((u32)0xFFFFFFFF)
+/*Image CRC of a record whose image was rewritten and could not be saved again (programmed to zero in place), not checked at boot*/
+#define		APPINFO_INVALIDATED_CRC						((u32)0x00000000)
+
+/*One log record (28 bytes), the layout from (baseAddress) to (name) is the same one reported to host*/
+typedef struct
+{
+	u32 sequence;							/*Increases with every appended record, newest wins*/
+	u32 baseAddress;						/*Application base memory address*/
+	u32 sizeInBytes;						/*Application size in bytes*/
+	u8  name[APPINFO_NAME_SIZE];			/*Application name*/
+	u32 imageCrc;							/*CRC32 of (sizeInBytes) bytes starting from (baseAddress), computed at save time*/
+	u16 slot;								/*Application number inside the table*/
+	u16 commit;								/*Written last, record is ignored if it was not written*/
+}APPINFO_Record_t;
+
+
+/*Description: This API will scan the two log pages, recover from an interrupted compaction, migrate the old
+ * 				single page table if found, and build the RAM index of the applications
+ * parameters: void
+ * Return: Error Status*/
+extern u8 APPINFO_u8Init (void);
+
+/*Description: This API will return the number of applications saved in the table
+ * parameters: void
+ * Return: number of applications*/
+extern u8 APPINFO_u8GetNumberOfApps (void);
+
+/*Description: This API will copy the newest record of an application from flash
+ * parameters: application slot (u8), pointer to record that will hold the data (APPINFO_Record_t*)
+ * Return: Error Status*/
+extern u8 APPINFO_u8GetRecord (u8 Copy_u8Slot, APPINFO_Record_t* Copy_pRecord);
+
+/*Description: This API will append a record for an application, passing slot equal to number of apps adds a new application
+ * parameters: application slot (u8), base address (u32), size in bytes (u32), name of 8 chars (u8*), image CRC32 (u32)
+ * Return: Error Status*/
+extern u8 APPINFO_u8WriteApp (u8 Copy_u8Slot, u32 Copy_u32BaseAddress, u32 Copy_u32SizeInBytes, u8* Copy_u8Name, u32 Copy_u32ImageCrc);
+
+/*Description: This API will find the newest application record whose image starts at a given address
+ * parameters: base address (u32), pointer to record that will hold the data (APPINFO_Record_t*)
+ * Return: Error Status*/
+extern u8 APPINFO_u8FindByBaseAddress (u32 Copy_u32BaseAddress, APPINFO_Record_t* Copy_pRecord);
+
+/*Description: This API will refresh the newest record of a base address after a new image was written and verified there,
+ * 				the record keeps its slot and name. If it can not be appended, its saved CRC is invalidated in place
+ * parameters: base address (u32), size in bytes (u32), image CRC32 (u32)
+ * Return: Error Status (OK also when no record describes this address)*/
+extern u8 APPINFO_u8UpdateImage (u32 Copy_u32BaseAddress, u32 Copy_u32SizeInBytes, u32 Copy_u32ImageCrc);
+
+#endif /* APPINFO_INTERFACE_H_ */
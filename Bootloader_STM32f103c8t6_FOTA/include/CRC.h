@@ -19,6 +19,7 @@ void 		CRC_ResetDR(void);
 //u32 		CRC_CalcCRC(u32 Data); //original and Hamdy
 u32 		CRC_CalcCRC(u32 Data/*,u32* ret_val*/); //Nafe3
 u32 		CRC_CalcBlockCRC(u32 pBuffer[], u32 BufferLength);
+u32 		CRC_CalcBlockCRCDMA(u32 pBuffer[], u32 BufferLength); //DMA1 clock must be enabled
 u32 		CRC_GetCRC(void);
 void 		CRC_SetIDRegister(u8 IDValue);
 u8 	        CRC_GetIDRegister(void);
@@ -0,0 +1,33 @@
+/*DMA DRIVER FOR STM32
+VERSION: 1.0
+AUTHOR: MAHMOUD HAMDY*/
+
+/*This driver is for DMA1 only, transfers are done in polling mode (no interrupts)*/
+
+#ifndef DMA_INTERFACE_H_
+#define DMA_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+/*Channels Selections*/
+#define DMA_CHANNEL1								(u8)1
+#define DMA_CHANNEL2								(u8)2
+#define DMA_CHANNEL3								(u8)3
+#define DMA_CHANNEL4								(u8)4
+#define DMA_CHANNEL5								(u8)5
+#define DMA_CHANNEL6								(u8)6
+#define DMA_CHANNEL7								(u8)7
+
+/*Maximum number of items in one transfer (CNDTR is 16 bits)*/
+#define DMA_MAX_TRANSFER_ITEMS						(u16)0xFFFF
+
+
+/*APIs*/
+/*Description: This API will copy words from memory to a fixed address (like a peripheral data register) in
+ * memory to memory mode, source address is incremented while destination address is not.
+ * The function waits until the transfer is complete
+Parameters: channel (u8), source address (const u32*), destination address (volatile u32*), number of words (u16)
+Return:Error Status (u8)*/
+extern u8 DMA_u8MemoryToFixedAddress (u8 Copy_u8Channel, const u32* Copy_pu32Source, volatile u32* Copy_pu32Destination, u16 Copy_u16NumberOfWords);
+
+#endif /* DMA_INTERFACE_H_ */
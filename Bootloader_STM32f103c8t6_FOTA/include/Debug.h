@@ -9,6 +9,7 @@
 #define DEBUG_H_
 
 u16 printmsg1(const char* format, ...);
+void flushmsg1(void);
 u16 printmsg2(const char* format, ...);
 u16 printmsg3(const char* format, ...);
 
@@ -6,5 +6,7 @@
 void delay_setCPUclockFactor(void);
 void delay_ms(u32 time);
 void delay_us(u32 time);
+/* returns the current value of HCLK in Hz */
+u32  delay_u32GetCPUclock(void);
 
 #endif /* DELAY_INTERFACE_H_ */
@@ -0,0 +1,36 @@
+/*
+ * HEX_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/*Hex codec shared by the command decoder, the image download and the WIFI replies
+ * every byte travels as two chars, encoded with lower case letters and decoded from either case*/
+
+#ifndef HEX_INTERFACE_H_
+#define HEX_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+/*Macros*/
+#define		HEX_INVALID_CHAR						(u8)0xFF		/*Value of a char that is not a hex digit in HEX_u8DecodeTable*/
+
+/*Nibble value of every char (0..15), HEX_INVALID_CHAR for chars that are not hex digits*/
+extern const u8 HEX_u8DecodeTable[256];
+/*Char of every nibble value*/
+extern const u8 HEX_u8EncodeTable[16];
+
+
+/*Description: This API will convert chars to bytes, two chars per byte, four chars are loaded at once
+ * the output may overlap the input as long as it starts at the same address or before it
+ * parameters: chars (u8*), bytes (u8*), number of bytes to produce (u16)
+ * Return: Error Status (NOK if any char is not a hex digit, the bytes are then not to be trusted)*/
+extern u8 HEX_u8Decode (const u8* Copy_pu8Chars, u8* Copy_pu8Bytes, u16 Copy_u16NumOfBytes);
+
+/*Description: This API will convert bytes to chars, two chars per byte, four chars are stored at once
+ * parameters: bytes (u8*), chars (u8*), number of bytes to convert (u16)
+ * Return: void*/
+extern void HEX_voidEncode (const u8* Copy_pu8Bytes, u8* Copy_pu8Chars, u16 Copy_u16NumOfBytes);
+
+#endif /* HEX_INTERFACE_H_ */
@@ -3,9 +3,14 @@
  *
  *  Created on: June 4, 2020
  *      Author: Mahmoud Hamdy
- *      Version: 2.0
+ *      Version: 2.1
  */
 
+/*Changelog from version 2.0:
+ * 1) Added RTS and CTS pins to the peripheral objects and HUART_u8SetFlowControl for hardware flow control
+ * 2) Added HUART_u8GetErrors to read the receive errors counted by the IRQs
+ * */
+
 /*Changelog from version 1.1:
  * 1) Removed Deparcated Macros (related to baudrate)
  * 2) Changed the flags for the IRQ because there were bugs in it
@@ -24,6 +29,7 @@
 #define HUART_INTERFACE_H_
 
 #include "GPIO.h"
+#include "UART_interface.h"
 
 /*Macros*/
 
@@ -36,6 +42,12 @@
 #define UART_PARITY_ODD					(u32)(0x600)
 #define UART_PARITY_DISABLED			(u32)~(0x400)
 
+/*Hardware Flow Control*/
+#define HUART_FLOW_CONTROL_NONE			UART_FLOW_CONTROL_NONE
+#define HUART_FLOW_CONTROL_RTS			UART_FLOW_CONTROL_RTS
+#define HUART_FLOW_CONTROL_CTS			UART_FLOW_CONTROL_CTS
+#define HUART_FLOW_CONTROL_RTS_CTS		UART_FLOW_CONTROL_RTS_CTS
+
 /*Interrupt Enable Controls*/
 #define UART_INTERRUPT_PARITY_ERROR		(u32)(0x100)
 #define UART_INTERRUPT_IDLE				(u32)(0x10)
@@ -53,6 +65,9 @@ typedef struct
 {
 	GPIO_Pin_t TX;
 	GPIO_Pin_t RX;
+	/*Flow control pins, configured only by HUART_u8SetFlowControl*/
+	GPIO_Pin_t RTS;
+	GPIO_Pin_t CTS;
 	u32 Port;
 	u32 PeripheralClockName;
 	u8 InterruptPeripheralName;
@@ -87,22 +102,66 @@ extern u8 HUART_u8SetTXCallBack(TXCallback_t Copy_TXCallbackFunction, u32 Copy_u
 extern u8 HUART_u8SetRXCallBack(RXCallback_t Copy_RXCallbackFunction, u32 Copy_u32DesiredUART);
 
 /*Description: This API will be used to pass data buffer for sending using interrupts.
- * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u8)
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
  * Return: Error Status (u8)  */
-extern u8 HUART_u8SendAsync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u8 Copy_u8Size);
+extern u8 HUART_u8SendAsync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size);
+/*Description: This API will be used to send several buffers back to back using interrupts, without copying them together
+ * The data of every segment must stay unchanged until the sending is done, the segments array itself is copied
+ * Parameters: Desired UART (struct), segments (UART_Segment_t*), number of segments (u8, up to UART_GATHER_MAX_SEGMENTS)
+ * Return: Error Status (u8)  */
+extern u8 HUART_u8SendGatherAsync(UART_GPIO_t Copy_u32PeripheralNumber, const UART_Segment_t* Copy_pSegments, u8 Copy_u8Count);
 /*Description: This API will be used to pass data buffer for receiving using interrupts.
- * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u8)
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
  * Return: Error Status (u8)  */
-extern u8 HUART_u8ReceiveAsync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u8 Copy_u8Size);
+extern u8 HUART_u8ReceiveAsync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size);
 
 /*Description: This API will be used to pass data buffer for sending using polling.
- * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u8), desired time between frames (u32)
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16), timeout for each frame in ms (u32, 0 waits for ever)
  * Return: Error Status (u8)  */
-extern u8 HUART_u8SendSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u8 Copy_u8Size, u32 Copy_u32Time);
+extern u8 HUART_u8SendSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32Time);
 /*Description: This API will be used to pass data buffer for receiving using polling.
- * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u8)
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
+ * Return: Error Status (u8)  */
+extern u8 HUART_u8ReceiveSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32Time);
+
+/*Description: This API will make received bytes go to the rx ring of the peripheral (emptied first), they are taken with HUART_u16Read
+ * Parameters: Desired UART (struct)
+ * Return: Error Status (u8)  */
+extern u8 HUART_u8StartRXRing(UART_GPIO_t Copy_u32PeripheralNumber);
+/*Description: This API will stop putting received bytes in the rx ring
+ * Parameters: Desired UART (struct)
+ * Return: None  */
+extern void HUART_voidStopRXRing(UART_GPIO_t Copy_u32PeripheralNumber);
+/*Description: This API will take the received bytes waiting in the rx ring, up to the size of the buffer, without waiting
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
+ * Return: number of bytes taken (u16)  */
+extern u16 HUART_u16Read(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size);
+/*Description: This API will drop the received bytes that were not read yet
+ * Parameters: Desired UART (struct)
+ * Return: None  */
+extern void HUART_voidFlushRX(UART_GPIO_t Copy_u32PeripheralNumber);
+/*Description: This API will give the number of received bytes dropped because the rx ring was full, since reset
+ * Parameters: Desired UART (struct)
+ * Return: number of bytes dropped (u16)  */
+extern u16 HUART_u16GetRXDropped(UART_GPIO_t Copy_u32PeripheralNumber);
+/*Description: This API will queue bytes in the tx ring without waiting, they are sent by interrupts
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
+ * Return: number of bytes queued (u16)  */
+extern u16 HUART_u16Write(UART_GPIO_t Copy_u32PeripheralNumber, const u8 *Copy_u8Buffer, u16 Copy_u16Size);
+/*Description: This API will wait until the bytes queued in the tx ring are on the wire
+ * Parameters: Desired UART (struct), timeout in ms (u32, 0 waits for ever)
+ * Return: Error Status (u8)  */
+extern u8 HUART_u8FlushTX(UART_GPIO_t Copy_u32PeripheralNumber, u32 Copy_u32Time);
+
+/*Description: This API will enable or disable hardware flow control and configure the pins it uses
+ * (USART1 RTS PA12 CTS PA11, USART2 RTS PA1 CTS PA0, USART3 RTS PB14 CTS PB13)
+ * Parameters: Desired UART (struct), flow control (u8, HUART_FLOW_CONTROL_...)
+ * Return: Error Status (u8)  */
+extern u8 HUART_u8SetFlowControl(UART_GPIO_t Copy_u32PeripheralNumber, u8 Copy_u8FlowControl);
+/*Description: This API will give the overrun, noise and framing errors counted since reset
+ * Parameters: Desired UART (struct), counters (UART_Errors_t*)
  * Return: Error Status (u8)  */
-extern u8 HUART_u8ReceiveSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u8 Copy_u8Size, u32 Copy_u32Time);
+extern u8 HUART_u8GetErrors(UART_GPIO_t Copy_u32PeripheralNumber, UART_Errors_t* Copy_pErrors);
 
 /*Description: This function can be used to terminate async receiving (Warning!: Don't use it unless you know what you are doing)
  * Parameters: Desired UART Peripheral address (u32)
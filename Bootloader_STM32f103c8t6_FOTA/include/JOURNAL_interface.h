@@ -0,0 +1,57 @@
+/*
+ * JOURNAL_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/* Download progress journal, kept in one flash page so that a download interrupted by a power failure or a reset
+ * continues from the last verified page instead of byte zero.
+ * The header identifies the download (base address, size and CRC32 of the whole image), then one word is appended
+ * after every page that was written and read back correctly.
+ * Writing functions need the FPEC to be unlocked by the caller (the download keeps it unlocked)*/
+
+#ifndef JOURNAL_INTERFACE_H_
+#define JOURNAL_INTERFACE_H_
+
+#include "STD_TYPES.h"
+#include "Flash.h"
+
+/*Macros*/
+/*Last page of the region (BLMETA) that the linker script (mem.ld) keeps out of the bootloader image*/
+#define		JOURNAL_PAGE								FLASH_MEMORY_PAGE_31
+/*Progress is saved in steps of one flash page*/
+#define		JOURNAL_STEP_SIZE							(1 K)
+
+typedef struct
+{
+	u32 baseAddress;						/*First address of the image*/
+	u32 sizeInBytes;						/*Size of the whole image*/
+	u32 imageCrc;							/*CRC32 of the whole image as sent by host*/
+	u32 bytesDone;							/*Number of bytes from (baseAddress) that were written and verified*/
+}JOURNAL_Progress_t;
+
+
+/*Description: This API will continue the journal of the same download (same address, size and CRC) if there is one,
+ * 				otherwise it will erase the journal and start a new one
+ * parameters: base address (u32), size in bytes (u32), image CRC32 (u32), pointer that will hold the resume offset (u32*)
+ * Return: Error Status*/
+extern u8 JOURNAL_u8Start (u32 Copy_u32BaseAddress, u32 Copy_u32SizeInBytes, u32 Copy_u32ImageCrc, u32* Copy_pu32ResumeOffset);
+
+/*Description: This API will append the number of bytes written and verified so far, it must be a multiple of
+ * 				(JOURNAL_STEP_SIZE) or the end of the image
+ * parameters: bytes done (u32)
+ * Return: Error Status*/
+extern u8 JOURNAL_u8CommitProgress (u32 Copy_u32BytesDone);
+
+/*Description: This API will erase the journal, it is called when the download is finished
+ * parameters: void
+ * Return: Error Status*/
+extern u8 JOURNAL_u8Clear (void);
+
+/*Description: This API will read the state of an unfinished download
+ * parameters: pointer to progress that will hold the data (JOURNAL_Progress_t*)
+ * Return: STATUS_OK if an unfinished download was found*/
+extern u8 JOURNAL_u8GetProgress (JOURNAL_Progress_t* Copy_pProgress);
+
+#endif /* JOURNAL_INTERFACE_H_ */
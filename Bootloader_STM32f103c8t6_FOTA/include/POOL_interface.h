@@ -0,0 +1,62 @@
+/*
+ * POOL_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/* Fixed-block pools for the transfer buffers of the bootloader (decoded commands, flash pages, hex chars)
+ * Every pool is a static array of blocks of one size, a buffer is taken for one phase of a command and given back
+ * when the phase is done, so buffers that are never live together share the same RAM
+ * A request is served by the smallest pool whose blocks can hold it, a larger pool is used when that one is full
+ * Blocks are word aligned and zeroed when they are handed out
+ * The pools are used from thread mode only (not from interrupts)*/
+
+#ifndef POOL_INTERFACE_H_
+#define POOL_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+/*Pools sizes, blocks sizes must be multiples of 4 and a pool can not have more than 8 blocks*/
+#define		POOL_SMALL_BLOCK_SIZE					256U		/*Decoded command packet (length byte + 255 bytes)*/
+#define		POOL_SMALL_BLOCKS						2U
+#define		POOL_PAGE_BLOCK_SIZE					1024U		/*One flash page*/
+#define		POOL_PAGE_BLOCKS						2U
+#define		POOL_CHARS_BLOCK_SIZE					2048U		/*Hex chars of one page, as received from the server*/
+#define		POOL_CHARS_BLOCKS						1U
+
+/*Pools numbers, from the smallest blocks to the largest*/
+#define		POOL_SMALL								0
+#define		POOL_PAGE								1
+#define		POOL_CHARS								2
+#define		POOL_COUNT								3
+
+typedef struct
+{
+	u16 blockSize;
+	u16 largestRequest;						/*Largest size asked from this pool since reset*/
+	u16 exhausted;							/*Requests that found this pool full (served by a larger pool or not served)*/
+	u8  blocks;
+	u8  inUse;
+	u8  peakInUse;							/*Most blocks taken at the same time since reset*/
+}POOL_Stats_t;
+
+#define		POOL_STATS_RECORD_SIZE					9U		/*blockSize (2), largestRequest (2), exhausted (2), blocks, inUse, peakInUse*/
+
+
+/*Description: This API will take a zeroed block that can hold (Copy_u16Size) bytes
+ * parameters: size (u16)
+ * Return: block, NULL if no pool has a free block large enough*/
+extern void* POOL_pvAlloc (u16 Copy_u16Size);
+
+/*Description: This API will give a block back to its pool, NULL is ignored
+ * parameters: block (void*)
+ * Return: void*/
+extern void POOL_voidFree (void* Copy_pvBlock);
+
+/*Description: This API will read the usage of one pool
+ * parameters: pool (POOL_SMALL ... POOL_CHARS), stats (POOL_Stats_t*)
+ * Return: Error Status*/
+extern u8 POOL_u8GetStats (u8 Copy_u8Pool, POOL_Stats_t* Copy_pStats);
+
+#endif /* POOL_INTERFACE_H_ */
@@ -0,0 +1,61 @@
+/*
+ * PROF_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/* Sampling profiler of the bootloader, read by the host with BL_GET_PROFILE
+ * SysTick interrupts the CPU at the chosen rate and the PC stacked by the interrupt is counted in a histogram,
+ * every bucket covers (1 << PROF_BUCKET_SHIFT) bytes of the bootloader code, samples taken outside it
+ * (application code, RAM) are only counted
+ * SysTick has the highest priority, so time spent in other interrupt handlers (UART callbacks) is sampled as well
+ * This driver owns SysTick_Handler*/
+
+#ifndef PROF_INTERFACE_H_
+#define PROF_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+/*Code covered by the histogram*/
+#define		PROF_CODE_START							0x08000000
+#define		PROF_CODE_SIZE							0x8000			/*32 KB of bootloader, the application starts after it*/
+#define		PROF_BUCKET_SHIFT						7				/*128 bytes per bucket*/
+#define		PROF_NUMBER_OF_BUCKETS					(PROF_CODE_SIZE>>PROF_BUCKET_SHIFT)
+
+/*Sampling rates (Hz), SysTick reload is 24 bits so the rate can not go lower at 72 MHz*/
+#define		PROF_MIN_RATE							5U
+#define		PROF_MAX_RATE							10000U
+
+
+/*Description: This API will clear the histogram and start sampling
+ * parameters: samples per second (u16), from PROF_MIN_RATE to PROF_MAX_RATE
+ * Return: Error Status*/
+extern u8 PROF_u8Start (u16 Copy_u16RateHz);
+
+/*Description: This API will stop sampling, the histogram is kept
+ * parameters: void
+ * Return: void*/
+extern void PROF_voidStop (void);
+
+/*Description: This API will start sampling again at the last rate without clearing the histogram
+ * parameters: void
+ * Return: void*/
+extern void PROF_voidResume (void);
+
+/*Description: This API will clear the histogram
+ * parameters: void
+ * Return: void*/
+extern void PROF_voidClear (void);
+
+/*Description: This API will give the state of the profiler
+ * parameters: rate in Hz, 0 when stopped (u16*), total samples (u32*), samples outside the bootloader code (u32*)
+ * Return: void*/
+extern void PROF_voidGetSummary (u16* Copy_pu16RateHz, u32* Copy_pu32Samples, u32* Copy_pu32Outside);
+
+/*Description: This API will find the next bucket holding samples
+ * parameters: bucket to start looking from (u16), number of samples of the bucket found (u32*)
+ * Return: index of the bucket found, PROF_NUMBER_OF_BUCKETS if there is none*/
+extern u16 PROF_u16NextBucket (u16 Copy_u16From, u32* Copy_pu32Samples);
+
+#endif /* PROF_INTERFACE_H_ */
@@ -0,0 +1,62 @@
+/*
+ * RING_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/* Single producer / single consumer byte rings, used between an interrupt and the main loop without disabling interrupts
+ * Only the producer writes (head) and only the consumer writes (tail), both run freely and are masked on access,
+ * so the size must be a power of two (2 ... 32768)
+ * Every ring has one producer and one consumer : an interrupt and the main loop, never two of either*/
+
+#ifndef RING_INTERFACE_H_
+#define RING_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+typedef struct
+{
+	u8*          buffer;
+	u16          mask;							/*Size - 1*/
+	volatile u16 head;							/*Next byte to write, written by the producer only*/
+	volatile u16 tail;							/*Next byte to read, written by the consumer only*/
+	volatile u16 dropped;						/*Bytes the producer could not put because the ring was full*/
+}RING_t;
+
+/*Description: This API will attach a storage array to a ring and empty it
+ * parameters: ring (RING_t*), storage (u8*), size of storage (u16, power of two)
+ * Return: Error Status (NOK if the size is not a power of two)*/
+extern u8 RING_u8Init (RING_t* Copy_pRing, u8* Copy_pu8Storage, u16 Copy_u16Size);
+
+/*Description: This API will put one byte in the ring (producer side), the byte is counted as dropped if the ring is full
+ * parameters: ring (RING_t*), byte (u8)
+ * Return: Error Status (NOK if the ring is full)*/
+extern u8 RING_u8Put (RING_t* Copy_pRing, u8 Copy_u8Byte);
+
+/*Description: This API will take one byte from the ring (consumer side)
+ * parameters: ring (RING_t*), byte (u8*)
+ * Return: Error Status (NOK if the ring is empty)*/
+extern u8 RING_u8Get (RING_t* Copy_pRing, u8* Copy_pu8Byte);
+
+/*Description: This API will put as many bytes as fit in the ring (producer side)
+ * parameters: ring (RING_t*), bytes (u8*), number of bytes (u16)
+ * Return: number of bytes put*/
+extern u16 RING_u16Write (RING_t* Copy_pRing, const u8* Copy_pu8Bytes, u16 Copy_u16Count);
+
+/*Description: This API will take up to (Copy_u16Max) bytes from the ring (consumer side)
+ * parameters: ring (RING_t*), destination (u8*), most bytes to take (u16)
+ * Return: number of bytes taken*/
+extern u16 RING_u16Read (RING_t* Copy_pRing, u8* Copy_pu8Bytes, u16 Copy_u16Max);
+
+/*Description: This API will drop everything in the ring (consumer side)
+ * parameters: ring (RING_t*)
+ * Return: void*/
+extern void RING_voidFlush (RING_t* Copy_pRing);
+
+/*Description: This API will give the number of bytes waiting in the ring
+ * parameters: ring (RING_t*)
+ * Return: number of bytes*/
+extern u16 RING_u16Count (RING_t* Copy_pRing);
+
+#endif /* RING_INTERFACE_H_ */
@@ -0,0 +1,70 @@
+/*
+ * SCHED_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/* Cooperative run-to-completion scheduler of the bootloader (no RTOS, one stack)
+ * A task is a function called with the events posted to it since its last run, it runs until it returns and is never
+ * preempted by another task. The task number is its priority, task 0 runs first
+ * Events are posted by tasks, by timers and by interrupts (SCHED_voidPost is lock free)
+ * Timers are kept in a hashed timer wheel of SCHED_WHEEL_SLOTS slots of SCHED_TICK_MS each, timed on the DWT cycle counter,
+ * so the scheduler must be run at least once every DWT wrap (about 59 s at 72 MHz)
+ * A task that has to wait calls SCHED_voidSleep, the other tasks run meanwhile, a task is never run inside itself*/
+
+#ifndef SCHED_INTERFACE_H_
+#define SCHED_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+#define		SCHED_MAX_TASKS							4U
+#define		SCHED_MAX_TIMERS						4U
+#define		SCHED_TICK_MS							10U
+#define		SCHED_WHEEL_SLOTS						16U		/*Power of two*/
+
+/*Task function, called with the events posted to the task since its last run (never 0)*/
+typedef void (*SCHED_Task_t)(u32 Copy_u32Events);
+
+
+/*Description: This API will enable the DWT cycle counter, remove all tasks and timers and start the wheel from now
+ * parameters: void
+ * Return: void*/
+extern void SCHED_voidInit (void);
+
+/*Description: This API will add a task to the scheduler
+ * parameters: task number, also its priority (u8, 0 ... SCHED_MAX_TASKS-1), task function (SCHED_Task_t)
+ * Return: Error Status (NOK if the number is out of range or already taken)*/
+extern u8 SCHED_u8AddTask (u8 Copy_u8Task, SCHED_Task_t Copy_pfTask);
+
+/*Description: This API will post events to a task, it can be called from interrupts
+ * parameters: task number (u8), events (u32, one bit per event)
+ * Return: void*/
+extern void SCHED_voidPost (u8 Copy_u8Task, u32 Copy_u32Events);
+
+/*Description: This API will start (or restart) a timer that posts events to a task when it expires
+ * parameters: timer number (u8), task number (u8), events (u32), delay in ms (u32), period in ms (u32, 0 for a one shot timer)
+ * Return: Error Status*/
+extern u8 SCHED_u8StartTimer (u8 Copy_u8Timer, u8 Copy_u8Task, u32 Copy_u32Events, u32 Copy_u32DelayMs, u32 Copy_u32PeriodMs);
+
+/*Description: This API will stop a timer, its events are not posted
+ * parameters: timer number (u8)
+ * Return: void*/
+extern void SCHED_voidStopTimer (u8 Copy_u8Timer);
+
+/*Description: This API will bring the timer wheel up to date and run the ready task with the highest priority
+ * parameters: void
+ * Return: 1 if a task was run, 0 otherwise*/
+extern u8 SCHED_u8RunOnce (void);
+
+/*Description: This API will wait for a time while running the other tasks (delay_ms is used before SCHED_voidInit)
+ * parameters: time in ms (u32, less than one DWT wrap)
+ * Return: void*/
+extern void SCHED_voidSleep (u32 Copy_u32TimeMs);
+
+/*Description: This API will run the tasks for ever
+ * parameters: void
+ * Return: never returns*/
+extern void SCHED_voidRun (void);
+
+#endif /* SCHED_INTERFACE_H_ */
@@ -0,0 +1,43 @@
+/*
+ * SHA256_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/*SHA-256 (FIPS 180-4) computed in software, used to digest flash regions*/
+
+#ifndef SHA256_INTERFACE_H_
+#define SHA256_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+/*Macros*/
+#define		SHA256_DIGEST_SIZE						(u8)32
+#define		SHA256_BLOCK_SIZE						(u8)64
+
+typedef struct
+{
+	u32 state[8];								/*Intermediate hash value*/
+	u32 totalLength;							/*Number of bytes hashed so far*/
+	u8  block[SHA256_BLOCK_SIZE];				/*Bytes waiting for a full block*/
+	u8  blockLength;							/*Number of bytes inside (block)*/
+}SHA256_Context_t;
+
+
+/*Description: This API will start a new digest
+ * parameters: context (SHA256_Context_t*)
+ * Return: void*/
+extern void SHA256_voidInit (SHA256_Context_t* Copy_pContext);
+
+/*Description: This API will add bytes to the digest, it can be called many times
+ * parameters: context (SHA256_Context_t*), data (u8*), number of bytes (u32)
+ * Return: void*/
+extern void SHA256_voidUpdate (SHA256_Context_t* Copy_pContext, const u8* Copy_u8Data, u32 Copy_u32Length);
+
+/*Description: This API will pad the message and write the 32 bytes digest
+ * parameters: context (SHA256_Context_t*), array of 32 bytes that will hold the digest (u8*)
+ * Return: void*/
+extern void SHA256_voidFinal (SHA256_Context_t* Copy_pContext, u8* Copy_u8Digest);
+
+#endif /* SHA256_INTERFACE_H_ */
@@ -0,0 +1,44 @@
+/*
+ * STACK_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/* RAM usage of the bootloader : static data, heap and the deepest point the stack has reached
+ * The RAM between the heap and the stack is painted with a known pattern at startup, the stack high-water mark
+ * is the lowest word that does not hold the pattern anymore
+ * The stack is not limited to the size reserved by the linker script, it can grow down until it meets the heap*/
+
+#ifndef STACK_INTERFACE_H_
+#define STACK_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+#define		STACK_PAINT_PATTERN						0xC5ACCE55
+
+typedef struct
+{
+	u32 ramSize;							/*Whole RAM*/
+	u32 staticSize;							/*.data, .bss and .noinit*/
+	u32 heapUsed;							/*Bytes given by _sbrk (newlib allocations)*/
+	u32 stackPeak;							/*Deepest the stack has been since it was painted*/
+	u32 stackNow;							/*Stack in use by the caller of STACK_voidGetUsage*/
+	u32 freeBytes;							/*Never touched, between the heap and the deepest point of the stack*/
+	u32 stackReserved;						/*Stack size reserved by the linker script*/
+}STACK_Usage_t;
+
+#define		STACK_USAGE_RECORD_SIZE					(u8)(sizeof(STACK_Usage_t))
+
+
+/*Description: This API will paint the RAM between the heap and the current stack pointer, it must be called once at startup
+ * parameters: void
+ * Return: void*/
+extern void STACK_voidPaint (void);
+
+/*Description: This API will measure the RAM usage
+ * parameters: usage (STACK_Usage_t*)
+ * Return: void*/
+extern void STACK_voidGetUsage (STACK_Usage_t* Copy_pUsage);
+
+#endif /* STACK_INTERFACE_H_ */
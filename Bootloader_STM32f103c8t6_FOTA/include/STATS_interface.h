@@ -0,0 +1,68 @@
+/*
+ * STATS_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/* Performance counters of the bootloader, read by the host with BL_GET_STATS
+ * Counters count events or bytes, timers accumulate the time spent in one kind of work (in us, from DWT cycles)
+ * A timed section must be shorter than one DWT wrap (2^32 cycles, about 59 s at 72 MHz)*/
+
+#ifndef STATS_INTERFACE_H_
+#define STATS_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+/*Counters*/
+#define		STATS_BYTES_RECEIVED					(u8)0		/*Chars handed over by the WIFI module (commands and image windows)*/
+#define		STATS_BYTES_PROGRAMMED					(u8)1
+#define		STATS_PAGES_ERASED						(u8)2
+#define		STATS_CRC_FAILURES						(u8)3		/*Commands, image chunks, manifests and whole images that failed their CRC*/
+#define		STATS_NACKS_SENT						(u8)4
+#define		STATS_FETCH_RETRIES						(u8)5		/*AT request sequences sent again for a window that was not received right*/
+#define		STATS_NUMBER_OF_COUNTERS				(u8)6
+
+/*Timers*/
+#define		STATS_TIME_NETWORK						(u8)0		/*Waiting for the WIFI module and the server*/
+#define		STATS_TIME_HEX_DECODE					(u8)1
+#define		STATS_TIME_FLASH_ERASE					(u8)2
+#define		STATS_TIME_FLASH_PROGRAM				(u8)3
+#define		STATS_TIME_LOGGING						(u8)4		/*Debug messages on USART1*/
+#define		STATS_NUMBER_OF_TIMERS					(u8)5
+
+/*Record sent to host : counters, timers (us), then the time since the stats were cleared (us), all u32 little endian*/
+#define		STATS_RECORD_SIZE						(u8)((STATS_NUMBER_OF_COUNTERS+STATS_NUMBER_OF_TIMERS+1)*4)
+
+
+/*Description: This API will enable the DWT cycle counter and clear all the stats
+ * parameters: void
+ * Return: void*/
+extern void STATS_voidInit (void);
+
+/*Description: This API will clear all the stats, the elapsed time starts again from now
+ * parameters: void
+ * Return: void*/
+extern void STATS_voidClear (void);
+
+/*Description: This API will add to one of the counters
+ * parameters: counter (u8), amount to add (u32)
+ * Return: void*/
+extern void STATS_voidCount (u8 Copy_u8Counter, u32 Copy_u32Amount);
+
+/*Description: This API will start a timed section
+ * parameters: void
+ * Return: cycle stamp to be passed to STATS_voidStop*/
+extern u32 STATS_u32Start (void);
+
+/*Description: This API will end a timed section and add its time to one of the timers
+ * parameters: timer (u8), cycle stamp returned by STATS_u32Start (u32)
+ * Return: void*/
+extern void STATS_voidStop (u8 Copy_u8Timer, u32 Copy_u32StartCycles);
+
+/*Description: This API will write the stats record
+ * parameters: array of STATS_RECORD_SIZE bytes (u8*)
+ * Return: void*/
+extern void STATS_voidGetRecord (u8* Copy_pu8Record);
+
+#endif /* STATS_INTERFACE_H_ */
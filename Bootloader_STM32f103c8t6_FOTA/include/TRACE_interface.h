@@ -0,0 +1,70 @@
+/*
+ * TRACE_interface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+/* Event trace of the bootloader, a RAM ring of timestamped records read by the host with BL_GET_TRACE
+ * Once the ring is full the oldest records are overwritten
+ * Timestamps are in us since TRACE_voidInit, counted from the DWT cycle counter, so two calls to TRACE_voidRecord
+ * must not be more than one DWT wrap apart (2^32 cycles, about 59 s at 72 MHz)
+ * Records are only written from thread mode (never from an ISR)*/
+
+#ifndef TRACE_INTERFACE_H_
+#define TRACE_INTERFACE_H_
+
+#include "STD_TYPES.h"
+
+/*Number of records in the ring (power of 2), 8 bytes each*/
+#define		TRACE_RING_RECORDS						128U
+#define		TRACE_RECORD_SIZE						8U
+
+/*Events, the argument of every event is given next to it*/
+#define		TRACE_EVENT_COMMAND						(u8)1		/*Command handler, command code*/
+#define		TRACE_EVENT_WIFI_REQUEST				(u8)2		/*AT command or request sent to the WIFI module until it answers, length*/
+#define		TRACE_EVENT_FLASH_ERASE					(u8)3		/*Page erase, page number*/
+#define		TRACE_EVENT_FLASH_PROGRAM				(u8)4		/*Flash programming, number of bytes*/
+#define		TRACE_EVENT_HEX_DECODE					(u8)5		/*Hex decoding of received chars, number of bytes*/
+#define		TRACE_EVENT_CHUNK_REFETCH				(u8)6		/*Image window fetched again, chunk index*/
+
+/*Phases*/
+#define		TRACE_PHASE_BEGIN						(u8)0
+#define		TRACE_PHASE_END							(u8)1
+#define		TRACE_PHASE_INSTANT						(u8)2
+
+typedef struct
+{
+	u32 timeUs;
+	u8  event;
+	u8  phase;
+	u16 arg;
+}TRACE_Record_t;
+
+
+/*Description: This API will enable the DWT cycle counter, empty the ring and start recording
+ * parameters: void
+ * Return: void*/
+extern void TRACE_voidInit (void);
+
+/*Description: This API will add a record to the ring
+ * parameters: event (u8), phase (u8), argument (u16)
+ * Return: void*/
+extern void TRACE_voidRecord (u8 Copy_u8Event, u8 Copy_u8Phase, u16 Copy_u16Arg);
+
+/*Description: This API will stop or restart recording (records are not written while the ring is being read)
+ * parameters: 1 to record, 0 to stop (u8)
+ * Return: void*/
+extern void TRACE_voidSetEnable (u8 Copy_u8Enable);
+
+/*Description: This API will give the sequence numbers of the records held by the ring
+ * parameters: sequence number of the oldest record (u32*), sequence number of the next record to be written (u32*)
+ * Return: void*/
+extern void TRACE_voidGetRange (u32* Copy_pu32First, u32* Copy_pu32Next);
+
+/*Description: This API will copy records out of the ring
+ * parameters: sequence number of the first record (u32), destination (u8*), maximum number of records (u8)
+ * Return: number of records copied, 0 if the first record was overwritten or not written yet*/
+extern u8 TRACE_u8CopyRecords (u32 Copy_u32First, u8* Copy_pu8Dest, u8 Copy_u8MaxRecords);
+
+#endif /* TRACE_INTERFACE_H_ */
@@ -3,9 +3,25 @@
  *
  *  Created on: June 4, 2020
  *      Author: Mahmoud Hamdy
- *      Version: 2.0
+ *      Version: 2.3
  */
 
+/*Changelog from version 2.2:
+ * 1) Added UART_u8SetFlowControl for hardware RTS/CTS flow control (CR3 RTSE/CTSE)
+ * 2) The IRQs count overrun, noise and framing errors, read with UART_u8GetErrors
+ * */
+/*Changelog from version 2.1:
+ * 1) Added an rx ring and a tx ring for every UART peripheral : once UART_u8StartRXRing is called the IRQ puts every received
+ *    byte in the rx ring and never waits for the main loop, which takes them in bulk with UART_u16Read
+ * 2) Added UART_u16Write that queues bytes in the tx ring, they are sent by the TXE interrupt after any async send in progress
+ *    and UART_u8FlushTX that waits for them to be sent
+ * */
+/*Changelog from version 2.0:
+ * 1) UART_voidSendSync became UART_u8SendSync, it waits for TXE/TC instead of a fixed delay after every byte
+ *    and the time passed is a timeout for each byte
+ * 2) Sizes are u16, so buffers longer than 255 bytes go in one call
+ * 3) Added UART_u8SendGatherAsync to send several buffers in one interrupt based session
+ * */
 /*Changelog from version 1.1:
  * 1) Removed Deparcated Macros (related to baudrate)
  * 2) Changed the flags for the IRQ because there were bugs in it
@@ -25,6 +41,37 @@
 /*Callback functions pointers*/
 typedef void(*TXCallback_t)(void);
 typedef void(*RXCallback_t)(void);
+
+/*One part of a gather send, the parts are sent back to back as if they were one buffer*/
+typedef struct {
+	const u8* data;
+	u16 length;
+} UART_Segment_t;
+/*Most parts one gather send can take, they are copied by the driver so the array itself does not have to outlive the call*/
+#define UART_GATHER_MAX_SEGMENTS			(u8)6
+
+/*Receive errors counted by the IRQ of one peripheral since reset, every counter stops at its maximum*/
+typedef struct {
+	u16 overrun;							/*A byte arrived before the previous one was read, the new one is lost*/
+	u16 noise;
+	u16 framing;							/*Stop bit not found, usually a wrong baudrate or a break*/
+} UART_Errors_t;
+
+/*Hardware flow control options (UART_u8SetFlowControl), RTS and CTS can be used alone*/
+#define UART_FLOW_CONTROL_NONE				(u8)0
+#define UART_FLOW_CONTROL_RTS				(u8)1		/*The peripheral holds RTS high while a received byte is not read*/
+#define UART_FLOW_CONTROL_CTS				(u8)2		/*The peripheral sends only while CTS is low*/
+#define UART_FLOW_CONTROL_RTS_CTS			(u8)3
+
+/*Rings sizes in bytes, every size must be a power of two
+ * USART2 carries the WIFI module, its rx ring must hold what arrives while the main loop is busy between two reads
+ * (115200 baud is about 12 bytes per ms)*/
+#define UART1_RX_RING_SIZE					16U
+#define UART1_TX_RING_SIZE					256U
+#define UART2_RX_RING_SIZE					256U
+#define UART2_TX_RING_SIZE					16U
+#define UART3_RX_RING_SIZE					16U
+#define UART3_TX_RING_SIZE					16U
 /*********************************************************************************/
 /************Warning: Don't change anything in this section***********************/
 /*Base Addresses*/
@@ -73,6 +120,8 @@ typedef void(*RXCallback_t)(void);
 #define UART_STOP_BIT1_MASK							(u32)~(0x3000)
 #define UART_STOP_BIT2_MASK							(u32)(0x2000)
 /*CR3 Options*/
+#define UART_CTS_ENABLE_MASK						(u32)(0x200)
+#define UART_RTS_ENABLE_MASK						(u32)(0x100)
 #define UART_DMA_TX_ENABLE_MASK						(u32)(0x80)
 #define UART_DMA_RX_ENABLE_MASK						(u32)(0x40)
 #define UART_ERROR_INT_ENABLE_MASK					(u32)(0x1)
@@ -91,13 +140,18 @@ typedef void(*RXCallback_t)(void);
 extern u8 UART_u8Configure (u32 Copy_u32BaseAddress, u16 Copy_u16Baudrate, u32 Copy_u32StopBits, u32 Copy_u32ParityBits);
 
 /*Description: This function will be used to trigger sending data. It will send only the first bit of the buffer and the rest will be handled by the interrupt request
- * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u8)
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16)
  * Return: Error Status  */
-extern u8 UART_voidSendAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size);
+extern u8 UART_voidSendAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size);
+/*Description: This function will be used to send several buffers back to back in one interrupt based session, without copying them together
+ * The segments array is copied, the data of every segment must stay unchanged until the sending is done
+ * Parameters: Desired UART Peripheral (u32), segments (UART_Segment_t*), number of segments (u8, up to UART_GATHER_MAX_SEGMENTS)
+ * Return: Error Status */
+extern u8 UART_u8SendGatherAsync(u32 Copy_u32UARTAddress, const UART_Segment_t* Copy_pSegments, u8 Copy_u8Count);
 /*Description: This API will be used to receive data using interrupts
- * Parameters:Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u8)
+ * Parameters:Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16)
  * Return: Error Status */
-extern u8 UART_u8ReceiveAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size);
+extern u8 UART_u8ReceiveAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size);
 
 /*Description: This function will save the passed callback by the user to the static variable
  * Parameters: Pointer to TX CallbackFunction, Desired UART Peripheral (u32)
@@ -108,14 +162,55 @@ extern u8 UART_u8SetTXCallBack(TXCallback_t Copy_TXCallbackFunction, u32 Copy_u3
  * Return:Error Status */
 extern u8 UART_u8SetRXCallBack(RXCallback_t Copy_RXCallbackFunction, u32 Copy_u32DesiredUART);
 
-/*Description: This function will be used to trigger sending data synchronously without using interrupts
- * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u8), required delay in ms (u32)
- * Return: void  */
-extern void UART_voidSendSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size, u32 Copy_u32Time);
+/*Description: This function will be used to send data synchronously without using interrupts, every byte waits for TXE only
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16), timeout for each byte in ms (u32, 0 waits for ever)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown or a byte timed out)  */
+extern u8 UART_u8SendSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32Time);
 /*Description: This function will be used to trigger receiving data synchronously without using interrupts
- * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u8), required delay in ms (u32)
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16), required delay in ms (u32)
  * Return: Error Status */
-extern u8 UART_u8ReceiveSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size, u32 Copy_u32Time);
+extern u8 UART_u8ReceiveSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32Time);
+
+/*Description: This API will make the IRQ put every received byte in the rx ring of the peripheral (emptied first) instead of
+ * a buffer passed to UART_u8ReceiveAsync, which is refused while the ring is on. The RX callback is not called in this mode
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown) */
+extern u8 UART_u8StartRXRing(u32 Copy_u32UARTAddress);
+/*Description: This API will stop putting received bytes in the rx ring, the bytes already in it can still be read
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: None */
+extern void UART_voidStopRXRing(u32 Copy_u32UARTAddress);
+/*Description: This API will take up to (Copy_u16Max) received bytes from the rx ring, without waiting
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16)
+ * Return: number of bytes taken (0 if none arrived or the peripheral is unknown) */
+extern u16 UART_u16Read(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size);
+/*Description: This API will drop the received bytes that were not read yet
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: None */
+extern void UART_voidFlushRX(u32 Copy_u32UARTAddress);
+/*Description: This API will give the number of received bytes dropped because the rx ring was full, since reset
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: number of bytes dropped */
+extern u16 UART_u16GetRXDropped(u32 Copy_u32UARTAddress);
+/*Description: This API will queue bytes in the tx ring without waiting, the TXE interrupt sends them
+ * The bytes are copied, so the buffer can be reused right after the call. Don't mix it with sync sends on the same peripheral
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16)
+ * Return: number of bytes queued (less than the size when the ring is full) */
+extern u16 UART_u16Write(u32 Copy_u32UARTAddress, const u8 *Copy_u8Buffer, u16 Copy_u16Size);
+/*Description: This API will wait until the bytes of the tx ring are sent and the last frame left the shift register (TC),
+ * to be called before a reset or a jump that would cut the sending
+ * Parameters: Desired UART Peripheral (u32), timeout in ms (u32, 0 waits for ever)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown or the time ran out) */
+extern u8 UART_u8FlushTX(u32 Copy_u32UARTAddress, u32 Copy_u32Time);
+
+/*Description: This API will enable or disable hardware flow control, the RTS and CTS pins must be configured by the caller
+ * Parameters: Desired UART Peripheral (u32), flow control (u8, UART_FLOW_CONTROL_...)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown or the option is not one of the list) */
+extern u8 UART_u8SetFlowControl(u32 Copy_u32UARTAddress, u8 Copy_u8FlowControl);
+/*Description: This API will give the receive errors counted by the IRQ of the peripheral since reset
+ * Parameters: Desired UART Peripheral (u32), counters (UART_Errors_t*)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown) */
+extern u8 UART_u8GetErrors(u32 Copy_u32UARTAddress, UART_Errors_t* Copy_pErrors);
 
 /*Description: This API will be used to enable or disable desired interrupt
  * Parameters: Desired UART Peripheral(u32), Desired Interrupt (u32), Desired Status (u8)
@@ -3,9 +3,28 @@
  *
  *  Created on: Jun 21, 2020
  *      Author: Mahmoud
- *      Version: 1.1
+ *      Version: 1.5
  */
 
+/*Changelog from version 1.4:
+ * 1) Added the UDP link of the multicast image download (WIFI_u8McastOpen, WIFI_u16McastReceive, WIFI_u8McastSend, WIFI_voidMcastClose)*/
+
+/*Changelog from version 1.3:
+ * 1) Added the LAN direct mode : the module is a TCP server on the LAN (AT+CIPMUX=1, AT+CIPSERVER=1), the host connects to it
+ *    and sends the commands and the image data on the connection, the channels are not used
+ * 2) The push transport and the LAN direct mode share the frames on the connection (the link), WIFI_u8PushConnect and
+ *    WIFI_u8PushIsConnected are now WIFI_u8LinkOpen and WIFI_u8LinkIsOpen*/
+
+/*Changelog from version 1.2:
+ * 1) Added the push transport : commands come as frames on one TCP connection kept open to a command server, the replies
+ *    go back on it, the channels are only polled while the command server cannot be reached*/
+
+/*Changelog from version 1.1:
+ * 1) The data downloaded from the server is read in passive receiving (AT+CIPRECVMODE=1, AT+CIPRECVDATA) in reads that fit
+ *    the rx ring and the space left in the data array, reading stops once the array is full
+ * 2) Added WIFI_BAUD_RATE and WIFI_FLOW_CONTROL to move the link with the module to another baudrate and to hardware
+ *    flow control after reset*/
+
 /*Changelog from version 1.0:
  * 1) Added function to count data found on server
  * 2) Improved Functionality of callback function to better handle data and prevent garbage*/
@@ -27,6 +46,71 @@
 
 #define 	 WIFI_RECEIVE_ARRAY_SIZE						(u16)(2048)
 
+/*Passive receiving (AT+CIPRECVMODE=1) of the data downloaded from the server : the module keeps what the server sends and
+ * gives it only when it is read with AT+CIPRECVDATA, so it never sends more than the bootloader can take
+ * Set to 0 for modules without AT+CIPRECVMODE (the data path also falls back by itself when the command is refused)*/
+#define		 WIFI_PASSIVE_RECEIVE							1
+#define		 WIFI_COMMAND_PASSIVE_MODE_ON					(u8*)"AT+CIPRECVMODE=1\r\n"
+#define		 WIFI_COMMAND_PASSIVE_MODE_OFF					(u8*)"AT+CIPRECVMODE=0\r\n"
+#define		 WIFI_COMMAND_CLOSE								(u8*)"AT+CIPCLOSE\r\n"
+/*Most chars asked by one read, a whole read response (header, chars and OK) must fit the rx ring of the WIFI peripheral*/
+#define		 WIFI_PASSIVE_READ_SIZE							192U
+/*Empty reads in a row (WIFI_PASSIVE_POLL_MS apart) after which the server is taken as done sending*/
+#define		 WIFI_PASSIVE_EMPTY_READS						(u8)(5)
+#define		 WIFI_PASSIVE_POLL_MS							(u32)(200)
+
+/*Baudrate of the link with the module, the module starts at 115200 after reset and is moved to this one (AT+UART_CUR)
+ * With passive receiving the chars only come when asked, so faster links do not overrun the rx ring*/
+#define		 WIFI_BAUD_RATE									115200UL
+/*Hardware flow control of the link (0 none, 1 RTS, 2 CTS, 3 both, as HUART_FLOW_CONTROL_...), the module gets the same setting with AT+UART_CUR
+ * Needs the module RTS (GPIO15) wired to PA0 and its CTS (GPIO13) to PA1, the ESP-01 boards do not bring them out*/
+#define		 WIFI_FLOW_CONTROL								0
+
+/*Push transport : the bootloader keeps one TCP connection open to a command server (the host application listens for it),
+ * the commands come on it as soon as they are sent and the replies go back on it, instead of polling the channels
+ * A frame is its length as 4 hex chars (most significant first) followed by that many chars, the same hex chars as on the channels
+ * The module has one connection (AT+CIPMUX=0), so it is closed for the exchanges with the channels (image data) and opened again
+ * for the next reply or command. While the command server cannot be reached the channels are polled as before
+ * Needs WIFI_PASSIVE_RECEIVE, the frames are kept by the module and read one at a time*/
+#define		 WIFI_PUSH_TRANSPORT							0
+#define		 WIFI_PUSH_SERVER								"192.168.1.10"
+#define		 WIFI_PUSH_PORT									5050
+/*Idle time after which the module checks that the command server is still there (AT+CIPSTART keep alive, seconds)*/
+#define		 WIFI_PUSH_KEEPALIVE_S							60
+
+/*LAN direct mode : the module listens on WIFI_LAN_PORT and the host application connects to it over the LAN, the commands,
+ * the replies and the image data all go on that connection in the frames of the push transport, nothing goes to the channels
+ * The module takes one connection (AT+CIPSERVERMAXCONN=1), so the host is always link 0
+ * The image data is asked for with a data request frame : 'D', the first char as 8 hex chars then the number of chars as 4 hex chars,
+ * the host answers with a frame of these chars (fewer at the end of the image)
+ * Needs WIFI_PASSIVE_RECEIVE, cannot be used with WIFI_PUSH_TRANSPORT*/
+#define		 WIFI_LAN_DIRECT								0
+#define		 WIFI_LAN_PORT									3333
+/*Time after which the module closes a connection with no traffic (AT+CIPSTO, seconds, 0 never)*/
+#define		 WIFI_LAN_IDLE_TIMEOUT_S						0
+/*Time to wait for the answer of a data request*/
+#define		 WIFI_LAN_DATA_TIMEOUT_MS						(u32)(5000)
+
+/*Multicast image download : the module opens a UDP link on WIFI_MCAST_PORT (AT+CIPSTART="UDP", mode 2 so the answers go to
+ * the host that sent the last datagram) and the host sends the image to all the boards at once
+ * The module must join the group for a multicast address, AT firmwares that do not can be given the broadcast address of the
+ * LAN (e.g. "192.168.1.255") and the host sends to it too
+ * Needs WIFI_PASSIVE_RECEIVE (for the commands to the module), cannot be used in LAN direct mode*/
+#define		 WIFI_MCAST_GROUP								"239.255.0.1"
+#define		 WIFI_MCAST_PORT								5051
+/*Time between two looks at the rx ring while no datagram comes, the ring must not fill meanwhile*/
+#define		 WIFI_MCAST_POLL_MS								(u32)(2)
+
+/*Length of a frame on the link (push transport or LAN direct) in hex chars*/
+#define		 WIFI_LINK_FRAME_HEADER_SIZE					4U
+
+/*Replies to the server are hex chars written in place inside one request buffer, between a fixed prefix and suffix*/
+#define		 WIFI_REPLY_REQUEST_SIZE						(u16)(512)
+#define		 WIFI_REPLY_REQUEST_PREFIX						"GET https://api.thingspeak.com/update?api_key=PCF4VMCRFW340IZ8&field1="
+#define		 WIFI_REPLY_REQUEST_SUFFIX						"\r\nHost:api.thingspeak.com\r\n\r\n\r\n\r\n\r\n"
+#define		 WIFI_REPLY_MAX_CHARS							(u16)(WIFI_REPLY_REQUEST_SIZE-sizeof(WIFI_REPLY_REQUEST_PREFIX)-sizeof(WIFI_REPLY_REQUEST_SUFFIX)+1)
+#define		 WIFI_REPLY_MAX_BYTES							(u16)(WIFI_REPLY_MAX_CHARS/2)
+
 
 
 /*Description: This API will be used to initialize WIFI module on USART 2
@@ -59,11 +143,72 @@ extern u8 WIFI_u8ReceiveData (u16 Copy_u16startByte, u16 Copy_u16TotalSize, u8*
  * Return: Error Status*/
 extern u8 WIFI_u8SendCommandToServer (u8* Copy_u8commandNumber, u16 Copy_u16Size);
 
+/*Description: This API will start a new reply to the server, dropping whatever was appended before
+ * parameters: void
+ * Return: void*/
+extern void WIFI_voidReplyBegin (void);
+
+/*Description: This API will append one byte to the reply, as two hex chars written directly in the request buffer
+ * parameters: Byte to append (u8)
+ * Return: void*/
+extern void WIFI_voidReplyAppendU8 (u8 Copy_u8Value);
+
+/*Description: This API will append a half word to the reply, least significant byte first
+ * parameters: Half word to append (u16)
+ * Return: void*/
+extern void WIFI_voidReplyAppendU16 (u16 Copy_u16Value);
+
+/*Description: This API will append a word to the reply, least significant byte first
+ * parameters: Word to append (u32)
+ * Return: void*/
+extern void WIFI_voidReplyAppendU32 (u32 Copy_u32Value);
+
+/*Description: This API will append bytes to the reply, they are read from their place (RAM or flash) and not copied before
+ * parameters: Bytes to append (u8*), Number of bytes (u16)
+ * Return: void*/
+extern void WIFI_voidReplyAppendBytes (const u8* Copy_pu8Bytes, u16 Copy_u16Count);
+
+/*Description: This API will send the reply built so far to our server
+ * parameters: void
+ * Return: Error Status (NOK if the wifi is not initialized or the reply did not fit WIFI_REPLY_MAX_BYTES)*/
+extern u8 WIFI_u8ReplySend (void);
+
 /*Description: This API will be used to receive command passed to server
  * parameters: Desired Command
  * Return: Error Status*/
 extern u8 WIFI_u8ReceiveCommand (u8* Copy_u8Command);
 
+/*Description: This API will open the link if it is not open yet : the connection to the command server (push transport)
+ * or the server on the module (LAN direct, open once the host is connected)
+ * parameters: void
+ * Return: Error Status (NOK if both are off, the server cannot be reached or the host is not connected)*/
+extern u8 WIFI_u8LinkOpen (void);
+
+/*Description: This API will tell whether the link is open (as far as the module told)
+ * parameters: void
+ * Return: 1 if open, 0 otherwise*/
+extern u8 WIFI_u8LinkIsOpen (void);
+
+/*Description: This API will open the UDP link of the multicast image download, the link of the commands is closed first
+ * parameters: void
+ * Return: Error Status (NOK without passive receiving, in LAN direct mode or if the module refused the link)*/
+extern u8 WIFI_u8McastOpen (void);
+
+/*Description: This API will wait for the next datagram of the UDP link and take its chars
+ * parameters: buffer (u8*), size of the buffer (u16, the chars past it are dropped), longest time with no char in ms (u32)
+ * Return: number of chars of the datagram (0 if the time was over)*/
+extern u16 WIFI_u16McastReceive (u8* Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32TimeoutMs);
+
+/*Description: This API will send chars as one datagram on the UDP link, to the host that sent the last datagram
+ * parameters: chars (u8*), number of chars (u16)
+ * Return: Error Status*/
+extern u8 WIFI_u8McastSend (const u8* Copy_pu8Chars, u16 Copy_u16Count);
+
+/*Description: This API will close the UDP link of the multicast image download
+ * parameters: void
+ * Return: void*/
+extern void WIFI_voidMcastClose (void);
+
 /*Description: This API will calculate data on site and return the number of chars
  * Parameters: Pointer to variable that will hold the number of chars on site
  * Return: Error Status*/
@@ -0,0 +1,313 @@
+/*
+ * APPINFO_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "Flash.h"
+#include "APPINFO_interface.h"
+#include <string.h>
+#include <stddef.h>
+
+/*Page header: magic word at offset 0 and generation word at offset 4
+ * The generation is written first and the magic last, so a page is only valid after it was completely written*/
+#define APPINFO_PAGE_MAGIC						((u32)0x32474C41)		/*"ALG2", records carry the image CRC*/
+#define APPINFO_PAGE_HEADER_SIZE				8U
+#define APPINFO_PAGE_SIZE						(1 K)
+#define APPINFO_RECORD_SIZE						(sizeof(APPINFO_Record_t))
+#define APPINFO_RECORD_COMMITTED				((u16)0x5AA5)
+#define APPINFO_ERASED_WORD						((u32)0xFFFFFFFF)
+
+#define APPINFO_PAGE_MAGIC_OF(PAGE)				(*((volatile u32*)(PAGE)))
+#define APPINFO_PAGE_GENERATION_OF(PAGE)		(*((volatile u32*)((PAGE)+4)))
+#define APPINFO_OTHER_PAGE(PAGE)				(((PAGE)==APPINFO_LOG_PAGE_A)? APPINFO_LOG_PAGE_B : APPINFO_LOG_PAGE_A)
+
+/*RAM index: flash address of the newest record of every slot (0 if slot is empty)*/
+static u32 static_u32SlotAddress[APPINFO_MAX_APPS]={0};
+/*This static variable will hold the number of applications found in the log*/
+static u8  static_u8NumberOfApps=0;
+/*This static variable will hold the page that new records are appended to*/
+static u32 static_u32ActivePage=0;
+/*This static variable will hold the generation of the active page, it increases with every compaction*/
+static u32 static_u32Generation=0;
+/*This static variable will hold the address at which the next record will be written*/
+static u32 static_u32NextFreeAddress=0;
+/*This static variable will hold the highest sequence number found in the log*/
+static u32 static_u32LastSequence=0;
+
+
+/*Writes a record in two steps, everything except the last word first then slot and commit together,
+ * the commit half-word is the last one programmed*/
+static u8 APPINFO_u8ProgramRecord (u32 Copy_u32Address, APPINFO_Record_t* Copy_pRecord)
+{
+	u8 Local_u8Status = STATUS_NOK;
+
+	if (FLASH_WriteProgram(Copy_pRecord, (void*)Copy_u32Address, APPINFO_RECORD_SIZE-4) == STD_TYPES_ERROR_OK)
+	{
+		if (FLASH_WriteWord((void*)(Copy_u32Address+APPINFO_RECORD_SIZE-4), ((u32)Copy_pRecord->slot) | ((u32)APPINFO_RECORD_COMMITTED<<16)) == STD_TYPES_ERROR_OK)
+		{
+			Local_u8Status = STATUS_OK;
+		}
+	}
+	return Local_u8Status;
+}
+
+/*Writes the header of a page, generation first and magic last*/
+static u8 APPINFO_u8ProgramHeader (u32 Copy_u32Page, u32 Copy_u32Generation)
+{
+	u8 Local_u8Status = STATUS_NOK;
+
+	if (FLASH_WriteWord((void*)(Copy_u32Page+4), Copy_u32Generation) == STD_TYPES_ERROR_OK)
+	{
+		if (FLASH_WriteWord((void*)Copy_u32Page, APPINFO_PAGE_MAGIC) == STD_TYPES_ERROR_OK)
+		{
+			Local_u8Status = STATUS_OK;
+		}
+	}
+	return Local_u8Status;
+}
+
+/*Erases a page only if it is not already erased*/
+static u8 APPINFO_u8ErasePage (u32 Copy_u32Page)
+{
+	u16 Local_u16Index;
+
+	for (Local_u16Index=0; Local_u16Index<(APPINFO_PAGE_SIZE/4); Local_u16Index++)
+	{
+		if (*((volatile u32*)Copy_u32Page+Local_u16Index) != APPINFO_ERASED_WORD)
+		{
+			return (FLASH_PageErase(Copy_u32Page) == STD_TYPES_ERROR_OK)? STATUS_OK : STATUS_NOK;
+		}
+	}
+	return STATUS_OK;
+}
+
+/*Checks whether all bytes of a record slot were never programmed*/
+static u8 APPINFO_u8IsErasedRecord (u32 Copy_u32Address)
+{
+	u8 Local_u8Index;
+
+	for (Local_u8Index=0; Local_u8Index<(APPINFO_RECORD_SIZE/4); Local_u8Index++)
+	{
+		if (*((volatile u32*)Copy_u32Address+Local_u8Index) != APPINFO_ERASED_WORD) return 0;
+	}
+	return 1;
+}
+
+/*Rebuilds the RAM index from the records of a valid page
+ * Records that were interrupted before their commit half-word are skipped, their space stays used*/
+static void APPINFO_voidScanPage (u32 Copy_u32Page)
+{
+	u32 Local_u32Address;
+	APPINFO_Record_t* Local_pRecord;
+
+	memset(static_u32SlotAddress, 0, sizeof(static_u32SlotAddress));
+	static_u8NumberOfApps  = 0;
+	static_u32LastSequence = 0;
+	static_u32ActivePage   = Copy_u32Page;
+	static_u32Generation   = APPINFO_PAGE_GENERATION_OF(Copy_u32Page);
+
+	for (Local_u32Address = Copy_u32Page+APPINFO_PAGE_HEADER_SIZE;
+		 Local_u32Address+APPINFO_RECORD_SIZE <= Copy_u32Page+APPINFO_PAGE_SIZE;
+		 Local_u32Address += APPINFO_RECORD_SIZE)
+	{
+		/*First erased record marks the end of the log*/
+		if (APPINFO_u8IsErasedRecord(Local_u32Address)) break;
+
+		Local_pRecord = (APPINFO_Record_t*)Local_u32Address;
+		if ((Local_pRecord->commit == APPINFO_RECORD_COMMITTED) && (Local_pRecord->slot < APPINFO_MAX_APPS))
+		{
+			/*Keep the newest record of this slot*/
+			if ((static_u32SlotAddress[Local_pRecord->slot] == 0) ||
+				(Local_pRecord->sequence > ((APPINFO_Record_t*)static_u32SlotAddress[Local_pRecord->slot])->sequence))
+			{
+				static_u32SlotAddress[Local_pRecord->slot] = Local_u32Address;
+			}
+			if (Local_pRecord->slot >= static_u8NumberOfApps) static_u8NumberOfApps = Local_pRecord->slot+1;
+			if (Local_pRecord->sequence > static_u32LastSequence) static_u32LastSequence = Local_pRecord->sequence;
+		}
+	}
+	static_u32NextFreeAddress = Local_u32Address;
+}
+
+/*Copies the newest record of every slot to the other page, then validates it and erases the old page
+ * If power fails before the header is written, the old page is still the valid one*/
+static u8 APPINFO_u8Compact (void)
+{
+	u8  Local_u8Slot;
+	u32 Local_u32DestinationPage = APPINFO_OTHER_PAGE(static_u32ActivePage);
+	u32 Local_u32Address = Local_u32DestinationPage+APPINFO_PAGE_HEADER_SIZE;
+	APPINFO_Record_t Local_Record;
+
+	if (APPINFO_u8ErasePage(Local_u32DestinationPage) != STATUS_OK) return STATUS_NOK;
+
+	for (Local_u8Slot=0; Local_u8Slot<static_u8NumberOfApps; Local_u8Slot++)
+	{
+		if (static_u32SlotAddress[Local_u8Slot] == 0) continue;
+		memcpy(&Local_Record, (void*)static_u32SlotAddress[Local_u8Slot], APPINFO_RECORD_SIZE);
+		if (APPINFO_u8ProgramRecord(Local_u32Address, &Local_Record) != STATUS_OK) return STATUS_NOK;
+		Local_u32Address += APPINFO_RECORD_SIZE;
+	}
+
+	if (APPINFO_u8ProgramHeader(Local_u32DestinationPage, static_u32Generation+1) != STATUS_OK) return STATUS_NOK;
+	FLASH_PageErase(static_u32ActivePage);
+
+	APPINFO_voidScanPage(Local_u32DestinationPage);
+	return STATUS_OK;
+}
+
+u8 APPINFO_u8Init (void)
+{
+	u8 Local_u8Status = STATUS_OK;
+	u8 Local_u8ValidA = (APPINFO_PAGE_MAGIC_OF(APPINFO_LOG_PAGE_A) == APPINFO_PAGE_MAGIC);
+	u8 Local_u8ValidB = (APPINFO_PAGE_MAGIC_OF(APPINFO_LOG_PAGE_B) == APPINFO_PAGE_MAGIC);
+
+	FLASH_Unlock();
+
+	if (Local_u8ValidA && Local_u8ValidB)
+	{
+		/*Compaction was interrupted after the new page was validated, the newer generation wins*/
+		if (APPINFO_PAGE_GENERATION_OF(APPINFO_LOG_PAGE_B) > APPINFO_PAGE_GENERATION_OF(APPINFO_LOG_PAGE_A))
+		{
+			FLASH_PageErase(APPINFO_LOG_PAGE_A);
+			APPINFO_voidScanPage(APPINFO_LOG_PAGE_B);
+		}
+		else
+		{
+			FLASH_PageErase(APPINFO_LOG_PAGE_B);
+			APPINFO_voidScanPage(APPINFO_LOG_PAGE_A);
+		}
+	}
+	else if (Local_u8ValidA || Local_u8ValidB)
+	{
+		/*The other page may hold a compaction that was interrupted before its header was written*/
+		static_u32ActivePage = (Local_u8ValidA)? APPINFO_LOG_PAGE_A : APPINFO_LOG_PAGE_B;
+		Local_u8Status = APPINFO_u8ErasePage(APPINFO_OTHER_PAGE(static_u32ActivePage));
+		APPINFO_voidScanPage(static_u32ActivePage);
+	}
+	else
+	{
+		/*No table yet, start a fresh log on page A*/
+		if ((APPINFO_u8ErasePage(APPINFO_LOG_PAGE_A) != STATUS_OK) ||
+			(APPINFO_u8ErasePage(APPINFO_LOG_PAGE_B) != STATUS_OK) ||
+			(APPINFO_u8ProgramHeader(APPINFO_LOG_PAGE_A, 1) != STATUS_OK))
+		{
+			Local_u8Status = STATUS_NOK;
+		}
+		APPINFO_voidScanPage(APPINFO_LOG_PAGE_A);
+	}
+
+	FLASH_Lock();
+	return Local_u8Status;
+}
+
+u8 APPINFO_u8GetNumberOfApps (void)
+{
+	return static_u8NumberOfApps;
+}
+
+u8 APPINFO_u8GetRecord (u8 Copy_u8Slot, APPINFO_Record_t* Copy_pRecord)
+{
+	if ((Copy_pRecord == NULL) || (Copy_u8Slot >= static_u8NumberOfApps) || (static_u32SlotAddress[Copy_u8Slot] == 0))
+	{
+		return STATUS_NOK;
+	}
+	memcpy(Copy_pRecord, (void*)static_u32SlotAddress[Copy_u8Slot], APPINFO_RECORD_SIZE);
+	return STATUS_OK;
+}
+
+u8 APPINFO_u8FindByBaseAddress (u32 Copy_u32BaseAddress, APPINFO_Record_t* Copy_pRecord)
+{
+	u8  Local_u8Slot;
+	u32 Local_u32NewestAddress = 0;
+
+	if (Copy_pRecord == NULL) return STATUS_NOK;
+
+	for (Local_u8Slot=0; Local_u8Slot<static_u8NumberOfApps; Local_u8Slot++)
+	{
+		if ((static_u32SlotAddress[Local_u8Slot] != 0) &&
+			(((APPINFO_Record_t*)static_u32SlotAddress[Local_u8Slot])->baseAddress == Copy_u32BaseAddress))
+		{
+			/*Many slots may describe the same address, the last saved one is the image in flash*/
+			if ((Local_u32NewestAddress == 0) ||
+				(((APPINFO_Record_t*)static_u32SlotAddress[Local_u8Slot])->sequence > ((APPINFO_Record_t*)Local_u32NewestAddress)->sequence))
+			{
+				Local_u32NewestAddress = static_u32SlotAddress[Local_u8Slot];
+			}
+		}
+	}
+	if (Local_u32NewestAddress == 0) return STATUS_NOK;
+
+	memcpy(Copy_pRecord, (void*)Local_u32NewestAddress, APPINFO_RECORD_SIZE);
+	return STATUS_OK;
+}
+
+u8 APPINFO_u8WriteApp (u8 Copy_u8Slot, u32 Copy_u32BaseAddress, u32 Copy_u32SizeInBytes, u8* Copy_u8Name, u32 Copy_u32ImageCrc)
+{
+	u8 Local_u8Status = STATUS_OK;
+	APPINFO_Record_t Local_Record;
+
+	/*Slots are filled in order, so a new application can only take the next free slot*/
+	if ((Copy_u8Name == NULL) || (Copy_u8Slot > static_u8NumberOfApps) || (Copy_u8Slot >= APPINFO_MAX_APPS))
+	{
+		return STATUS_NOK;
+	}
+
+	Local_Record.sequence    = static_u32LastSequence+1;
+	Local_Record.baseAddress = Copy_u32BaseAddress;
+	Local_Record.sizeInBytes = Copy_u32SizeInBytes;
+	memcpy(Local_Record.name, Copy_u8Name, APPINFO_NAME_SIZE);
+	Local_Record.imageCrc    = Copy_u32ImageCrc;
+	Local_Record.slot        = Copy_u8Slot;
+	Local_Record.commit      = APPINFO_RECORD_COMMITTED;
+
+	FLASH_Unlock();
+
+	/*Page is full, keep only the newest record of every slot in the other page*/
+	if (static_u32NextFreeAddress+APPINFO_RECORD_SIZE > static_u32ActivePage+APPINFO_PAGE_SIZE)
+	{
+		Local_u8Status = APPINFO_u8Compact();
+	}
+
+	if (Local_u8Status == STATUS_OK)
+	{
+		Local_u8Status = APPINFO_u8ProgramRecord(static_u32NextFreeAddress, &Local_Record);
+		if (Local_u8Status == STATUS_OK)
+		{
+			static_u32SlotAddress[Copy_u8Slot] = static_u32NextFreeAddress;
+			static_u32LastSequence = Local_Record.sequence;
+			if (Copy_u8Slot == static_u8NumberOfApps) static_u8NumberOfApps++;
+		}
+		/*Space of a failed record is never reused*/
+		static_u32NextFreeAddress += APPINFO_RECORD_SIZE;
+	}
+
+	FLASH_Lock();
+	return Local_u8Status;
+}
+
+u8 APPINFO_u8UpdateImage (u32 Copy_u32BaseAddress, u32 Copy_u32SizeInBytes, u32 Copy_u32ImageCrc)
+{
+	u8  Local_u8Status;
+	u8  Local_u8Slot;
+	APPINFO_Record_t Local_Record;
+
+	if (APPINFO_u8FindByBaseAddress(Copy_u32BaseAddress, &Local_Record) != STATUS_OK) return STATUS_OK;
+
+	Local_u8Slot   = (u8)Local_Record.slot;
+	Local_u8Status = APPINFO_u8WriteApp(Local_u8Slot, Copy_u32BaseAddress, Copy_u32SizeInBytes, Local_Record.name, Copy_u32ImageCrc);
+	if (Local_u8Status != STATUS_OK)
+	{
+		/*The old CRC must not be checked against the new image: a programmed word can still be written to zero*/
+		FLASH_Unlock();
+		if (APPINFO_u8FindByBaseAddress(Copy_u32BaseAddress, &Local_Record) == STATUS_OK &&
+			FLASH_WriteWord((void*)(static_u32SlotAddress[Local_Record.slot]+offsetof(APPINFO_Record_t, imageCrc)), APPINFO_INVALIDATED_CRC) == STD_TYPES_ERROR_OK)
+		{
+			Local_u8Status = STATUS_OK;
+		}
+		FLASH_Lock();
+	}
+	return Local_u8Status;
+}
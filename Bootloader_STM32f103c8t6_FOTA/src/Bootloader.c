@@ -18,6 +18,16 @@
 #include "Delay_interface.h"
 
 #include "WIFI_interface.h"
+#include "APPINFO_interface.h"
+#include "SHA256_interface.h"
+#include "JOURNAL_interface.h"
+#include "HEX_interface.h"
+#include "STATS_interface.h"
+#include "TRACE_interface.h"
+#include "PROF_interface.h"
+#include "STACK_interface.h"
+#include "POOL_interface.h"
+#include "SCHED_interface.h"
 
 #ifndef  SCB_BASE_ADDRESS
 #define  SCB_BASE_ADDRESS       		0xE000ED00
@@ -27,8 +37,8 @@
 #define  FLASH_BOOTLDR_BASE_ADDRESS		0x08000000
 #define  FLASH_USR_APP_BASE_ADDRESS		0x08008000
 
-#define BL_RX_LEN 						2200
-u8  	bl_rx_buffer[BL_RX_LEN]      =  {0};
+/*Decoded command packet, length byte and up to 255 bytes that follow it (taken from the pools for every command)*/
+#define BL_RX_LEN 						256
 
 
 
@@ -55,6 +65,13 @@ u8  	bl_rx_buffer[BL_RX_LEN]      =  {0};
 #define BL_SYSTEM_RESET					0X5D	/**/
 #define BL_EXISTING_APPS				0x5E	/**/
 #define BL_SAVE_APP_INFO				0x61	/*Set app info*/
+#define BL_GET_DIGEST					0x62	/*This command is used to compute a CRC32 or SHA-256 digest of a memory region on the MCU*/
+#define BL_GET_RESUME					0x63	/*This command is used to read the progress of an interrupted download*/
+#define BL_GET_STATS					0x65	/*This command is used to read the performance counters of the boot-loader*/
+#define BL_GET_TRACE					0x66	/*This command is used to read the event trace of the boot-loader*/
+#define BL_GET_PROFILE					0x67	/*This command is used to read the PC sampling histogram and to start/stop the profiler*/
+#define BL_GET_MEMORY					0x68	/*This command is used to read the RAM usage (static, heap, stack high-water mark)*/
+#define BL_MEM_MULTICAST				0x69	/*This command is used to write an image sent by the host to many boards at once over UDP*/
 
 
 u8   supported_commands[] = {
@@ -74,7 +91,14 @@ u8   supported_commands[] = {
 							BL_PROTECTION_STATUS    ,
 							BL_SYSTEM_RESET		    ,
 							BL_EXISTING_APPS		,
-							BL_SAVE_APP_INFO
+							BL_SAVE_APP_INFO		,
+							BL_GET_DIGEST			,
+							BL_GET_RESUME			,
+							BL_GET_STATS			,
+							BL_GET_TRACE			,
+							BL_GET_PROFILE			,
+							BL_GET_MEMORY			,
+							BL_MEM_MULTICAST
 							};
 
 
@@ -89,8 +113,10 @@ u8   supported_commands[] = {
 #define BL_FLASH_ERASE_REPLY_LEN		((u8)(BL_ACK_LEN+1))
 #define BL_FLASH_MASS_ERASE_REPLY_LEN	((u8)(BL_ACK_LEN+0))
 
-#define BL_MEM_WRITE_REPLY_LEN			((u8)(BL_ACK_LEN+1))
-#define BL_MEM_READ_REPLY_LEN
+#define BL_MEM_WRITE_REPLY_LEN			((u8)(BL_ACK_LEN+9))		/*status, offset the download started from (4), chunk fetches repeated (2), chunks that were fetched again (2)*/
+#define BL_MEM_READ_HEADER_LEN			7U						/*4 bytes offset, 2 bytes raw length, 1 byte encoding*/
+#define BL_MEM_READ_MAX_PAYLOAD			184U					/*Largest chunk whose hex reply still fits the server request buffer*/
+#define BL_MEM_READ_REPLY_LEN(PAYLOAD)	((u8)(BL_ACK_LEN+BL_MEM_READ_HEADER_LEN+(PAYLOAD)))
 
 #define BL_EN_R_PROTECT_REPLY_LEN		((u8)(BL_ACK_LEN+0))
 #define BL_DIS_R_PROTECT_REPLY_LEN      ((u8)(BL_ACK_LEN+0))
@@ -100,8 +126,20 @@ u8   supported_commands[] = {
 #define BL_PROTECTION_STATUS_REPLY_LEN	((u8)(BL_ACK_LEN+10))
 
 #define BL_SYSTEM_RESET_REPLY_LEN				((u8)(BL_ACK_LEN+0))
-#define BL_EXISTING_APPS_REPLY_LEN(NUM_APP)		((u8)(BL_ACK_LEN+(16*NUM_APP)))
+#define BL_EXISTING_APPS_REPLY_LEN(NUM_APP)		((u8)(BL_ACK_LEN+(APPINFO_PUBLIC_RECORD_SIZE*NUM_APP)))
 #define BL_SAVE_APP_INFO_REPLY_LEN				((u8)(BL_ACK_LEN+1))
+#define BL_GET_DIGEST_REPLY_LEN(DIGEST_LEN)		((u8)(BL_ACK_LEN+6+(DIGEST_LEN)))	/*status, algorithm, time in us (4), digest*/
+#define BL_GET_RESUME_REPLY_LEN					((u8)(BL_ACK_LEN+13))	/*found, base address (4), size (4), bytes done (4)*/
+#define BL_GET_STATS_REPLY_LEN					((u8)(BL_ACK_LEN+STATS_RECORD_SIZE))
+#define BL_GET_TRACE_HEADER_LEN					7U		/*sequence of the first record (4), records left after this reply (2), records in this reply (1)*/
+#define BL_GET_TRACE_MAX_RECORDS				24U		/*Most records whose hex reply still fits the server request buffer*/
+#define BL_GET_TRACE_REPLY_LEN(RECORDS)			((u8)(BL_ACK_LEN+BL_GET_TRACE_HEADER_LEN+(RECORDS)*TRACE_RECORD_SIZE))
+#define BL_GET_PROFILE_HEADER_LEN				16U		/*rate (2), samples (4), samples outside (4), bucket shift (1), first entry (2), entries left (2), entries in reply (1)*/
+#define BL_GET_PROFILE_ENTRY_LEN				6U		/*bucket (2), samples (4)*/
+#define BL_GET_PROFILE_MAX_ENTRIES				30U
+#define BL_GET_PROFILE_REPLY_LEN(ENTRIES)		((u8)(BL_ACK_LEN+BL_GET_PROFILE_HEADER_LEN+(ENTRIES)*BL_GET_PROFILE_ENTRY_LEN))
+#define BL_GET_MEMORY_REPLY_LEN					((u8)(BL_ACK_LEN+STACK_USAGE_RECORD_SIZE+1+POOL_COUNT*POOL_STATS_RECORD_SIZE))
+#define BL_MEM_MULTICAST_REPLY_LEN				((u8)(BL_ACK_LEN+7))	/*status, chunks missing (2), datagrams taken (2), datagrams dropped (2)*/
 
 
 /*ACK and NACK bytes*/
@@ -115,6 +153,67 @@ u8   supported_commands[] = {
 #define VERIFY_CRC_SUCCESS				0U
 #define VERIFY_CRC_FAIL					1U
 
+/*Memory read encodings*/
+#define BL_MEM_READ_ENCODING_RAW		0U		/*Chunk bytes are sent as they are*/
+#define BL_MEM_READ_ENCODING_FF_RUNS	1U		/*Every run of 0xFF is sent as (0xFF, run length)*/
+/*Server accepts one update every 15 seconds, so chunks of the stream are spaced by this delay*/
+#define BL_MEM_READ_STREAM_DELAY_MS		15000
+
+/*BL_GET_PROFILE rates with a meaning of their own, any other rate restarts the profiler at that rate*/
+#define BL_PROFILE_RATE_STOP			0x0000U
+#define BL_PROFILE_RATE_KEEP			0xFFFFU		/*Keep sampling (or not) as before the command*/
+
+/*Digest algorithms*/
+#define BL_DIGEST_CRC32					0U		/*Hardware CRC unit fed with one 32-bit word per write*/
+#define BL_DIGEST_SHA256				1U
+#define BL_DIGEST_CRC32_LEN				4U
+#define BL_DIGEST_SHA256_LEN			32U
+
+/*DWT cycle counter, used to time the digest*/
+#define DEMCR							*((volatile u32*)0xE000EDFC)
+#define DEMCR_TRCENA					((u32)0x01000000)
+#define DWT_CTRL						*((volatile u32*)0xE0001000)
+#define DWT_CTRL_CYCCNTENA				((u32)0x00000001)
+#define DWT_CYCCNT						*((volatile u32*)0xE0001004)
+
+/*Set to 1 to print the cycles/byte of the hex codec (and of the per-nibble code it replaced) when entering BL mode*/
+#define BL_HEX_BENCHMARK				0
+#define BL_HEX_BENCHMARK_BYTES			512U
+/*Set to 1 to print the cost of one byte sent by HUART_u8SendSync on the debug UART when entering BL mode
+ * At 115200 baud a frame (start, 8 data, stop) takes 86.8us, that is about 6250 cycles at 72MHz (the 1ms delay after
+ * every byte it replaced took 72000)*/
+#define BL_UART_BENCHMARK				0
+#define BL_UART_BENCHMARK_BYTES			64U
+
+/*Scheduler tasks (the number is the priority), their events and timers*/
+#define BL_TASK_FLASH					0U		/*Writes and verifies the pages queued by a download*/
+#define BL_TASK_COMMAND					1U		/*Fetches the next host command and runs its handler*/
+#define BL_EVENT_FLASH_JOB				((u32)0x01)
+#define BL_EVENT_POLL					((u32)0x01)
+#define BL_TIMER_POLL					0U
+#define BL_POLL_PERIOD_MS				15000U	/*From the end of a command to the next fetch, the host waits as long*/
+#define BL_LINK_POLL_MS					100U	/*Same while the link (push transport or LAN direct) is open, a poll is one read of the module*/
+#define BL_POLL_DELAY_MS()				(WIFI_u8LinkIsOpen()? BL_LINK_POLL_MS : BL_POLL_PERIOD_MS)
+
+/*Flash jobs, one per page block of the pools : a page is fetched from the server while the previous one is written*/
+#define BL_FLASH_JOBS					2U
+#define BL_JOB_FREE						0U
+#define BL_JOB_QUEUED					1U
+#define BL_JOB_DONE						2U
+#define BL_JOB_FAILED					3U		/*The page did not read back as written*/
+
+/*Backup registers keep their value on warm resets (NRST, software, watchdog), they are cleared on power loss without VBAT*/
+#define PWR_CR							*((volatile u32*)0x40007000)
+#define PWR_CR_DBP						((u32)0x00000100)		/*Disable backup domain write protection*/
+#define BKP_DR1							*((volatile u32*)0x40006C04)
+#define BKP_DR2							*((volatile u32*)0x40006C08)
+#define BKP_DR3							*((volatile u32*)0x40006C0C)
+#define BKP_DR4							*((volatile u32*)0x40006C10)
+
+/*Validated marker: tag in DR1, image CRC in DR2/DR3 and record sequence in DR4
+ * so that saving a new record or flashing a new image never matches an old marker*/
+#define BL_VALIDATED_TAG				((u32)0xB007)
+
 /*MCU Chip ID*/
 #define DBGMCU_IDCODE 					*((volatile u32*)0xE0042000)
 #define DEV_ID_MASK						0x00000FFF
@@ -123,12 +222,44 @@ u8   supported_commands[] = {
 /*GOTO Address command macros*/
 #define ADDR_VALID   					0U
 #define ADDR_INVALID  					1U
+
+/*BL_MEM_WRITE status*/
+#define BL_MEM_WRITE_VERIFY_FAIL		2U		/*A page did not read back as written, the download can be resumed*/
+#define BL_MEM_WRITE_IMAGE_CRC_FAIL		3U		/*All pages were written but the image CRC does not match the one sent by host*/
+#define BL_MEM_WRITE_CHUNK_FAIL			4U		/*A chunk kept failing its manifest CRC, the download can be resumed*/
+#define BL_MEM_WRITE_MANIFEST_FAIL		5U		/*The chunk manifest does not match the CRC sent by host*/
+#define BL_MEM_WRITE_NO_BUFFER			6U		/*The pools had no free block for the download, nothing was written*/
+#define BL_MEM_WRITE_NO_LINK			7U		/*The UDP link of a multicast download could not be opened, nothing was written*/
+#define BL_MEM_WRITE_PAGE_RETRIES		2U
+#define BL_MEM_WRITE_CHUNK_RETRIES		3U		/*Fetches of one chunk (or of the manifest) after the first one*/
+#define BL_IMAGE_CHUNK_SIZE				1024U	/*Every chunk is one window of the published image text*/
+#define BL_MANIFEST_MAX_CHUNKS			(FLASH_SIZE/BL_IMAGE_CHUNK_SIZE)
+
+/*Multicast download : every datagram is hex chars, a type char then the session (low 16 bits of the image CRC, 4 chars)
+ * 'F' chunk (4 chars), part (2 chars), CRC32 of the whole chunk (8 chars), then the bytes of the part
+ * 'Q' round (2 chars) : the board answers 'B', session, round, unique ID (24 chars), chunks (4 chars), bitmap of missing chunks
+ * 'E' : the download is over
+ * The numbers are most significant first, bit n of byte n/8 of the bitmap is chunk n*/
+#define BL_MCAST_DATA					'F'
+#define BL_MCAST_QUERY					'Q'
+#define BL_MCAST_BITMAP					'B'
+#define BL_MCAST_END					'E'
+#define BL_MCAST_SESSION_LEN			5U		/*Type char and session*/
+#define BL_MCAST_DATA_HEADER_LEN		19U
+#define BL_MCAST_PART_SIZE				256U	/*Bytes of a chunk in one datagram, the datagram is about half a 1 KB page of chars*/
+#define BL_MCAST_UID_ADDRESS			0x1FFFF7E8
+#define BL_MCAST_UID_LEN				12U
+#define BL_MCAST_IDLE_TIMEOUT_MS		60000U	/*The host is taken as gone after this long without a datagram*/
+#define BL_MCAST_NO_CHUNK				0xFFFFU
 #define FLASH_START						0x08000000
 #define FLASH_SIZE                      128*1024 		/*128K*/
 #define FLASH_END                       (FLASH_START+(FLASH_SIZE-1))
 #define RAM_START                       0x20000000
 #define RAM_SIZE                        20*1024 		/*20K*/
 #define RAM_END                         (RAM_START+RAM_SIZE-1)
+/*Pages 29 to 31 hold the application info log and the download journal, region BLMETA of the linker script (mem.ld)*/
+#define BL_METADATA_START				FLASH_MEMORY_PAGE_29
+#define BL_METADATA_END					(FLASH_MEMORY_PAGE_31+0x3FF)
 
 
 /*Commands handle functions prototypes*/
@@ -140,6 +271,7 @@ void bootloader_handle_flash_erase_cmd			(u8* bl_rx_buffer);
 void bootloader_handle_flash_mass_erase_cmd		(u8* bl_rx_buffer);///////////
 void bootloader_handle_mem_write_cmd			(u8* bl_rx_buffer);
 void bootloader_handle_mem_read_cmd				(u8* bl_rx_buffer);
+void bootloader_handle_mem_multicast_cmd		(u8* bl_rx_buffer);
 void bootloader_handle_en_read_protect_cmd		(u8* bl_rx_buffer);
 void bootloader_handle_dis_read_protect_cmd		(u8* bl_rx_buffer);
 void bootloader_handle_en_write_protect_cmd		(u8* bl_rx_buffer);
@@ -149,18 +281,38 @@ void bootloader_handle_read_sectors_status_cmd	(u8* bl_rx_buffer);
 void bootloader_handle_system_reset_cmd			(u8* bl_rx_buffer);
 void bootloader_handle_existing_apps_cmd		(u8* bl_rx_buffer);
 void bootloader_handle_save_app_info_cmd		(u8* buff);
+void bootloader_handle_get_digest_cmd			(u8* bl_rx_buffer);
+void bootloader_handle_get_resume_cmd			(u8* bl_rx_buffer);
+void bootloader_handle_get_stats_cmd			(u8* bl_rx_buffer);
+void bootloader_handle_get_trace_cmd			(u8* bl_rx_buffer);
+void bootloader_handle_get_profile_cmd			(u8* bl_rx_buffer);
+void bootloader_handle_get_memory_cmd			(u8* bl_rx_buffer);
 
 
 
 
 
 /*Helper functions prototypes*/
+u8   bootloader_validate_user_app(u32* pElapsed_us);
+void bootloader_set_validated_marker(APPINFO_Record_t* pRecord);
+void bootloader_clear_validated_marker(void);
+void bootloader_start_cycle_counter(void);
+u32  bootloader_cycles_to_us(u32 cycles);
 void bootloader_send_ack(u8 follow_len);
 void bootloader_send_nack(void);
 u8   bootloader_verify_crc(u8* pData, u32 len, u32 crc_host);
+u8   bootloader_decode_hex(u8* pChars, u8* pBytes, u16 len);
 u8   verify_address(u32 go_address);
-void char2hex(u8* inBuffer, u8* outBuffer, u16 NumOfBytesToBeConverted );
-void hex2char(u8* inBuffer, u8* outBuffer, u16 NumOfBytesToBeConverted );
+u8   verify_flash_write_range(u32 start_address, u32 len);
+u32  bootloader_crc32_words(u32 start_address, u32 len);
+u8   bootloader_fetch_manifest(u16 chunks, u32 file_size, u32 manifest_crc, u8* pWebBuffer, u16* pRefetches);
+u16  bootloader_encode_ff_runs(u8* pSrc, u32 src_len, u8* pDest, u16 dest_max, u32* pConsumed);
+#if BL_HEX_BENCHMARK
+void bootloader_benchmark_hex_codec(void);
+#endif
+#if BL_UART_BENCHMARK
+void bootloader_benchmark_uart_tx(void);
+#endif
 
 
 
@@ -172,19 +324,33 @@ GPIO_Pin_t OnBoard_Led;
 /*This variable is used in the data receiving function for flashing*/
 extern u16 Global_u16IteratorForNumberOfTimesDataAreReceived;
 
-#define BOOTLOADER_RESPONSE_ARRAY_SIZE		(u16)256
-/*This array will be used for holding data that will be sent to webserver*/
-u8 Global_u8ResponseArray[BOOTLOADER_RESPONSE_ARRAY_SIZE]={0};
+/*Records of one BL_GET_TRACE reply are copied out of the trace ring here*/
+static u8 static_u8TraceRecords[BL_GET_TRACE_MAX_RECORDS*TRACE_RECORD_SIZE];
+/*Memory read chunks packed with FF runs are built here, raw chunks are encoded into the reply straight from memory*/
+static u8 static_u8EncodedChunk[BL_MEM_READ_MAX_PAYLOAD];
+/*CRC32 of every chunk of the image being downloaded, fetched from the manifest window that follows the image*/
+static u32 static_u32ChunkManifest[BL_MANIFEST_MAX_CHUNKS];
+/*Chunks of a multicast download that are not in flash yet, one bit per chunk*/
+static u8 static_u8MissingChunks[BL_MANIFEST_MAX_CHUNKS/8];
 
 
 /*Jumps to the user application code if there is no Boot-loader request*/
 void bootloader_voidJumpToUserApp(void)
 {
+	u32 validation_us = 0;
+
 	printmsg1("BL_DEBUG_MSG: Button is not pressed .. executing user app \r\n");
 
 	//just a function to hold the address of the reset handler of the user app
 	void (*app_reset_handler)(void);
 
+	/*0. make sure the image is intact before jumping to it, stay in BL mode otherwise*/
+	if(bootloader_validate_user_app(&validation_us) != STATUS_OK)
+	{
+		printmsg1("BL_DEBUG_MSG: User app is corrupted (%d us) .. going to BL mode\r\n",validation_us);
+		bootloader_voidUARTReadData();
+	}
+
 	/*1. configure the MSP by reading the value from the base address of the FLASH sector
 	 * that contains the user app*/
 	u32 msp_value = *(volatile u32*)FLASH_USR_APP_BASE_ADDRESS;  //getting the user app flash sector
@@ -203,27 +369,250 @@ void bootloader_voidJumpToUserApp(void)
 	 * */
 	app_reset_handler = (void*)(*((volatile u32*)(FLASH_USR_APP_BASE_ADDRESS+0x04)));
 
-	/*3. Jump to reset handler of the user application*/
+	/*3. Jump to reset handler of the user application, the logs still queued are sent first*/
+	flushmsg1();
 	app_reset_handler();
 }
 
-/*Reads the command packet which comes from the host application*/
-void bootloader_voidUARTReadData (void)
+/*Page of a download waiting to be written by the flash task*/
+typedef struct
+{
+	u32* source;
+	u32  destination;
+	u32  offsetEnd;								/*Download offset reached once this page is written*/
+	u16  length;
+	volatile u8 state;
+}bl_flash_job_t;
+
+static bl_flash_job_t static_FlashJobs[BL_FLASH_JOBS];
+/*Next job for the flash task, jobs are written in the order they were queued*/
+static u8 static_u8NextFlashJob;
+
+/*Flash task : writes one queued page and reads it back, a page is erased and written again up to BL_MEM_WRITE_PAGE_RETRIES times
+ * Flash operations stall the CPU, so this task only runs while the other tasks sleep (the WIFI module is quiet then)*/
+static void bootloader_flash_task(u32 events)
+{
+	u8 retry;
+	bl_flash_job_t* job = &static_FlashJobs[static_u8NextFlashJob];
+
+	/*The only event is BL_EVENT_FLASH_JOB, the queue itself says what is left to write*/
+	(void)events;
+	if(job->state != BL_JOB_QUEUED) return;
+	for(retry=0;retry<BL_MEM_WRITE_PAGE_RETRIES;retry++)
+	{
+		FLASH_PageErase		(job->destination);
+		FLASH_WriteProgram	(job->source, (u32*)job->destination, job->length);
+		if(memcmp((void*)job->destination, job->source, job->length)==0) break;
+	}
+	job->state = (retry==BL_MEM_WRITE_PAGE_RETRIES)? BL_JOB_FAILED : BL_JOB_DONE;
+	static_u8NextFlashJob = (static_u8NextFlashJob+1)%BL_FLASH_JOBS;
+	/*One page per run, the next one is written on the next run*/
+	if(static_FlashJobs[static_u8NextFlashJob].state == BL_JOB_QUEUED) SCHED_voidPost(BL_TASK_FLASH, BL_EVENT_FLASH_JOB);
+}
+
+/*Queues a page for the flash task, the source must not change until the job is finished
+ * Flash is programmed by half-words, an odd length is padded with one erased byte (the page buffer has room for it)*/
+static void bootloader_flash_job_queue(u8 job, u32* source, u32 destination, u16 length, u32 offset_end)
+{
+	if(length & 1U)
+	{
+		((u8*)source)[length] = 0xFF;
+		length++;
+	}
+	static_FlashJobs[job].source      = source;
+	static_FlashJobs[job].destination = destination;
+	static_FlashJobs[job].length      = length;
+	static_FlashJobs[job].offsetEnd   = offset_end;
+	static_FlashJobs[job].state       = BL_JOB_QUEUED;
+	SCHED_voidPost(BL_TASK_FLASH, BL_EVENT_FLASH_JOB);
+}
+
+/*Waits for a queued page to be written (the flash task runs meanwhile) and frees its job
+ * With commit set, the download progress is saved in the journal once the page reads back as written
+ * Returns STATUS_OK if the job was free or its page reads back as written*/
+static u8 bootloader_flash_job_finish(u8 job, u8 commit, u32 file_size)
+{
+	u8 status = STATUS_OK;
+
+	if(static_FlashJobs[job].state == BL_JOB_FREE) return status;
+	while(static_FlashJobs[job].state == BL_JOB_QUEUED) SCHED_u8RunOnce();
+	if(static_FlashJobs[job].state == BL_JOB_FAILED)
+	{
+		printmsg1("\r\nBL_DEBUG_MSG: Page at %#x failed verification\r\n",static_FlashJobs[job].destination);
+		status = STATUS_NOK;
+	}
+	else if(commit)
+	{
+		JOURNAL_u8CommitProgress(static_FlashJobs[job].offsetEnd);
+		printmsg1("\rFlashing : %.f %% \tdone  ",((f32)static_FlashJobs[job].offsetEnd/(f32)file_size)*100);
+	}
+	static_FlashJobs[job].state = BL_JOB_FREE;
+	return status;
+}
+
+/*Command task : fetches the next command from the server, runs its handler, then fetches again BL_POLL_DELAY_MS() later*/
+static void bootloader_command_task(u32 events)
 {
 	/****************Modification by Mahmoud for WIFI**************/
-	/*This local variable will hold the data coming from site so that we can convert them later*/
-	u8 Local_u8Buffer[1100]={0};
+	/*This local variable will hold the data coming from site so that we can convert them later (a block of the pools)*/
+	u8* Local_u8Buffer;
 	/*******************End of modification******************/
+	/*Decoded command packet (a block of the pools)*/
+	u8* bl_rx_buffer;
+	/*This variable holds the length of the data that will follow the command. It will be used to know how many bytes
+	to convert and save in the receiving buffer*/
+	u8 rcv_len=0;
+
+	/*The only event is BL_EVENT_POLL*/
+	(void)events;
+	/*Both buffers are taken for this command only, the blocks come zeroed*/
+	Local_u8Buffer = POOL_pvAlloc(WIFI_RECEIVE_ARRAY_SIZE);
+	bl_rx_buffer   = POOL_pvAlloc(BL_RX_LEN);
+	if(Local_u8Buffer==NULL || bl_rx_buffer==NULL)
+	{
+		printmsg1("BL_DEBUG_MSG: No buffer left for the command\r\n");
+		POOL_voidFree(Local_u8Buffer);
+		POOL_voidFree(bl_rx_buffer);
+		SCHED_u8StartTimer(BL_TIMER_POLL, BL_TASK_COMMAND, BL_EVENT_POLL, BL_POLL_DELAY_MS(), 0);
+		return;
+	}
+	/*here we will read and and decode the commands coming from host*/
+
+    /*WIFI modifications by Mahmoud*/
+    /*Start receiving data using WIFI*/
+    WIFI_u8ReceiveCommand(Local_u8Buffer);
+    //delay_ms(15000);
+    //WIFI_u8SendCommandToServer(" ",1);
+    //delay_ms(15000);
+	/*Convert first byte received, which is equivalent to length to follow, and save it inside rcv_len variable*/
+	/*Anything that is not hex (the server holds "EMPTY" between commands) is not a command, nothing is decoded then*/
+	if(bootloader_decode_hex(Local_u8Buffer,&rcv_len,1)!=STATUS_OK) rcv_len=0;
+	/*Add rcv_len to first element of buffer (needed in further operations)*/
+	bl_rx_buffer[0] = rcv_len;
+    /*Convert data to proper format (hex) according to the received length, and put them inside buffer starting from 
+	element of index[1] and to length equal to rcv_len, the app name of BL_SAVE_APP_INFO is plain chars and the CRC covers the rest*/
+    bootloader_decode_hex(&Local_u8Buffer[2], &bl_rx_buffer[1], rcv_len);
+	/*The chars are not needed anymore (BL_SAVE_APP_INFO reads them), their block can serve the command*/
+	if(bl_rx_buffer[1]!=BL_SAVE_APP_INFO)
+	{
+		POOL_voidFree(Local_u8Buffer);
+		Local_u8Buffer = NULL;
+	}
 
+	/***************************************************************************/
+	if(rcv_len) TRACE_voidRecord(TRACE_EVENT_COMMAND, TRACE_PHASE_BEGIN, bl_rx_buffer[1]);
+	switch(bl_rx_buffer[1]) //checking for the received command and then executing its code
+	{
+		case BL_GET_VER:
+			bootloader_handle_getver_cmd(bl_rx_buffer);
+			break;
+		case BL_GET_HELP:
+			bootloader_handle_gethelp_cmd(bl_rx_buffer);
+			break;
+		case BL_GET_CID:
+			bootloader_handle_getcid_cmd(bl_rx_buffer);
+			break;
+
+		case BL_GO_TO_ADDR:
+			bootloader_handle_goto_address_cmd(bl_rx_buffer);
+			break;
+
+		case BL_FLASH_ERASE:
+			bootloader_handle_flash_erase_cmd(bl_rx_buffer);
+			break;
+		case BL_FLASH_MASS_ERASE:
+			bootloader_handle_flash_mass_erase_cmd(bl_rx_buffer);
+			break;
+
+		case BL_MEM_WRITE:
+			bootloader_handle_mem_write_cmd(bl_rx_buffer);
+			break;
+		case BL_MEM_READ:
+			bootloader_handle_mem_read_cmd(bl_rx_buffer);
+			break;
+		case BL_MEM_MULTICAST:
+			bootloader_handle_mem_multicast_cmd(bl_rx_buffer);
+			break;
+
+		case BL_EN_R_PROTECT:
+			bootloader_handle_en_read_protect_cmd(bl_rx_buffer);
+			break;
+		case BL_DIS_R_PROTECT:
+			bootloader_handle_dis_read_protect_cmd(bl_rx_buffer);
+			break;
+		case BL_EN_W_PROTECT:
+			bootloader_handle_en_write_protect_cmd(bl_rx_buffer);
+			break;
+		case BL_DIS_W_PROTECT:
+			bootloader_handle_dis_write_protect_cmd(bl_rx_buffer);
+			break;
+		case BL_GET_RDP_STATUS:
+			bootloader_handle_getrdp_cmd(bl_rx_buffer);
+			break;
+		case BL_PROTECTION_STATUS:
+			bootloader_handle_read_sectors_status_cmd(bl_rx_buffer);
+			break;
+
+		case BL_SYSTEM_RESET:
+			bootloader_handle_system_reset_cmd(bl_rx_buffer);
+			break;
+		case BL_EXISTING_APPS:
+			bootloader_handle_existing_apps_cmd(bl_rx_buffer);
+			break;
+		case BL_SAVE_APP_INFO:
+			bootloader_handle_save_app_info_cmd(Local_u8Buffer);
+			break;
+		case BL_GET_DIGEST:
+			bootloader_handle_get_digest_cmd(bl_rx_buffer);
+			break;
+		case BL_GET_RESUME:
+			bootloader_handle_get_resume_cmd(bl_rx_buffer);
+			break;
+		case BL_GET_STATS:
+			bootloader_handle_get_stats_cmd(bl_rx_buffer);
+			break;
+		case BL_GET_TRACE:
+			bootloader_handle_get_trace_cmd(bl_rx_buffer);
+			break;
+		case BL_GET_PROFILE:
+			bootloader_handle_get_profile_cmd(bl_rx_buffer);
+			break;
+		case BL_GET_MEMORY:
+			bootloader_handle_get_memory_cmd(bl_rx_buffer);
+			break;
+		default:
+			/*Polls of the command server come every BL_LINK_POLL_MS, they are not all told*/
+			if(!WIFI_u8LinkIsOpen()) printmsg1("\nBL_DEBUG_MSG: Ready to receive command from HOST application ... \r\n");
+			break;
+	}
+	if(rcv_len) TRACE_voidRecord(TRACE_EVENT_COMMAND, TRACE_PHASE_END, bl_rx_buffer[1]);
+	POOL_voidFree(Local_u8Buffer);
+	POOL_voidFree(bl_rx_buffer);
+	SCHED_u8StartTimer(BL_TIMER_POLL, BL_TASK_COMMAND, BL_EVENT_POLL, BL_POLL_DELAY_MS(), 0);
+}
+
+/*Reads the command packet which comes from the host application*/
+void bootloader_voidUARTReadData (void)
+{
 	/*This local variable should hold username of desired WIFI network
 	 * Note: By standard, SSID is limited to 32 characters including null terminator*/
 	u8 Local_u8SSID[32]={0};
 	/*This local variable should hold password of desired WIFI network
 	 * Note: By standard, password is limited to 64 characters including null terminator*/
 	u8 Local_u8Password[64]={0};
+	/*This local variable will hold the progress of an interrupted download (if any)*/
+	JOURNAL_Progress_t download_progress;
 
+	/*Performance counters cover everything done in BL mode from here*/
+	STATS_voidInit();
+	TRACE_voidInit();
+	SCHED_voidInit();
 	printmsg1("BL_DEBUG_MSG: Button is pressed .. going to BL mode\r\n");
-
+	/*The image may be changed from BL mode, so it has to be checked again on next boot*/
+	bootloader_clear_validated_marker();
+	if(JOURNAL_u8GetProgress(&download_progress)==STATUS_OK)
+		printmsg1("BL_DEBUG_MSG: Unfinished download at %#x, resuming from offset %d of %d bytes\r\n",
+				  download_progress.baseAddress,download_progress.bytesDone,download_progress.sizeInBytes);
 
 
 	OnBoard_Led.port = PORTC;
@@ -233,6 +622,15 @@ void bootloader_voidUARTReadData (void)
 
 	GPIO_Init(&OnBoard_Led);
 	GPIO_Pin_Write(&OnBoard_Led,HIGH);
+#if BL_HEX_BENCHMARK
+	bootloader_benchmark_hex_codec();
+#endif
+#if BL_UART_BENCHMARK
+	bootloader_benchmark_uart_tx();
+#endif
+	/*Build the applications table index from the log pages (once per boot)*/
+	if(APPINFO_u8Init()!=STATUS_OK)
+		printmsg1("BL_DEBUG_MSG: Applications table could not be recovered\r\n");
 	/***************************WiFi initialization***************************/
 	printmsg1("BL_DEBUG_MSG: Initializing WiFi module (ESP8266 S01) ...\r\n");
 	WIFI_u8Init(HUART_USART2);
@@ -240,115 +638,26 @@ void bootloader_voidUARTReadData (void)
 	//WIFI_u8SetOutput(HUART_USART1);
 	/*Initialize UART peripheral on UART 2
 	 * WIFI must be on UART2 because logic levels of UART2 is 3.3 not 5V*/
-	delay_ms(1000);
+	SCHED_voidSleep(1000);
 	WIFI_u8SendCommand(WIFI_COMMAND_SET_MODE_STATION);
-	delay_ms(1000);
+	SCHED_voidSleep(1000);
 	//WIFI_u8EnterSSID(Local_u8SSID, Local_u8Password);
 //	WIFI_u8SendCommand(WIFI_COMMAND_LIST_AP);
 //	delay_ms(5000);
 	//WIFI_u8ConnectToAccessPoint(Local_u8SSID,Local_u8Password);
 	//WIFI_u8ConnectToAccessPoint((u8*)"Hamdy",(u8*)"commandos123");
 	WIFI_u8ConnectToAccessPoint((u8*)"TEdata61D609",(u8*)"03926003");
-	delay_ms(5000);
+	SCHED_voidSleep(5000);
 	//HUART_u8SetRXCallBack(rxDone);
 	printmsg1("BL_DEBUG_MSG: WiFi initialization Done!\r\n");
 
 
-	/*This variable holds the length of the data that will follow the command. It will be used to know how many bytes
-	to convert and save in the receiving buffer*/
-    u8 rcv_len;
-
-
-
-
-	while(1)
-	{
-		/*Reinitialize these variables because they will be used as flags, this is to work well with the while loop inside*/
-		rcv_len=0;
-
-		/*Reinitialize data buffer to zeros again*/
-        memset(bl_rx_buffer,0,1000);
-		/*here we will read and and decode the commands coming from host*/
-
-        /*WIFI modifications by Mahmoud*/
-        /*Start receiving data using WIFI*/
-        WIFI_u8ReceiveCommand(Local_u8Buffer);
-        //delay_ms(15000);
-        //WIFI_u8SendCommandToServer(" ",1);
-        //delay_ms(15000);
-		/*Convert first byte received, which is equivalent to length to follow, and save it inside rcv_len variable*/
-		char2hex(Local_u8Buffer,&rcv_len,1);
-		/*Add rcv_len to first element of buffer (needed in further operations)*/
-		bl_rx_buffer[0] = rcv_len;
-        /*Convert data to proper format (hex) according to the received length, and put them inside buffer starting from 
-		element of index[1] and to length equal to rcv_len*/
-        char2hex(&Local_u8Buffer[2], &bl_rx_buffer[1], rcv_len);
-
-		/***************************************************************************/
-		switch(bl_rx_buffer[1]) //checking for the received command and then executing its code
-		{
-			case BL_GET_VER:
-				bootloader_handle_getver_cmd(bl_rx_buffer);
-				break;
-			case BL_GET_HELP:
-				bootloader_handle_gethelp_cmd(bl_rx_buffer);
-				break;
-			case BL_GET_CID:
-				bootloader_handle_getcid_cmd(bl_rx_buffer);
-				break;
-
-			case BL_GO_TO_ADDR:
-				bootloader_handle_goto_address_cmd(bl_rx_buffer);
-				break;
-
-			case BL_FLASH_ERASE:
-				bootloader_handle_flash_erase_cmd(bl_rx_buffer);
-				break;
-			case BL_FLASH_MASS_ERASE:
-				bootloader_handle_flash_mass_erase_cmd(bl_rx_buffer);
-				break;
-
-			case BL_MEM_WRITE:
-				bootloader_handle_mem_write_cmd(bl_rx_buffer);
-				break;
-			case BL_MEM_READ:
-				bootloader_handle_mem_read_cmd(bl_rx_buffer);
-				break;
-
-			case BL_EN_R_PROTECT:
-				bootloader_handle_en_read_protect_cmd(bl_rx_buffer);
-				break;
-			case BL_DIS_R_PROTECT:
-				bootloader_handle_dis_read_protect_cmd(bl_rx_buffer);
-				break;
-			case BL_EN_W_PROTECT:
-				bootloader_handle_en_write_protect_cmd(bl_rx_buffer);
-				break;
-			case BL_DIS_W_PROTECT:
-				bootloader_handle_dis_write_protect_cmd(bl_rx_buffer);
-				break;
-			case BL_GET_RDP_STATUS:
-				bootloader_handle_getrdp_cmd(bl_rx_buffer);
-				break;
-			case BL_PROTECTION_STATUS:
-				bootloader_handle_read_sectors_status_cmd(bl_rx_buffer);
-				break;
-
-			case BL_SYSTEM_RESET:
-				bootloader_handle_system_reset_cmd(bl_rx_buffer);
-				break;
-			case BL_EXISTING_APPS:
-				bootloader_handle_existing_apps_cmd(bl_rx_buffer);
-				break;
-			case BL_SAVE_APP_INFO:
-				bootloader_handle_save_app_info_cmd(Local_u8Buffer);
-				break;
-			default:
-				printmsg1("\nBL_DEBUG_MSG: Ready to receive command from HOST application ... \r\n");
-				break;
-		}
-		delay_ms(15000);
-	}
+	/*From here the bootloader runs as tasks : the command task fetches and handles the host commands, the flash task
+	 * writes the pages of a download while the next one is fetched*/
+	SCHED_u8AddTask(BL_TASK_FLASH, bootloader_flash_task);
+	SCHED_u8AddTask(BL_TASK_COMMAND, bootloader_command_task);
+	SCHED_u8StartTimer(BL_TIMER_POLL, BL_TASK_COMMAND, BL_EVENT_POLL, 0, 0);
+	SCHED_voidRun();
 }
 
 /******************* Implementation of Boot-loader Command Handle Functions *******************/
@@ -356,7 +665,6 @@ void bootloader_voidUARTReadData (void)
 /*Helper function to handle BL_GET_VER command*/
 void bootloader_handle_getver_cmd				(u8* bl_rx_buffer)
 {
-	u8  Local_u8FinalReply[BL_GET_VER_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 	u8  bl_version;											/*variable to store BL version*/
 
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
@@ -377,11 +685,9 @@ void bootloader_handle_getver_cmd				(u8* bl_rx_buffer)
 		printmsg1("BL_DEBUG_MSG: BL_VER : 0x%x \r\n",bl_version);
 		/******************************Modifications by Mahmoud For WIFI***********************/
 		/*Write bootloader version in the next byte*/
-		Global_u8ResponseArray[2]=bl_version;
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_GET_VER_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_GET_VER_REPLY_LEN*2);
+		WIFI_voidReplyAppendU8(bl_version);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 		//HUART_u8SendSync(HUART_USART2,&bl_version,1,10); //sending version to host
 	}
 	else
@@ -397,9 +703,6 @@ void bootloader_handle_getver_cmd				(u8* bl_rx_buffer)
  * Bootloader sends out all supported command codes*/
 void bootloader_handle_gethelp_cmd				(u8* bl_rx_buffer)
 {
-		u8  index;
-		u8  Local_u8FinalReply[BL_GET_HELP_REPLY_LEN*2] = {0};
-
 
 		u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
 		u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
@@ -416,14 +719,10 @@ void bootloader_handle_gethelp_cmd				(u8* bl_rx_buffer)
 			bootloader_send_ack(sizeof(supported_commands));
 			//Sending boot-loader supported commands
 			/******************************Modifications by Mahmoud For WIFI***********************/
-			/*Write reply bytes after the first two bytes of ack*/
-			for(index=0;index<sizeof(supported_commands);index++)
-				Global_u8ResponseArray[index+2]=supported_commands[index];
-			//Global_u8ResponseArray[2]=bl_version;
-			/*Convert array to char to send them over WIFI*/
-			hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_GET_HELP_REPLY_LEN);
-			/*Send converted Bytes over WIFI*/
-			WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_GET_HELP_REPLY_LEN*2);
+			/*Append reply bytes after the ack*/
+			WIFI_voidReplyAppendBytes(supported_commands, sizeof(supported_commands));
+			/*Send the reply over WIFI*/
+			WIFI_u8ReplySend();
 
 			//HUART_u8SendSync(HUART_USART2,supported_commands,sizeof(supported_commands),10);
 
@@ -445,7 +744,6 @@ void bootloader_handle_getcid_cmd				(u8* bl_rx_buffer)
 {
 	u16 device_id 	= DBGMCU_IDCODE & DEV_ID_MASK;
 	u16 revision_id = DBGMCU_IDCODE & REV_ID_MASK;
-	u8  Local_u8FinalReply[BL_GET_CID_REPLY_LEN*2] = {0};
 
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
 	u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
@@ -462,19 +760,15 @@ void bootloader_handle_getcid_cmd				(u8* bl_rx_buffer)
 		bootloader_send_ack(4);
 		//Sending device ID and Revision ID
 		/******************************Modifications by Mahmoud For WIFI***********************/
-		/*Write reply bytes after the first two bytes of ack*/
- 		Global_u8ResponseArray[2]=(u8)device_id;
- 		Global_u8ResponseArray[3]=(u8)(device_id>>8);
- 		Global_u8ResponseArray[4]=(u8)revision_id;
- 		Global_u8ResponseArray[5]=(u8)(revision_id>>8);
+		/*Append reply bytes after the ack*/
+ 		WIFI_voidReplyAppendU16(device_id);
+ 		WIFI_voidReplyAppendU16(revision_id);
 
 		//HUART_u8SendSync(HUART_USART2,(u8*)&device_id,2,10);
 		//HUART_u8SendSync(HUART_USART2,(u8*)&revision_id,2,10);
 
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_GET_CID_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_GET_CID_REPLY_LEN*2);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
 
 		/*for debugging*/
@@ -494,7 +788,6 @@ void bootloader_handle_getcid_cmd				(u8* bl_rx_buffer)
 void bootloader_handle_goto_address_cmd			(u8* bl_rx_buffer)
 {
 	u8 index;
-	u8  Local_u8FinalReply[BL_GO_TO_ADDR_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 
 	u32 go_address=0;
 	u8 addr_valid   = ADDR_VALID;
@@ -528,12 +821,10 @@ void bootloader_handle_goto_address_cmd			(u8* bl_rx_buffer)
         	{
 				//tell host that address is fine
     			/******************************Modifications by Mahmoud For WIFI***********************/
-        	/*Write reply bytes after the first two bytes of ack*/
-        		Global_u8ResponseArray[2]=	addr_valid;
-        		/*Convert array to char to send them over WIFI*/
-        		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_GO_TO_ADDR_REPLY_LEN);
-        		/*Send converted Bytes over WIFI*/
-        		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_GO_TO_ADDR_REPLY_LEN*2);
+        	/*Append reply bytes after the ack*/
+        		WIFI_voidReplyAppendU8(addr_valid);
+        		/*Send the reply over WIFI*/
+        		WIFI_u8ReplySend();
 
 
         		//HUART_u8SendSync(HUART_USART2,&addr_valid,1,10);
@@ -552,6 +843,10 @@ void bootloader_handle_goto_address_cmd			(u8* bl_rx_buffer)
 			   // void (*lets_jump)(void) = (void *)Local_u8FinalAddress;
 
 				printmsg1("BL_DEBUG_MSG: jumping to go address! \n");
+				/*Nothing must be left running from the interrupts once the code there takes over (profiler SysTick included)*/
+				flushmsg1();
+				HUART_voidStopRXRing(HUART_USART2);
+				PROF_voidStop();
 
 				lets_jump();
 
@@ -561,12 +856,10 @@ void bootloader_handle_goto_address_cmd			(u8* bl_rx_buffer)
 				printmsg1("BL_DEBUG_MSG:GO addr invalid ! \n");
 				//tell host that address is invalid
     			/******************************Modifications by Mahmoud For WIFI***********************/
-				/*Write reply bytes after the first two bytes of ack*/
-        		Global_u8ResponseArray[2]=	addr_invalid;
-        		/*Convert array to char to send them over WIFI*/
-        		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_GO_TO_ADDR_REPLY_LEN);
-        		/*Send converted Bytes over WIFI*/
-        		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_GO_TO_ADDR_REPLY_LEN*2);
+				/*Append reply bytes after the ack*/
+        		WIFI_voidReplyAppendU8(addr_invalid);
+        		/*Send the reply over WIFI*/
+        		WIFI_u8ReplySend();
 				//HUART_u8SendSync(HUART_USART2,&addr_invalid,1,10);
 			}
 
@@ -583,7 +876,6 @@ void bootloader_handle_goto_address_cmd			(u8* bl_rx_buffer)
 void bootloader_handle_flash_erase_cmd			(u8* bl_rx_buffer)
 {
 	u8  index;
-	u8  Local_u8FinalReply[BL_FLASH_ERASE_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 
 	u8  status;
 	u8  Local_u8FinalAddress[4];								/*This local variable will hold the concatenated address  value that should be passed*/
@@ -622,12 +914,10 @@ void bootloader_handle_flash_erase_cmd			(u8* bl_rx_buffer)
 		bootloader_send_ack(1);
 		//Sending status to HOST application
 		/******************************Modifications by Mahmoud For WIFI***********************/
-		/*Write reply bytes after the first two bytes of ack*/
-		Global_u8ResponseArray[2]=	status;
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_FLASH_ERASE_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_FLASH_ERASE_REPLY_LEN*2);
+		/*Append reply bytes after the ack*/
+		WIFI_voidReplyAppendU8(status);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 		//HUART_u8SendSync(HUART_USART2,&status,1,10);
 	}
 	else
@@ -640,7 +930,6 @@ void bootloader_handle_flash_erase_cmd			(u8* bl_rx_buffer)
 
 void bootloader_handle_flash_mass_erase_cmd		(u8* bl_rx_buffer)
 {
-	u8  Local_u8FinalReply[BL_FLASH_MASS_ERASE_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 	//u8  Local_u8FinalHostCRC[4];
 
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
@@ -662,10 +951,8 @@ void bootloader_handle_flash_mass_erase_cmd		(u8* bl_rx_buffer)
 		//processing
 		//Stating that a reply of zero bytes is going to be sent
 		bootloader_send_ack(0);
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_FLASH_MASS_ERASE_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_FLASH_MASS_ERASE_REPLY_LEN*2);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
 		FLASH_Unlock();
 		FLASH_MassErase();
@@ -682,11 +969,9 @@ void bootloader_handle_flash_mass_erase_cmd		(u8* bl_rx_buffer)
 void bootloader_handle_mem_write_cmd			(u8* bl_rx_buffer)
 {
 	u8  index;
-	u8  Local_u8FinalReply[BL_MEM_WRITE_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 
 
 
-	u8 addr_valid   = ADDR_VALID;
 	u8 addr_invalid = ADDR_INVALID;
 
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
@@ -701,11 +986,22 @@ void bootloader_handle_mem_write_cmd			(u8* bl_rx_buffer)
 	u32 bytes_received_so_far =0;
 	u32 len_to_read			  =0;
 	u32 destination_address   =0;
-	f32 loading_percentage    =0;
+	u32 image_crc             =0;
+	u32 resume_offset         =0;
+	u32 manifest_crc          =0;
+	u16 number_of_chunks      =0;
+	u16 chunk_index           =0;
+	u16 chunk_refetches       =0;
+	u16 chunks_refetched      =0;
+	u8  write_status          =ADDR_VALID;
+	u8  retry;
+	u8  job                   =0;
+	/*All buffers are taken from the pools for the download only, one page buffer per flash job : the flash task writes
+	 * one page while the next one is fetched into the other*/
 	#define FLASH_RX_LEN					1024
-	u8	FLASH_src_buffer_1K[FLASH_RX_LEN]=  {0};
+	u32* page_buffer[BL_FLASH_JOBS];								/*Word aligned, they are fed to the CRC unit and to flash*/
 	#define WEB_RX_LEN						2048
-	u8	website_buffer[WEB_RX_LEN]=			{0};
+	u8*	website_buffer;
 	/*This variable will be used as the start byte for each buffer received from the internet, it starts at byte #1 and keeps increasing by the buffer
 	 * size during each loop*/
 	u16 Local_u16BufferStartByte=1;
@@ -730,12 +1026,49 @@ void bootloader_handle_mem_write_cmd			(u8* bl_rx_buffer)
 		for(index=0;index<4;index++)
 			Local_u8FinalAddress[index]=bl_rx_buffer[2+index];
 		destination_address = *((u32*)Local_u8FinalAddress);
+		/*CRC32 of the whole file, it identifies the download in the journal and is checked at the end*/
+		image_crc = *((u32*)&bl_rx_buffer[10]);
+		/*CRC32 of the chunk manifest published after the image*/
+		manifest_crc = *((u32*)&bl_rx_buffer[14]);
 
 		printmsg1("BL_DEBUG_MSG: destination address: 0x%02x%02x%02x%02x\r\n",Local_u8FinalAddress[3],Local_u8FinalAddress[2],Local_u8FinalAddress[1],Local_u8FinalAddress[0]);
-		 if( verify_address(destination_address) == ADDR_VALID )
+		 if( verify_flash_write_range(destination_address, Local_u32FileSize) == ADDR_VALID )
 		 {
-			 	FLASH_Unlock();
-			 	bytes_remaining = Local_u32FileSize;
+			 	website_buffer = POOL_pvAlloc(WEB_RX_LEN);
+			 	if(website_buffer==NULL) write_status = BL_MEM_WRITE_NO_BUFFER;
+			 	for(index=0;index<BL_FLASH_JOBS;index++)
+			 	{
+			 		page_buffer[index] = POOL_pvAlloc(FLASH_RX_LEN);
+			 		if(page_buffer[index]==NULL) write_status = BL_MEM_WRITE_NO_BUFFER;
+			 	}
+			 	for(index=0;index<BL_FLASH_JOBS;index++)
+			 		static_FlashJobs[index].state = BL_JOB_FREE;
+			 	static_u8NextFlashJob = 0;
+			 	/*Nothing is written without every buffer, so the journal of an interrupted download is left as it is*/
+			 	if(write_status==BL_MEM_WRITE_NO_BUFFER)
+			 	{
+			 		printmsg1("BL_DEBUG_MSG: No buffer left for the download\r\n");
+			 	}
+			 	else
+			 	{
+			 		FLASH_Unlock();
+			 		/*Skip the pages that were already written and verified by an interrupted download of the same image*/
+			 		if(JOURNAL_u8Start(destination_address, Local_u32FileSize, image_crc, &resume_offset)!=STATUS_OK)
+			 			printmsg1("BL_DEBUG_MSG: Download journal could not be written, download will not be resumable\r\n");
+			 		if(resume_offset)
+			 			printmsg1("BL_DEBUG_MSG: Resuming download from offset %d\r\n",resume_offset);
+			 	}
+			 	destination_address   += resume_offset;
+			 	bytes_received_so_far  = resume_offset;
+			 	/*Server data is fetched in windows of one page, the window after the last page holds the manifest*/
+			 	number_of_chunks = (Local_u32FileSize+BL_IMAGE_CHUNK_SIZE-1)/BL_IMAGE_CHUNK_SIZE;
+			 	if(write_status==ADDR_VALID &&
+			 	   bootloader_fetch_manifest(number_of_chunks, Local_u32FileSize, manifest_crc, website_buffer, &chunk_refetches)!=STATUS_OK)
+			 	{
+			 		printmsg1("BL_DEBUG_MSG: Chunk manifest does not match its CRC\r\n");
+			 		write_status = BL_MEM_WRITE_MANIFEST_FAIL;
+			 	}
+			 	bytes_remaining = (write_status==ADDR_VALID)? (Local_u32FileSize - bytes_received_so_far) : 0;
 			 	while(bytes_remaining)
 			 	{
 			 		GPIO_Pin_Write(&OnBoard_Led,LOW);
@@ -748,42 +1081,94 @@ void bootloader_handle_mem_write_cmd			(u8* bl_rx_buffer)
 			 			len_to_read=bytes_remaining;
 			 		}
 
+					/*The page fetched two pages ago must be in flash before its buffer takes this one*/
+					if(bootloader_flash_job_finish(job, 1, Local_u32FileSize)!=STATUS_OK)
+					{
+						write_status = BL_MEM_WRITE_VERIFY_FAIL;
+						GPIO_Pin_Write(&OnBoard_Led,HIGH);
+						break;
+					}
 					//FLASH_MultiplePageErase   			(u32 pageAddress, 8); //since the file's size is 7992 bytes and that's about 8KB
 					//for(index=0;index<64;index++)
 						//FLASH_src_buffer_1K[index]=bl_rx_buffer[11+index];
-			 		WIFI_u8ReceiveData(Local_u16BufferStartByte, Local_u32FileSize, website_buffer);
-			 		Local_u16BufferStartByte=+1024;
-			 		Global_u16IteratorForNumberOfTimesDataAreReceived++;
-					char2hex(website_buffer,FLASH_src_buffer_1K,1024);
-
-
-				    FLASH_PageErase		(destination_address);
-					FLASH_WriteProgram	((u32*)FLASH_src_buffer_1K, (u32*)destination_address, len_to_read);
+					/*Fetch the window of the first missing page, and fetch it again only while it does not match its manifest entry*/
+					chunk_index = bytes_received_so_far/BL_IMAGE_CHUNK_SIZE;
+					for(retry=0;retry<=BL_MEM_WRITE_CHUNK_RETRIES;retry++)
+					{
+						Global_u16IteratorForNumberOfTimesDataAreReceived = chunk_index;
+						WIFI_u8ReceiveData(Local_u16BufferStartByte, Local_u32FileSize, website_buffer);
+						/*A window holding chars that are not hex was cut or garbled on the way, it is fetched again like a CRC mismatch*/
+						if((bootloader_decode_hex(website_buffer,(u8*)page_buffer[job],len_to_read)==STATUS_OK) &&
+						   (bootloader_crc32_words((u32)page_buffer[job], len_to_read)==static_u32ChunkManifest[chunk_index])) break;
+						chunk_refetches++;
+						TRACE_voidRecord(TRACE_EVENT_CHUNK_REFETCH, TRACE_PHASE_INSTANT, chunk_index);
+						STATS_voidCount(STATS_CRC_FAILURES, 1);
+						STATS_voidCount(STATS_FETCH_RETRIES, 1);
+					}
+					if(retry) chunks_refetched++;
+					if(retry>BL_MEM_WRITE_CHUNK_RETRIES)
+					{
+						printmsg1("\r\nBL_DEBUG_MSG: Chunk %d kept failing its CRC\r\n",chunk_index);
+						write_status = BL_MEM_WRITE_CHUNK_FAIL;
+						GPIO_Pin_Write(&OnBoard_Led,HIGH);
+						break;
+					}
+
+					/*The flash task writes the page and reads it back while the next one is fetched, the page only counts as
+					 * done (in the journal) when flash holds what was received*/
+					bootloader_flash_job_queue(job, page_buffer[job], destination_address, len_to_read, bytes_received_so_far+len_to_read);
 
 					/**************************** Updating variables for the next loop ****************************/
 					//update base mem address for the next loop
 					destination_address 	+= len_to_read;
 					bytes_received_so_far 	+= len_to_read;
 					bytes_remaining			 = Local_u32FileSize - bytes_received_so_far;
-					loading_percentage       = ((f32)bytes_received_so_far/(f32)Local_u32FileSize)*100;
-					printmsg1("\rFlashing : %.f %% \tdone  ",loading_percentage);
+					job                      = (job+1)%BL_FLASH_JOBS;
 					GPIO_Pin_Write(&OnBoard_Led,HIGH);
 			 	}
+			 	/*Pages still queued are written in order, after a failure they are written but not committed to the journal*/
+			 	for(index=0;index<BL_FLASH_JOBS;index++)
+			 	{
+			 		if(bootloader_flash_job_finish(job, (write_status==ADDR_VALID), Local_u32FileSize)!=STATUS_OK &&
+			 		   write_status==ADDR_VALID)
+			 			write_status = BL_MEM_WRITE_VERIFY_FAIL;
+			 		job = (job+1)%BL_FLASH_JOBS;
+			 	}
 			 	/*Reset iterators*/
-		 		Local_u16BufferStartByte=+1024;
-		 		Global_u16IteratorForNumberOfTimesDataAreReceived++;
+		 		Global_u16IteratorForNumberOfTimesDataAreReceived=0;
+
+				/*Whole image is in flash, check it against the CRC of the file then forget the journal*/
+				if(write_status==ADDR_VALID)
+				{
+					if(bootloader_crc32_words(destination_address-Local_u32FileSize, Local_u32FileSize)!=image_crc)
+					{
+						printmsg1("\r\nBL_DEBUG_MSG: Image CRC mismatch\r\n");
+						STATS_voidCount(STATS_CRC_FAILURES, 1);
+						write_status = BL_MEM_WRITE_IMAGE_CRC_FAIL;
+					}
+					else
+					{
+						/*The record of this address must describe the new image, or boot refuses it*/
+						APPINFO_u8UpdateImage(destination_address-Local_u32FileSize, Local_u32FileSize, image_crc);
+					}
+					JOURNAL_u8Clear();
+				}
 
 			 	FLASH_Lock();
-				//Stating that a reply of one byte is going to be sent
-				bootloader_send_ack(1);
+			 	for(index=0;index<BL_FLASH_JOBS;index++)
+			 		POOL_voidFree(page_buffer[index]);
+			 	POOL_voidFree(website_buffer);
+				//Stating that a reply of 9 bytes is going to be sent
+				bootloader_send_ack(9);
 				//tell host that address is fine
 				/******************************Modifications by Mahmoud For WIFI***********************/
-				/*Write reply bytes after the first two bytes of ack*/
-				Global_u8ResponseArray[2]=	addr_valid;
-				/*Convert array to char to send them over WIFI*/
-				hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_FLASH_ERASE_REPLY_LEN);
-				/*Send converted Bytes over WIFI*/
-				WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_FLASH_ERASE_REPLY_LEN*2);
+				/*Append reply bytes after the ack*/
+				WIFI_voidReplyAppendU8(write_status);
+				WIFI_voidReplyAppendU32(resume_offset);
+				WIFI_voidReplyAppendU16(chunk_refetches);
+				WIFI_voidReplyAppendU16(chunks_refetched);
+				/*Send the reply over WIFI*/
+				WIFI_u8ReplySend();
 				//HUART_u8SendSync(HUART_USART2,&addr_valid,1,10);
 		 }
 		 else
@@ -791,12 +1176,10 @@ void bootloader_handle_mem_write_cmd			(u8* bl_rx_buffer)
 			printmsg1("BL_DEBUG_MSG:GO addr invalid ! \n");
 			//tell host that address is invalid
 			/******************************Modifications by Mahmoud For WIFI***********************/
-			/*Write reply bytes after the first two bytes of ack*/
-    		Global_u8ResponseArray[2]=	addr_invalid;
-    		/*Convert array to char to send them over WIFI*/
-    		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_GO_TO_ADDR_REPLY_LEN);
-    		/*Send converted Bytes over WIFI*/
-    		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_GO_TO_ADDR_REPLY_LEN*2);
+			/*Append reply bytes after the ack*/
+    		WIFI_voidReplyAppendU8(addr_invalid);
+    		/*Send the reply over WIFI*/
+    		WIFI_u8ReplySend();
 			//HUART_u8SendSync(HUART_USART2,&addr_invalid,1,10);
 		}
 
@@ -810,25 +1193,317 @@ void bootloader_handle_mem_write_cmd			(u8* bl_rx_buffer)
 
 }
 
-/*Handle function to handle BL_MEM_READ command*/
+/*Waits for the page of a multicast job to be written, the chunk it held is missing again if it did not read back as written*/
+static void bootloader_mcast_job_finish(u8 job, u16* job_chunk, u32 file_size)
+{
+	if(bootloader_flash_job_finish(job, 0, file_size)!=STATUS_OK && job_chunk[job]!=BL_MCAST_NO_CHUNK)
+		static_u8MissingChunks[job_chunk[job]/8] |= (u8)(1<<(job_chunk[job]%8));
+	job_chunk[job] = BL_MCAST_NO_CHUNK;
+}
+
+/*Handle function to handle BL_MEM_MULTICAST command
+ * Host sends: base address (4 bytes), file size (4 bytes), CRC32 of the file (4 bytes), then the image on the UDP link
+ * Every chunk whose parts all came and match the chunk CRC is written, the others stay missing and are sent again by the host
+ * after it read the bitmaps of all the boards (repair rounds). The host ends the download with 'E'
+ * Bootloader replies: status (as BL_MEM_WRITE), chunks missing (2 bytes), datagrams taken (2 bytes), datagrams dropped (2 bytes)*/
+void bootloader_handle_mem_multicast_cmd		(u8* bl_rx_buffer)
+{
+	u8  addr_invalid = ADDR_INVALID;
+
+	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
+	u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
+	u32 crc_host = *((u32*)(bl_rx_buffer+command_length_without_crc));
+	u32 base_address;
+	u32 file_size;
+	u32 image_crc;
+	u32 chunk_crc;
+	u32 assembling_crc    =0;
+	u16 session;
+	u16 number_of_chunks;
+	u16 chunk;
+	u16 chunk_len;
+	u16 part_len;
+	u16 length;
+	u16 assembling        =BL_MCAST_NO_CHUNK;					/*Chunk whose parts are being put together*/
+	u16 job_chunk[BL_FLASH_JOBS];								/*Chunk held by the page buffer of every flash job*/
+	u16 chunks_missing    =0;
+	u16 datagrams_taken   =0;
+	u16 datagrams_dropped =0;
+	u8  header[9];
+	u8  parts_in          =0;									/*One bit per part of the chunk being put together*/
+	u8  parts;
+	u8  part;
+	u8  write_status      =ADDR_VALID;
+	u8  done              =0;
+	u8  index;
+	u8  job               =0;
+	u32* page_buffer[BL_FLASH_JOBS];
+	u8*  datagram;
+
+	printmsg1("------------------------------------------------\r\nBL_DEBUG_MSG: bootloader_handle_mem_multicast_cmd \r\n");
+	if(bootloader_verify_crc(bl_rx_buffer, command_length_without_crc, crc_host))
+	{
+		printmsg1("BL_DEBUG_MSG: checksum fail !! \r\n");
+		bootloader_send_nack();
+		return;
+	}
+	printmsg1("BL_DEBUG_MSG: checksum success !! \r\n");
+	base_address = *((u32*)&bl_rx_buffer[2]);
+	file_size    = *((u32*)&bl_rx_buffer[6]);
+	image_crc    = *((u32*)&bl_rx_buffer[10]);
+	if(verify_flash_write_range(base_address, file_size) != ADDR_VALID)
+	{
+		printmsg1("BL_DEBUG_MSG: address invalid ! \n");
+		bootloader_send_ack(1);
+		WIFI_voidReplyAppendU8(addr_invalid);
+		WIFI_u8ReplySend();
+		return;
+	}
+
+	datagram = POOL_pvAlloc(WIFI_RECEIVE_ARRAY_SIZE);
+	if(datagram==NULL) write_status = BL_MEM_WRITE_NO_BUFFER;
+	for(index=0;index<BL_FLASH_JOBS;index++)
+	{
+		page_buffer[index] = POOL_pvAlloc(BL_IMAGE_CHUNK_SIZE);
+		if(page_buffer[index]==NULL) write_status = BL_MEM_WRITE_NO_BUFFER;
+		static_FlashJobs[index].state = BL_JOB_FREE;
+		job_chunk[index] = BL_MCAST_NO_CHUNK;
+	}
+	static_u8NextFlashJob = 0;
+	session          = (u16)image_crc;
+	number_of_chunks = (file_size+BL_IMAGE_CHUNK_SIZE-1)/BL_IMAGE_CHUNK_SIZE;
+	memset(static_u8MissingChunks, 0, sizeof(static_u8MissingChunks));
+	for(chunk=0;chunk<number_of_chunks;chunk++)
+		static_u8MissingChunks[chunk/8] |= (u8)(1<<(chunk%8));
+
+	if(write_status==ADDR_VALID && WIFI_u8McastOpen()!=STATUS_OK)
+	{
+		printmsg1("BL_DEBUG_MSG: UDP link could not be opened\r\n");
+		write_status = BL_MEM_WRITE_NO_LINK;
+	}
+	if(write_status==ADDR_VALID)
+	{
+		FLASH_Unlock();
+		/*The pages are written in any order, the journal of an interrupted download in order does not hold anymore
+		 * (it is kept when the download stops before writing anything)*/
+		JOURNAL_u8Clear();
+	}
+
+	while(write_status==ADDR_VALID && !done)
+	{
+		/*Pages are written while the host pauses after every chunk, the chars that come meanwhile are lost*/
+		length = WIFI_u16McastReceive(datagram, WIFI_RECEIVE_ARRAY_SIZE, BL_MCAST_IDLE_TIMEOUT_MS);
+		if(length==0)
+		{
+			printmsg1("\r\nBL_DEBUG_MSG: No datagram for %d ms, the host is gone\r\n",BL_MCAST_IDLE_TIMEOUT_MS);
+			break;
+		}
+		if(length<BL_MCAST_SESSION_LEN || bootloader_decode_hex(&datagram[1], header, 2)!=STATUS_OK ||
+		   (u16)((header[0]<<8)|header[1])!=session)
+		{
+			datagrams_dropped++;
+			continue;
+		}
+		switch(datagram[0])
+		{
+		case BL_MCAST_DATA:
+			if(length<BL_MCAST_DATA_HEADER_LEN || bootloader_decode_hex(&datagram[1], header, 9)!=STATUS_OK)
+			{
+				datagrams_dropped++;
+				break;
+			}
+			chunk     = (header[2]<<8)|header[3];
+			part      = header[4];
+			chunk_crc = ((u32)header[5]<<24)|((u32)header[6]<<16)|((u32)header[7]<<8)|header[8];
+			chunk_len = (chunk<number_of_chunks-1)? BL_IMAGE_CHUNK_SIZE : (file_size-(u32)chunk*BL_IMAGE_CHUNK_SIZE);
+			parts     = (chunk_len+BL_MCAST_PART_SIZE-1)/BL_MCAST_PART_SIZE;
+			/*Only the last part of the last chunk can be shorter*/
+			part_len  = ((u32)(part+1)*BL_MCAST_PART_SIZE<=chunk_len)? BL_MCAST_PART_SIZE : (u16)(chunk_len-(u32)part*BL_MCAST_PART_SIZE);
+			/*Chars lost on the way make the datagram shorter than its part*/
+			if(chunk>=number_of_chunks || part>=parts || length!=BL_MCAST_DATA_HEADER_LEN+2*part_len)
+			{
+				datagrams_dropped++;
+				break;
+			}
+			/*Parts of chunks already written come again in the repair rounds of the other boards*/
+			if(!(static_u8MissingChunks[chunk/8] & (1<<(chunk%8)))) break;
+			if(chunk!=assembling)
+			{
+				/*A chunk left with parts missing is sent again in the next repair round*/
+				bootloader_mcast_job_finish(job, job_chunk, file_size);
+				assembling = chunk;
+				parts_in   = 0;
+				assembling_crc = chunk_crc;
+			}
+			if(chunk_crc!=assembling_crc ||
+			   bootloader_decode_hex(&datagram[BL_MCAST_DATA_HEADER_LEN], (u8*)page_buffer[job]+part*BL_MCAST_PART_SIZE, part_len)!=STATUS_OK)
+			{
+				datagrams_dropped++;
+				break;
+			}
+			datagrams_taken++;
+			parts_in |= (u8)(1<<part);
+			if(parts_in != (u8)((1<<parts)-1)) break;
+			assembling = BL_MCAST_NO_CHUNK;
+			if(bootloader_crc32_words((u32)page_buffer[job], chunk_len)!=chunk_crc)
+			{
+				TRACE_voidRecord(TRACE_EVENT_CHUNK_REFETCH, TRACE_PHASE_INSTANT, chunk);
+				STATS_voidCount(STATS_CRC_FAILURES, 1);
+				break;
+			}
+			/*Written by the flash task while the host pauses, the chunk is missing again if the page does not read back*/
+			static_u8MissingChunks[chunk/8] &= (u8)~(1<<(chunk%8));
+			job_chunk[job] = chunk;
+			bootloader_flash_job_queue(job, page_buffer[job], base_address+(u32)chunk*BL_IMAGE_CHUNK_SIZE, chunk_len, 0);
+			job = (job+1)%BL_FLASH_JOBS;
+			break;
+
+		case BL_MCAST_QUERY:
+			/*The bitmap tells the pages that are in flash, the queued ones are written first*/
+			for(index=0;index<BL_FLASH_JOBS;index++)
+				bootloader_mcast_job_finish((job+index)%BL_FLASH_JOBS, job_chunk, file_size);
+			assembling = BL_MCAST_NO_CHUNK;
+			if(length<BL_MCAST_SESSION_LEN+2 || bootloader_decode_hex(&datagram[BL_MCAST_SESSION_LEN], &header[2], 1)!=STATUS_OK)
+			{
+				datagrams_dropped++;
+				break;
+			}
+			header[3] = (u8)(number_of_chunks>>8);
+			header[4] = (u8)number_of_chunks;
+			datagram[0] = BL_MCAST_BITMAP;
+			HEX_voidEncode(&header[2], &datagram[BL_MCAST_SESSION_LEN], 1);
+			HEX_voidEncode((u8*)BL_MCAST_UID_ADDRESS, &datagram[BL_MCAST_SESSION_LEN+2], BL_MCAST_UID_LEN);
+			HEX_voidEncode(&header[3], &datagram[BL_MCAST_SESSION_LEN+2+2*BL_MCAST_UID_LEN], 2);
+			HEX_voidEncode(static_u8MissingChunks, &datagram[BL_MCAST_SESSION_LEN+6+2*BL_MCAST_UID_LEN], (number_of_chunks+7)/8);
+			WIFI_u8McastSend(datagram, BL_MCAST_SESSION_LEN+6+2*BL_MCAST_UID_LEN+2*((number_of_chunks+7)/8));
+			break;
+
+		case BL_MCAST_END:
+			done = 1;
+			break;
+
+		default:
+			datagrams_dropped++;
+			break;
+		}
+	}
+	for(index=0;index<BL_FLASH_JOBS;index++)
+		bootloader_mcast_job_finish((job+index)%BL_FLASH_JOBS, job_chunk, file_size);
+	if(write_status!=BL_MEM_WRITE_NO_LINK) WIFI_voidMcastClose();
+
+	for(chunk=0;chunk<number_of_chunks;chunk++)
+		if(static_u8MissingChunks[chunk/8] & (1<<(chunk%8))) chunks_missing++;
+	if(write_status==ADDR_VALID)
+	{
+		if(chunks_missing)
+		{
+			printmsg1("\r\nBL_DEBUG_MSG: %d chunks missing at the end of the download\r\n",chunks_missing);
+			write_status = BL_MEM_WRITE_CHUNK_FAIL;
+		}
+		else if(bootloader_crc32_words(base_address, file_size)!=image_crc)
+		{
+			printmsg1("\r\nBL_DEBUG_MSG: Image CRC mismatch\r\n");
+			STATS_voidCount(STATS_CRC_FAILURES, 1);
+			write_status = BL_MEM_WRITE_IMAGE_CRC_FAIL;
+		}
+		else
+		{
+			APPINFO_u8UpdateImage(base_address, file_size, image_crc);
+		}
+	}
+	printmsg1("\r\nBL_DEBUG_MSG: Multicast download done, %d datagrams taken, %d dropped\r\n",datagrams_taken,datagrams_dropped);
+
+	FLASH_Lock();
+	for(index=0;index<BL_FLASH_JOBS;index++)
+		POOL_voidFree(page_buffer[index]);
+	POOL_voidFree(datagram);
+	bootloader_send_ack(BL_MEM_MULTICAST_REPLY_LEN-BL_ACK_LEN);
+	WIFI_voidReplyAppendU8(write_status);
+	WIFI_voidReplyAppendU16(chunks_missing);
+	WIFI_voidReplyAppendU16(datagrams_taken);
+	WIFI_voidReplyAppendU16(datagrams_dropped);
+	WIFI_u8ReplySend();
+}
+
+/*Handle function to handle BL_MEM_READ command
+ * Host sends: start address (4 bytes), number of bytes (4 bytes), encoding (1 byte)
+ * Bootloader streams the range back as consecutive replies, each reply holds:
+ * offset from start address (4 bytes), number of memory bytes in this chunk (2 bytes), encoding (1 byte), payload*/
 void bootloader_handle_mem_read_cmd				(u8* bl_rx_buffer)
 {
+	u8  addr_invalid = ADDR_INVALID;
+
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
 	u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
 	u32 crc_host;
+
+	u32 start_address    =0;
+	u32 len_to_read      =0;
+	u32 bytes_sent_so_far=0;
+	u32 chunk_len        =0;								/*Number of memory bytes carried by the current reply*/
+	u16 payload_len      =0;								/*Number of bytes in the current reply after encoding*/
+	u8  encoding         =BL_MEM_READ_ENCODING_RAW;
+
 	crc_host= *((u32*)(bl_rx_buffer+command_packet-4));          /*Extract the CRC32 sent by host*/
 
-	printmsg1("BL_DEBUG_MSG: bootloader_handle_mem_read_cmd \r\n");
+	printmsg1("------------------------------------------------\r\nBL_DEBUG_MSG: bootloader_handle_mem_read_cmd \r\n");
 	// 1) verify the checksum
 	if(! bootloader_verify_crc(bl_rx_buffer, command_length_without_crc, crc_host))
 	{
 		//checksum is correct
 		printmsg1("BL_DEBUG_MSG: checksum success !! \r\n");
-		//Stating that a reply of one byte is going to be sent
-		bootloader_send_ack(1);
-		//processing
 
+		start_address = *((u32*)&bl_rx_buffer[2]);
+		len_to_read   = *((u32*)&bl_rx_buffer[6]);
+		encoding      = bl_rx_buffer[10];
+		printmsg1("BL_DEBUG_MSG: reading %d bytes from %#x\r\n",len_to_read,start_address);
+
+		/*Both ends of the range must be inside the same memory*/
+		if( (len_to_read==0) || (encoding>BL_MEM_READ_ENCODING_FF_RUNS) ||
+			(verify_address(start_address)!=ADDR_VALID) || (verify_address(start_address+len_to_read-1)!=ADDR_VALID) ||
+			((start_address>=RAM_START) != ((start_address+len_to_read-1)>=RAM_START)) )
+		{
+			printmsg1("BL_DEBUG_MSG: read range invalid ! \r\n");
+			bootloader_send_ack(1);
+			WIFI_voidReplyAppendU8(addr_invalid);
+			WIFI_u8ReplySend();
+			return;
+		}
+
+		while(bytes_sent_so_far < len_to_read)
+		{
+			GPIO_Pin_Write(&OnBoard_Led,LOW);
+			/*Fill the payload straight from memory after the ack and chunk header*/
+			if(encoding==BL_MEM_READ_ENCODING_FF_RUNS)
+			{
+				payload_len = bootloader_encode_ff_runs((u8*)(start_address+bytes_sent_so_far), len_to_read-bytes_sent_so_far,
+														static_u8EncodedChunk, BL_MEM_READ_MAX_PAYLOAD, &chunk_len);
+			}
+			else
+			{
+				chunk_len = len_to_read-bytes_sent_so_far;
+				if(chunk_len > BL_MEM_READ_MAX_PAYLOAD) chunk_len = BL_MEM_READ_MAX_PAYLOAD;
+				payload_len = chunk_len;
+			}
 
+			bootloader_send_ack(BL_MEM_READ_HEADER_LEN+payload_len);
+			WIFI_voidReplyAppendU32(bytes_sent_so_far);
+			WIFI_voidReplyAppendU16((u16)chunk_len);
+			WIFI_voidReplyAppendU8(encoding);
+			/*Raw payload is encoded straight from the memory being read, runs were packed in the scratch buffer*/
+			if(encoding==BL_MEM_READ_ENCODING_FF_RUNS)
+				WIFI_voidReplyAppendBytes(static_u8EncodedChunk, payload_len);
+			else
+				WIFI_voidReplyAppendBytes((u8*)(start_address+bytes_sent_so_far), payload_len);
+			/*Send the reply over WIFI*/
+			WIFI_u8ReplySend();
+
+			bytes_sent_so_far += chunk_len;
+			printmsg1("\rReading : %d of %d bytes sent  ",bytes_sent_so_far,len_to_read);
+			GPIO_Pin_Write(&OnBoard_Led,HIGH);
+			/*Give the host time to fetch this chunk before it is overwritten by the next one*/
+			if(bytes_sent_so_far < len_to_read) SCHED_voidSleep(BL_MEM_READ_STREAM_DELAY_MS);
+		}
 	}
 	else
 	{
@@ -840,7 +1515,6 @@ void bootloader_handle_mem_read_cmd				(u8* bl_rx_buffer)
 
 void bootloader_handle_en_read_protect_cmd		(u8* bl_rx_buffer)
 {
-	u8  Local_u8FinalReply[BL_EN_R_PROTECT_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 	//u8  Local_u8FinalHostCRC[4];
 
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
@@ -861,10 +1535,8 @@ void bootloader_handle_en_read_protect_cmd		(u8* bl_rx_buffer)
 		//processing
 		//Stating that a reply of zero bytes is going to be sent
 		bootloader_send_ack(0);
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_EN_R_PROTECT_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_EN_R_PROTECT_REPLY_LEN*2);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
 		FLASH_OPT_Unlock();
 		FLASH_OPT_ReadProtection_Enable();
@@ -879,7 +1551,6 @@ void bootloader_handle_en_read_protect_cmd		(u8* bl_rx_buffer)
 
 void bootloader_handle_dis_read_protect_cmd		(u8* bl_rx_buffer)
 {
-	u8  Local_u8FinalReply[BL_DIS_R_PROTECT_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 	//u8  Local_u8FinalHostCRC[4];
 
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
@@ -901,10 +1572,8 @@ void bootloader_handle_dis_read_protect_cmd		(u8* bl_rx_buffer)
 		//processing
 		//Stating that a reply of zero bytes is going to be sent
 		bootloader_send_ack(0);
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_DIS_R_PROTECT_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_DIS_R_PROTECT_REPLY_LEN*2);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
 		FLASH_OPT_Unlock();
 		FLASH_OPT_ReadProtection_Disable();
@@ -920,7 +1589,6 @@ void bootloader_handle_dis_read_protect_cmd		(u8* bl_rx_buffer)
 void bootloader_handle_en_write_protect_cmd		(u8* bl_rx_buffer)
 {
 	u8  index;
-	u8  Local_u8FinalReply[BL_EN_W_PROTECT_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 	//u8  Local_u8FinalHostCRC[4];
 	u8  Local_u8FinalWRProt_mask[4];
 	u32 WRProt_mask = 0;
@@ -952,10 +1620,8 @@ void bootloader_handle_en_write_protect_cmd		(u8* bl_rx_buffer)
 
 		//Stating that a reply of zero bytes is going to be sent
 		bootloader_send_ack(0);
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_EN_W_PROTECT_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_EN_W_PROTECT_REPLY_LEN*2);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
 	}
 	else
@@ -969,7 +1635,6 @@ void bootloader_handle_en_write_protect_cmd		(u8* bl_rx_buffer)
 void bootloader_handle_dis_write_protect_cmd	(u8* bl_rx_buffer)
 {
 	u8  index;
-	u8  Local_u8FinalReply[BL_DIS_W_PROTECT_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 	//u8  Local_u8FinalHostCRC[4];
 	u8  Local_u8FinalWRProt_mask[4];
 	u32 WRProt_mask = 0;
@@ -1001,10 +1666,8 @@ void bootloader_handle_dis_write_protect_cmd	(u8* bl_rx_buffer)
 
 		//Stating that a reply of zero bytes is going to be sent
 		bootloader_send_ack(0);
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_DIS_W_PROTECT_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_DIS_W_PROTECT_REPLY_LEN*2);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
 	}
 	else
@@ -1018,7 +1681,6 @@ void bootloader_handle_dis_write_protect_cmd	(u8* bl_rx_buffer)
 /*Handle function to handle BL_GET_RDP_STATUS command*/
 void bootloader_handle_getrdp_cmd				(u8* bl_rx_buffer)
 {
-	u8  Local_u8FinalReply[BL_GET_RDP_STATUS_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 
 	u8  RDP_status;
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
@@ -1036,13 +1698,11 @@ void bootloader_handle_getrdp_cmd				(u8* bl_rx_buffer)
 		bootloader_send_ack(1);
 		//processing
 		RDP_status = FLASH_OPT_GetRDPStatus();
-		/*Write reply bytes after the first two bytes of ack*/
+		/*Append reply bytes after the ack*/
 
-		Global_u8ResponseArray[2]=	RDP_status;
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_GET_RDP_STATUS_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_GET_RDP_STATUS_REPLY_LEN*2);
+		WIFI_voidReplyAppendU8(RDP_status);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
 		//HUART_u8SendSync(HUART_USART2,&RDP_status,1,10);
 
@@ -1058,7 +1718,6 @@ void bootloader_handle_getrdp_cmd				(u8* bl_rx_buffer)
 /*Handle function to handle BL_READ_SECTOR_STATUS command*/
 void bootloader_handle_read_sectors_status_cmd	(u8* bl_rx_buffer)
 {
-	u8  Local_u8FinalReply[BL_PROTECTION_STATUS_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 
 	#define REPLY_LEN 10
 	u8  RDP_status;
@@ -1090,16 +1749,12 @@ void bootloader_handle_read_sectors_status_cmd	(u8* bl_rx_buffer)
 		bootloader_send_ack(REPLY_LEN);
 
 		/******************************Modifications by Mahmoud For WIFI***********************/
-		/*Convert 2 ack bytes to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, &Local_u8FinalReply[0], 2);
-		/*Write reply bytes after the first two bytes of ack*/
-		/*Convert RDP byte to char to send them over WIFI*/
-		hex2char(&RDP_status           , &Local_u8FinalReply[4], 1);
-		/*Convert WRP 4 bytes to char to send them over WIFI*/
-		hex2char((u8*)&WRP_status      , &Local_u8FinalReply[6], 4);
+		/*Append RDP byte and WRP 4 bytes after the ack*/
+		WIFI_voidReplyAppendU8(RDP_status);
+		WIFI_voidReplyAppendU32(WRP_status);
 
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_PROTECTION_STATUS_REPLY_LEN*2);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
 		//HUART_u8SendSync(HUART_USART2,Local_u8Tx_buffer,REPLY_LEN,10);
 	}
@@ -1113,7 +1768,6 @@ void bootloader_handle_read_sectors_status_cmd	(u8* bl_rx_buffer)
 
 void bootloader_handle_system_reset_cmd			(u8* bl_rx_buffer)
 {
-	u8  Local_u8FinalReply[BL_SYSTEM_RESET_REPLY_LEN*2]={0};		/*This local variable will hold the array that will be send over WIFI*/
 	//u8  Local_u8FinalHostCRC[4];
 
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
@@ -1134,11 +1788,10 @@ void bootloader_handle_system_reset_cmd			(u8* bl_rx_buffer)
 		//processing
 		//Stating that a reply of zero bytes is going to be sent
 		bootloader_send_ack(0);
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_SYSTEM_RESET_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_SYSTEM_RESET_REPLY_LEN*2);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
+		flushmsg1();
 		FLASH_SystemReset();
 	}
 	else
@@ -1152,11 +1805,10 @@ void bootloader_handle_system_reset_cmd			(u8* bl_rx_buffer)
 
 void bootloader_handle_existing_apps_cmd		(u8* bl_rx_buffer)
 {
-	u8  Local_u8FinalReply[512]={0};		/*This local variable will hold the array that will be send over WIFI*/
 
-	u8  i,j;
-	//u32 application_info_block_start_address = FLASH_MEMORY_PAGE_19;
-	u8  number_of_apps = *((u8*)FLASH_MEMORY_PAGE_22);
+	u8  i;
+	u8  number_of_apps = 0;
+	APPINFO_Record_t app_record;
 	//u8  Local_u8FinalHostCRC[4];
 
 	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
@@ -1177,47 +1829,17 @@ void bootloader_handle_existing_apps_cmd		(u8* bl_rx_buffer)
 		//processing
 
 		//Stating that a reply of zero bytes is going to be sent
-		number_of_apps = *((u8*)FLASH_MEMORY_PAGE_22);
-		if(number_of_apps==0xFF)number_of_apps =0;
-		bootloader_send_ack(number_of_apps*16);
+		number_of_apps = APPINFO_u8GetNumberOfApps();
+		bootloader_send_ack(number_of_apps*APPINFO_PUBLIC_RECORD_SIZE);
 		for(i=0;i<number_of_apps;i++)
 		{
-			for(j=0;j<16;j++)
-			{
-				Global_u8ResponseArray [2+(i*16)+j] = *((u8*)(FLASH_MEMORY_PAGE_22+16+(i*16))+j);
-			}
-//			Global_u8ResponseArray[i+2]= *((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16))       );//sending app base memory address
-//			Global_u8ResponseArray[i+3]= *((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)))>>8    ;//sending app base memory address
-//			Global_u8ResponseArray[i+4]= *((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)))>>16   ;//sending app base memory address
-//			Global_u8ResponseArray[i+5]= *((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)))>>24   ;//sending app base memory address
-//
-//
-//			Global_u8ResponseArray[i+6]= *((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+4)      );//sending app size in bytes
-//			Global_u8ResponseArray[i+7]= *((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+4))>>8   ;//sending app size in bytes
-//			Global_u8ResponseArray[i+8]= *((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+4))>>16  ;//sending app size in bytes
-//			Global_u8ResponseArray[i+9]= *((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+4))>>24  ;//sending app size in bytes
-//
-//
-//			Global_u8ResponseArray[i+10]=*((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+8)      );//sending app name
-//			Global_u8ResponseArray[i+11]=*((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+8))>>8  ;//sending app name
-//			Global_u8ResponseArray[i+12]=*((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+8))>>16 ;//sending app name
-//			Global_u8ResponseArray[i+13]=*((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+8))>>24 ;//sending app name
-//			Global_u8ResponseArray[i+14]=(u8)(*((u32*)FLASH_MEMORY_PAGE_22+16+(i*16)+12))      ;//sending app name
-//			Global_u8ResponseArray[i+15]=*((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+12))>>8 ;//sending app name
-//			Global_u8ResponseArray[i+16]=*((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+12))>>16;//sending app name
-//			Global_u8ResponseArray[i+17]=*((u32*)(FLASH_MEMORY_PAGE_22+16+(i*16)+12))>>24;//sending app name
-
-//			HUART_u8SendSync(HUART_USART2,(u8*)(FLASH_MEMORY_PAGE_19+16+(i*16))  ,4,10);//sending app base memory address
-//			HUART_u8SendSync(HUART_USART2,(u8*)(FLASH_MEMORY_PAGE_19+16+(i*16)+4),4,10);//sending app size in bytes
-//			HUART_u8SendSync(HUART_USART2,(u8*)(FLASH_MEMORY_PAGE_19+16+(i*16)+8),8,10);//sending app name
+			/*Newest record of every app is looked up through the RAM index, no flash scan here*/
+			if(APPINFO_u8GetRecord(i,&app_record)!=STATUS_OK)memset(&app_record,0xFF,sizeof(app_record));
+			/*base address, size in bytes and name are contiguous inside the record*/
+			WIFI_voidReplyAppendBytes((u8*)&app_record.baseAddress,APPINFO_PUBLIC_RECORD_SIZE);
 		}
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_EXISTING_APPS_REPLY_LEN(number_of_apps));
-		//hex2char(Global_u8ResponseArray, Local_u8FinalReply, 2);
-		//for(i=0;i<(16*number_of_apps);i++)Local_u8FinalReply [4+i] = Global_u8ResponseArray [2+i];
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_EXISTING_APPS_REPLY_LEN(number_of_apps)*2);
-		//WIFI_u8SendCommandToServer(Local_u8FinalReply, (4+(16*number_of_apps)));
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 
 
 	}
@@ -1236,12 +1858,15 @@ void bootloader_handle_save_app_info_cmd		(u8* buff)
 	u8  status  =0;
 
 	u8  number_of_apps = 0;
+	u8  slot;
 	u32 app_base_address=0;
+	APPINFO_Record_t previous_record;
 //	u8  Local_u8FinalAppBaseAddress[4]={0};
 //	u8  Local_u8FinalAppSizeInBytes[4]={0};
 
 	u32 app_size_in_bytes=0;
 	u8  app_name[8]={0};
+	u32 app_image_crc=APPINFO_NO_IMAGE_CRC;
 //	u8  Local_u8FinalHostCRC[4];
 
 	u8  command_packet = 22;                 /*Total length of command packet*/
@@ -1252,11 +1877,10 @@ void bootloader_handle_save_app_info_cmd		(u8* buff)
 	/*This variable will be used as iterator for filling the buffer*/
 	u8 Local_u8Iterator=0;
 	/*This local variable will hold the command that will be sent over wifi*/
-	u8 Local_u8FinalReply[6]={0};
 
 
 	/*We will need to convert everything in the buffer except for the name because it is already in the right format*/
-	char2hex(buff, Local_u8ConversionBuffer, 10);
+	HEX_u8Decode(buff, Local_u8ConversionBuffer, 10);
 	Local_u8ConversionBuffer[10]=buff[20];
 	Local_u8ConversionBuffer[11]=buff[21];
 	Local_u8ConversionBuffer[12]=buff[22];
@@ -1265,7 +1889,7 @@ void bootloader_handle_save_app_info_cmd		(u8* buff)
 	Local_u8ConversionBuffer[15]=buff[25];
 	Local_u8ConversionBuffer[16]=buff[26];
 	Local_u8ConversionBuffer[17]=buff[27];
-	char2hex(&buff[28],&Local_u8ConversionBuffer[18],4);
+	HEX_u8Decode(&buff[28],&Local_u8ConversionBuffer[18],4);
 
 
 	//char2hex(&buff[command_length_without_crc], Local_u8FinalHostCRC, 4);
@@ -1281,41 +1905,33 @@ void bootloader_handle_save_app_info_cmd		(u8* buff)
 		//checksum is correct
 		printmsg1("BL_DEBUG_MSG: checksum success !! \r\n");
 		//processing
-		number_of_apps = *((u8*)FLASH_MEMORY_PAGE_22);
-		if(number_of_apps==0xFF)number_of_apps =0;
-		number_of_apps++;
-		//char2hex(&buff[2], Local_u8FinalAppBaseAddress ,4);
-		//char2hex(&buff[10],Local_u8FinalAppSizeInBytes ,4);
-		//app_base_address =*((u32*)Local_u8FinalAppBaseAddress);
-		//app_size_in_bytes=*((u32*)Local_u8FinalAppSizeInBytes);
 		app_base_address =*((u32*)&Local_u8ConversionBuffer[2]);
 		app_size_in_bytes=*((u32*)&Local_u8ConversionBuffer[6]);
+		/*An image saved again at the same base address supersedes its record, only a new address takes a new slot*/
+		if(APPINFO_u8FindByBaseAddress(app_base_address, &previous_record) == STATUS_OK) slot = (u8)previous_record.slot;
+		else                                                                              slot = APPINFO_u8GetNumberOfApps();
+		number_of_apps = (slot < APPINFO_u8GetNumberOfApps())? APPINFO_u8GetNumberOfApps() : slot+1;
 
 		for(index=0;index<8;index++)
 			app_name[index]=Local_u8ConversionBuffer[10+index];
-			//app_name[index]=buff[18+index];
+		/*The image is already in flash, its CRC is saved with the record to be checked at boot*/
+		if( (app_size_in_bytes!=0) && !(app_base_address&0x3) &&
+			(verify_address(app_base_address)==ADDR_VALID) && (verify_address(app_base_address+app_size_in_bytes-1)==ADDR_VALID) &&
+			(app_base_address+app_size_in_bytes-1 < RAM_START) )
+			app_image_crc = bootloader_crc32_words(app_base_address, app_size_in_bytes);
 		printmsg1("\nNumber of apps: %d"    ,number_of_apps);
 		printmsg1("\r\nApp name: %s"        ,app_name);
 		printmsg1("\r\nApp size: %d bytes"    ,app_size_in_bytes);
 		printmsg1("\r\nApp Base address: %#x\r\n"  ,app_base_address);
+		printmsg1("App image CRC: %#x\r\n"  ,app_image_crc);
 
-		FLASH_Unlock();
-		status = FLASH_savePage(FLASH_MEMORY_PAGE_22,SAVE_FLASH);		/*save*/
-		status = FLASH_PageErase(FLASH_MEMORY_PAGE_22);					/*erase*/
-		FLASH_updatePage((u32*)&number_of_apps   ,1,0,SAVE_FLASH);		/*update number of apps			*/
-		FLASH_updatePage(&app_base_address     ,4,(16+(16*(number_of_apps-1))),SAVE_FLASH);		/*update app base memory address*/
-		FLASH_updatePage(&app_size_in_bytes    ,4,(20+(16*(number_of_apps-1))),SAVE_FLASH);		/*update app size in bytes      */
-		FLASH_updatePage((u32*)app_name        ,8,(24+(16*(number_of_apps-1))),SAVE_FLASH);		/*update app name               */
-		//FLASH_updatePage((u32*)app_name        ,4,(24+(16*(number_of_apps-1))),SAVE_FLASH);		/*update app name               */
-		//FLASH_updatePage((u32*)&app_name[4]    ,4,(28+(16*(number_of_apps-1))),SAVE_FLASH);		/*update app name               */
-		FLASH_reloadPage(FLASH_MEMORY_PAGE_22,SAVE_FLASH);              /*reload*/
-		FLASH_Lock();
-		//Stating that a reply of 10 bytes is going to be sent
+		/*Append one record to the applications log, no page erase needed (the log is compacted when its page is full)*/
+		status = APPINFO_u8WriteApp(slot, app_base_address, app_size_in_bytes, app_name, app_image_crc);
+		//Stating that a reply of 1 byte is going to be sent
 		bootloader_send_ack(1);
-		/*Convert array to char to send them over WIFI*/
-		hex2char(Global_u8ResponseArray, Local_u8FinalReply, BL_SAVE_APP_INFO_REPLY_LEN);
-		/*Send converted Bytes over WIFI*/
-		WIFI_u8SendCommandToServer(Local_u8FinalReply, BL_SAVE_APP_INFO_REPLY_LEN*2);
+		WIFI_voidReplyAppendU8(status);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
 		//HUART_u8SendSync(HUART_USART2,&status,1,10);
 	}
 	else
@@ -1342,17 +1958,467 @@ void bootloader_handle_save_app_info_cmd		(u8* buff)
 	//FLASH_Lock();
 }
 
+/*Handle function to handle BL_GET_DIGEST command
+ * Host sends: start address (4 bytes), number of bytes (4 bytes), algorithm (1 byte)
+ * Bootloader replies: status (1 byte), algorithm (1 byte), hashing time in us (4 bytes), digest (4 or 32 bytes)*/
+void bootloader_handle_get_digest_cmd			(u8* bl_rx_buffer)
+{
+
+	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
+	u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
+	u32 crc_host;
+
+	u32 start_address =0;
+	u32 len_to_digest =0;
+	u8  algorithm     =BL_DIGEST_CRC32;
+	u8  digest_len    =0;
+	u32 crc_value     =0;
+	u32 start_cycles  =0;
+	u32 elapsed_us    =0;
+	u8  sha_digest[BL_DIGEST_SHA256_LEN];
+	SHA256_Context_t sha_context;
+
+	crc_host= *((u32*)(bl_rx_buffer+command_length_without_crc));         /*Extract the CRC32 sent by host*/
+
+	printmsg1("------------------------------------------------\r\n");
+	printmsg1("BL_DEBUG_MSG: bootloader_handle_get_digest_cmd \r\n");
+	// 1) verify the checksum
+	if(! bootloader_verify_crc(bl_rx_buffer, command_length_without_crc, crc_host))
+	{
+		//checksum is correct
+		printmsg1("BL_DEBUG_MSG: checksum success !! \r\n");
+
+		start_address = *((u32*)&bl_rx_buffer[2]);
+		len_to_digest = *((u32*)&bl_rx_buffer[6]);
+		algorithm     = bl_rx_buffer[10];
+
+		/*Range must be inside one memory, CRC words are read from a word aligned address*/
+		if( (len_to_digest==0) || (algorithm>BL_DIGEST_SHA256) || (start_address&0x3) ||
+			(verify_address(start_address)!=ADDR_VALID) || (verify_address(start_address+len_to_digest-1)!=ADDR_VALID) ||
+			((start_address>=RAM_START) != ((start_address+len_to_digest-1)>=RAM_START)) )
+		{
+			printmsg1("BL_DEBUG_MSG: digest range invalid ! \r\n");
+			bootloader_send_ack(1);
+			WIFI_voidReplyAppendU8(ADDR_INVALID);
+			WIFI_u8ReplySend();
+			return;
+		}
+
+		bootloader_start_cycle_counter();
+		start_cycles = DWT_CYCCNT;
+		if(algorithm==BL_DIGEST_SHA256)
+		{
+			SHA256_voidInit  (&sha_context);
+			SHA256_voidUpdate(&sha_context, (u8*)start_address, len_to_digest);
+			SHA256_voidFinal (&sha_context, sha_digest);
+			digest_len = BL_DIGEST_SHA256_LEN;
+		}
+		else
+		{
+			crc_value  = bootloader_crc32_words(start_address, len_to_digest);
+			digest_len = BL_DIGEST_CRC32_LEN;
+		}
+		elapsed_us = bootloader_cycles_to_us(DWT_CYCCNT-start_cycles);
+		printmsg1("BL_DEBUG_MSG: %d bytes digested in %d us (%d bytes/ms)\r\n",len_to_digest,elapsed_us,
+				  (elapsed_us)? (u32)(((f32)len_to_digest*1000)/elapsed_us) : len_to_digest);
+
+		bootloader_send_ack(6+digest_len);
+		WIFI_voidReplyAppendU8(ADDR_VALID);
+		WIFI_voidReplyAppendU8(algorithm);
+		WIFI_voidReplyAppendU32(elapsed_us);
+		if(algorithm==BL_DIGEST_SHA256)
+			WIFI_voidReplyAppendBytes(sha_digest, digest_len);
+		else
+			WIFI_voidReplyAppendU32(crc_value);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
+	}
+	else
+	{
+		//checksum is wrong send nack
+		printmsg1("BL_DEBUG_MSG: checksum fail !! \r\n");
+		bootloader_send_nack();
+	}
+}
+
+/*Handle function to handle BL_GET_RESUME command
+ * Bootloader replies: found (1 byte), base address (4 bytes), size (4 bytes), bytes written and verified (4 bytes)
+ * Sending BL_MEM_WRITE again with the same address, size and CRC continues from (bytes written and verified)*/
+void bootloader_handle_get_resume_cmd			(u8* bl_rx_buffer)
+{
+
+	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
+	u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
+	u32 crc_host;
+	JOURNAL_Progress_t progress={0};
+
+	crc_host= *((u32*)(bl_rx_buffer+command_length_without_crc));         /*Extract the CRC32 sent by host*/
+
+	printmsg1("------------------------------------------------\r\n");
+	printmsg1("BL_DEBUG_MSG: bootloader_handle_get_resume_cmd \r\n");
+	// 1) verify the checksum
+	if(! bootloader_verify_crc(bl_rx_buffer, command_length_without_crc, crc_host))
+	{
+		//checksum is correct
+		printmsg1("BL_DEBUG_MSG: checksum success !! \r\n");
+
+		bootloader_send_ack(13);
+		WIFI_voidReplyAppendU8(JOURNAL_u8GetProgress(&progress)==STATUS_OK);
+		WIFI_voidReplyAppendU32(progress.baseAddress);
+		WIFI_voidReplyAppendU32(progress.sizeInBytes);
+		WIFI_voidReplyAppendU32(progress.bytesDone);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
+	}
+	else
+	{
+		//checksum is wrong send nack
+		printmsg1("BL_DEBUG_MSG: checksum fail !! \r\n");
+		bootloader_send_nack();
+	}
+}
+
+/*Handle function to handle BL_GET_STATS command
+ * Command carries one byte after the code : 1 to clear the counters once they are read
+ * Bootloader replies: bytes received, bytes programmed, pages erased, CRC failures, NACKs sent, network fetches repeated,
+ * then the time in us spent waiting for the network, decoding hex, erasing flash, programming flash and logging,
+ * then the time in us since the counters were cleared (4 bytes each)*/
+void bootloader_handle_get_stats_cmd			(u8* bl_rx_buffer)
+{
+
+	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
+	u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
+	u32 crc_host;
+	u8  clear_after_read = bl_rx_buffer[2];
+	u8  stats_record[STATS_RECORD_SIZE];
+	UART_Errors_t wifi_errors;
+
+	crc_host= *((u32*)(bl_rx_buffer+command_length_without_crc));         /*Extract the CRC32 sent by host*/
+
+	printmsg1("------------------------------------------------\r\n");
+	printmsg1("BL_DEBUG_MSG: bootloader_handle_get_stats_cmd \r\n");
+	// 1) verify the checksum
+	if(! bootloader_verify_crc(bl_rx_buffer, command_length_without_crc, crc_host))
+	{
+		//checksum is correct
+		printmsg1("BL_DEBUG_MSG: checksum success !! \r\n");
+
+		/*Receive errors on the WIFI link are logged only, overruns there tell that flow control (or a lower baudrate) is needed*/
+		HUART_u8GetErrors(HUART_USART2, &wifi_errors);
+		printmsg1("BL_DEBUG_MSG: WIFI link errors : overrun %d noise %d framing %d, rx ring drops %d\r\n",
+				  wifi_errors.overrun, wifi_errors.noise, wifi_errors.framing, HUART_u16GetRXDropped(HUART_USART2));
+
+		/*Take the record before the reply is sent, so the reply itself is counted in the next read*/
+		STATS_voidGetRecord(stats_record);
+		if(clear_after_read) STATS_voidClear();
+
+		bootloader_send_ack(STATS_RECORD_SIZE);
+		WIFI_voidReplyAppendBytes(stats_record, STATS_RECORD_SIZE);
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
+	}
+	else
+	{
+		//checksum is wrong send nack
+		printmsg1("BL_DEBUG_MSG: checksum fail !! \r\n");
+		bootloader_send_nack();
+	}
+}
+
+/*Handle function to handle BL_GET_TRACE command
+ * Command carries one byte after the code : 1 to empty the trace once it is read
+ * The records held by the trace ring are streamed oldest first, every reply carries : sequence number of its first record (4 bytes),
+ * records left after this reply (2 bytes), number of records (1 byte), records (8 bytes each : time in us (4), event, phase, argument (2))
+ * A first sequence number above 0 means older records were overwritten, recording stops while the ring is read*/
+void bootloader_handle_get_trace_cmd			(u8* bl_rx_buffer)
+{
+
+	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
+	u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
+	u32 crc_host;
+	u8  clear_after_read = bl_rx_buffer[2];
+	u32 first_record;
+	u32 next_record;
+	u8  records;
+
+	crc_host= *((u32*)(bl_rx_buffer+command_length_without_crc));         /*Extract the CRC32 sent by host*/
+
+	printmsg1("------------------------------------------------\r\n");
+	printmsg1("BL_DEBUG_MSG: bootloader_handle_get_trace_cmd \r\n");
+	// 1) verify the checksum
+	if(! bootloader_verify_crc(bl_rx_buffer, command_length_without_crc, crc_host))
+	{
+		//checksum is correct
+		printmsg1("BL_DEBUG_MSG: checksum success !! \r\n");
+
+		TRACE_voidSetEnable(0);
+		TRACE_voidGetRange(&first_record, &next_record);
+		printmsg1("BL_DEBUG_MSG: sending trace records %d to %d\r\n",first_record,next_record);
+		do
+		{
+			GPIO_Pin_Write(&OnBoard_Led,LOW);
+			records = TRACE_u8CopyRecords(first_record, static_u8TraceRecords, BL_GET_TRACE_MAX_RECORDS);
+
+			bootloader_send_ack(BL_GET_TRACE_HEADER_LEN+records*TRACE_RECORD_SIZE);
+			WIFI_voidReplyAppendU32(first_record);
+			WIFI_voidReplyAppendU16((u16)(next_record-first_record-records));
+			WIFI_voidReplyAppendU8(records);
+			WIFI_voidReplyAppendBytes(static_u8TraceRecords, records*TRACE_RECORD_SIZE);
+			/*Send the reply over WIFI*/
+			WIFI_u8ReplySend();
+
+			first_record += records;
+			GPIO_Pin_Write(&OnBoard_Led,HIGH);
+			/*Give the host time to fetch this reply before it is overwritten by the next one*/
+			if(first_record < next_record) SCHED_voidSleep(BL_MEM_READ_STREAM_DELAY_MS);
+		}while(first_record < next_record);
+
+		/*Empty the ring (time restarts from 0) or keep adding to it*/
+		if(clear_after_read) TRACE_voidInit();
+		else                 TRACE_voidSetEnable(1);
+	}
+	else
+	{
+		//checksum is wrong send nack
+		printmsg1("BL_DEBUG_MSG: checksum fail !! \r\n");
+		bootloader_send_nack();
+	}
+}
+
+/*Handle function to handle BL_GET_PROFILE command
+ * Command carries : new sampling rate in Hz (2 bytes, 0 to stop, 0xFFFF to keep the profiler as it is), 1 to clear the histogram once it is read (1 byte)
+ * The buckets holding samples are streamed in order, every reply carries : rate while sampling (2 bytes, 0 if stopped),
+ * total samples (4 bytes), samples outside the bootloader code (4 bytes), bucket shift (1 byte), index of its first entry (2 bytes),
+ * entries left after this reply (2 bytes), number of entries (1 byte), entries (bucket (2 bytes), samples (4 bytes))
+ * Sampling is paused while the histogram is read, then the new rate is applied*/
+void bootloader_handle_get_profile_cmd			(u8* bl_rx_buffer)
+{
+
+	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
+	u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
+	u32 crc_host;
+	u16 new_rate         = *((u16*)&bl_rx_buffer[2]);
+	u8  clear_after_read = bl_rx_buffer[4];
+	u16 rate;
+	u32 samples;
+	u32 outside;
+	u32 bucket_samples;
+	u16 bucket;
+	u16 entries_total    =0;
+	u16 entries_sent     =0;
+	u16 entries_left;
+	u8  entries;
+
+	crc_host= *((u32*)(bl_rx_buffer+command_length_without_crc));         /*Extract the CRC32 sent by host*/
+
+	printmsg1("------------------------------------------------\r\n");
+	printmsg1("BL_DEBUG_MSG: bootloader_handle_get_profile_cmd \r\n");
+	// 1) verify the checksum
+	if(! bootloader_verify_crc(bl_rx_buffer, command_length_without_crc, crc_host))
+	{
+		//checksum is correct
+		printmsg1("BL_DEBUG_MSG: checksum success !! \r\n");
+
+		PROF_voidGetSummary(&rate, &samples, &outside);
+		PROF_voidStop();
+		for(bucket=PROF_u16NextBucket(0, &bucket_samples); bucket<PROF_NUMBER_OF_BUCKETS; bucket=PROF_u16NextBucket(bucket+1, &bucket_samples))
+			entries_total++;
+		printmsg1("BL_DEBUG_MSG: %d samples, %d buckets used\r\n",samples,entries_total);
+
+		bucket = PROF_u16NextBucket(0, &bucket_samples);
+		do
+		{
+			GPIO_Pin_Write(&OnBoard_Led,LOW);
+			entries_left = entries_total-entries_sent;
+			entries = (entries_left > (u16)BL_GET_PROFILE_MAX_ENTRIES)? (u8)BL_GET_PROFILE_MAX_ENTRIES : (u8)entries_left;
+
+			bootloader_send_ack(BL_GET_PROFILE_HEADER_LEN+entries*BL_GET_PROFILE_ENTRY_LEN);
+			WIFI_voidReplyAppendU16(rate);
+			WIFI_voidReplyAppendU32(samples);
+			WIFI_voidReplyAppendU32(outside);
+			WIFI_voidReplyAppendU8(PROF_BUCKET_SHIFT);
+			WIFI_voidReplyAppendU16(entries_sent);
+			WIFI_voidReplyAppendU16(entries_total-entries_sent-entries);
+			WIFI_voidReplyAppendU8(entries);
+			entries_sent += entries;
+			while(entries--)
+			{
+				WIFI_voidReplyAppendU16(bucket);
+				WIFI_voidReplyAppendU32(bucket_samples);
+				bucket = PROF_u16NextBucket(bucket+1, &bucket_samples);
+			}
+			/*Send the reply over WIFI*/
+			WIFI_u8ReplySend();
+
+			GPIO_Pin_Write(&OnBoard_Led,HIGH);
+			/*Give the host time to fetch this reply before it is overwritten by the next one*/
+			if(entries_sent < entries_total) SCHED_voidSleep(BL_MEM_READ_STREAM_DELAY_MS);
+		}while(entries_sent < entries_total);
+
+		if(clear_after_read) PROF_voidClear();
+		if(new_rate==BL_PROFILE_RATE_KEEP)
+		{
+			if(rate) PROF_voidResume();
+		}
+		else if(new_rate!=BL_PROFILE_RATE_STOP)
+		{
+			if(PROF_u8Start(new_rate)!=STATUS_OK) printmsg1("BL_DEBUG_MSG: sampling rate %d Hz not supported\r\n",new_rate);
+		}
+	}
+	else
+	{
+		//checksum is wrong send nack
+		printmsg1("BL_DEBUG_MSG: checksum fail !! \r\n");
+		bootloader_send_nack();
+	}
+}
+
+/*Handle function to handle BL_GET_MEMORY command
+ * Bootloader replies: RAM size, static data (.data, .bss, .noinit), heap in use, stack high-water mark, stack in use now,
+ * RAM never touched between the heap and the deepest stack, stack size reserved by the linker script (4 bytes each)
+ * then the number of buffer pools and for each pool : block size (2), largest request (2), requests that found it full (2),
+ * blocks, blocks in use now, most blocks in use at the same time (1 byte each)
+ * The high-water marks cover everything since reset, including earlier BL_MEM_WRITE downloads*/
+void bootloader_handle_get_memory_cmd			(u8* bl_rx_buffer)
+{
+
+	u8  command_packet = bl_rx_buffer[0]+1;                 /*Total length of command packet*/
+	u32 command_length_without_crc = command_packet-4;      /*Length to be sent to (bl_verify_crc) function*/
+	u32 crc_host;
+	STACK_Usage_t usage;
+	POOL_Stats_t  pool;
+	u8  pool_index;
+
+	crc_host= *((u32*)(bl_rx_buffer+command_length_without_crc));         /*Extract the CRC32 sent by host*/
+
+	printmsg1("------------------------------------------------\r\n");
+	printmsg1("BL_DEBUG_MSG: bootloader_handle_get_memory_cmd \r\n");
+	// 1) verify the checksum
+	if(! bootloader_verify_crc(bl_rx_buffer, command_length_without_crc, crc_host))
+	{
+		//checksum is correct
+		printmsg1("BL_DEBUG_MSG: checksum success !! \r\n");
+
+		STACK_voidGetUsage(&usage);
+		printmsg1("BL_DEBUG_MSG: static %d, heap %d, stack peak %d, free %d bytes\r\n",
+				  usage.staticSize,usage.heapUsed,usage.stackPeak,usage.freeBytes);
+
+		bootloader_send_ack(STACK_USAGE_RECORD_SIZE+1+POOL_COUNT*POOL_STATS_RECORD_SIZE);
+		/*Cortex-M3 is little endian, the record is sent as it is in memory*/
+		WIFI_voidReplyAppendBytes((u8*)&usage, STACK_USAGE_RECORD_SIZE);
+		WIFI_voidReplyAppendU8(POOL_COUNT);
+		for(pool_index=0;pool_index<POOL_COUNT;pool_index++)
+		{
+			POOL_u8GetStats(pool_index, &pool);
+			WIFI_voidReplyAppendU16(pool.blockSize);
+			WIFI_voidReplyAppendU16(pool.largestRequest);
+			WIFI_voidReplyAppendU16(pool.exhausted);
+			WIFI_voidReplyAppendU8(pool.blocks);
+			WIFI_voidReplyAppendU8(pool.inUse);
+			WIFI_voidReplyAppendU8(pool.peakInUse);
+		}
+		/*Send the reply over WIFI*/
+		WIFI_u8ReplySend();
+	}
+	else
+	{
+		//checksum is wrong send nack
+		printmsg1("BL_DEBUG_MSG: checksum fail !! \r\n");
+		bootloader_send_nack();
+	}
+}
+
 /******************* Implementation Helper functions prototypes **********************************************/
 
+/* Checks the image at FLASH_USR_APP_BASE_ADDRESS against the length and CRC saved in its application record
+ * A valid marker in the backup registers (left by a previous check on this image) skips the CRC pass
+ * Images without a record or without a saved CRC (or whose CRC was invalidated by a download) are not checked
+ * The time is taken before the debug messages are queued, formatting them is not part of the check
+ * Return: STATUS_OK if the app can be executed, time taken by the check in (pElapsed_us)*/
+u8 bootloader_validate_user_app(u32* pElapsed_us)
+{
+	u8  status = STATUS_OK;
+	u32 start_cycles;
+	u32 crc_value;
+	APPINFO_Record_t record;
+
+	bootloader_start_cycle_counter();
+	start_cycles = DWT_CYCCNT;
+
+	APPINFO_u8Init();
+	if(APPINFO_u8FindByBaseAddress(FLASH_USR_APP_BASE_ADDRESS, &record) != STATUS_OK || record.imageCrc == APPINFO_NO_IMAGE_CRC ||
+	   record.imageCrc == APPINFO_INVALIDATED_CRC)
+	{
+		*pElapsed_us = bootloader_cycles_to_us(DWT_CYCCNT-start_cycles);
+		printmsg1("BL_DEBUG_MSG: No saved CRC for the user app, image is not checked\r\n");
+	}
+	else if( (BKP_DR1 == BL_VALIDATED_TAG) && (BKP_DR2 == (record.imageCrc&0xFFFF)) &&
+			 (BKP_DR3 == (record.imageCrc>>16)) && (BKP_DR4 == (record.sequence&0xFFFF)) )
+	{
+		*pElapsed_us = bootloader_cycles_to_us(DWT_CYCCNT-start_cycles);
+		printmsg1("BL_DEBUG_MSG: User app already validated, check skipped in %d us\r\n",*pElapsed_us);
+		return STATUS_OK;
+	}
+	else if( (record.sizeInBytes == 0) || (verify_address(FLASH_USR_APP_BASE_ADDRESS+record.sizeInBytes-1) != ADDR_VALID) ||
+			 (FLASH_USR_APP_BASE_ADDRESS+record.sizeInBytes-1 >= RAM_START) )
+	{
+		status = STATUS_NOK;
+		*pElapsed_us = bootloader_cycles_to_us(DWT_CYCCNT-start_cycles);
+	}
+	else
+	{
+		crc_value = bootloader_crc32_words(FLASH_USR_APP_BASE_ADDRESS, record.sizeInBytes);
+		if(crc_value == record.imageCrc) bootloader_set_validated_marker(&record);
+		else                             status = STATUS_NOK;
+		*pElapsed_us = bootloader_cycles_to_us(DWT_CYCCNT-start_cycles);
+		printmsg1("BL_DEBUG_MSG: CRC of %d bytes is %#x, saved %#x\r\n",record.sizeInBytes,crc_value,record.imageCrc);
+	}
+	printmsg1("BL_DEBUG_MSG: User app check took %d us\r\n",*pElapsed_us);
+	return status;
+}
+
+/*Leaves a marker in the backup registers so that warm resets skip the CRC pass of this image*/
+void bootloader_set_validated_marker(APPINFO_Record_t* pRecord)
+{
+	PWR_CR |= PWR_CR_DBP;
+	BKP_DR2 = pRecord->imageCrc&0xFFFF;
+	BKP_DR3 = pRecord->imageCrc>>16;
+	BKP_DR4 = pRecord->sequence&0xFFFF;
+	/*Tag is written last, a marker interrupted by reset is never valid*/
+	BKP_DR1 = BL_VALIDATED_TAG;
+	PWR_CR &= ~PWR_CR_DBP;
+}
+
+void bootloader_clear_validated_marker(void)
+{
+	PWR_CR |= PWR_CR_DBP;
+	BKP_DR1 = 0;
+	PWR_CR &= ~PWR_CR_DBP;
+}
+
+/*Enables the DWT cycle counter, it counts HCLK cycles*/
+void bootloader_start_cycle_counter(void)
+{
+	DEMCR    |= DEMCR_TRCENA;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+/*Cycles to microseconds, the counter wraps after a minute at 72MHz which is far more than any flash region needs*/
+u32 bootloader_cycles_to_us(u32 cycles)
+{
+	return cycles/(delay_u32GetCPUclock()/1000000);
+}
+
 void bootloader_send_ack(u8 follow_len)
 {
 	//here we send 2 bytes .. first byte is ack and the second byte is the length of the following
 	//reply bytes
 	/*************Modifications made by Mahmoud for WIFI************/
 	u8 ack_buffer[2]={BL_ACK,follow_len};
-	/*Write ACK Bytes inside the array that will be sent to web server*/
-	Global_u8ResponseArray[0]=ack_buffer[0];
-	Global_u8ResponseArray[1]=ack_buffer[1];
+	/*Start the reply with the ACK bytes, the handler appends the following bytes and sends it*/
+	WIFI_voidReplyBegin();
+	WIFI_voidReplyAppendU8(ack_buffer[0]);
+	WIFI_voidReplyAppendU8(ack_buffer[1]);
 	printmsg1("Sending BL_ACK: 0x%x\r\n",ack_buffer[0]);
 	printmsg1("reply length= %d bytes\r\n",ack_buffer[1]);
 	/*********************End of Modifications**********************/
@@ -1361,8 +2427,10 @@ void bootloader_send_ack(u8 follow_len)
 void bootloader_send_nack(void)
 {
 	//HUART_u8SendSync(HUART_USART2,(u8*)BL_NACK,1,10);
-	hex2char((u8*)BL_NACK, Global_u8ResponseArray, 1);
-	WIFI_u8SendCommandToServer(Global_u8ResponseArray, 2);
+	WIFI_voidReplyBegin();
+	WIFI_voidReplyAppendU8(BL_NACK);
+	WIFI_u8ReplySend();
+	STATS_voidCount(STATS_NACKS_SENT, 1);
 
 }
 
@@ -1380,12 +2448,32 @@ u8 bootloader_verify_crc(u8* pData, u32 len, u32 crc_host)
 	}
 	if(crc_rcv==crc_host)
 		return VERIFY_CRC_SUCCESS;
+	STATS_voidCount(STATS_CRC_FAILURES, 1);
 	return VERIFY_CRC_FAIL;
 }
 
+/*Decodes (len) bytes from the hex chars received from the server, the time it takes is added to the performance counters
+ * Return: STATUS_NOK if a char is not a hex digit*/
+u8 bootloader_decode_hex(u8* pChars, u8* pBytes, u16 len)
+{
+	u8  status;
+	u32 start_cycles = STATS_u32Start();
+
+	TRACE_voidRecord(TRACE_EVENT_HEX_DECODE, TRACE_PHASE_BEGIN, len);
+	status = HEX_u8Decode(pChars, pBytes, len);
+	STATS_voidStop(STATS_TIME_HEX_DECODE, start_cycles);
+	TRACE_voidRecord(TRACE_EVENT_HEX_DECODE, TRACE_PHASE_END, len);
+	return status;
+}
+
 u8 verify_address(u32 go_address)
 {
-	if ( go_address >= RAM_START && go_address <= RAM_END)
+	/*The metadata pages are only reached through their drivers (APPINFO, JOURNAL)*/
+	if ( go_address >= BL_METADATA_START && go_address <= BL_METADATA_END)
+		{
+			return ADDR_INVALID;
+		}
+	else if ( go_address >= RAM_START && go_address <= RAM_END)
 		{
 			return ADDR_VALID;
 		}
@@ -1398,13 +2486,94 @@ u8 verify_address(u32 go_address)
 
 }
 
-/* convert (inBuffer) which has (char) elements of double the size of the (outBuffer)
- * merging every two bytes of the (inBuffer) into one byte of (outBuffer)
- * This is done as we had to receive every byte(Hex) as two bytes in their (ASCII) representation
- * for example : (inBuffer) has 1024 bytes
- * 				 (outBuffer) has 512 bytes
- * 				 so we are going to iterate for 512 times*/
-void char2hex(u8* inBuffer, u8* outBuffer, u16 NumOfBytesToBeConverted )
+/* Checks a range that is going to be written to flash : both ends in flash and the metadata pages neither
+ * at its ends nor in between*/
+u8 verify_flash_write_range(u32 start_address, u32 len)
+{
+	if( (len == 0) || (len > FLASH_SIZE) || (start_address < FLASH_START) || (start_address+len-1 > FLASH_END) ||
+		(verify_address(start_address) != ADDR_VALID) || (verify_address(start_address+len-1) != ADDR_VALID) ||
+		((start_address < BL_METADATA_START) && (start_address+len-1 > BL_METADATA_END)) )
+	{
+		return ADDR_INVALID;
+	}
+	return ADDR_VALID;
+}
+
+/* CRC32 of a memory region using the hardware CRC unit
+ * Whole words are moved from memory to the data register by DMA (one write per 4 bytes),
+ * the last 1 to 3 bytes (if any) are written one byte per word*/
+u32 bootloader_crc32_words(u32 start_address, u32 len)
+{
+	u32 index;
+	u32 iData;
+	u32 crc_value;
+
+	CRC_ResetDR();
+	crc_value = CRC_CalcBlockCRCDMA((u32*)start_address, len/4);
+	for(index=(len&~0x3);index<len;index++)
+	{
+		iData     = *((u8*)(start_address+index));
+		crc_value = CRC_CalcBlockCRC(&iData, 1);
+	}
+	return crc_value;
+}
+
+/* Fetches the manifest window published after the (chunks) windows of the image, it holds the CRC32 of every chunk
+ * The manifest is fetched again while it does not match (manifest_crc), every extra fetch is counted in (pRefetches)
+ * Return: STATUS_OK when (static_u32ChunkManifest) holds a manifest that can be trusted*/
+u8 bootloader_fetch_manifest(u16 chunks, u32 file_size, u32 manifest_crc, u8* pWebBuffer, u16* pRefetches)
+{
+	u8 retry;
+
+	if(chunks > BL_MANIFEST_MAX_CHUNKS) return STATUS_NOK;
+	for(retry=0;retry<=BL_MEM_WRITE_CHUNK_RETRIES;retry++)
+	{
+		Global_u16IteratorForNumberOfTimesDataAreReceived = chunks;
+		WIFI_u8ReceiveData(1, file_size, pWebBuffer);
+		if((bootloader_decode_hex(pWebBuffer, (u8*)static_u32ChunkManifest, chunks*4)==STATUS_OK) &&
+		   (bootloader_crc32_words((u32)static_u32ChunkManifest, chunks*4)==manifest_crc)) return STATUS_OK;
+		(*pRefetches)++;
+		STATS_voidCount(STATS_CRC_FAILURES, 1);
+		STATS_voidCount(STATS_FETCH_RETRIES, 1);
+	}
+	return STATUS_NOK;
+}
+
+/* Copies (pSrc) into (pDest) replacing every run of 0xFF bytes (erased flash) with the pair (0xFF, run length)
+ * Stops when (pDest) can not hold the next token, the number of source bytes consumed is returned in (pConsumed)
+ * Return: number of bytes written in (pDest)*/
+u16 bootloader_encode_ff_runs(u8* pSrc, u32 src_len, u8* pDest, u16 dest_max, u32* pConsumed)
+{
+	u32 src_index =0;
+	u16 dest_index=0;
+	u8  run_len;
+
+	while( (src_index<src_len) && (dest_index<dest_max) )
+	{
+		if(pSrc[src_index]==0xFF)
+		{
+			if(dest_index+2 > dest_max) break;
+			run_len=0;
+			while( (src_index<src_len) && (pSrc[src_index]==0xFF) && (run_len<0xFF) )
+			{
+				run_len++;
+				src_index++;
+			}
+			pDest[dest_index++]=0xFF;
+			pDest[dest_index++]=run_len;
+		}
+		else
+		{
+			pDest[dest_index++]=pSrc[src_index++];
+		}
+	}
+	*pConsumed = src_index;
+	return dest_index;
+}
+
+#if BL_HEX_BENCHMARK
+/*Per-nibble conversions the bootloader used before the hex codec, kept only to compare against it*/
+static void bootloader_reference_char2hex(u8* inBuffer, u8* outBuffer, u16 NumOfBytesToBeConverted)
 {
 	u16 index;
 	u8  Local_u8inBuffer;
@@ -1420,28 +2589,79 @@ void char2hex(u8* inBuffer, u8* outBuffer, u16 NumOfBytesToBeConverted )
 	}
 }
 
-void hex2char(u8* inBuffer, u8* outBuffer, u16 NumOfBytesToBeConverted)
+static void bootloader_reference_hex2char(u8* inBuffer, u8* outBuffer, u16 NumOfBytesToBeConverted)
 {
-    u16 index;
+	u16 index;
+	u8  nibble;
 
-    for(index=0;index<NumOfBytesToBeConverted;index++)
-    {
-        outBuffer[index*2] = inBuffer[index] & 0xF0 ;
-        outBuffer[index*2] = outBuffer[index*2] >> 4 ;
+	for(index=0;index<NumOfBytesToBeConverted*2;index++)
+	{
+		nibble = (index&1)? (inBuffer[index/2]&0x0F) : (inBuffer[index/2]>>4);
+		if(nibble<=0x9) outBuffer[index] = nibble|0x30;
+		else            outBuffer[index] = (nibble|0x60)-9;
+	}
+}
 
-        if      ( outBuffer[index*2] >= 0x0 && outBuffer[index*2] <= 0x9 )
-                  outBuffer[index*2] |= 0x30;
-        else if ( outBuffer[index*2] >= 0xA && outBuffer[index*2] <= 0xF ){
-                  outBuffer[index*2] |= 0x60;
-                  outBuffer[index*2] -= 9;}
+/*Times both directions over (BL_HEX_BENCHMARK_BYTES) bytes of flash, the chars and bytes share one block of the pools*/
+void bootloader_benchmark_hex_codec(void)
+{
+	u8* chars = POOL_pvAlloc(BL_HEX_BENCHMARK_BYTES*3);
+	u8* bytes = &chars[BL_HEX_BENCHMARK_BYTES*2];
+	u32 start_cycles;
+	u32 cycles[4];
+	u8  status;
 
-        outBuffer[index*2+1] = inBuffer[index] & 0x0F ;
+	if(chars==NULL) return;
+	bootloader_start_cycle_counter();
+
+	start_cycles = DWT_CYCCNT;
+	bootloader_reference_hex2char((u8*)FLASH_START, chars, BL_HEX_BENCHMARK_BYTES);
+	cycles[0] = DWT_CYCCNT-start_cycles;
+	start_cycles = DWT_CYCCNT;
+	HEX_voidEncode((u8*)FLASH_START, chars, BL_HEX_BENCHMARK_BYTES);
+	cycles[1] = DWT_CYCCNT-start_cycles;
+
+	start_cycles = DWT_CYCCNT;
+	bootloader_reference_char2hex(chars, bytes, BL_HEX_BENCHMARK_BYTES);
+	cycles[2] = DWT_CYCCNT-start_cycles;
+	start_cycles = DWT_CYCCNT;
+	status = HEX_u8Decode(chars, bytes, BL_HEX_BENCHMARK_BYTES);
+	cycles[3] = DWT_CYCCNT-start_cycles;
+
+	printmsg1("BL_DEBUG_MSG: hex encode %d.%02d -> %d.%02d cycles/byte\r\n",
+			  cycles[0]/BL_HEX_BENCHMARK_BYTES, (cycles[0]%BL_HEX_BENCHMARK_BYTES)*100/BL_HEX_BENCHMARK_BYTES,
+			  cycles[1]/BL_HEX_BENCHMARK_BYTES, (cycles[1]%BL_HEX_BENCHMARK_BYTES)*100/BL_HEX_BENCHMARK_BYTES);
+	printmsg1("BL_DEBUG_MSG: hex decode %d.%02d -> %d.%02d cycles/byte (%s, %s)\r\n",
+			  cycles[2]/BL_HEX_BENCHMARK_BYTES, (cycles[2]%BL_HEX_BENCHMARK_BYTES)*100/BL_HEX_BENCHMARK_BYTES,
+			  cycles[3]/BL_HEX_BENCHMARK_BYTES, (cycles[3]%BL_HEX_BENCHMARK_BYTES)*100/BL_HEX_BENCHMARK_BYTES,
+			  (status==STATUS_OK)? "valid" : "INVALID",
+			  (memcmp(bytes,(u8*)FLASH_START,BL_HEX_BENCHMARK_BYTES)==0)? "round trip ok" : "ROUND TRIP MISMATCH");
+	POOL_voidFree(chars);
+}
+#endif
+
+#if BL_UART_BENCHMARK
+/*Times one line of (BL_UART_BENCHMARK_BYTES) bytes sent on the debug UART, from the first write to the end of the last frame*/
+void bootloader_benchmark_uart_tx(void)
+{
+	u8  line[BL_UART_BENCHMARK_BYTES];
+	u32 start_cycles;
+	u32 cycles;
+	u8  status;
+
+	memset(line, '-', sizeof(line)-2);
+	line[sizeof(line)-2] = '\r';
+	line[sizeof(line)-1] = '\n';
+	bootloader_start_cycle_counter();
+	/*The logs queued so far must not be timed with the line*/
+	flushmsg1();
 
-        if      ( outBuffer[index*2+1] >= 0x0 && outBuffer[index*2+1] <= 0x9 )
-                  outBuffer[index*2+1] |= 0x30;
-        else if ( outBuffer[index*2+1] >= 0xA && outBuffer[index*2+1] <= 0xF ){
-                  outBuffer[index*2+1] |= 0x60;
-                  outBuffer[index*2+1] -= 9;}
+	start_cycles = DWT_CYCCNT;
+	status = HUART_u8SendSync(HUART_USART1, line, sizeof(line), 1);
+	cycles = DWT_CYCCNT-start_cycles;
 
-    }
+	printmsg1("BL_DEBUG_MSG: uart send %d cycles/byte, %d us for %d bytes (%s)\r\n",
+			  cycles/BL_UART_BENCHMARK_BYTES, bootloader_cycles_to_us(cycles), BL_UART_BENCHMARK_BYTES,
+			  (status==STATUS_OK)? "ok" : "TIMED OUT");
 }
+#endif
@@ -9,11 +9,14 @@
 
 #include "STD_TYPES.h"
 #include "CRC.h"
+#include "DMA_interface.h"
 
 
 #define CRC_BASE_ADDRESS 					((void*)0x40023000)
 
 #define CRC									((CRC_TypeDef*)(CRC_BASE_ADDRESS))
+/*Any DMA1 channel can be used in memory to memory mode*/
+#define CRC_DMA_CHANNEL						DMA_CHANNEL1
 
 /******************************************************************************/
 /*                                                                            */
@@ -97,6 +100,27 @@ u32 CRC_CalcBlockCRC(u32 pBuffer[], u32 BufferLength)
   return (CRC->DR);
 }
 
+/**
+  * @brief  Computes the 32-bit CRC of a given buffer of data word(32-bit) using DMA1 to feed the data register.
+  *         The CPU only waits for the transfer, which avoids the load/store loop of CRC_CalcBlockCRC.
+  * @param  pBuffer: pointer to the buffer containing the data to be computed
+  * @param  BufferLength: length of the buffer to be computed
+  * @retval 32-bit CRC
+  */
+u32 CRC_CalcBlockCRCDMA(u32 pBuffer[], u32 BufferLength)
+{
+  u16 items;
+
+  while(BufferLength)
+  {
+    items = (BufferLength > DMA_MAX_TRANSFER_ITEMS)? DMA_MAX_TRANSFER_ITEMS : (u16)BufferLength;
+    DMA_u8MemoryToFixedAddress(CRC_DMA_CHANNEL, pBuffer, &CRC->DR, items);
+    pBuffer      += items;
+    BufferLength -= items;
+  }
+  return (CRC->DR);
+}
+
 /**
   * @brief  Returns the current CRC value.
   * @param  None
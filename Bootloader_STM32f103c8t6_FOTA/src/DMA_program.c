@@ -0,0 +1,60 @@
+/*DMA DRIVER FOR STM32
+VERSION: 1.0
+AUTHOR: MAHMOUD HAMDY*/
+
+#include "STD_TYPES.h"
+#include "DMA_interface.h"
+
+/*Registers*/
+#define DMA1_BASE_ADDRESS									(u32)0x40020000
+#define DMA1_ISR											*((u32 volatile*)(DMA1_BASE_ADDRESS+0x00))
+#define DMA1_IFCR											*((u32 volatile*)(DMA1_BASE_ADDRESS+0x04))
+/*Every channel has 4 registers (CCR, CNDTR, CPAR, CMAR) spaced by 20 bytes starting from offset 0x08*/
+#define DMA1_CCR(CHANNEL)									*((u32 volatile*)(DMA1_BASE_ADDRESS+0x08+(20*((CHANNEL)-1))))
+#define DMA1_CNDTR(CHANNEL)									*((u32 volatile*)(DMA1_BASE_ADDRESS+0x0C+(20*((CHANNEL)-1))))
+#define DMA1_CPAR(CHANNEL)									*((u32 volatile*)(DMA1_BASE_ADDRESS+0x10+(20*((CHANNEL)-1))))
+#define DMA1_CMAR(CHANNEL)									*((u32 volatile*)(DMA1_BASE_ADDRESS+0x14+(20*((CHANNEL)-1))))
+
+/*CCR Masks*/
+#define DMA_CCR_EN											((u32)0x0001)
+#define DMA_CCR_DIR_FROM_MEMORY								((u32)0x0010)
+#define DMA_CCR_MINC										((u32)0x0080)
+#define DMA_CCR_PSIZE_32									((u32)0x0200)
+#define DMA_CCR_MSIZE_32									((u32)0x0800)
+#define DMA_CCR_PL_VERY_HIGH								((u32)0x3000)
+#define DMA_CCR_MEM2MEM										((u32)0x4000)
+
+/*ISR/IFCR Masks, every channel has 4 flags (GIF, TCIF, HTIF, TEIF)*/
+#define DMA_FLAGS_SHIFT(CHANNEL)							(4*((CHANNEL)-1))
+#define DMA_ISR_TCIF(CHANNEL)								((u32)0x2<<DMA_FLAGS_SHIFT(CHANNEL))
+#define DMA_ISR_TEIF(CHANNEL)								((u32)0x8<<DMA_FLAGS_SHIFT(CHANNEL))
+#define DMA_IFCR_ALL(CHANNEL)								((u32)0xF<<DMA_FLAGS_SHIFT(CHANNEL))
+
+
+u8 DMA_u8MemoryToFixedAddress (u8 Copy_u8Channel, const u32* Copy_pu32Source, volatile u32* Copy_pu32Destination, u16 Copy_u16NumberOfWords)
+{
+	u8 Local_u8Status = STATUS_OK;
+
+	if ((Copy_u8Channel < DMA_CHANNEL1) || (Copy_u8Channel > DMA_CHANNEL7) || (Copy_pu32Source == NULL) || (Copy_pu32Destination == NULL))
+	{
+		return STATUS_NOK;
+	}
+	if (Copy_u16NumberOfWords == 0) return STATUS_OK;
+
+	/*Channel must be disabled before it is configured*/
+	DMA1_CCR(Copy_u8Channel)   = 0;
+	DMA1_IFCR                  = DMA_IFCR_ALL(Copy_u8Channel);
+	/*In memory to memory mode with DIR set, data goes from CMAR (incremented) to CPAR (fixed)*/
+	DMA1_CMAR(Copy_u8Channel)  = (u32)Copy_pu32Source;
+	DMA1_CPAR(Copy_u8Channel)  = (u32)Copy_pu32Destination;
+	DMA1_CNDTR(Copy_u8Channel) = Copy_u16NumberOfWords;
+	DMA1_CCR(Copy_u8Channel)   = DMA_CCR_MEM2MEM | DMA_CCR_PL_VERY_HIGH | DMA_CCR_MSIZE_32 | DMA_CCR_PSIZE_32 |
+								 DMA_CCR_MINC | DMA_CCR_DIR_FROM_MEMORY | DMA_CCR_EN;
+
+	while (!(DMA1_ISR & (DMA_ISR_TCIF(Copy_u8Channel) | DMA_ISR_TEIF(Copy_u8Channel))));
+	if (DMA1_ISR & DMA_ISR_TEIF(Copy_u8Channel)) Local_u8Status = STATUS_NOK;
+
+	DMA1_CCR(Copy_u8Channel) = 0;
+	DMA1_IFCR                = DMA_IFCR_ALL(Copy_u8Channel);
+	return Local_u8Status;
+}
@@ -11,13 +11,21 @@
 #include <stdarg.h>
 #include <string.h>
 #include "HUART_interface.h"
+#include "STATS_interface.h"
 
 
-/*This function is used to print msgs through uart1*/
+/*Longest time a flush of the debug messages may take (the tx ring of uart1 takes about 22 ms to empty)*/
+#define PRINTMSG1_FLUSH_TIMEOUT_MS		100
+
+/*This function is used to print msgs through uart1
+ * The message is queued in the tx ring of uart1 and sent by its interrupt, the caller only waits when the ring is full*/
 u16 printmsg1(const char* format, ...)
 {
   u16 ret;
+  u16 len;
+  u16 queued = 0;
   va_list ap;
+  u32 start_cycles = STATS_u32Start();
 
   va_start (ap, format);
 
@@ -27,10 +35,20 @@ u16 printmsg1(const char* format, ...)
   // Print to the local buffer
   ret = vsnprintf (buf, sizeof(buf), format, ap);
 
-  HUART_u8SendSync(HUART_USART1,buf,strlen(buf),1);
+  len = strlen(buf);
+  while (queued < len)
+  {
+	  queued += HUART_u16Write(HUART_USART1,&buf[queued],len-queued);
+  }
   va_end (ap);
+  STATS_voidStop(STATS_TIME_LOGGING, start_cycles);
   return ret;
 }
+/*This function is used to wait for the msgs queued by printmsg1 to be sent, before a reset or a jump*/
+void flushmsg1(void)
+{
+	HUART_u8FlushTX(HUART_USART1,PRINTMSG1_FLUSH_TIMEOUT_MS);
+}
 /*This function is used to print msgs through uart2*/
 u16 printmsg2(const char* format, ...)
 {
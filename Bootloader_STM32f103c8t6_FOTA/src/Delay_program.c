@@ -74,3 +74,10 @@ void delay_us(u32 time)
 
 	}
 }
+
+u32 delay_u32GetCPUclock(void)
+{
+	/*Check for current clock*/
+	delay_setCPUclockFactor();
+	return CPU_CLOCK;
+}
@@ -7,6 +7,8 @@
 
 #include "STD_TYPES.h"
 #include "Flash.h"
+#include "STATS_interface.h"
+#include "TRACE_interface.h"
 
 #ifndef  SCB_BASE_ADDRESS
 #define  SCB_BASE_ADDRESS       			0xE000ED00
@@ -181,7 +183,9 @@ extern ErrorStatus FLASH_WriteProgram (void* srcAddress, void* destAddress, u32
 {
 	u8 error_status = STD_TYPES_ERROR_NOK;
 	u32 index;
+	u32 start_cycles = STATS_u32Start();
 
+	TRACE_voidRecord(TRACE_EVENT_FLASH_PROGRAM, TRACE_PHASE_BEGIN, (u16)numberOfBytes);
 	while(FLASH_SR & FLASH_SR_BSY);					/*wait for busy bit to be cleared*/
 
 	FLASH_CR |= FLASH_CR_PG;						/*Flash Programming enabled*/
@@ -198,6 +202,10 @@ extern ErrorStatus FLASH_WriteProgram (void* srcAddress, void* destAddress, u32
 
 	FLASH_CR &=~ FLASH_CR_PG;						/*Flash Programming disabled*/
 
+	STATS_voidStop(STATS_TIME_FLASH_PROGRAM, start_cycles);
+	TRACE_voidRecord(TRACE_EVENT_FLASH_PROGRAM, TRACE_PHASE_END, (u16)numberOfBytes);
+	STATS_voidCount(STATS_BYTES_PROGRAMMED, numberOfBytes);
+
 	for(index=0; index<(numberOfBytes/4); index++)  /*looping for quarter the number of bytes chosen by the user,
 													  since we are reading 4 bytes at a time*/
 	{
@@ -223,7 +231,9 @@ return error_status;
 extern ErrorStatus FLASH_PageErase   (u32 pageAddress)
 {
 	volatile u8 error_status = STD_TYPES_ERROR_NOK;
+	u32 start_cycles = STATS_u32Start();
 
+	TRACE_voidRecord(TRACE_EVENT_FLASH_ERASE, TRACE_PHASE_BEGIN, (u16)((pageAddress-FLASH_MEMORY_BASE_ADDRESS)/1024));
 	FLASH_CR |= FLASH_CR_PER;						/*page erase enable*/
 
 	FLASH_AR  = pageAddress; 						/*passing the required destination address*/
@@ -237,6 +247,10 @@ extern ErrorStatus FLASH_PageErase   (u32 pageAddress)
 
 	FLASH_CR &=~ FLASH_CR_PER;						/*page erase disable*/
 
+	STATS_voidStop(STATS_TIME_FLASH_ERASE, start_cycles);
+	STATS_voidCount(STATS_PAGES_ERASED, 1);
+	TRACE_voidRecord(TRACE_EVENT_FLASH_ERASE, TRACE_PHASE_END, (u16)((pageAddress-FLASH_MEMORY_BASE_ADDRESS)/1024));
+
 	if(*((u32*)pageAddress) == 0xFFFFFFFF) error_status = STD_TYPES_ERROR_OK; /*verifying*/
 
 return error_status;
@@ -246,7 +260,9 @@ extern ErrorStatus FLASH_MultiplePageErase   		(u32 pageAddress, u8 numberOfPage
 {
 	u8 error_status = STD_TYPES_ERROR_NOK;
 	u32 index;
+	u32 start_cycles = STATS_u32Start();
 
+	TRACE_voidRecord(TRACE_EVENT_FLASH_ERASE, TRACE_PHASE_BEGIN, (u16)((pageAddress-FLASH_MEMORY_BASE_ADDRESS)/1024));
 	FLASH_CR |= FLASH_CR_PER;						/*page erase enable*/
 
 	for(index=0;index<numberOfPages;index++)
@@ -261,6 +277,10 @@ extern ErrorStatus FLASH_MultiplePageErase   		(u32 pageAddress, u8 numberOfPage
 
 	FLASH_CR &=~ FLASH_CR_PER;							/*page erase disable*/
 
+	STATS_voidStop(STATS_TIME_FLASH_ERASE, start_cycles);
+	STATS_voidCount(STATS_PAGES_ERASED, numberOfPages);
+	TRACE_voidRecord(TRACE_EVENT_FLASH_ERASE, TRACE_PHASE_END, (u16)((pageAddress-FLASH_MEMORY_BASE_ADDRESS)/1024));
+
 	for(index=0;index<(numberOfPages*256);index++)
 	{
 		if(*((u32*)(pageAddress+index)) == 0xFFFFFFFF) error_status = STD_TYPES_ERROR_OK; /*verifying*/
@@ -282,12 +302,18 @@ extern ErrorStatus FLASH_MassErase    				(void)
 {
 	u8 error_status = STD_TYPES_ERROR_NOK;
 	u32 index;
+	u32 start_cycles = STATS_u32Start();
 
+	TRACE_voidRecord(TRACE_EVENT_FLASH_ERASE, TRACE_PHASE_BEGIN, 0);
 	FLASH_CR |=  FLASH_CR_MER;		/*Mass erase enabled*/
 	FLASH_CR |=  FLASH_CR_STRT;		/*start erase operation*/
 	while(FLASH_SR & FLASH_SR_BSY);	/*wait for busy bit to be cleared*/
 	FLASH_CR &=~ FLASH_CR_MER;		/*Mass erase disabled*/
 
+	STATS_voidStop(STATS_TIME_FLASH_ERASE, start_cycles);
+	STATS_voidCount(STATS_PAGES_ERASED, 64);
+	TRACE_voidRecord(TRACE_EVENT_FLASH_ERASE, TRACE_PHASE_END, 0);
+
 	for(index=0;index<(64*256);index++)
 	{
 		if(*((u32*)(FLASH_MEMORY_BASE_ADDRESS+index)) == 0xFFFFFFFF) error_status = STD_TYPES_ERROR_OK; /*verifying*/
@@ -0,0 +1,94 @@
+/*
+ * HEX_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "HEX_interface.h"
+#include <string.h>
+
+#define X		HEX_INVALID_CHAR
+
+const u8 HEX_u8DecodeTable[256]=
+{
+	X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,  X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+	X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,  0,1,2,3,4,5,6,7,8,9,X,X,X,X,X,X,			/*'0'..'9'*/
+	X,10,11,12,13,14,15,X,X,X,X,X,X,X,X,X,  X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,	/*'A'..'F'*/
+	X,10,11,12,13,14,15,X,X,X,X,X,X,X,X,X,  X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,	/*'a'..'f'*/
+	X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,  X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+	X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,  X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+	X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,  X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,
+	X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,  X,X,X,X,X,X,X,X,X,X,X,X,X,X,X,X
+};
+
+#undef X
+
+const u8 HEX_u8EncodeTable[16]={'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
+
+/*Description: This API will convert chars to bytes, two chars per byte, four chars are loaded at once
+ * the output may overlap the input as long as it starts at the same address or before it
+ * parameters: chars (u8*), bytes (u8*), number of bytes to produce (u16)
+ * Return: Error Status (NOK if any char is not a hex digit, the bytes are then not to be trusted)*/
+u8 HEX_u8Decode (const u8* Copy_pu8Chars, u8* Copy_pu8Bytes, u16 Copy_u16NumOfBytes)
+{
+	/*All nibbles are ORed here, a valid nibble never sets the upper 4 bits so one check at the end covers every char*/
+	u8  Local_u8Check=0;
+	u8  Local_u8Nibble0, Local_u8Nibble1, Local_u8Nibble2, Local_u8Nibble3;
+	u32 Local_u32Chars=0;
+
+	/*Two bytes per loop, the four chars are one (unaligned) word load on Cortex-M3*/
+	while (Copy_u16NumOfBytes>=2)
+	{
+		memcpy(&Local_u32Chars, Copy_pu8Chars, 4);
+		Local_u8Nibble0 = HEX_u8DecodeTable[(u8) Local_u32Chars     ];
+		Local_u8Nibble1 = HEX_u8DecodeTable[(u8)(Local_u32Chars>>8) ];
+		Local_u8Nibble2 = HEX_u8DecodeTable[(u8)(Local_u32Chars>>16)];
+		Local_u8Nibble3 = HEX_u8DecodeTable[(u8)(Local_u32Chars>>24)];
+		Local_u8Check  |= Local_u8Nibble0 | Local_u8Nibble1 | Local_u8Nibble2 | Local_u8Nibble3;
+
+		Copy_pu8Bytes[0] = (u8)((Local_u8Nibble0<<4) | Local_u8Nibble1);
+		Copy_pu8Bytes[1] = (u8)((Local_u8Nibble2<<4) | Local_u8Nibble3);
+
+		Copy_pu8Chars      +=4;
+		Copy_pu8Bytes      +=2;
+		Copy_u16NumOfBytes -=2;
+	}
+	if (Copy_u16NumOfBytes)
+	{
+		Local_u8Nibble0 = HEX_u8DecodeTable[Copy_pu8Chars[0]];
+		Local_u8Nibble1 = HEX_u8DecodeTable[Copy_pu8Chars[1]];
+		Local_u8Check  |= Local_u8Nibble0 | Local_u8Nibble1;
+		Copy_pu8Bytes[0] = (u8)((Local_u8Nibble0<<4) | Local_u8Nibble1);
+	}
+
+	return (Local_u8Check & 0xF0)? STATUS_NOK : STATUS_OK;
+}
+
+/*Description: This API will convert bytes to chars, two chars per byte, four chars are stored at once
+ * parameters: bytes (u8*), chars (u8*), number of bytes to convert (u16)
+ * Return: void*/
+void HEX_voidEncode (const u8* Copy_pu8Bytes, u8* Copy_pu8Chars, u16 Copy_u16NumOfBytes)
+{
+	u32 Local_u32Chars;
+
+	/*Two bytes per loop, the four chars are assembled in a register and stored as one word*/
+	while (Copy_u16NumOfBytes>=2)
+	{
+		Local_u32Chars = ((u32)HEX_u8EncodeTable[Copy_pu8Bytes[0]>>4]        ) |
+						 ((u32)HEX_u8EncodeTable[Copy_pu8Bytes[0]&0x0F] << 8 ) |
+						 ((u32)HEX_u8EncodeTable[Copy_pu8Bytes[1]>>4]   << 16) |
+						 ((u32)HEX_u8EncodeTable[Copy_pu8Bytes[1]&0x0F] << 24);
+		memcpy(Copy_pu8Chars, &Local_u32Chars, 4);
+
+		Copy_pu8Bytes      +=2;
+		Copy_pu8Chars      +=4;
+		Copy_u16NumOfBytes -=2;
+	}
+	if (Copy_u16NumOfBytes)
+	{
+		Copy_pu8Chars[0] = HEX_u8EncodeTable[Copy_pu8Bytes[0]>>4];
+		Copy_pu8Chars[1] = HEX_u8EncodeTable[Copy_pu8Bytes[0]&0x0F];
+	}
+}
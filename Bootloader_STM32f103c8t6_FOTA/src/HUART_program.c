@@ -3,9 +3,14 @@
  *
  *  Created on: June 4, 2020
  *      Author: Mahmoud Hamdy
- *      Version: 2.0
+ *      Version: 2.1
  */
 
+/*Changelog from version 2.0:
+ * 1) Added RTS and CTS pins to the peripheral objects and HUART_u8SetFlowControl for hardware flow control
+ * 2) Added HUART_u8GetErrors to read the receive errors counted by the IRQs
+ * */
+
 /*Changelog from version 1.1:
  * 1) Removed Deparcated Macros (related to baudrate)
  * 2) Changed the flags for the IRQ because there were bugs in it
@@ -31,6 +36,8 @@
 
 		.TX = {GPIOA, GPIO_PIN_9,GPIO_OUTPUT_SPEED_50MHz ,GPIO_MODE_OUTPUT_ALTERNATE_FUNCTION_PUSH_PULL },
 		.RX = {GPIOA, GPIO_PIN_10,GPIO_INPUT_MODE_RESET_STATE ,GPIO_MODE_INPUT_PULLUP_PULLDOWN },
+		.RTS = {GPIOA, GPIO_PIN_12, GPIO_OUTPUT_SPEED_50MHz ,GPIO_MODE_OUTPUT_ALTERNATE_FUNCTION_PUSH_PULL },
+		.CTS = {GPIOA, GPIO_PIN_11,GPIO_INPUT_MODE_RESET_STATE ,GPIO_MODE_INPUT_PULLUP_PULLDOWN },
 		.Port = RCC_PERIPHERALS_PORTA,
 		.PeripheralClockName = RCC_PERIPHERALS_USART1,
 		.InterruptPeripheralName = NVIC_USART1,
@@ -39,6 +46,8 @@
  const UART_GPIO_t HUART_USART2 = {
  		.TX = {GPIOA, GPIO_PIN_2, GPIO_OUTPUT_SPEED_50MHz ,GPIO_MODE_OUTPUT_ALTERNATE_FUNCTION_PUSH_PULL},
  		.RX = {GPIOA, GPIO_PIN_3,GPIO_INPUT_MODE_RESET_STATE ,GPIO_MODE_INPUT_PULLUP_PULLDOWN},
+ 		.RTS = {GPIOA, GPIO_PIN_1, GPIO_OUTPUT_SPEED_50MHz ,GPIO_MODE_OUTPUT_ALTERNATE_FUNCTION_PUSH_PULL},
+ 		.CTS = {GPIOA, GPIO_PIN_0,GPIO_INPUT_MODE_RESET_STATE ,GPIO_MODE_INPUT_PULLUP_PULLDOWN},
  		.Port = RCC_PERIPHERALS_PORTA,
  		.PeripheralClockName = RCC_PERIPHERALS_USART2,
  		.InterruptPeripheralName = NVIC_USART2,
@@ -47,6 +56,8 @@
  const UART_GPIO_t HUART_USART3 = {
  		.TX = {GPIOB, GPIO_PIN_10, GPIO_OUTPUT_SPEED_50MHz ,GPIO_MODE_OUTPUT_ALTERNATE_FUNCTION_PUSH_PULL},
  		.RX = {GPIOB, GPIO_PIN_11,GPIO_INPUT_MODE_RESET_STATE ,GPIO_MODE_INPUT_PULLUP_PULLDOWN},
+ 		.RTS = {GPIOB, GPIO_PIN_14, GPIO_OUTPUT_SPEED_50MHz ,GPIO_MODE_OUTPUT_ALTERNATE_FUNCTION_PUSH_PULL},
+ 		.CTS = {GPIOB, GPIO_PIN_13,GPIO_INPUT_MODE_RESET_STATE ,GPIO_MODE_INPUT_PULLUP_PULLDOWN},
  		.Port = RCC_PERIPHERALS_PORTB,
  		.PeripheralClockName = RCC_PERIPHERALS_USART3,
  		.InterruptPeripheralName = NVIC_USART3,
@@ -229,71 +240,157 @@ u8 HUART_u8EnableInterrupt(UART_GPIO_t Copy_u32PeripheralNumber, u32 Copy_u32Des
 
 /*Description: This API will be used to pass data buffer for sending using interrupts.
  * It will check that the data buffer and size passed by user are proper and if everything is right, it will call the UART_send function
- * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u8)
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
  * Return: Error Status (u8)  */
-u8 HUART_u8SendAsync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u8 Copy_u8Size)
+u8 HUART_u8SendAsync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size)
 {
 	/*This local variable will hold the status that will be returned at the end*/
 	u8 Local_u8Status = STATUS_NOK;
 	/*Check that data buffer exists and that the size is not zero*/
-	if (Copy_u8Buffer && Copy_u8Size!=0)
+	if (Copy_u8Buffer && Copy_u16Size!=0)
+	{
+		/*Call Send Function*/
+		Local_u8Status = UART_voidSendAsync(Copy_u32PeripheralNumber.BaseAddress, Copy_u8Buffer, Copy_u16Size);
+	}
+	return Local_u8Status;
+}
+
+/*Description: This API will be used to send several buffers back to back using interrupts, without copying them together
+ * The data of every segment must stay unchanged until the sending is done, the segments array itself is copied
+ * Parameters: Desired UART (struct), segments (UART_Segment_t*), number of segments (u8, up to UART_GATHER_MAX_SEGMENTS)
+ * Return: Error Status (u8)  */
+u8 HUART_u8SendGatherAsync(UART_GPIO_t Copy_u32PeripheralNumber, const UART_Segment_t* Copy_pSegments, u8 Copy_u8Count)
+{
+	/*This local variable will hold the status that will be returned at the end*/
+	u8 Local_u8Status = STATUS_NOK;
+	/*Check that segments exist and that their number is not zero*/
+	if (Copy_pSegments && Copy_u8Count!=0)
 	{
 		/*Call Send Function*/
-		UART_voidSendAsync(Copy_u32PeripheralNumber.BaseAddress, Copy_u8Buffer, Copy_u8Size);
-		Local_u8Status = STATUS_OK;
+		Local_u8Status = UART_u8SendGatherAsync(Copy_u32PeripheralNumber.BaseAddress, Copy_pSegments, Copy_u8Count);
 	}
 	return Local_u8Status;
 }
 
 /*Description: This API will be used to pass data buffer for receiving using interrupts.
  * It will check that the data buffer and size passed by user are proper and if everything is right, it will call the UART_receive function
- * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u8)
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
  * Return: Error Status (u8)  */
- u8 HUART_u8ReceiveAsync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u8 Copy_u8Size)
+ u8 HUART_u8ReceiveAsync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size)
 {
 	 /*This local variable will hold the status that will be returned at the end*/
 	 	u8 Local_u8Status = STATUS_NOK;
 	 	/*Check that data buffer exists and that the size is not zero*/
-	 	if (Copy_u8Buffer && Copy_u8Size!=0)
+	 	if (Copy_u8Buffer && Copy_u16Size!=0)
 	 	{
 	 		/*Call Send Function*/
-	 		Local_u8Status = UART_u8ReceiveAsync(Copy_u32PeripheralNumber.BaseAddress ,Copy_u8Buffer, Copy_u8Size);
+	 		Local_u8Status = UART_u8ReceiveAsync(Copy_u32PeripheralNumber.BaseAddress ,Copy_u8Buffer, Copy_u16Size);
 	 	}
 	 	return Local_u8Status;
 }
 
  /*Description: This API will be used to pass data buffer for sending using polling.
-  * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u8), desired time between frames (u32)
+  * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16), timeout for each frame in ms (u32, 0 waits for ever)
   * Return: Error Status (u8)  */
-u8 HUART_u8SendSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u8 Copy_u8Size, u32 Copy_u32Time)
+u8 HUART_u8SendSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32Time)
 {
 	/*This local variable will hold the status that will be returned at the end*/
 	u8 Local_u8Status = STATUS_NOK;
 	/*Check that data buffer exists and that the size is not zero*/
-	if (Copy_u8Buffer && Copy_u8Size!=0)
+	if (Copy_u8Buffer && Copy_u16Size!=0)
 	{
 		/*Call Send Function*/
-		UART_voidSendSync(Copy_u32PeripheralNumber.BaseAddress, Copy_u8Buffer, Copy_u8Size, Copy_u32Time);
-		Local_u8Status = STATUS_OK;
+		Local_u8Status = UART_u8SendSync(Copy_u32PeripheralNumber.BaseAddress, Copy_u8Buffer, Copy_u16Size, Copy_u32Time);
 	}
 	return Local_u8Status;
 }
  /*Description: This API will be used to pass data buffer for receiving using polling.
-  * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u8)
+  * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
   * Return: Error Status (u8)  */
-u8 HUART_u8ReceiveSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u8 Copy_u8Size, u32 Copy_u32Time)
+u8 HUART_u8ReceiveSync(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32Time)
 {
 	 /*This local variable will hold the status that will be returned at the end*/
 	 	u8 Local_u8Status = STATUS_NOK;
 	 	/*Check that data buffer exists and that the size is not zero*/
-	 	if (Copy_u8Buffer && Copy_u8Size!=0)
+	 	if (Copy_u8Buffer && Copy_u16Size!=0)
 	 	{
 	 		/*Call Send Function*/
-	 		Local_u8Status = UART_u8ReceiveSync(Copy_u32PeripheralNumber.BaseAddress ,Copy_u8Buffer, Copy_u8Size, Copy_u32Time);
+	 		Local_u8Status = UART_u8ReceiveSync(Copy_u32PeripheralNumber.BaseAddress ,Copy_u8Buffer, Copy_u16Size, Copy_u32Time);
 	 	}
 	 	return Local_u8Status;
 }
 
+/*Description: This API will make received bytes go to the rx ring of the peripheral (emptied first), they are taken with HUART_u16Read
+ * Parameters: Desired UART (struct)
+ * Return: Error Status (u8)  */
+u8 HUART_u8StartRXRing(UART_GPIO_t Copy_u32PeripheralNumber)
+{
+	/*Call Function from driver directly*/
+	return UART_u8StartRXRing(Copy_u32PeripheralNumber.BaseAddress);
+}
+
+/*Description: This API will stop putting received bytes in the rx ring
+ * Parameters: Desired UART (struct)
+ * Return: None  */
+void HUART_voidStopRXRing(UART_GPIO_t Copy_u32PeripheralNumber)
+{
+	/*Call Function from driver directly*/
+	UART_voidStopRXRing(Copy_u32PeripheralNumber.BaseAddress);
+}
+
+/*Description: This API will take the received bytes waiting in the rx ring, up to the size of the buffer, without waiting
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
+ * Return: number of bytes taken (u16)  */
+u16 HUART_u16Read(UART_GPIO_t Copy_u32PeripheralNumber, u8 *Copy_u8Buffer, u16 Copy_u16Size)
+{
+	/*Check that data buffer exists before taking anything from the ring*/
+	if (Copy_u8Buffer == NULL)
+	{
+		return 0;
+	}
+	return UART_u16Read(Copy_u32PeripheralNumber.BaseAddress, Copy_u8Buffer, Copy_u16Size);
+}
+
+/*Description: This API will drop the received bytes that were not read yet
+ * Parameters: Desired UART (struct)
+ * Return: None  */
+void HUART_voidFlushRX(UART_GPIO_t Copy_u32PeripheralNumber)
+{
+	/*Call Function from driver directly*/
+	UART_voidFlushRX(Copy_u32PeripheralNumber.BaseAddress);
+}
+
+/*Description: This API will give the number of received bytes dropped because the rx ring was full, since reset
+ * Parameters: Desired UART (struct)
+ * Return: number of bytes dropped (u16)  */
+u16 HUART_u16GetRXDropped(UART_GPIO_t Copy_u32PeripheralNumber)
+{
+	/*Call Function from driver directly*/
+	return UART_u16GetRXDropped(Copy_u32PeripheralNumber.BaseAddress);
+}
+
+/*Description: This API will queue bytes in the tx ring without waiting, they are sent by interrupts
+ * Parameters: Desired UART (struct), Pointer to Data Buffer (u8*), size of data buffer (u16)
+ * Return: number of bytes queued (u16)  */
+u16 HUART_u16Write(UART_GPIO_t Copy_u32PeripheralNumber, const u8 *Copy_u8Buffer, u16 Copy_u16Size)
+{
+	/*Check that data buffer exists before queuing anything*/
+	if (Copy_u8Buffer == NULL)
+	{
+		return 0;
+	}
+	return UART_u16Write(Copy_u32PeripheralNumber.BaseAddress, Copy_u8Buffer, Copy_u16Size);
+}
+
+/*Description: This API will wait until the bytes queued in the tx ring are on the wire
+ * Parameters: Desired UART (struct), timeout in ms (u32, 0 waits for ever)
+ * Return: Error Status (u8)  */
+u8 HUART_u8FlushTX(UART_GPIO_t Copy_u32PeripheralNumber, u32 Copy_u32Time)
+{
+	/*Call Function from driver directly*/
+	return UART_u8FlushTX(Copy_u32PeripheralNumber.BaseAddress, Copy_u32Time);
+}
+
 /*Description: This function can be used to terminate async receiving (Warning!: Don't use it unless you know what you are doing)
  * Parameters: Desired UART Peripheral address (u32)
  * return: None*/
@@ -312,4 +409,31 @@ void HUART_voidTerminateSending (u32 Copy_u32DesiredUARTBaseAddress)
 	UART_voidTerminateSending (Copy_u32DesiredUARTBaseAddress);
 }
 
+/*Description: This API will enable or disable hardware flow control and configure the pins it uses
+ * (USART1 RTS PA12 CTS PA11, USART2 RTS PA1 CTS PA0, USART3 RTS PB14 CTS PB13)
+ * Parameters: Desired UART (struct), flow control (u8, HUART_FLOW_CONTROL_...)
+ * Return: Error Status (u8)  */
+u8 HUART_u8SetFlowControl(UART_GPIO_t Copy_u32PeripheralNumber, u8 Copy_u8FlowControl)
+{
+	if (Copy_u8FlowControl & HUART_FLOW_CONTROL_RTS)
+	{
+		GPIO_Init(&Copy_u32PeripheralNumber.RTS);
+	}
+	if (Copy_u8FlowControl & HUART_FLOW_CONTROL_CTS)
+	{
+		GPIO_Init(&Copy_u32PeripheralNumber.CTS);
+		/*Pulled low : with the CTS wire missing the peripheral keeps sending as without flow control, instead of stalling*/
+		GPIO_Pin_Write(&Copy_u32PeripheralNumber.CTS,LOW);
+	}
+	/*Call Function from driver directly*/
+	return UART_u8SetFlowControl(Copy_u32PeripheralNumber.BaseAddress, Copy_u8FlowControl);
+}
 
+/*Description: This API will give the overrun, noise and framing errors counted since reset
+ * Parameters: Desired UART (struct), counters (UART_Errors_t*)
+ * Return: Error Status (u8)  */
+u8 HUART_u8GetErrors(UART_GPIO_t Copy_u32PeripheralNumber, UART_Errors_t* Copy_pErrors)
+{
+	/*Call Function from driver directly*/
+	return UART_u8GetErrors(Copy_u32PeripheralNumber.BaseAddress, Copy_pErrors);
+}
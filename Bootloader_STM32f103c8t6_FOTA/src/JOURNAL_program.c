@@ -0,0 +1,118 @@
+/*
+ * JOURNAL_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "Flash.h"
+#include "JOURNAL_interface.h"
+
+/*Header: magic (written last), base address, size and image CRC*/
+#define JOURNAL_MAGIC							((u32)0x4E524A44)		/*"DJRN"*/
+#define JOURNAL_HEADER_SIZE						16U
+#define JOURNAL_PAGE_SIZE						(1 K)
+#define JOURNAL_ERASED_WORD						((u32)0xFFFFFFFF)
+
+#define JOURNAL_MAGIC_WORD						(*((volatile u32*)(JOURNAL_PAGE)))
+#define JOURNAL_BASE_WORD						(*((volatile u32*)(JOURNAL_PAGE+4)))
+#define JOURNAL_SIZE_WORD						(*((volatile u32*)(JOURNAL_PAGE+8)))
+#define JOURNAL_CRC_WORD						(*((volatile u32*)(JOURNAL_PAGE+12)))
+#define JOURNAL_FIRST_ENTRY						(JOURNAL_PAGE+JOURNAL_HEADER_SIZE)
+#define JOURNAL_LAST_ENTRY						(JOURNAL_PAGE+JOURNAL_PAGE_SIZE-4)
+
+/*Every entry holds the number of steps done in the lower half-word and its complement in the upper one,
+ * an entry torn by a power failure does not match its complement and is ignored*/
+#define JOURNAL_ENTRY(STEPS)					(((u32)(STEPS)&0xFFFF) | ((~(u32)(STEPS))<<16))
+#define JOURNAL_ENTRY_IS_VALID(ENTRY)			((((ENTRY)>>16)^((ENTRY)&0xFFFF)) == 0xFFFF)
+
+/*Returns the address of the first erased entry, (JOURNAL_LAST_ENTRY+4) if the page is full
+ * and the number of steps of the newest valid entry in (Copy_pu32StepsDone)*/
+static u32 JOURNAL_u32ScanEntries (u32* Copy_pu32StepsDone)
+{
+	u32 Local_u32Address;
+	u32 Local_u32Entry;
+
+	*Copy_pu32StepsDone = 0;
+	for (Local_u32Address=JOURNAL_FIRST_ENTRY; Local_u32Address<=JOURNAL_LAST_ENTRY; Local_u32Address+=4)
+	{
+		Local_u32Entry = *((volatile u32*)Local_u32Address);
+		if (Local_u32Entry == JOURNAL_ERASED_WORD) break;
+		if (JOURNAL_ENTRY_IS_VALID(Local_u32Entry)) *Copy_pu32StepsDone = Local_u32Entry&0xFFFF;
+	}
+	return Local_u32Address;
+}
+
+u8 JOURNAL_u8Start (u32 Copy_u32BaseAddress, u32 Copy_u32SizeInBytes, u32 Copy_u32ImageCrc, u32* Copy_pu32ResumeOffset)
+{
+	u32 Local_u32StepsDone;
+
+	if (Copy_pu32ResumeOffset == NULL) return STATUS_NOK;
+	*Copy_pu32ResumeOffset = 0;
+
+	if ((JOURNAL_MAGIC_WORD == JOURNAL_MAGIC) && (JOURNAL_BASE_WORD == Copy_u32BaseAddress) &&
+		(JOURNAL_SIZE_WORD == Copy_u32SizeInBytes) && (JOURNAL_CRC_WORD == Copy_u32ImageCrc))
+	{
+		JOURNAL_u32ScanEntries(&Local_u32StepsDone);
+		*Copy_pu32ResumeOffset = Local_u32StepsDone*JOURNAL_STEP_SIZE;
+		/*The last step of an image may be shorter than a page*/
+		if (*Copy_pu32ResumeOffset > Copy_u32SizeInBytes) *Copy_pu32ResumeOffset = Copy_u32SizeInBytes;
+		return STATUS_OK;
+	}
+
+	if (JOURNAL_u8Clear() != STATUS_OK) return STATUS_NOK;
+	if ((FLASH_WriteWord((void*)(JOURNAL_PAGE+4),  Copy_u32BaseAddress) != STD_TYPES_ERROR_OK) ||
+		(FLASH_WriteWord((void*)(JOURNAL_PAGE+8),  Copy_u32SizeInBytes) != STD_TYPES_ERROR_OK) ||
+		(FLASH_WriteWord((void*)(JOURNAL_PAGE+12), Copy_u32ImageCrc)    != STD_TYPES_ERROR_OK) ||
+		(FLASH_WriteWord((void*)JOURNAL_PAGE,      JOURNAL_MAGIC)       != STD_TYPES_ERROR_OK))
+	{
+		return STATUS_NOK;
+	}
+	return STATUS_OK;
+}
+
+u8 JOURNAL_u8CommitProgress (u32 Copy_u32BytesDone)
+{
+	u32 Local_u32StepsDone;
+	u32 Local_u32FreeEntry;
+
+	if (JOURNAL_MAGIC_WORD != JOURNAL_MAGIC) return STATUS_NOK;
+
+	Local_u32FreeEntry = JOURNAL_u32ScanEntries(&Local_u32StepsDone);
+	/*No more room, the download still goes on but an interruption will restart from the last saved entry*/
+	if (Local_u32FreeEntry > JOURNAL_LAST_ENTRY) return STATUS_NOK;
+
+	Local_u32StepsDone = (Copy_u32BytesDone+JOURNAL_STEP_SIZE-1)/JOURNAL_STEP_SIZE;
+	return (FLASH_WriteWord((void*)Local_u32FreeEntry, JOURNAL_ENTRY(Local_u32StepsDone)) == STD_TYPES_ERROR_OK)? STATUS_OK : STATUS_NOK;
+}
+
+u8 JOURNAL_u8Clear (void)
+{
+	u16 Local_u16Index;
+
+	/*Skip the erase if the page is already erased*/
+	for (Local_u16Index=0; Local_u16Index<(JOURNAL_PAGE_SIZE/4); Local_u16Index++)
+	{
+		if (*((volatile u32*)JOURNAL_PAGE+Local_u16Index) != JOURNAL_ERASED_WORD)
+		{
+			return (FLASH_PageErase(JOURNAL_PAGE) == STD_TYPES_ERROR_OK)? STATUS_OK : STATUS_NOK;
+		}
+	}
+	return STATUS_OK;
+}
+
+u8 JOURNAL_u8GetProgress (JOURNAL_Progress_t* Copy_pProgress)
+{
+	u32 Local_u32StepsDone;
+
+	if ((Copy_pProgress == NULL) || (JOURNAL_MAGIC_WORD != JOURNAL_MAGIC)) return STATUS_NOK;
+
+	JOURNAL_u32ScanEntries(&Local_u32StepsDone);
+	Copy_pProgress->baseAddress = JOURNAL_BASE_WORD;
+	Copy_pProgress->sizeInBytes = JOURNAL_SIZE_WORD;
+	Copy_pProgress->imageCrc    = JOURNAL_CRC_WORD;
+	Copy_pProgress->bytesDone   = Local_u32StepsDone*JOURNAL_STEP_SIZE;
+	if (Copy_pProgress->bytesDone > Copy_pProgress->sizeInBytes) Copy_pProgress->bytesDone = Copy_pProgress->sizeInBytes;
+	return STATUS_OK;
+}
@@ -0,0 +1,99 @@
+/*
+ * POOL_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "POOL_interface.h"
+#include <string.h>
+
+/*Blocks storage, declared as words so that every block is word aligned (CRC unit and flash programming read words)*/
+static u32 POOL_u32SmallBlocks[POOL_SMALL_BLOCKS*POOL_SMALL_BLOCK_SIZE/4];
+static u32 POOL_u32PageBlocks [POOL_PAGE_BLOCKS *POOL_PAGE_BLOCK_SIZE/4];
+static u32 POOL_u32CharsBlocks[POOL_CHARS_BLOCKS*POOL_CHARS_BLOCK_SIZE/4];
+
+static u8* const POOL_pu8Base[POOL_COUNT] = {(u8*)POOL_u32SmallBlocks, (u8*)POOL_u32PageBlocks, (u8*)POOL_u32CharsBlocks};
+
+/*One bit per block, set while the block is taken*/
+static u8 POOL_u8Taken[POOL_COUNT];
+
+static POOL_Stats_t POOL_Stats[POOL_COUNT] = {
+		{POOL_SMALL_BLOCK_SIZE, 0, 0, POOL_SMALL_BLOCKS, 0, 0},
+		{POOL_PAGE_BLOCK_SIZE , 0, 0, POOL_PAGE_BLOCKS , 0, 0},
+		{POOL_CHARS_BLOCK_SIZE, 0, 0, POOL_CHARS_BLOCKS, 0, 0}
+};
+
+/*Description: This API will take a zeroed block that can hold (Copy_u16Size) bytes
+ * parameters: size (u16)
+ * Return: block, NULL if no pool has a free block large enough*/
+void* POOL_pvAlloc (u16 Copy_u16Size)
+{
+	u8  Local_u8Pool;
+	u8  Local_u8Block;
+	u8  Local_u8Fits = 0;
+	u8* Local_pu8Block;
+
+	for (Local_u8Pool=0; Local_u8Pool<POOL_COUNT; Local_u8Pool++)
+	{
+		if (POOL_Stats[Local_u8Pool].blockSize < Copy_u16Size) continue;
+		/*The request is accounted to the first pool it fits in, the one that should be sized for it*/
+		if (!Local_u8Fits)
+		{
+			Local_u8Fits = 1;
+			if (Copy_u16Size > POOL_Stats[Local_u8Pool].largestRequest) POOL_Stats[Local_u8Pool].largestRequest = Copy_u16Size;
+			if (POOL_Stats[Local_u8Pool].inUse == POOL_Stats[Local_u8Pool].blocks) POOL_Stats[Local_u8Pool].exhausted++;
+		}
+		for (Local_u8Block=0; Local_u8Block<POOL_Stats[Local_u8Pool].blocks; Local_u8Block++)
+		{
+			if (POOL_u8Taken[Local_u8Pool] & (1<<Local_u8Block)) continue;
+
+			POOL_u8Taken[Local_u8Pool] |= (1<<Local_u8Block);
+			POOL_Stats[Local_u8Pool].inUse++;
+			if (POOL_Stats[Local_u8Pool].inUse > POOL_Stats[Local_u8Pool].peakInUse)
+				POOL_Stats[Local_u8Pool].peakInUse = POOL_Stats[Local_u8Pool].inUse;
+
+			Local_pu8Block = POOL_pu8Base[Local_u8Pool]+(u32)Local_u8Block*POOL_Stats[Local_u8Pool].blockSize;
+			memset(Local_pu8Block, 0, POOL_Stats[Local_u8Pool].blockSize);
+			return Local_pu8Block;
+		}
+	}
+	return NULL;
+}
+
+/*Description: This API will give a block back to its pool, NULL is ignored
+ * parameters: block (void*)
+ * Return: void*/
+void POOL_voidFree (void* Copy_pvBlock)
+{
+	u8  Local_u8Pool;
+	u32 Local_u32Offset;
+	u8  Local_u8Block;
+
+	for (Local_u8Pool=0; Local_u8Pool<POOL_COUNT; Local_u8Pool++)
+	{
+		Local_u32Offset = (u8*)Copy_pvBlock-POOL_pu8Base[Local_u8Pool];
+		if ((u8*)Copy_pvBlock < POOL_pu8Base[Local_u8Pool] ||
+			Local_u32Offset >= (u32)POOL_Stats[Local_u8Pool].blocks*POOL_Stats[Local_u8Pool].blockSize) continue;
+
+		Local_u8Block = Local_u32Offset/POOL_Stats[Local_u8Pool].blockSize;
+		/*A block given back twice is not counted twice*/
+		if (POOL_u8Taken[Local_u8Pool] & (1<<Local_u8Block))
+		{
+			POOL_u8Taken[Local_u8Pool] &= ~(1<<Local_u8Block);
+			POOL_Stats[Local_u8Pool].inUse--;
+		}
+		return;
+	}
+}
+
+/*Description: This API will read the usage of one pool
+ * parameters: pool (POOL_SMALL ... POOL_CHARS), stats (POOL_Stats_t*)
+ * Return: Error Status*/
+u8 POOL_u8GetStats (u8 Copy_u8Pool, POOL_Stats_t* Copy_pStats)
+{
+	if (Copy_u8Pool >= POOL_COUNT) return STATUS_NOK;
+	*Copy_pStats = POOL_Stats[Copy_u8Pool];
+	return STATUS_OK;
+}
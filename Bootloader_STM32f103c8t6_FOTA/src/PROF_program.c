@@ -0,0 +1,140 @@
+/*
+ * PROF_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "PROF_interface.h"
+#include "Delay_interface.h"
+#include <string.h>
+
+/*SysTick registers*/
+#define STK_CTRL						*((volatile u32*)0xE000E010)
+#define STK_LOAD						*((volatile u32*)0xE000E014)
+#define STK_VAL							*((volatile u32*)0xE000E018)
+#define STK_CTRL_ENABLE					((u32)0x00000001)
+#define STK_CTRL_TICKINT				((u32)0x00000002)
+#define STK_CTRL_CLKSOURCE				((u32)0x00000004)		/*Processor clock (HCLK)*/
+
+/*Stacked exception frame : r0, r1, r2, r3, r12, lr, pc, xpsr*/
+#define PROF_FRAME_PC					6
+
+static volatile u32 static_u32Buckets[PROF_NUMBER_OF_BUCKETS];
+static volatile u32 static_u32Samples;
+static volatile u32 static_u32Outside;
+static u16 static_u16RateHz;
+static u8  static_u8Running;
+
+/*Called by SysTick_Handler with the frame stacked on exception entry*/
+void __attribute__ ((used)) PROF_voidSample (u32* Copy_pu32Frame)
+{
+	u32 Local_u32Offset = Copy_pu32Frame[PROF_FRAME_PC]-PROF_CODE_START;
+
+	static_u32Samples++;
+	/*Unsigned offset, addresses below the code start wrap to large values*/
+	if (Local_u32Offset < PROF_CODE_SIZE)
+	{
+		static_u32Buckets[Local_u32Offset>>PROF_BUCKET_SHIFT]++;
+	}
+	else
+	{
+		static_u32Outside++;
+	}
+}
+
+/*The frame is on the stack that was in use when SysTick fired (EXC_RETURN bit 2 tells which one),
+ * it is read before any register is pushed by C code*/
+void __attribute__ ((naked)) SysTick_Handler (void)
+{
+	asm volatile(
+		" tst lr,#4       \n"
+		" ite eq          \n"
+		" mrseq r0,msp    \n"
+		" mrsne r0,psp    \n"
+		" ldr r1,=PROF_voidSample \n"
+		" bx r1"
+	);
+}
+
+/*Description: This API will clear the histogram and start sampling
+ * parameters: samples per second (u16), from PROF_MIN_RATE to PROF_MAX_RATE
+ * Return: Error Status*/
+u8 PROF_u8Start (u16 Copy_u16RateHz)
+{
+	if ((Copy_u16RateHz < PROF_MIN_RATE) || (Copy_u16RateHz > PROF_MAX_RATE))
+	{
+		return STATUS_NOK;
+	}
+	PROF_voidStop();
+	PROF_voidClear();
+	static_u16RateHz = Copy_u16RateHz;
+	PROF_voidResume();
+	return STATUS_OK;
+}
+
+/*Description: This API will stop sampling, the histogram is kept
+ * parameters: void
+ * Return: void*/
+void PROF_voidStop (void)
+{
+	STK_CTRL = 0;
+	static_u8Running = 0;
+}
+
+/*Description: This API will start sampling again at the last rate without clearing the histogram
+ * parameters: void
+ * Return: void*/
+void PROF_voidResume (void)
+{
+	if (static_u16RateHz == 0)
+	{
+		return;
+	}
+	STK_LOAD = (delay_u32GetCPUclock()/static_u16RateHz)-1;
+	STK_VAL  = 0;
+	STK_CTRL = STK_CTRL_CLKSOURCE | STK_CTRL_TICKINT | STK_CTRL_ENABLE;
+	static_u8Running = 1;
+}
+
+/*Description: This API will clear the histogram
+ * parameters: void
+ * Return: void*/
+void PROF_voidClear (void)
+{
+	u8 Local_u8WasRunning = static_u8Running;
+
+	/*SysTick must not count a sample in the middle of the clear*/
+	PROF_voidStop();
+	memset((void*)static_u32Buckets, 0, sizeof(static_u32Buckets));
+	static_u32Samples = 0;
+	static_u32Outside = 0;
+	if (Local_u8WasRunning) PROF_voidResume();
+}
+
+/*Description: This API will give the state of the profiler
+ * parameters: rate in Hz, 0 when stopped (u16*), total samples (u32*), samples outside the bootloader code (u32*)
+ * Return: void*/
+void PROF_voidGetSummary (u16* Copy_pu16RateHz, u32* Copy_pu32Samples, u32* Copy_pu32Outside)
+{
+	*Copy_pu16RateHz  = static_u8Running? static_u16RateHz : 0;
+	*Copy_pu32Samples = static_u32Samples;
+	*Copy_pu32Outside = static_u32Outside;
+}
+
+/*Description: This API will find the next bucket holding samples
+ * parameters: bucket to start looking from (u16), number of samples of the bucket found (u32*)
+ * Return: index of the bucket found, PROF_NUMBER_OF_BUCKETS if there is none*/
+u16 PROF_u16NextBucket (u16 Copy_u16From, u32* Copy_pu32Samples)
+{
+	while ((Copy_u16From < PROF_NUMBER_OF_BUCKETS) && (static_u32Buckets[Copy_u16From] == 0))
+	{
+		Copy_u16From++;
+	}
+	if (Copy_u16From < PROF_NUMBER_OF_BUCKETS)
+	{
+		*Copy_pu32Samples = static_u32Buckets[Copy_u16From];
+	}
+	return Copy_u16From;
+}
@@ -0,0 +1,117 @@
+/*
+ * RING_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "RING_interface.h"
+
+/*The bytes must be stored (or read) before the index that publishes them is moved*/
+#define		RING_BARRIER()					__sync_synchronize()
+
+/*Description: This API will attach a storage array to a ring and empty it
+ * parameters: ring (RING_t*), storage (u8*), size of storage (u16, power of two)
+ * Return: Error Status (NOK if the size is not a power of two)*/
+u8 RING_u8Init (RING_t* Copy_pRing, u8* Copy_pu8Storage, u16 Copy_u16Size)
+{
+	if (Copy_pRing == NULL || Copy_pu8Storage == NULL) return STATUS_NOK;
+	if (Copy_u16Size < 2 || (Copy_u16Size & (Copy_u16Size-1))) return STATUS_NOK;
+
+	Copy_pRing->buffer  = Copy_pu8Storage;
+	Copy_pRing->mask    = Copy_u16Size-1;
+	Copy_pRing->head    = 0;
+	Copy_pRing->tail    = 0;
+	Copy_pRing->dropped = 0;
+	return STATUS_OK;
+}
+
+/*Description: This API will put one byte in the ring (producer side), the byte is counted as dropped if the ring is full
+ * parameters: ring (RING_t*), byte (u8)
+ * Return: Error Status (NOK if the ring is full)*/
+u8 RING_u8Put (RING_t* Copy_pRing, u8 Copy_u8Byte)
+{
+	u16 Local_u16Head = Copy_pRing->head;
+
+	if ((u16)(Local_u16Head-Copy_pRing->tail) > Copy_pRing->mask)
+	{
+		Copy_pRing->dropped++;
+		return STATUS_NOK;
+	}
+	Copy_pRing->buffer[Local_u16Head & Copy_pRing->mask] = Copy_u8Byte;
+	RING_BARRIER();
+	Copy_pRing->head = Local_u16Head+1;
+	return STATUS_OK;
+}
+
+/*Description: This API will take one byte from the ring (consumer side)
+ * parameters: ring (RING_t*), byte (u8*)
+ * Return: Error Status (NOK if the ring is empty)*/
+u8 RING_u8Get (RING_t* Copy_pRing, u8* Copy_pu8Byte)
+{
+	u16 Local_u16Tail = Copy_pRing->tail;
+
+	if (Local_u16Tail == Copy_pRing->head) return STATUS_NOK;
+	RING_BARRIER();
+	*Copy_pu8Byte = Copy_pRing->buffer[Local_u16Tail & Copy_pRing->mask];
+	RING_BARRIER();
+	Copy_pRing->tail = Local_u16Tail+1;
+	return STATUS_OK;
+}
+
+/*Description: This API will put as many bytes as fit in the ring (producer side)
+ * parameters: ring (RING_t*), bytes (u8*), number of bytes (u16)
+ * Return: number of bytes put*/
+u16 RING_u16Write (RING_t* Copy_pRing, const u8* Copy_pu8Bytes, u16 Copy_u16Count)
+{
+	u16 Local_u16Head = Copy_pRing->head;
+	u16 Local_u16Free = Copy_pRing->mask+1-(u16)(Local_u16Head-Copy_pRing->tail);
+	u16 Local_u16Iterator;
+
+	if (Copy_u16Count > Local_u16Free) Copy_u16Count = Local_u16Free;
+	for (Local_u16Iterator=0; Local_u16Iterator<Copy_u16Count; Local_u16Iterator++)
+	{
+		Copy_pRing->buffer[(u16)(Local_u16Head+Local_u16Iterator) & Copy_pRing->mask] = Copy_pu8Bytes[Local_u16Iterator];
+	}
+	/*All the bytes are published with one index update*/
+	RING_BARRIER();
+	Copy_pRing->head = Local_u16Head+Copy_u16Count;
+	return Copy_u16Count;
+}
+
+/*Description: This API will take up to (Copy_u16Max) bytes from the ring (consumer side)
+ * parameters: ring (RING_t*), destination (u8*), most bytes to take (u16)
+ * Return: number of bytes taken*/
+u16 RING_u16Read (RING_t* Copy_pRing, u8* Copy_pu8Bytes, u16 Copy_u16Max)
+{
+	u16 Local_u16Tail  = Copy_pRing->tail;
+	u16 Local_u16Count = Copy_pRing->head-Local_u16Tail;
+	u16 Local_u16Iterator;
+
+	if (Local_u16Count > Copy_u16Max) Local_u16Count = Copy_u16Max;
+	RING_BARRIER();
+	for (Local_u16Iterator=0; Local_u16Iterator<Local_u16Count; Local_u16Iterator++)
+	{
+		Copy_pu8Bytes[Local_u16Iterator] = Copy_pRing->buffer[(u16)(Local_u16Tail+Local_u16Iterator) & Copy_pRing->mask];
+	}
+	RING_BARRIER();
+	Copy_pRing->tail = Local_u16Tail+Local_u16Count;
+	return Local_u16Count;
+}
+
+/*Description: This API will drop everything in the ring (consumer side)
+ * parameters: ring (RING_t*)
+ * Return: void*/
+void RING_voidFlush (RING_t* Copy_pRing)
+{
+	Copy_pRing->tail = Copy_pRing->head;
+}
+
+/*Description: This API will give the number of bytes waiting in the ring
+ * parameters: ring (RING_t*)
+ * Return: number of bytes*/
+u16 RING_u16Count (RING_t* Copy_pRing)
+{
+	return (u16)(Copy_pRing->head-Copy_pRing->tail);
+}
@@ -0,0 +1,273 @@
+/*
+ * SCHED_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "SCHED_interface.h"
+#include "Delay_interface.h"
+
+#if (SCHED_WHEEL_SLOTS & (SCHED_WHEEL_SLOTS-1))
+#error "SCHED_WHEEL_SLOTS must be a power of two"
+#endif
+
+/*DWT cycle counter*/
+#define DEMCR							*((volatile u32*)0xE000EDFC)
+#define DEMCR_TRCENA					((u32)0x01000000)
+#define DWT_CTRL						*((volatile u32*)0xE0001000)
+#define DWT_CTRL_CYCCNTENA				((u32)0x00000001)
+#define DWT_CYCCNT						*((volatile u32*)0xE0001004)
+
+#define SCHED_NO_TIMER					(u8)0xFF
+
+typedef struct
+{
+	SCHED_Task_t function;
+	volatile u32 events;				/*Posted and not handled yet, set from interrupts too*/
+	u8           running;
+}SCHED_TaskEntry_t;
+
+typedef struct
+{
+	u32 events;
+	u32 periodTicks;					/*0 for a one shot timer*/
+	u32 rounds;							/*Turns of the wheel left before the timer expires in its slot*/
+	u8  task;
+	u8  active;
+	u8  next;							/*Next timer in the same slot*/
+}SCHED_Timer_t;
+
+static SCHED_TaskEntry_t static_Tasks[SCHED_MAX_TASKS];
+static SCHED_Timer_t     static_Timers[SCHED_MAX_TIMERS];
+/*First timer of every slot of the wheel*/
+static u8  static_u8SlotHead[SCHED_WHEEL_SLOTS];
+/*Ticks done by the wheel since init, the slot being served is static_u32Tick % SCHED_WHEEL_SLOTS*/
+static u32 static_u32Tick;
+/*Cycle stamp of the last tick done*/
+static u32 static_u32TickCycles;
+/*0 until SCHED_voidInit is called*/
+static u32 static_u32CyclesPerTick;
+static u32 static_u32CyclesPerMs;
+
+/*Description: This function will take a timer out of the slot it is linked in
+ * parameters: timer number (u8)
+ * Return: void*/
+static void SCHED_voidUnlink (u8 Copy_u8Timer)
+{
+	u8* Local_pu8Link;
+	u8  Local_u8Slot;
+
+	for (Local_u8Slot=0; Local_u8Slot<SCHED_WHEEL_SLOTS; Local_u8Slot++)
+	{
+		for (Local_pu8Link=&static_u8SlotHead[Local_u8Slot]; *Local_pu8Link!=SCHED_NO_TIMER; Local_pu8Link=&static_Timers[*Local_pu8Link].next)
+		{
+			if (*Local_pu8Link == Copy_u8Timer)
+			{
+				*Local_pu8Link = static_Timers[Copy_u8Timer].next;
+				return;
+			}
+		}
+	}
+}
+
+/*Description: This function will link a timer in the slot where it expires after (Copy_u32Ticks) ticks
+ * parameters: timer number (u8), ticks from now (u32, 1 at least)
+ * Return: void*/
+static void SCHED_voidLink (u8 Copy_u8Timer, u32 Copy_u32Ticks)
+{
+	u8 Local_u8Slot = (static_u32Tick+Copy_u32Ticks) & (SCHED_WHEEL_SLOTS-1);
+
+	static_Timers[Copy_u8Timer].rounds = (Copy_u32Ticks-1)/SCHED_WHEEL_SLOTS;
+	static_Timers[Copy_u8Timer].next   = static_u8SlotHead[Local_u8Slot];
+	static_u8SlotHead[Local_u8Slot]    = Copy_u8Timer;
+}
+
+/*Description: This function will turn the wheel by one tick and post the events of the timers that expire in the new slot
+ * parameters: void
+ * Return: void*/
+static void SCHED_voidTick (void)
+{
+	u8* Local_pu8Link;
+	u8  Local_u8Timer;
+	/*Periodic timers that expired in this slot, linked again once the walk is over*/
+	u8  Local_u8Expired = SCHED_NO_TIMER;
+
+	static_u32Tick++;
+	Local_pu8Link = &static_u8SlotHead[static_u32Tick & (SCHED_WHEEL_SLOTS-1)];
+	while (*Local_pu8Link != SCHED_NO_TIMER)
+	{
+		Local_u8Timer = *Local_pu8Link;
+		if (static_Timers[Local_u8Timer].rounds != 0)
+		{
+			static_Timers[Local_u8Timer].rounds--;
+			Local_pu8Link = &static_Timers[Local_u8Timer].next;
+			continue;
+		}
+		/*Expired : out of the slot, a periodic timer is kept aside so the walk does not meet it again*/
+		*Local_pu8Link = static_Timers[Local_u8Timer].next;
+		SCHED_voidPost(static_Timers[Local_u8Timer].task, static_Timers[Local_u8Timer].events);
+		if (static_Timers[Local_u8Timer].periodTicks != 0)
+		{
+			static_Timers[Local_u8Timer].next = Local_u8Expired;
+			Local_u8Expired = Local_u8Timer;
+		}
+		else
+		{
+			static_Timers[Local_u8Timer].active = 0;
+		}
+	}
+	while (Local_u8Expired != SCHED_NO_TIMER)
+	{
+		Local_u8Timer   = Local_u8Expired;
+		Local_u8Expired = static_Timers[Local_u8Timer].next;
+		SCHED_voidLink(Local_u8Timer, static_Timers[Local_u8Timer].periodTicks);
+	}
+}
+
+/*Description: This API will enable the DWT cycle counter, remove all tasks and timers and start the wheel from now
+ * parameters: void
+ * Return: void*/
+void SCHED_voidInit (void)
+{
+	u8 Local_u8Iterator;
+
+	DEMCR    |= DEMCR_TRCENA;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+
+	for (Local_u8Iterator=0; Local_u8Iterator<SCHED_MAX_TASKS; Local_u8Iterator++)
+	{
+		static_Tasks[Local_u8Iterator].function = NULL;
+		static_Tasks[Local_u8Iterator].events   = 0;
+		static_Tasks[Local_u8Iterator].running  = 0;
+	}
+	for (Local_u8Iterator=0; Local_u8Iterator<SCHED_MAX_TIMERS; Local_u8Iterator++)
+	{
+		static_Timers[Local_u8Iterator].active = 0;
+	}
+	for (Local_u8Iterator=0; Local_u8Iterator<SCHED_WHEEL_SLOTS; Local_u8Iterator++)
+	{
+		static_u8SlotHead[Local_u8Iterator] = SCHED_NO_TIMER;
+	}
+	/*The clock is read once here, delay_u32GetCPUclock reads RCC*/
+	static_u32CyclesPerMs   = delay_u32GetCPUclock()/1000;
+	static_u32CyclesPerTick = static_u32CyclesPerMs*SCHED_TICK_MS;
+	static_u32Tick          = 0;
+	static_u32TickCycles    = DWT_CYCCNT;
+}
+
+/*Description: This API will add a task to the scheduler
+ * parameters: task number, also its priority (u8, 0 ... SCHED_MAX_TASKS-1), task function (SCHED_Task_t)
+ * Return: Error Status (NOK if the number is out of range or already taken)*/
+u8 SCHED_u8AddTask (u8 Copy_u8Task, SCHED_Task_t Copy_pfTask)
+{
+	if (Copy_u8Task >= SCHED_MAX_TASKS || Copy_pfTask == NULL || static_Tasks[Copy_u8Task].function != NULL) return STATUS_NOK;
+	static_Tasks[Copy_u8Task].events   = 0;
+	static_Tasks[Copy_u8Task].running  = 0;
+	static_Tasks[Copy_u8Task].function = Copy_pfTask;
+	return STATUS_OK;
+}
+
+/*Description: This API will post events to a task, it can be called from interrupts
+ * parameters: task number (u8), events (u32, one bit per event)
+ * Return: void*/
+void SCHED_voidPost (u8 Copy_u8Task, u32 Copy_u32Events)
+{
+	if (Copy_u8Task < SCHED_MAX_TASKS)
+	{
+		/*Exclusive load/store, an interrupt posting in the middle makes the store fail and the OR is done again*/
+		__sync_fetch_and_or(&static_Tasks[Copy_u8Task].events, Copy_u32Events);
+	}
+}
+
+/*Description: This API will start (or restart) a timer that posts events to a task when it expires
+ * parameters: timer number (u8), task number (u8), events (u32), delay in ms (u32), period in ms (u32, 0 for a one shot timer)
+ * Return: Error Status*/
+u8 SCHED_u8StartTimer (u8 Copy_u8Timer, u8 Copy_u8Task, u32 Copy_u32Events, u32 Copy_u32DelayMs, u32 Copy_u32PeriodMs)
+{
+	if (Copy_u8Timer >= SCHED_MAX_TIMERS || Copy_u8Task >= SCHED_MAX_TASKS || static_u32CyclesPerTick == 0) return STATUS_NOK;
+
+	SCHED_voidStopTimer(Copy_u8Timer);
+	static_Timers[Copy_u8Timer].task        = Copy_u8Task;
+	static_Timers[Copy_u8Timer].events      = Copy_u32Events;
+	/*Times are rounded up to whole ticks, a timer never expires early*/
+	static_Timers[Copy_u8Timer].periodTicks = (Copy_u32PeriodMs+SCHED_TICK_MS-1)/SCHED_TICK_MS;
+	static_Timers[Copy_u8Timer].active      = 1;
+	SCHED_voidLink(Copy_u8Timer, (Copy_u32DelayMs<SCHED_TICK_MS)? 1 : (Copy_u32DelayMs+SCHED_TICK_MS-1)/SCHED_TICK_MS);
+	return STATUS_OK;
+}
+
+/*Description: This API will stop a timer, its events are not posted
+ * parameters: timer number (u8)
+ * Return: void*/
+void SCHED_voidStopTimer (u8 Copy_u8Timer)
+{
+	if (Copy_u8Timer < SCHED_MAX_TIMERS && static_Timers[Copy_u8Timer].active)
+	{
+		SCHED_voidUnlink(Copy_u8Timer);
+		static_Timers[Copy_u8Timer].active = 0;
+	}
+}
+
+/*Description: This API will bring the timer wheel up to date and run the ready task with the highest priority
+ * parameters: void
+ * Return: 1 if a task was run, 0 otherwise*/
+u8 SCHED_u8RunOnce (void)
+{
+	u8  Local_u8Task;
+	u32 Local_u32Events;
+
+	if (static_u32CyclesPerTick == 0) return 0;
+
+	/*Ticks missed while a task was running are all done now, in order*/
+	while ((u32)(DWT_CYCCNT-static_u32TickCycles) >= static_u32CyclesPerTick)
+	{
+		static_u32TickCycles += static_u32CyclesPerTick;
+		SCHED_voidTick();
+	}
+
+	for (Local_u8Task=0; Local_u8Task<SCHED_MAX_TASKS; Local_u8Task++)
+	{
+		/*A task sleeping is not run again from its own sleep*/
+		if (static_Tasks[Local_u8Task].function == NULL || static_Tasks[Local_u8Task].running || static_Tasks[Local_u8Task].events == 0) continue;
+
+		Local_u32Events = __sync_fetch_and_and(&static_Tasks[Local_u8Task].events, 0);
+		static_Tasks[Local_u8Task].running = 1;
+		static_Tasks[Local_u8Task].function(Local_u32Events);
+		static_Tasks[Local_u8Task].running = 0;
+		return 1;
+	}
+	return 0;
+}
+
+/*Description: This API will wait for a time while running the other tasks (delay_ms is used before SCHED_voidInit)
+ * parameters: time in ms (u32, less than one DWT wrap)
+ * Return: void*/
+void SCHED_voidSleep (u32 Copy_u32TimeMs)
+{
+	u32 Local_u32Start = DWT_CYCCNT;
+	u32 Local_u32Cycles;
+
+	if (static_u32CyclesPerTick == 0)
+	{
+		delay_ms(Copy_u32TimeMs);
+		return;
+	}
+	Local_u32Cycles = Copy_u32TimeMs*static_u32CyclesPerMs;
+	while ((u32)(DWT_CYCCNT-Local_u32Start) < Local_u32Cycles)
+	{
+		SCHED_u8RunOnce();
+	}
+}
+
+/*Description: This API will run the tasks for ever
+ * parameters: void
+ * Return: never returns*/
+void SCHED_voidRun (void)
+{
+	while (1)
+	{
+		SCHED_u8RunOnce();
+	}
+}
@@ -0,0 +1,139 @@
+/*
+ * SHA256_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "SHA256_interface.h"
+
+#define ROTR(X,N)						(((X)>>(N)) | ((X)<<(32-(N))))
+#define CH(X,Y,Z)						(((X)&(Y)) ^ (~(X)&(Z)))
+#define MAJ(X,Y,Z)						(((X)&(Y)) ^ ((X)&(Z)) ^ ((Y)&(Z)))
+#define BSIG0(X)						(ROTR(X,2)  ^ ROTR(X,13) ^ ROTR(X,22))
+#define BSIG1(X)						(ROTR(X,6)  ^ ROTR(X,11) ^ ROTR(X,25))
+#define SSIG0(X)						(ROTR(X,7)  ^ ROTR(X,18) ^ ((X)>>3))
+#define SSIG1(X)						(ROTR(X,17) ^ ROTR(X,19) ^ ((X)>>10))
+
+/*Round constants (first 32 bits of the fractional parts of the cube roots of the first 64 primes)*/
+static const u32 static_u32RoundConstants[64]=
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*Processes one 64 bytes block, the message schedule is kept as a 16 words circular buffer to save stack*/
+static void SHA256_voidProcessBlock (SHA256_Context_t* Copy_pContext, const u8* Copy_u8Block)
+{
+	u32 Local_u32Schedule[16];
+	u32 a,b,c,d,e,f,g,h;
+	u32 Local_u32Temp1, Local_u32Temp2;
+	u8  Local_u8Round;
+
+	for (Local_u8Round=0; Local_u8Round<16; Local_u8Round++)
+	{
+		/*Message words are big endian*/
+		Local_u32Schedule[Local_u8Round] = ((u32)Copy_u8Block[Local_u8Round*4]<<24)   | ((u32)Copy_u8Block[Local_u8Round*4+1]<<16) |
+										   ((u32)Copy_u8Block[Local_u8Round*4+2]<<8)  |  (u32)Copy_u8Block[Local_u8Round*4+3];
+	}
+
+	a=Copy_pContext->state[0]; b=Copy_pContext->state[1]; c=Copy_pContext->state[2]; d=Copy_pContext->state[3];
+	e=Copy_pContext->state[4]; f=Copy_pContext->state[5]; g=Copy_pContext->state[6]; h=Copy_pContext->state[7];
+
+	for (Local_u8Round=0; Local_u8Round<64; Local_u8Round++)
+	{
+		if (Local_u8Round >= 16)
+		{
+			Local_u32Schedule[Local_u8Round&0x0F] += SSIG1(Local_u32Schedule[(Local_u8Round+14)&0x0F]) +
+													 Local_u32Schedule[(Local_u8Round+9)&0x0F] +
+													 SSIG0(Local_u32Schedule[(Local_u8Round+1)&0x0F]);
+		}
+		Local_u32Temp1 = h + BSIG1(e) + CH(e,f,g) + static_u32RoundConstants[Local_u8Round] + Local_u32Schedule[Local_u8Round&0x0F];
+		Local_u32Temp2 = BSIG0(a) + MAJ(a,b,c);
+		h=g; g=f; f=e; e=d+Local_u32Temp1;
+		d=c; c=b; b=a; a=Local_u32Temp1+Local_u32Temp2;
+	}
+
+	Copy_pContext->state[0]+=a; Copy_pContext->state[1]+=b; Copy_pContext->state[2]+=c; Copy_pContext->state[3]+=d;
+	Copy_pContext->state[4]+=e; Copy_pContext->state[5]+=f; Copy_pContext->state[6]+=g; Copy_pContext->state[7]+=h;
+}
+
+void SHA256_voidInit (SHA256_Context_t* Copy_pContext)
+{
+	Copy_pContext->state[0]=0x6a09e667;
+	Copy_pContext->state[1]=0xbb67ae85;
+	Copy_pContext->state[2]=0x3c6ef372;
+	Copy_pContext->state[3]=0xa54ff53a;
+	Copy_pContext->state[4]=0x510e527f;
+	Copy_pContext->state[5]=0x9b05688c;
+	Copy_pContext->state[6]=0x1f83d9ab;
+	Copy_pContext->state[7]=0x5be0cd19;
+	Copy_pContext->totalLength=0;
+	Copy_pContext->blockLength=0;
+}
+
+void SHA256_voidUpdate (SHA256_Context_t* Copy_pContext, const u8* Copy_u8Data, u32 Copy_u32Length)
+{
+	Copy_pContext->totalLength += Copy_u32Length;
+
+	/*Complete a block that was partially filled by a previous call*/
+	while ((Copy_pContext->blockLength != 0) && (Copy_u32Length != 0))
+	{
+		Copy_pContext->block[Copy_pContext->blockLength++] = *Copy_u8Data++;
+		Copy_u32Length--;
+		if (Copy_pContext->blockLength == SHA256_BLOCK_SIZE)
+		{
+			SHA256_voidProcessBlock(Copy_pContext, Copy_pContext->block);
+			Copy_pContext->blockLength = 0;
+		}
+	}
+	/*Full blocks are hashed straight from the source (flash) without copying*/
+	while (Copy_u32Length >= SHA256_BLOCK_SIZE)
+	{
+		SHA256_voidProcessBlock(Copy_pContext, Copy_u8Data);
+		Copy_u8Data    += SHA256_BLOCK_SIZE;
+		Copy_u32Length -= SHA256_BLOCK_SIZE;
+	}
+	while (Copy_u32Length != 0)
+	{
+		Copy_pContext->block[Copy_pContext->blockLength++] = *Copy_u8Data++;
+		Copy_u32Length--;
+	}
+}
+
+void SHA256_voidFinal (SHA256_Context_t* Copy_pContext, u8* Copy_u8Digest)
+{
+	u32 Local_u32BitLength = Copy_pContext->totalLength*8;
+	u8  Local_u8Index;
+
+	Copy_pContext->block[Copy_pContext->blockLength++] = 0x80;
+	/*No room for the 8 bytes length, pad this block and use another one*/
+	if (Copy_pContext->blockLength > (SHA256_BLOCK_SIZE-8))
+	{
+		while (Copy_pContext->blockLength < SHA256_BLOCK_SIZE) Copy_pContext->block[Copy_pContext->blockLength++] = 0;
+		SHA256_voidProcessBlock(Copy_pContext, Copy_pContext->block);
+		Copy_pContext->blockLength = 0;
+	}
+	while (Copy_pContext->blockLength < (SHA256_BLOCK_SIZE-4)) Copy_pContext->block[Copy_pContext->blockLength++] = 0;
+	/*Message length in bits, big endian (flash regions are far below 512 MB, so the upper word is 0)*/
+	Copy_pContext->block[60] = (u8)(Local_u32BitLength>>24);
+	Copy_pContext->block[61] = (u8)(Local_u32BitLength>>16);
+	Copy_pContext->block[62] = (u8)(Local_u32BitLength>>8);
+	Copy_pContext->block[63] = (u8)(Local_u32BitLength);
+	SHA256_voidProcessBlock(Copy_pContext, Copy_pContext->block);
+
+	for (Local_u8Index=0; Local_u8Index<8; Local_u8Index++)
+	{
+		Copy_u8Digest[Local_u8Index*4]   = (u8)(Copy_pContext->state[Local_u8Index]>>24);
+		Copy_u8Digest[Local_u8Index*4+1] = (u8)(Copy_pContext->state[Local_u8Index]>>16);
+		Copy_u8Digest[Local_u8Index*4+2] = (u8)(Copy_pContext->state[Local_u8Index]>>8);
+		Copy_u8Digest[Local_u8Index*4+3] = (u8)(Copy_pContext->state[Local_u8Index]);
+	}
+}
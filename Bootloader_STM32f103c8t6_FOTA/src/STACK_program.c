@@ -0,0 +1,68 @@
+/*
+ * STACK_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "STACK_interface.h"
+
+/*Defined by the linker script (sections.ld)*/
+extern u32 __stack;
+extern u32 _Heap_Begin;
+extern u32 _Main_Stack_Size;
+extern u32 _sdata;
+/*Defined by newlib, _sbrk(0) gives the current end of the heap*/
+extern char* _sbrk (int incr);
+
+#define STACK_RAM_START					((u32)0x20000000)
+
+static u32* STACK_pu32StackPointer (void)
+{
+	u32* Local_pu32Sp;
+
+	asm volatile ("mov %0, sp" : "=r" (Local_pu32Sp));
+	return Local_pu32Sp;
+}
+
+/*Description: This API will paint the RAM between the heap and the current stack pointer, it must be called once at startup
+ * parameters: void
+ * Return: void*/
+void STACK_voidPaint (void)
+{
+	/*Heap end is word aligned (_sbrk keeps it so)*/
+	volatile u32* Local_pu32Word = (volatile u32*)_sbrk(0);
+	u32* Local_pu32Sp = STACK_pu32StackPointer();
+
+	/*Plain loop, a call to memset would put its own frame in the painted area
+	 * A few words under the stack pointer are left for the interrupts that may come meanwhile*/
+	while (Local_pu32Word < (Local_pu32Sp-16))
+	{
+		*Local_pu32Word++ = STACK_PAINT_PATTERN;
+	}
+}
+
+/*Description: This API will measure the RAM usage
+ * parameters: usage (STACK_Usage_t*)
+ * Return: void*/
+void STACK_voidGetUsage (STACK_Usage_t* Copy_pUsage)
+{
+	u32* Local_pu32HeapEnd = (u32*)_sbrk(0);
+	u32* Local_pu32Sp      = STACK_pu32StackPointer();
+	u32* Local_pu32Word    = Local_pu32HeapEnd;
+
+	/*Heap allocations may have covered the bottom of the painted area, the search starts above them*/
+	while ((Local_pu32Word < Local_pu32Sp) && (*Local_pu32Word == STACK_PAINT_PATTERN))
+	{
+		Local_pu32Word++;
+	}
+
+	Copy_pUsage->ramSize       = (u32)&__stack-STACK_RAM_START;
+	Copy_pUsage->staticSize    = (u32)&_Heap_Begin-(u32)&_sdata;
+	Copy_pUsage->heapUsed      = (u32)Local_pu32HeapEnd-(u32)&_Heap_Begin;
+	Copy_pUsage->stackPeak     = (u32)&__stack-(u32)Local_pu32Word;
+	Copy_pUsage->stackNow      = (u32)&__stack-(u32)Local_pu32Sp;
+	Copy_pUsage->freeBytes     = (u32)Local_pu32Word-(u32)Local_pu32HeapEnd;
+	Copy_pUsage->stackReserved = (u32)&_Main_Stack_Size;
+}
@@ -0,0 +1,110 @@
+/*
+ * STATS_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "STATS_interface.h"
+#include "Delay_interface.h"
+#include <string.h>
+
+/*DWT cycle counter*/
+#define DEMCR							*((volatile u32*)0xE000EDFC)
+#define DEMCR_TRCENA					((u32)0x01000000)
+#define DWT_CTRL						*((volatile u32*)0xE0001000)
+#define DWT_CTRL_CYCCNTENA				((u32)0x00000001)
+#define DWT_CYCCNT						*((volatile u32*)0xE0001004)
+
+static u32 static_u32Counters[STATS_NUMBER_OF_COUNTERS];
+static u32 static_u32TimersUs[STATS_NUMBER_OF_TIMERS];
+/*Time since the stats were cleared, it is brought up to date on every start and stop so that the
+ * cycle counter never wraps between two updates while the bootloader is working*/
+static u32 static_u32ElapsedUs;
+static u32 static_u32LastCycles;
+/*Cycles below one us that were not added yet to the elapsed time*/
+static u32 static_u32ElapsedRemainder;
+
+static u32 STATS_u32CyclesPerUs (void)
+{
+	return delay_u32GetCPUclock()/1000000;
+}
+
+static u32 STATS_u32UpdateElapsed (void)
+{
+	u32 Local_u32Now = DWT_CYCCNT;
+	u32 Local_u32CyclesPerUs = STATS_u32CyclesPerUs();
+
+	static_u32ElapsedRemainder += Local_u32Now-static_u32LastCycles;
+	static_u32ElapsedUs        += static_u32ElapsedRemainder/Local_u32CyclesPerUs;
+	static_u32ElapsedRemainder %= Local_u32CyclesPerUs;
+	static_u32LastCycles        = Local_u32Now;
+	return Local_u32Now;
+}
+
+/*Description: This API will enable the DWT cycle counter and clear all the stats
+ * parameters: void
+ * Return: void*/
+void STATS_voidInit (void)
+{
+	DEMCR    |= DEMCR_TRCENA;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+	STATS_voidClear();
+}
+
+/*Description: This API will clear all the stats, the elapsed time starts again from now
+ * parameters: void
+ * Return: void*/
+void STATS_voidClear (void)
+{
+	memset(static_u32Counters, 0, sizeof(static_u32Counters));
+	memset(static_u32TimersUs, 0, sizeof(static_u32TimersUs));
+	static_u32ElapsedUs        = 0;
+	static_u32ElapsedRemainder = 0;
+	static_u32LastCycles       = DWT_CYCCNT;
+}
+
+/*Description: This API will add to one of the counters
+ * parameters: counter (u8), amount to add (u32)
+ * Return: void*/
+void STATS_voidCount (u8 Copy_u8Counter, u32 Copy_u32Amount)
+{
+	if (Copy_u8Counter < STATS_NUMBER_OF_COUNTERS)
+	{
+		static_u32Counters[Copy_u8Counter] += Copy_u32Amount;
+	}
+}
+
+/*Description: This API will start a timed section
+ * parameters: void
+ * Return: cycle stamp to be passed to STATS_voidStop*/
+u32 STATS_u32Start (void)
+{
+	return STATS_u32UpdateElapsed();
+}
+
+/*Description: This API will end a timed section and add its time to one of the timers
+ * parameters: timer (u8), cycle stamp returned by STATS_u32Start (u32)
+ * Return: void*/
+void STATS_voidStop (u8 Copy_u8Timer, u32 Copy_u32StartCycles)
+{
+	u32 Local_u32Now = STATS_u32UpdateElapsed();
+
+	if (Copy_u8Timer < STATS_NUMBER_OF_TIMERS)
+	{
+		static_u32TimersUs[Copy_u8Timer] += (Local_u32Now-Copy_u32StartCycles)/STATS_u32CyclesPerUs();
+	}
+}
+
+/*Description: This API will write the stats record
+ * parameters: array of STATS_RECORD_SIZE bytes (u8*)
+ * Return: void*/
+void STATS_voidGetRecord (u8* Copy_pu8Record)
+{
+	STATS_u32UpdateElapsed();
+	/*Cortex-M3 is little endian, the arrays are already in the order of the record*/
+	memcpy(Copy_pu8Record, static_u32Counters, sizeof(static_u32Counters));
+	memcpy(&Copy_pu8Record[sizeof(static_u32Counters)], static_u32TimersUs, sizeof(static_u32TimersUs));
+	memcpy(&Copy_pu8Record[sizeof(static_u32Counters)+sizeof(static_u32TimersUs)], &static_u32ElapsedUs, 4);
+}
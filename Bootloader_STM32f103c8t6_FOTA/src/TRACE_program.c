@@ -0,0 +1,114 @@
+/*
+ * TRACE_program.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: Mohamed Nafea
+ */
+
+#include "STD_TYPES.h"
+#include "TRACE_interface.h"
+#include "Delay_interface.h"
+#include <string.h>
+
+/*DWT cycle counter*/
+#define DEMCR							*((volatile u32*)0xE000EDFC)
+#define DEMCR_TRCENA					((u32)0x01000000)
+#define DWT_CTRL						*((volatile u32*)0xE0001000)
+#define DWT_CTRL_CYCCNTENA				((u32)0x00000001)
+#define DWT_CYCCNT						*((volatile u32*)0xE0001004)
+
+#define TRACE_RING_MASK					(TRACE_RING_RECORDS-1)
+
+static TRACE_Record_t static_Ring[TRACE_RING_RECORDS];
+/*Sequence number of the next record, the record goes to (sequence & TRACE_RING_MASK)*/
+static u32 static_u32Next;
+static u8  static_u8Enabled;
+/*The cycle counter is extended to us on every record*/
+static u32 static_u32TimeUs;
+static u32 static_u32LastCycles;
+static u32 static_u32CyclesRemainder;
+
+/*Description: This API will enable the DWT cycle counter, empty the ring and start recording
+ * parameters: void
+ * Return: void*/
+void TRACE_voidInit (void)
+{
+	DEMCR    |= DEMCR_TRCENA;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+
+	static_u32Next            = 0;
+	static_u32TimeUs          = 0;
+	static_u32CyclesRemainder = 0;
+	static_u32LastCycles      = DWT_CYCCNT;
+	static_u8Enabled          = 1;
+}
+
+/*Description: This API will add a record to the ring
+ * parameters: event (u8), phase (u8), argument (u16)
+ * Return: void*/
+void TRACE_voidRecord (u8 Copy_u8Event, u8 Copy_u8Phase, u16 Copy_u16Arg)
+{
+	u32 Local_u32Now;
+	u32 Local_u32CyclesPerUs;
+	TRACE_Record_t* Local_pRecord;
+
+	/*Time is kept up to date even while recording is stopped, so it stays right once recording starts again*/
+	Local_u32Now         = DWT_CYCCNT;
+	Local_u32CyclesPerUs = delay_u32GetCPUclock()/1000000;
+	static_u32CyclesRemainder += Local_u32Now-static_u32LastCycles;
+	static_u32TimeUs          += static_u32CyclesRemainder/Local_u32CyclesPerUs;
+	static_u32CyclesRemainder %= Local_u32CyclesPerUs;
+	static_u32LastCycles       = Local_u32Now;
+
+	if (static_u8Enabled==0)
+	{
+		return;
+	}
+
+	Local_pRecord = &static_Ring[static_u32Next & TRACE_RING_MASK];
+	Local_pRecord->timeUs = static_u32TimeUs;
+	Local_pRecord->event  = Copy_u8Event;
+	Local_pRecord->phase  = Copy_u8Phase;
+	Local_pRecord->arg    = Copy_u16Arg;
+	static_u32Next++;
+}
+
+/*Description: This API will stop or restart recording (records are not written while the ring is being read)
+ * parameters: 1 to record, 0 to stop (u8)
+ * Return: void*/
+void TRACE_voidSetEnable (u8 Copy_u8Enable)
+{
+	static_u8Enabled = Copy_u8Enable;
+}
+
+/*Description: This API will give the sequence numbers of the records held by the ring
+ * parameters: sequence number of the oldest record (u32*), sequence number of the next record to be written (u32*)
+ * Return: void*/
+void TRACE_voidGetRange (u32* Copy_pu32First, u32* Copy_pu32Next)
+{
+	*Copy_pu32Next  = static_u32Next;
+	*Copy_pu32First = (static_u32Next > TRACE_RING_RECORDS)? (static_u32Next-TRACE_RING_RECORDS) : 0;
+}
+
+/*Description: This API will copy records out of the ring
+ * parameters: sequence number of the first record (u32), destination (u8*), maximum number of records (u8)
+ * Return: number of records copied, 0 if the first record was overwritten or not written yet*/
+u8 TRACE_u8CopyRecords (u32 Copy_u32First, u8* Copy_pu8Dest, u8 Copy_u8MaxRecords)
+{
+	u32 Local_u32Oldest;
+	u32 Local_u32Next;
+	u8  Local_u8Count=0;
+
+	TRACE_voidGetRange(&Local_u32Oldest, &Local_u32Next);
+	if (Copy_u32First < Local_u32Oldest)
+	{
+		return 0;
+	}
+	/*Records are stored little endian in the order of the record fields, they are copied as they are*/
+	while ((Copy_u32First+Local_u8Count < Local_u32Next) && (Local_u8Count < Copy_u8MaxRecords))
+	{
+		memcpy(&Copy_pu8Dest[Local_u8Count*TRACE_RECORD_SIZE], &static_Ring[(Copy_u32First+Local_u8Count) & TRACE_RING_MASK], TRACE_RECORD_SIZE);
+		Local_u8Count++;
+	}
+	return Local_u8Count;
+}
@@ -3,9 +3,27 @@
  *
  *  Created on: June 4, 2020
  *      Author: Mahmoud Hamdy
- *      Version: 2.0
+ *      Version: 2.3
  */
 
+/*Changelog from version 2.2:
+ * 1) Added UART_u8SetFlowControl for hardware RTS/CTS flow control (CR3 RTSE/CTSE)
+ * 2) The IRQs count overrun, noise and framing errors, read with UART_u8GetErrors
+ * */
+/*Changelog from version 2.1:
+ * 1) Added an rx ring and a tx ring for every UART peripheral : once UART_u8StartRXRing is called the IRQ puts every received
+ *    byte in the rx ring and never waits for the main loop, which takes them in bulk with UART_u16Read
+ * 2) Added UART_u16Write that queues bytes in the tx ring, they are sent by the TXE interrupt after any async send in progress
+ *    and UART_u8FlushTX that waits for them to be sent
+ * */
+
+/*Changelog from version 2.0:
+ * 1) UART_voidSendSync became UART_u8SendSync, it waits for TXE/TC instead of a fixed delay after every byte
+ *    and the time passed is a timeout for each byte
+ * 2) Sizes are u16, so buffers longer than 255 bytes go in one call
+ * 3) Added UART_u8SendGatherAsync to send several buffers in one interrupt based session
+ * */
+
 /*Changelog from version 1.1:
  * 1) Removed Deparcated Macros (related to baudrate)
  * 2) Changed the flags for the IRQ because there were bugs in it
@@ -23,6 +41,13 @@
 #include "STD_TYPES.h"
 #include "UART_interface.h"
 #include "Delay_interface.h"
+#include "RING_interface.h"
+
+#if (UART1_RX_RING_SIZE & (UART1_RX_RING_SIZE-1)) || (UART1_TX_RING_SIZE & (UART1_TX_RING_SIZE-1)) || \
+	(UART2_RX_RING_SIZE & (UART2_RX_RING_SIZE-1)) || (UART2_TX_RING_SIZE & (UART2_TX_RING_SIZE-1)) || \
+	(UART3_RX_RING_SIZE & (UART3_RX_RING_SIZE-1)) || (UART3_TX_RING_SIZE & (UART3_TX_RING_SIZE-1))
+#error "UART rings sizes must be powers of two"
+#endif
 
 /*These static variables will hold the call back functions*/
 static TXCallback_t TXCallbackFunctionUART1 = NULL;
@@ -36,22 +61,136 @@ static RXCallback_t RXCallbackFunctionUART3 = NULL;
 #define STATUS_BUSY				(u8)2
 #define STATUS_IDLE				(u8)3
 
+/*Cycles taken by one poll of the status register in UART_u8WaitFlag (load, test, count down, branch), used to turn timeouts into polls*/
+#define UART_POLL_CYCLES		(u32)8
+
 /*This struct will be used to create objects that will hold the data buffer and its status to be handled by the IRQ
  * The IRQ will contain a for loop that will keep looping on the array till the current position matches the size */
 typedef struct {
 	u8* dataArray;
-	u8 size;
-	u8 currentPosition;
+	u16 size;
+	u16 currentPosition;
 	u8 bufferState;
+	/*Gather sends only : segments that follow the one in dataArray*/
+	const UART_Segment_t* nextSegment;
+	u8 segmentsLeft;
 } dataBuffer_t;
 
 /*These static objects will hold the send and receive data buffers*/
-static dataBuffer_t txBufferUART1 = { NULL, 0, 0, STATUS_IDLE };
-static dataBuffer_t rxBufferUART1 = { NULL, 0, 0, STATUS_IDLE };
-static dataBuffer_t txBufferUART2 = { NULL, 0, 0, STATUS_IDLE };
-static dataBuffer_t rxBufferUART2 = { NULL, 0, 0, STATUS_IDLE };
-static dataBuffer_t txBufferUART3 = { NULL, 0, 0, STATUS_IDLE };
-static dataBuffer_t rxBufferUART3 = { NULL, 0, 0, STATUS_IDLE };
+static dataBuffer_t txBufferUART1 = { NULL, 0, 0, STATUS_IDLE, NULL, 0 };
+static dataBuffer_t rxBufferUART1 = { NULL, 0, 0, STATUS_IDLE, NULL, 0 };
+static dataBuffer_t txBufferUART2 = { NULL, 0, 0, STATUS_IDLE, NULL, 0 };
+static dataBuffer_t rxBufferUART2 = { NULL, 0, 0, STATUS_IDLE, NULL, 0 };
+static dataBuffer_t txBufferUART3 = { NULL, 0, 0, STATUS_IDLE, NULL, 0 };
+static dataBuffer_t rxBufferUART3 = { NULL, 0, 0, STATUS_IDLE, NULL, 0 };
+
+/*These static arrays will hold a copy of the segments of a gather send, so the caller does not have to keep them*/
+static UART_Segment_t txSegmentsUART1[UART_GATHER_MAX_SEGMENTS];
+static UART_Segment_t txSegmentsUART2[UART_GATHER_MAX_SEGMENTS];
+static UART_Segment_t txSegmentsUART3[UART_GATHER_MAX_SEGMENTS];
+
+/*This struct will hold the rings of one peripheral, the IRQ is the producer of rx and the consumer of tx, the main loop is the other side*/
+typedef struct {
+	RING_t rx;
+	RING_t tx;
+	/*Set while the received bytes go to the rx ring instead of the rxBuffer object*/
+	volatile u8 rxOn;
+} uartRings_t;
+
+/*These static arrays are the storage of the rings*/
+static u8 rxRingStorageUART1[UART1_RX_RING_SIZE];
+static u8 txRingStorageUART1[UART1_TX_RING_SIZE];
+static u8 rxRingStorageUART2[UART2_RX_RING_SIZE];
+static u8 txRingStorageUART2[UART2_TX_RING_SIZE];
+static u8 rxRingStorageUART3[UART3_RX_RING_SIZE];
+static u8 txRingStorageUART3[UART3_TX_RING_SIZE];
+
+/*These static objects will hold the rings of every peripheral, they are ready to use without calling RING_u8Init*/
+static uartRings_t ringsUART1 = { { rxRingStorageUART1, UART1_RX_RING_SIZE-1, 0, 0, 0 }, { txRingStorageUART1, UART1_TX_RING_SIZE-1, 0, 0, 0 }, 0 };
+static uartRings_t ringsUART2 = { { rxRingStorageUART2, UART2_RX_RING_SIZE-1, 0, 0, 0 }, { txRingStorageUART2, UART2_TX_RING_SIZE-1, 0, 0, 0 }, 0 };
+static uartRings_t ringsUART3 = { { rxRingStorageUART3, UART3_RX_RING_SIZE-1, 0, 0, 0 }, { txRingStorageUART3, UART3_TX_RING_SIZE-1, 0, 0, 0 }, 0 };
+
+/*These static objects will hold the receive errors of every peripheral, counted by the IRQs*/
+static UART_Errors_t errorsUART1 = { 0, 0, 0 };
+static UART_Errors_t errorsUART2 = { 0, 0, 0 };
+static UART_Errors_t errorsUART3 = { 0, 0, 0 };
+
+/*Description: This function will be used by the IRQs to count the receive errors flagged in the status register, it is called
+ * before DR is read (reading SR then DR clears the flags, so an error is counted once)
+ * Parameters: status register value (u32), counters of the peripheral (UART_Errors_t*)
+ * Return: None */
+static void UART_voidCountErrors(u32 Copy_u32Status, UART_Errors_t* Copy_pErrors)
+{
+	if ((Copy_u32Status & UART_OVERRUN_ERROR_MASK) && (Copy_pErrors->overrun != 0xFFFF)) Copy_pErrors->overrun++;
+	if ((Copy_u32Status & UART_NOISE_ERROR_MASK)   && (Copy_pErrors->noise   != 0xFFFF)) Copy_pErrors->noise++;
+	if ((Copy_u32Status & UART_FRAMING_ERROR_MASK) && (Copy_pErrors->framing != 0xFFFF)) Copy_pErrors->framing++;
+}
+
+/*Description: This function will give the rings of the chosen peripheral
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: rings of the peripheral (NULL if the peripheral is unknown) */
+static uartRings_t* UART_pGetRings(u32 Copy_u32UARTAddress)
+{
+	if (Copy_u32UARTAddress == UART_USART1_BASE_ADDRESS) return &ringsUART1;
+	if (Copy_u32UARTAddress == UART_USART2_BASE_ADDRESS) return &ringsUART2;
+	if (Copy_u32UARTAddress == UART_USART3_BASE_ADDRESS) return &ringsUART3;
+	return NULL;
+}
+
+/*Description: This function will be used by the IRQs in rx ring mode, the received byte is read once (SR then DR, which also
+ * clears an overrun) and put in the rx ring. A byte that does not fit is dropped and counted by the ring, the IRQ never waits
+ * Parameters: UART Peripheral (u32), rx ring (RING_t*)
+ * Return: None */
+static void UART_voidRXToRing(u32 Copy_u32UARTAddress, RING_t* Copy_pRing)
+{
+	u8 Local_u8Data;
+
+	if ((*((volatile u32*) (Copy_u32UARTAddress + UART_SR ))) & (UART_RX_NOT_EMPTY_MASK | UART_OVERRUN_ERROR_MASK))
+	{
+		Local_u8Data = *((volatile u32*) (Copy_u32UARTAddress + UART_DR ));
+		/*Since Parity is added to the data inside data register, remove it in case it is enabled*/
+		if ((*((u32*) (Copy_u32UARTAddress + UART_CR1 ))) & UART_PARITY_EVEN_MASK)
+		{
+			Local_u8Data &= UART_PARITY_CANCELLATION_MASK;
+		}
+		RING_u8Put(Copy_pRing, Local_u8Data);
+	}
+}
+
+/*Description: This function will be used by the IRQs when no async send is in progress, it sends the next byte of the tx ring
+ * or disables the TXE interrupt when the ring is empty (UART_u16Write enables it again)
+ * Parameters: UART Peripheral (u32), tx ring (RING_t*)
+ * Return: None */
+static void UART_voidTXFromRing(u32 Copy_u32UARTAddress, RING_t* Copy_pRing)
+{
+	u8 Local_u8Data;
+
+	if (RING_u8Get(Copy_pRing, &Local_u8Data) == STATUS_OK)
+	{
+		*((u32*) (Copy_u32UARTAddress + UART_DR )) = Local_u8Data;
+	}
+	else
+	{
+		UART_u8EnableInterrupt(Copy_u32UARTAddress, UART_TX_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_DISABLE_MASK);
+	}
+}
+
+/*Description: This function will be used by the IRQs to know whether there is a char left to send, moving to the next segment of
+ * a gather send when the current one is done (empty segments are skipped)
+ * Parameters: tx buffer (dataBuffer_t*)
+ * Return: 1 if dataArray[currentPosition] is the next char to send, 0 if the sending is done */
+static u8 UART_u8TXDataLeft(dataBuffer_t* Copy_txBuffer)
+{
+	while ((Copy_txBuffer->currentPosition == Copy_txBuffer->size) && (Copy_txBuffer->segmentsLeft != 0))
+	{
+		Copy_txBuffer->dataArray       = (u8*)Copy_txBuffer->nextSegment->data;
+		Copy_txBuffer->size            = Copy_txBuffer->nextSegment->length;
+		Copy_txBuffer->currentPosition = 0;
+		Copy_txBuffer->nextSegment++;
+		Copy_txBuffer->segmentsLeft--;
+	}
+	return (Copy_txBuffer->currentPosition != Copy_txBuffer->size);
+}
 
 /*APIs*/
 /*Description: This API will be configure the UART with the passed configurations
@@ -104,9 +243,9 @@ u8 UART_u8Configure(u32 Copy_u32BaseAddress, u16 Copy_u16Baudrate, u32 Copy_u32S
 }/*End of Configure*/
 
 /*Description: This function will be used to trigger sending data. It will enable the interrupt, pass parameters to buffers and the rest will be handled by IRQ
- * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u8)
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16)
  * Return: Error Status */
-u8 UART_voidSendAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size)
+u8 UART_voidSendAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size)
 {
 	/*This local pointer will point to the proper struct according to chosen peripheral*/
 	dataBuffer_t* Local_txBuffer;
@@ -132,7 +271,8 @@ u8 UART_voidSendAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size
 	{
 		/*Save the passed parameters in the txBuffer object*/
 		Local_txBuffer->dataArray = Copy_u8Buffer;
-		Local_txBuffer->size = Copy_u8Size;
+		Local_txBuffer->size = Copy_u16Size;
+		Local_txBuffer->segmentsLeft = 0;
 
 		/*Change status to busy*/
 		Local_txBuffer->bufferState = STATUS_BUSY;
@@ -145,13 +285,76 @@ u8 UART_voidSendAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size
 	return Local_u8Status;
 }/*End of SendAsync*/
 
+/*Description: This function will be used to send several buffers back to back in one interrupt based session, without copying them together
+ * The segments array is copied, the data of every segment must stay unchanged until the sending is done
+ * Parameters: Desired UART Peripheral (u32), segments (UART_Segment_t*), number of segments (u8, up to UART_GATHER_MAX_SEGMENTS)
+ * Return: Error Status */
+u8 UART_u8SendGatherAsync(u32 Copy_u32UARTAddress, const UART_Segment_t* Copy_pSegments, u8 Copy_u8Count)
+{
+	/*This local pointer will point to the proper struct according to chosen peripheral*/
+	dataBuffer_t* Local_txBuffer;
+	/*This local pointer will point to the segments copy of the chosen peripheral*/
+	UART_Segment_t* Local_txSegments;
+	/*This local variable will hold the status of the function whether it succeeded or not*/
+	u8 Local_u8Status = STATUS_NOK;
+	/*This local variable will be used as iterator on the segments*/
+	u8 Local_u8Iterator;
+
+	/*Check which UART peripheral has this call for sending, and according to it, pass the one specified for this peripheral to the local object*/
+	if (Copy_u32UARTAddress == UART_USART1_BASE_ADDRESS)
+	{
+		Local_txBuffer = &txBufferUART1;
+		Local_txSegments = txSegmentsUART1;
+	}
+	else if (Copy_u32UARTAddress == UART_USART2_BASE_ADDRESS)
+	{
+		Local_txBuffer = &txBufferUART2;
+		Local_txSegments = txSegmentsUART2;
+	}
+	else if (Copy_u32UARTAddress == UART_USART3_BASE_ADDRESS)
+	{
+		Local_txBuffer = &txBufferUART3;
+		Local_txSegments = txSegmentsUART3;
+	}
+	else
+	{
+		return STATUS_NOK;
+	}
+
+	/*If current status is IDLE, then it means we are ready to send new data and no current interrupt based sending on this UART is on*/
+	if ((Local_txBuffer->bufferState == STATUS_IDLE) && (Copy_pSegments != NULL) && (Copy_u8Count != 0) && (Copy_u8Count <= UART_GATHER_MAX_SEGMENTS))
+	{
+		for (Local_u8Iterator = 0; Local_u8Iterator < Copy_u8Count; Local_u8Iterator++)
+		{
+			Local_txSegments[Local_u8Iterator] = Copy_pSegments[Local_u8Iterator];
+		}
+		/*The first segment goes in the txBuffer object like a normal send, the IRQ moves to the next ones*/
+		Local_txBuffer->dataArray = (u8*)Local_txSegments[0].data;
+		Local_txBuffer->size = Local_txSegments[0].length;
+		Local_txBuffer->currentPosition = 0;
+		Local_txBuffer->nextSegment = &Local_txSegments[1];
+		Local_txBuffer->segmentsLeft = Copy_u8Count-1;
+
+		/*Change status to busy*/
+		Local_txBuffer->bufferState = STATUS_BUSY;
+
+		/*Enable Interrupt that will be related to sending data*/
+		UART_u8EnableInterrupt(Copy_u32UARTAddress, UART_TX_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_ENABLE_MASK);
+		/*Set status as successful*/
+		Local_u8Status = STATUS_OK;
+	}
+	return Local_u8Status;
+}/*End of SendGatherAsync*/
+
 /*Description: This function will be used to trigger receiving data. It will only trigger interrupt the rest will be handled by the interrupt request
- * Parameters:Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u8)
+ * Parameters:Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16)
  * Return: Error Status */
-u8 UART_u8ReceiveAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size)
+u8 UART_u8ReceiveAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size)
 {
 	/*This local pointer will point to the proper struct according to chosen peripheral*/
 	dataBuffer_t* Local_rxBuffer;
+	/*This local pointer will point to the rings of the chosen peripheral*/
+	uartRings_t* Local_pRings = UART_pGetRings(Copy_u32UARTAddress);
 
 	/*This local variable holds the status which will be returned at the end*/
 	u8 Local_u8Status = STATUS_NOK;
@@ -169,13 +372,18 @@ u8 UART_u8ReceiveAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Siz
 	{
 		Local_rxBuffer = &rxBufferUART3;
 	}
+	else
+	{
+		return STATUS_NOK;
+	}
 
-	/*If current status is IDLE, then it means we are ready to receive new data and no current interrupt based receiving on this UART is on*/
-	if (Local_rxBuffer->bufferState == STATUS_IDLE)
+	/*If current status is IDLE, then it means we are ready to receive new data and no current interrupt based receiving on this UART is on
+	 * While the rx ring is on, the received bytes go to the ring and the request is refused*/
+	if ((Local_rxBuffer->bufferState == STATUS_IDLE) && (Local_pRings->rxOn == 0))
 	{
 		/*Save the passed parameters in the txBuffer object*/
 		Local_rxBuffer->dataArray = Copy_u8Buffer;
-		Local_rxBuffer->size = Copy_u8Size;
+		Local_rxBuffer->size = Copy_u16Size;
 
 		/*Enable Interrupt that will be related to sending data*/
 		UART_u8EnableInterrupt(Copy_u32UARTAddress, UART_RX_NOT_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_ENABLE_MASK);
@@ -187,14 +395,38 @@ u8 UART_u8ReceiveAsync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Siz
 	return Local_u8Status;
 }/*End of ReceiveAsync*/
 
-/*Description: This function will be used to trigger sending data synchronously without using interrupts
- * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u8), required delay in ms (u32)
- * Return: void  */
-void UART_voidSendSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size, u32 Copy_u32Time)
+/*Description: This function will wait for a flag of the status register, polling it at most (Copy_u32Polls) times
+ * Parameters: UART Peripheral (u32), flag mask (u32), polls (u32, 0 waits for ever)
+ * Return: Error Status (STATUS_NOK if the flag was not set in time) */
+static u8 UART_u8WaitFlag(u32 Copy_u32UARTAddress, u32 Copy_u32FlagMask, u32 Copy_u32Polls)
 {
+	/*This local variable counts down the polls that are left*/
+	u32 Local_u32PollsLeft = Copy_u32Polls;
+
+	while (!((*((volatile u32*) (Copy_u32UARTAddress + UART_SR ))) & Copy_u32FlagMask))
+	{
+		if (Copy_u32Polls != 0)
+		{
+			Local_u32PollsLeft--;
+			if (Local_u32PollsLeft == 0) return STATUS_NOK;
+		}
+	}
+	return STATUS_OK;
+}
 
+/*Description: This function will be used to send data synchronously without using interrupts
+ * Every byte is written as soon as the data register is empty (TXE), then the function waits for the last frame to
+ * leave the shift register (TC), so the time taken is the time of the frames on the wire
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16), timeout for each byte in ms (u32, 0 waits for ever)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown or a byte timed out)  */
+u8 UART_u8SendSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32Time)
+{
+	/*This local variable holds the status which will be returned at the end*/
+	u8 Local_u8Status = STATUS_OK;
 	/*This local pointer will point to the proper struct according to chosen peripheral*/
 	dataBuffer_t* Local_txBuffer;
+	/*This local variable holds the timeout in polls of the status register*/
+	u32 Local_u32Polls = 0;
 
 	/*Check which UART peripheral has this call for sending, and according to it, pass the one specified for this peripheral to the local object*/
 	if (Copy_u32UARTAddress == UART_USART1_BASE_ADDRESS)
@@ -209,30 +441,49 @@ void UART_voidSendSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Siz
 	{
 		Local_txBuffer = &txBufferUART3;
 	}
+	else
+	{
+		return STATUS_NOK;
+	}
 
+	/*The timeout is turned once into a number of polls, delay_u32GetCPUclock reads RCC so it is not called for every byte*/
+	if (Copy_u32Time != 0)
+	{
+		Local_u32Polls = Copy_u32Time * (delay_u32GetCPUclock() / 1000 / UART_POLL_CYCLES);
+	}
 
 	/*Save the passed parameters in the txBuffer object*/
 	Local_txBuffer->dataArray = Copy_u8Buffer;
-	Local_txBuffer->size = Copy_u8Size;
+	Local_txBuffer->size = Copy_u16Size;
 
-	/*Send data to DR using for loop*/
+	/*Send data to DR using for loop, each byte goes as soon as the previous one moved to the shift register*/
 	for (Local_txBuffer->currentPosition = 0; Local_txBuffer->currentPosition < Local_txBuffer->size; Local_txBuffer->currentPosition++)
 	{
+		if (UART_u8WaitFlag(Copy_u32UARTAddress, UART_TX_EMPTY_MASK, Local_u32Polls) != STATUS_OK)
+		{
+			Local_u8Status = STATUS_NOK;
+			break;
+		}
 		/*Send desired character*/
 		*((u32*) (Copy_u32UARTAddress + UART_DR )) = Local_txBuffer->dataArray[Local_txBuffer->currentPosition];
-		delay_ms(Copy_u32Time);
+	}
+	/*Wait for the last frame to be on the wire, callers may reset or reconfigure the peripheral right after*/
+	if ((Local_u8Status == STATUS_OK) && (UART_u8WaitFlag(Copy_u32UARTAddress, UART_TX_COMPLETE_MASK, Local_u32Polls) != STATUS_OK))
+	{
+		Local_u8Status = STATUS_NOK;
 	}
 	/*Reset everything*/
 	Local_txBuffer->dataArray=NULL;
 	Local_txBuffer->size = 0;
 	Local_txBuffer->currentPosition = 0;
 
+	return Local_u8Status;
 }/*End of SendSync*/
 
 /*Description: This function will be used to trigger receiving data synchronously without using interrupts
- * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u8), required delay in ms (u32)
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16), required delay in ms (u32)
  * Return: Error Status */
-u8 UART_u8ReceiveSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size, u32 Copy_u32Time)
+u8 UART_u8ReceiveSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32Time)
 {
 	/*This local variable holds the status which will be returned at the end*/
 	u8 Local_u8Status = STATUS_NOK;
@@ -256,7 +507,7 @@ u8 UART_u8ReceiveSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size
 
 	/*Save the passed parameters in the txBuffer object*/
 	Local_rxBuffer->dataArray = Copy_u8Buffer;
-	Local_rxBuffer->size = Copy_u8Size;
+	Local_rxBuffer->size = Copy_u16Size;
 	Local_rxBuffer->currentPosition = 0;
 
 	/*As long as there are data in the data register, and we haven't reached end of buffer yet, keep receiving*/
@@ -287,6 +538,178 @@ u8 UART_u8ReceiveSync(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u8 Copy_u8Size
 	return Local_u8Status;
 }/*End of ReceiveSync*/
 
+/*Description: This API will make the IRQ put every received byte in the rx ring of the peripheral (emptied first) instead of
+ * a buffer passed to UART_u8ReceiveAsync, which is refused while the ring is on. The RX callback is not called in this mode
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown) */
+u8 UART_u8StartRXRing(u32 Copy_u32UARTAddress)
+{
+	/*This local pointer will point to the rings of the chosen peripheral*/
+	uartRings_t* Local_pRings = UART_pGetRings(Copy_u32UARTAddress);
+
+	if (Local_pRings == NULL)
+	{
+		return STATUS_NOK;
+	}
+	/*An interrupt based receiving in progress is ended, its buffer would never be filled*/
+	UART_voidTerminateReceiving(Copy_u32UARTAddress);
+	RING_voidFlush(&Local_pRings->rx);
+	Local_pRings->rxOn = 1;
+	/*Enable Interrupt that will be related to receiving data*/
+	UART_u8EnableInterrupt(Copy_u32UARTAddress, UART_RX_NOT_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_ENABLE_MASK);
+	return STATUS_OK;
+}/*End of StartRXRing*/
+
+/*Description: This API will stop putting received bytes in the rx ring, the bytes already in it can still be read
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: None */
+void UART_voidStopRXRing(u32 Copy_u32UARTAddress)
+{
+	/*This local pointer will point to the rings of the chosen peripheral*/
+	uartRings_t* Local_pRings = UART_pGetRings(Copy_u32UARTAddress);
+
+	if (Local_pRings != NULL)
+	{
+		UART_u8EnableInterrupt(Copy_u32UARTAddress, UART_RX_NOT_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_DISABLE_MASK);
+		Local_pRings->rxOn = 0;
+	}
+}/*End of StopRXRing*/
+
+/*Description: This API will take up to (Copy_u16Max) received bytes from the rx ring, without waiting
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16)
+ * Return: number of bytes taken (0 if none arrived or the peripheral is unknown) */
+u16 UART_u16Read(u32 Copy_u32UARTAddress, u8 *Copy_u8Buffer, u16 Copy_u16Size)
+{
+	/*This local pointer will point to the rings of the chosen peripheral*/
+	uartRings_t* Local_pRings = UART_pGetRings(Copy_u32UARTAddress);
+
+	if (Local_pRings == NULL)
+	{
+		return 0;
+	}
+	return RING_u16Read(&Local_pRings->rx, Copy_u8Buffer, Copy_u16Size);
+}/*End of Read*/
+
+/*Description: This API will drop the received bytes that were not read yet
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: None */
+void UART_voidFlushRX(u32 Copy_u32UARTAddress)
+{
+	/*This local pointer will point to the rings of the chosen peripheral*/
+	uartRings_t* Local_pRings = UART_pGetRings(Copy_u32UARTAddress);
+
+	if (Local_pRings != NULL)
+	{
+		RING_voidFlush(&Local_pRings->rx);
+	}
+}/*End of FlushRX*/
+
+/*Description: This API will give the number of received bytes dropped because the rx ring was full, since reset
+ * Parameters: Desired UART Peripheral (u32)
+ * Return: number of bytes dropped */
+u16 UART_u16GetRXDropped(u32 Copy_u32UARTAddress)
+{
+	/*This local pointer will point to the rings of the chosen peripheral*/
+	uartRings_t* Local_pRings = UART_pGetRings(Copy_u32UARTAddress);
+
+	if (Local_pRings == NULL)
+	{
+		return 0;
+	}
+	return Local_pRings->rx.dropped;
+}/*End of GetRXDropped*/
+
+/*Description: This API will queue bytes in the tx ring without waiting, the TXE interrupt sends them
+ * The bytes are copied, so the buffer can be reused right after the call. Don't mix it with sync sends on the same peripheral
+ * Parameters: Desired UART Peripheral (u32), Pointer to Data Buffer (u8*), size of data buffer (u16)
+ * Return: number of bytes queued (less than the size when the ring is full) */
+u16 UART_u16Write(u32 Copy_u32UARTAddress, const u8 *Copy_u8Buffer, u16 Copy_u16Size)
+{
+	/*This local pointer will point to the rings of the chosen peripheral*/
+	uartRings_t* Local_pRings = UART_pGetRings(Copy_u32UARTAddress);
+	/*This local variable holds the number of bytes that fit in the ring*/
+	u16 Local_u16Queued;
+
+	if (Local_pRings == NULL)
+	{
+		return 0;
+	}
+	Local_u16Queued = RING_u16Write(&Local_pRings->tx, Copy_u8Buffer, Copy_u16Size);
+	/*The bytes are published before the interrupt is enabled, so the IRQ finds them or finds the interrupt already enabled again*/
+	if (Local_u16Queued != 0)
+	{
+		UART_u8EnableInterrupt(Copy_u32UARTAddress, UART_TX_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_ENABLE_MASK);
+	}
+	return Local_u16Queued;
+}/*End of Write*/
+
+/*Description: This API will wait until the bytes of the tx ring are sent and the last frame left the shift register (TC),
+ * to be called before a reset or a jump that would cut the sending
+ * Parameters: Desired UART Peripheral (u32), timeout in ms (u32, 0 waits for ever)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown or the time ran out) */
+u8 UART_u8FlushTX(u32 Copy_u32UARTAddress, u32 Copy_u32Time)
+{
+	/*This local pointer will point to the rings of the chosen peripheral*/
+	uartRings_t* Local_pRings = UART_pGetRings(Copy_u32UARTAddress);
+	/*This local variable holds the timeout in polls*/
+	u32 Local_u32Polls = 0;
+	u32 Local_u32PollsLeft;
+
+	if (Local_pRings == NULL)
+	{
+		return STATUS_NOK;
+	}
+	if (Copy_u32Time != 0)
+	{
+		Local_u32Polls = Copy_u32Time * (delay_u32GetCPUclock() / 1000 / UART_POLL_CYCLES);
+	}
+	/*The TXE interrupt empties the ring, then the last frame is waited for like a sync send*/
+	Local_u32PollsLeft = Local_u32Polls;
+	while (RING_u16Count(&Local_pRings->tx) != 0)
+	{
+		if (Local_u32Polls != 0)
+		{
+			Local_u32PollsLeft--;
+			if (Local_u32PollsLeft == 0) return STATUS_NOK;
+		}
+	}
+	return UART_u8WaitFlag(Copy_u32UARTAddress, UART_TX_COMPLETE_MASK, Local_u32Polls);
+}/*End of FlushTX*/
+
+/*Description: This API will enable or disable hardware flow control, the RTS and CTS pins must be configured by the caller
+ * Parameters: Desired UART Peripheral (u32), flow control (u8, UART_FLOW_CONTROL_...)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown or the option is not one of the list) */
+u8 UART_u8SetFlowControl(u32 Copy_u32UARTAddress, u8 Copy_u8FlowControl)
+{
+	/*Only USART1 to USART3 have flow control*/
+	if (UART_pGetRings(Copy_u32UARTAddress) == NULL || Copy_u8FlowControl > UART_FLOW_CONTROL_RTS_CTS)
+	{
+		return STATUS_NOK;
+	}
+	*((u32*) (Copy_u32UARTAddress + UART_CR3 )) &= ~(UART_RTS_ENABLE_MASK | UART_CTS_ENABLE_MASK);
+	if (Copy_u8FlowControl & UART_FLOW_CONTROL_RTS)
+	{
+		*((u32*) (Copy_u32UARTAddress + UART_CR3 )) |= UART_RTS_ENABLE_MASK;
+	}
+	if (Copy_u8FlowControl & UART_FLOW_CONTROL_CTS)
+	{
+		*((u32*) (Copy_u32UARTAddress + UART_CR3 )) |= UART_CTS_ENABLE_MASK;
+	}
+	return STATUS_OK;
+}/*End of SetFlowControl*/
+
+/*Description: This API will give the receive errors counted by the IRQ of the peripheral since reset
+ * Parameters: Desired UART Peripheral (u32), counters (UART_Errors_t*)
+ * Return: Error Status (STATUS_NOK if the peripheral is unknown) */
+u8 UART_u8GetErrors(u32 Copy_u32UARTAddress, UART_Errors_t* Copy_pErrors)
+{
+	if (Copy_u32UARTAddress == UART_USART1_BASE_ADDRESS)		*Copy_pErrors = errorsUART1;
+	else if (Copy_u32UARTAddress == UART_USART2_BASE_ADDRESS)	*Copy_pErrors = errorsUART2;
+	else if (Copy_u32UARTAddress == UART_USART3_BASE_ADDRESS)	*Copy_pErrors = errorsUART3;
+	else return STATUS_NOK;
+	return STATUS_OK;
+}/*End of GetErrors*/
+
 /*Description: This API will be used to enable or disable desired interrupt
  * Parameters: Desired UART Peripheral(u32), Desired Interrupt (u32), Desired Status (u8)
  * Return:Error Status */
@@ -390,6 +813,8 @@ void UART_voidTerminateSending (u32 Copy_u32DesiredUARTBaseAddress)
 {
 	/*This local pointer will point to the proper struct according to chosen peripheral*/
 	dataBuffer_t* Local_txBuffer;
+	/*This local pointer will point to the rings of the chosen peripheral*/
+	uartRings_t* Local_pRings = UART_pGetRings(Copy_u32DesiredUARTBaseAddress);
 
 	/*This local variable holds the status which will be returned at the end*/
 	u8 Local_u8Status = STATUS_NOK;
@@ -412,21 +837,39 @@ void UART_voidTerminateSending (u32 Copy_u32DesiredUARTBaseAddress)
 	Local_txBuffer->dataArray = NULL;
 	Local_txBuffer->currentPosition = 0;
 	Local_txBuffer->size = 0;
+	Local_txBuffer->nextSegment = NULL;
+	Local_txBuffer->segmentsLeft = 0;
 	Local_txBuffer->bufferState = STATUS_IDLE;
 
 	/*Reset Flags*/
 	*((u32*) (Copy_u32DesiredUARTBaseAddress + UART_SR )) &= ~ UART_TX_COMPLETE_MASK;
 
-	/*Disable Interrupt*/
-	UART_u8EnableInterrupt(Copy_u32DesiredUARTBaseAddress, UART_TX_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_DISABLE_MASK);
+	/*Disable Interrupt, unless bytes queued in the tx ring are waiting for this sending to end*/
+	if ((Local_pRings == NULL) || (RING_u16Count(&Local_pRings->tx) == 0))
+	{
+		UART_u8EnableInterrupt(Copy_u32DesiredUARTBaseAddress, UART_TX_EMPTY_INTERRUPT_ENABLE_MASK, UART_INTERRUPT_DISABLE_MASK);
+	}
 }
 
 /*Interrupt Handler Implementation*/
 void USART1_IRQHandler(void) {
 	/*Check which flag fired the interrupt request*/
-	u32 volatile Local_u32RXFlag = *((u32*) (UART_USART1_BASE_ADDRESS + UART_DR )) & 0xFFFFFFFF;
+	u32 volatile Local_u32RXFlag = 0;
 	u32 volatile Local_u32TXFlag = *((u32*) (UART_USART1_BASE_ADDRESS + UART_SR )) & UART_TX_EMPTY_MASK;
 
+	/*Errors are counted before the received byte is read, that read clears them*/
+	UART_voidCountErrors(*((volatile u32*) (UART_USART1_BASE_ADDRESS + UART_SR )), &errorsUART1);
+
+	/*In rx ring mode the received byte is read only by the ring function, reading DR here would take it*/
+	if (ringsUART1.rxOn)
+	{
+		UART_voidRXToRing(UART_USART1_BASE_ADDRESS, &ringsUART1.rx);
+	}
+	else
+	{
+		Local_u32RXFlag = *((u32*) (UART_USART1_BASE_ADDRESS + UART_DR )) & 0xFFFFFFFF;
+	}
+
 	/*This is a local variable that will check whether the data that we are currently receiving is really data or empty data from register*/
 	u8 Local_u8DRValue = 0;
 
@@ -478,8 +921,8 @@ void USART1_IRQHandler(void) {
 		/*Check that we came here because of a previous function call using status flag*/
 		if (txBufferUART1.bufferState == STATUS_BUSY)
 		{
-			/*Check if we have reached the last character, if we haven't reached it yet, send the next char*/
-			if (txBufferUART1.currentPosition != (txBufferUART1.size))
+			/*Check if we have reached the last character (of the last segment), if we haven't reached it yet, send the next char*/
+			if (UART_u8TXDataLeft(&txBufferUART1))
 			{
 				/*Send the current char of the data array and increment the current position*/
 				*((u32*) (UART_USART1_BASE_ADDRESS + UART_DR )) = txBufferUART1.dataArray[txBufferUART1.currentPosition];
@@ -499,15 +942,33 @@ void USART1_IRQHandler(void) {
 				}
 			}
 		}
+		/*Otherwise the bytes queued in the tx ring are sent*/
+		else if ((*((u32*) (UART_USART1_BASE_ADDRESS + UART_CR1 ))) & UART_TX_EMPTY_INTERRUPT_ENABLE_MASK)
+		{
+			UART_voidTXFromRing(UART_USART1_BASE_ADDRESS, &ringsUART1.tx);
+		}
 	}
 }/*End of USART1_IRQHandler*/
 
 /*Interrupt Handler Implementation*/
 void USART2_IRQHandler(void) {
 	/*Check which flag fired the interrupt request*/
-	u32 volatile Local_u32RXFlag = *((u32*) (UART_USART2_BASE_ADDRESS + UART_DR )) & 0xFFFFFFFF;
+	u32 volatile Local_u32RXFlag = 0;
 	u32 volatile Local_u32TXFlag = *((u32*) (UART_USART2_BASE_ADDRESS + UART_SR )) & UART_TX_EMPTY_MASK;
 
+	/*Errors are counted before the received byte is read, that read clears them*/
+	UART_voidCountErrors(*((volatile u32*) (UART_USART2_BASE_ADDRESS + UART_SR )), &errorsUART2);
+
+	/*In rx ring mode the received byte is read only by the ring function, reading DR here would take it*/
+	if (ringsUART2.rxOn)
+	{
+		UART_voidRXToRing(UART_USART2_BASE_ADDRESS, &ringsUART2.rx);
+	}
+	else
+	{
+		Local_u32RXFlag = *((u32*) (UART_USART2_BASE_ADDRESS + UART_DR )) & 0xFFFFFFFF;
+	}
+
 	/*This is a local variable that will check whether the data that we are currently receiving is really data or empty data from register*/
 	u8 Local_u8DRValue = 0;
 
@@ -558,8 +1019,8 @@ void USART2_IRQHandler(void) {
 		/*Check that we came here because of a previous function call using status flag*/
 		if (txBufferUART2.bufferState == STATUS_BUSY)
 		{
-			/*Check if we have reached the last character, if we haven't reached it yet, send the next char*/
-			if (txBufferUART2.currentPosition != (txBufferUART2.size))
+			/*Check if we have reached the last character (of the last segment), if we haven't reached it yet, send the next char*/
+			if (UART_u8TXDataLeft(&txBufferUART2))
 			{
 				/*Send the current char of the data array and increment the current position*/
 				*((u32*) (UART_USART2_BASE_ADDRESS + UART_DR )) = txBufferUART2.dataArray[txBufferUART2.currentPosition];
@@ -579,15 +1040,33 @@ void USART2_IRQHandler(void) {
 				}
 			}
 		}
+		/*Otherwise the bytes queued in the tx ring are sent*/
+		else if ((*((u32*) (UART_USART2_BASE_ADDRESS + UART_CR1 ))) & UART_TX_EMPTY_INTERRUPT_ENABLE_MASK)
+		{
+			UART_voidTXFromRing(UART_USART2_BASE_ADDRESS, &ringsUART2.tx);
+		}
 	}
 }/*End of USART2_IRQHandler*/
 
 /*Interrupt Handler Implementation*/
 void USART3_IRQHandler(void) {
 	/*Check which flag fired the interrupt request*/
-	u32 volatile Local_u32RXFlag = *((u32*) (UART_USART3_BASE_ADDRESS + UART_DR )) & 0xFFFFFFFF;
+	u32 volatile Local_u32RXFlag = 0;
 	u32 volatile Local_u32TXFlag = *((u32*) (UART_USART3_BASE_ADDRESS + UART_SR )) & UART_TX_EMPTY_MASK;
 
+	/*Errors are counted before the received byte is read, that read clears them*/
+	UART_voidCountErrors(*((volatile u32*) (UART_USART3_BASE_ADDRESS + UART_SR )), &errorsUART3);
+
+	/*In rx ring mode the received byte is read only by the ring function, reading DR here would take it*/
+	if (ringsUART3.rxOn)
+	{
+		UART_voidRXToRing(UART_USART3_BASE_ADDRESS, &ringsUART3.rx);
+	}
+	else
+	{
+		Local_u32RXFlag = *((u32*) (UART_USART3_BASE_ADDRESS + UART_DR )) & 0xFFFFFFFF;
+	}
+
 	/*This is a local variable that will check whether the data that we are currently receiving is really data or empty data from register*/
 	u8 Local_u8DRValue = 0;
 
@@ -638,8 +1117,8 @@ void USART3_IRQHandler(void) {
 		/*Check that we came here because of a previous function call using status flag*/
 		if (txBufferUART3.bufferState == STATUS_BUSY)
 		{
-			/*Check if we have reached the last character, if we haven't reached it yet, send the next char*/
-			if (txBufferUART3.currentPosition != (txBufferUART3.size))
+			/*Check if we have reached the last character (of the last segment), if we haven't reached it yet, send the next char*/
+			if (UART_u8TXDataLeft(&txBufferUART3))
 			{
 				/*Send the current char of the data array and increment the current position*/
 				*((u32*) (UART_USART3_BASE_ADDRESS + UART_DR )) = txBufferUART3.dataArray[txBufferUART3.currentPosition];
@@ -659,5 +1138,10 @@ void USART3_IRQHandler(void) {
 				}
 			}
 		}
+		/*Otherwise the bytes queued in the tx ring are sent*/
+		else if ((*((u32*) (UART_USART3_BASE_ADDRESS + UART_CR1 ))) & UART_TX_EMPTY_INTERRUPT_ENABLE_MASK)
+		{
+			UART_voidTXFromRing(UART_USART3_BASE_ADDRESS, &ringsUART3.tx);
+		}
 	}
 }/*End of USART3_IRQHandler*/
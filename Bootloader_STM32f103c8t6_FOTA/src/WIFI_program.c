@@ -3,17 +3,35 @@
  *
  *  Created on: Jun 21, 2020
  *      Author: Mahmoud
- *      Version: 1.1
+ *      Version: 1.5
  */
 
+/*Changelog from version 1.4:
+ * 1) Multicast receiving of the image : datagrams of a UDP link are taken from the rx ring as the module sends them (+IPD)*/
+
+/*Changelog from version 1.3:
+ * 1) LAN direct mode : the module is a TCP server for the host, commands, replies and image data go as frames on its connection
+ * 2) The push transport and LAN direct share the frame code (the link)*/
+
+/*Changelog from version 1.2:
+ * 1) Push transport : commands and replies go as frames on a connection kept open to a command server, see WIFI_interface.h*/
+
+/*Changelog from version 1.1:
+ * 1) Passive receiving of the server data (AT+CIPRECVMODE=1), see WIFI_interface.h
+ * 2) Baudrate and hardware flow control of the link can be changed after reset*/
+
 /*Changelog from version 1.0:
  * 1) Added function to count data found on server
  * 2) Improved Functionality of callback function to better handle data and prevent garbage*/
 
 #include "WIFI_interface.h"
+#include "HEX_interface.h"
+#include "STATS_interface.h"
+#include "TRACE_interface.h"
 #include <string.h>
 #include <stdio.h>
 #include "Delay_interface.h"
+#include "SCHED_interface.h"
 
 
 
@@ -27,20 +45,22 @@ static UART_GPIO_t Static_UART_PERIPHERAL = {.BaseAddress = NULL};
 static UART_GPIO_t Static_OUTPUT_PERIPHERAL = {.BaseAddress = NULL};
 
 
+/*The received chars are put in the rx ring of the WIFI peripheral by its interrupt and handled here by the main loop,
+ * so the variables below are not shared with interrupts*/
 /*This static variable will hold the response that we are currently receiving from WIFI module*/
-static volatile u8 static_u8Response=0;
+static u8 static_u8Response=0;
 /*This variable will contain the previous character before the one we are currently receiving*/
-static volatile u8 static_u8PreviousChar=0;
+static u8 static_u8PreviousChar=0;
 /*This is the flag that will keep us sending and receiving until the end of the data*/
-static volatile u8 static_u8ReceiveFlag=1;
+static u8 static_u8ReceiveFlag=1;
 /*This static variable will be used as a flag so that we know whether the data incoming should be saved inside a variable or not*/
-static volatile u8 static_u8DataToArray=0;
+static u8 static_u8DataToArray=0;
 /*This variable will be used to store incoming data*/
-static volatile u8 Global_u8DataReceivedArray[WIFI_RECEIVE_ARRAY_SIZE]={0};
+static u8 Global_u8DataReceivedArray[WIFI_RECEIVE_ARRAY_SIZE]={0};
 /*This static variable will be used as iterator for array that will be used to save data*/
-static volatile u32 static_u32DataArrayIterator=0;
+static u32 static_u32DataArrayIterator=0;
 /*This static variable will be used as a flag to prompt start receiving data inside the array after the desired char is received ':'*/
-static volatile u8 static_u8StartSavingData=0;
+static u8 static_u8StartSavingData=0;
 
 /*This static variable will be used as an iterator for the data that will need to be saved*/
 static u32 static_u32DataToBeSavedIterator=0;
@@ -57,19 +77,91 @@ u16 Global_u16IteratorForNumberOfTimesDataAreReceived=0;
 /*This static variable will hold the size of data counted from the website*/
 static u32 static_u32DataSize=0;
 
+/*The waits between AT commands are scheduler sleeps, the module is quiet then and the other tasks of the bootloader
+ * (flash jobs) run meanwhile. A response is never waited for by a sleep : a flash operation stalls the CPU and the chars
+ * arriving while it runs would be lost*/
+/*Most received chars taken from the rx ring at once*/
+#define WIFI_RX_CHUNK_SIZE			(u16)32
+
+#if WIFI_PASSIVE_RECEIVE
+/*The module is on USART2 : a read response is never left half in the module, so it must fit its rx ring with room to spare
+ * for the header, the OK and a notification*/
+#if (WIFI_PASSIVE_READ_SIZE+64) > UART2_RX_RING_SIZE
+#error "WIFI_PASSIVE_READ_SIZE does not fit the rx ring of the WIFI peripheral"
+#endif
+/*Header of the chars read in passive receiving ("+CIPRECVDATA,<length>:<chars>")*/
+#define WIFI_PASSIVE_DATA_HEADER		"+CIPRECVDATA"
+/*Parts of a passive receiving response*/
+#define WIFI_PASSIVE_STATE_RESPONSE		(u8)0			/*Module text, up to OK or ERROR*/
+#define WIFI_PASSIVE_STATE_SEPARATOR	(u8)1
+#define WIFI_PASSIVE_STATE_LENGTH		(u8)2
+#define WIFI_PASSIVE_STATE_DATA			(u8)3
+
+/*This static variable will hold the part of the response being received*/
+static u8  static_u8PassiveState=WIFI_PASSIVE_STATE_RESPONSE;
+/*This static variable will hold the number of chars of the data header matched so far*/
+static u8  static_u8PassiveMatch=0;
+/*This static variable will hold the number of data chars left in the current read*/
+static u16 static_u16PassiveLeft=0;
+/*This static variable will hold the number of data chars received by the last read*/
+static u16 static_u16PassiveReceived=0;
+/*This static variable will be set when the response ended with ERROR*/
+static u8  static_u8PassiveError=0;
+/*This static variable will be set when the module tells the server closed the connection*/
+static u8  static_u8LinkClosed=0;
+#endif
+
+#if WIFI_PUSH_TRANSPORT && WIFI_LAN_DIRECT
+#error "WIFI_PUSH_TRANSPORT and WIFI_LAN_DIRECT cannot be used together"
+#endif
+/*Commands come as frames on a link kept open : the connection to the command server (push transport) or the one of the host (LAN direct)*/
+#define WIFI_LINK_FRAMES				(WIFI_PUSH_TRANSPORT || WIFI_LAN_DIRECT)
+#if WIFI_LINK_FRAMES
+#if !WIFI_PASSIVE_RECEIVE
+#error "WIFI_PUSH_TRANSPORT and WIFI_LAN_DIRECT need WIFI_PASSIVE_RECEIVE"
+#endif
+#if WIFI_LINK_FRAME_HEADER_SIZE > WIFI_PASSIVE_READ_SIZE
+#error "WIFI_LINK_FRAME_HEADER_SIZE does not fit one read"
+#endif
+#if WIFI_LAN_DIRECT
+/*The module takes many connections, the commands about one name it first, the host is always link 0 (one connection at most)*/
+#define WIFI_LINK_ID					"0,"
+#define WIFI_COMMAND_LAN_CLOSE			(u8*)"AT+CIPCLOSE=0\r\n"
+/*First char of a data request frame, the frames of the host never start with it (they are hex chars)*/
+#define WIFI_LAN_DATA_REQUEST			(u8)'D'
+/*Time between two reads while the answer to a data request is on its way*/
+#define WIFI_LAN_POLL_MS				(u32)(10)
+#else
+#define WIFI_LINK_ID					""
+#endif
+/*This static variable will be set while the link is open (push : connected to the command server, LAN : server started)*/
+static u8  static_u8LinkOpen=0;
+/*This static variable will be set while the module is in passive receiving for the link (it may be closed already)*/
+static u8  static_u8LinkPassive=0;
+/*This static variable will be set once the link was opened, the replies then go to it first*/
+static u8  static_u8LinkWanted=0;
+/*This static variable will hold the number of chars of the last frame received*/
+static u16 static_u16LinkFrameLength=0;
+/*While not null, the chars read in passive receiving are frame chars and are stored here as they are*/
+static u8* static_pu8LinkDestination=NULL;
+#endif
+
+#define WIFI_REPLY_PREFIX_LEN		(u16)(sizeof(WIFI_REPLY_REQUEST_PREFIX)-1)
+#define WIFI_REPLY_SUFFIX_LEN		(u16)(sizeof(WIFI_REPLY_REQUEST_SUFFIX)-1)
+/*This static array is the request that carries replies to the server, the prefix is written once here and the reply chars
+ * are encoded right after it, so a reply is never copied between buffers before it is sent*/
+static u8 static_u8ReplyRequest[WIFI_REPLY_REQUEST_SIZE]=WIFI_REPLY_REQUEST_PREFIX;
+/*This static variable will hold the length of the request built so far (prefix included)*/
+static u16 static_u16ReplyLength=WIFI_REPLY_PREFIX_LEN;
+/*This static variable will be set when an append did not fit the request buffer*/
+static u8 static_u8ReplyOverflow=0;
+
 /*This array is for debugging purposes to detect what is wrong with the counting function*/
 //u8 Global_u8TestCounting[8000]={0};
 
 /*This callback function will be used to count data on the website*/
 void callBackCountingRX (void)
 {
-	/*If display is specified (address is not null), we are free to send char to them*/
-	if (Static_OUTPUT_PERIPHERAL.BaseAddress!=NULL)
-	{
-		/*Send character that has been received*/
-		HUART_u8SendAsync(Static_OUTPUT_PERIPHERAL, &static_u8Response, sizeof(static_u8Response));
-	}
-
 	/*If data to array flag is on, send data to flag too*/
 	if (static_u8DataToArray==1)
 	{
@@ -119,52 +211,65 @@ void callBackCountingRX (void)
 	}
 }
 
-/*This callback will send the received data to the screen*/
-void callBackRX (void)
+/*Description: This static function will save the received char (static_u8Response) in the data array if it is data
+ * Chars between '<' or '+' and the next ':' or '>' are markup or module headers, the others are saved from the required index on
+ * parameters: void
+ * Return: void*/
+static void WIFI_voidSaveDataChar (void)
 {
-	/*If display is specified (address is not null), we are free to send char to them*/
-	if (Static_OUTPUT_PERIPHERAL.BaseAddress!=NULL)
-	{
-		/*Send character that has been received*/
-		HUART_u8SendAsync(Static_OUTPUT_PERIPHERAL, &static_u8Response, sizeof(static_u8Response));
-	}
-	/*If data to array flag is on, send data to array too*/
-	if (static_u8DataToArray==1)
+	if (static_u8StartSavingData)
 	{
-		if (static_u8StartSavingData)
+		/*Check that we haven't reached the maximum size of receiving array yet, if not, go for conditions that check we should
+		 * save data or not*/
+		if (static_u32DataArrayIterator<WIFI_RECEIVE_ARRAY_SIZE)
 		{
-			/*Check that we haven't reached the maximum size of receiving array yet, if not, go for conditions that check we should
-			 * save data or not*/
-			if (static_u32DataArrayIterator<WIFI_RECEIVE_ARRAY_SIZE)
+			/*If this specific character is received, it means we are receiving a line separator specific to html, so we should ignore it*/
+			if ((static_u8Response=='<')|(static_u8Response=='+'))
 			{
-				/*If this specific character is received, it means we are receiving a line separator specific to html, so we should ignore it*/
-				if ((static_u8Response=='<')|(static_u8Response=='+'))
+				static_u8StartSavingData=0;
+			}
+			/*If we reached a proper data that is not garbage or separators, check for flags and save data according to them*/
+			if (static_u8Response!=' ' && static_u8Response!='\n'&& static_u8Response!='<' && static_u8Response!='+' && static_u8Response!='\r'&& static_u8Response!='I' && static_u8Response!='P'&& static_u8Response!=':' &&static_u8Response!='r' && static_u8Response!='>' && static_u8Response!='n')
+			//if ((static_u8Response=='0') | (static_u8Response=='1')| (static_u8Response=='2') | (static_u8Response=='3') | (static_u8Response=='4')| (static_u8Response=='5') | (static_u8Response=='6')| (static_u8Response=='7')
+				//	| (static_u8Response=='8') | (static_u8Response=='9')| (static_u8Response=='a')| (static_u8Response=='b')| (static_u8Response=='c')| (static_u8Response=='d')| (static_u8Response=='e')| (static_u8Response=='f'))
+			{
+				/*Check which index we are at now, and in case we reached the required index, raise flag
+				 * index is multiplied by 2 because the data on site is as string and every byte is divided into 2
+				 * and then subtracted by 1 because index is started from 0*/
+				if (static_u32DataToBeSavedIterator>= ((static_u32RequiredIndex)))
 				{
-					static_u8StartSavingData=0;
+					static_u8IteratorFlag=1;
 				}
-				/*If we reached a proper data that is not garbage or separators, check for flags and save data according to them*/
-				if (static_u8Response!=' ' && static_u8Response!='\n'&& static_u8Response!='<' && static_u8Response!='+' && static_u8Response!='\r'&& static_u8Response!='I' && static_u8Response!='P'&& static_u8Response!=':' &&static_u8Response!='r' && static_u8Response!='>' && static_u8Response!='n')
-				//if ((static_u8Response=='0') | (static_u8Response=='1')| (static_u8Response=='2') | (static_u8Response=='3') | (static_u8Response=='4')| (static_u8Response=='5') | (static_u8Response=='6')| (static_u8Response=='7')
-					//	| (static_u8Response=='8') | (static_u8Response=='9')| (static_u8Response=='a')| (static_u8Response=='b')| (static_u8Response=='c')| (static_u8Response=='d')| (static_u8Response=='e')| (static_u8Response=='f'))
+				/*Increment iterator to know which index we are at now*/
+				static_u32DataToBeSavedIterator++;
+				/*If iterator flag has been set, then start saving data without problems*/
+				if (static_u8IteratorFlag==1)
 				{
-					/*Check which index we are at now, and in case we reached the required index, raise flag
-					 * index is multiplied by 2 because the data on site is as string and every byte is divided into 2
-					 * and then subtracted by 1 because index is started from 0*/
-					if (static_u32DataToBeSavedIterator>= ((static_u32RequiredIndex)))
-					{
-						static_u8IteratorFlag=1;
-					}
-					/*Increment iterator to know which index we are at now*/
-					static_u32DataToBeSavedIterator++;
-					/*If iterator flag has been set, then start saving data without problems*/
-					if (static_u8IteratorFlag==1)
-					{
-						Global_u8DataReceivedArray[static_u32DataArrayIterator]=static_u8Response;
-						static_u32DataArrayIterator++;
-					}
+					Global_u8DataReceivedArray[static_u32DataArrayIterator]=static_u8Response;
+					static_u32DataArrayIterator++;
 				}
 			}
+		}
+	}
+	if ((static_u8Response==':') | (static_u8Response=='>'))
+	{
+		static_u8StartSavingData=1;
+	}
+}
 
+/*This callback will handle the received data (the chars go to the screen from WIFI_voidHandleSegments)*/
+void callBackRX (void)
+{
+	/*This local variable will hold whether the char came while saving, the end of the data is only looked for then*/
+	u8 Local_u8Saving;
+
+	/*If data to array flag is on, send data to array too*/
+	if (static_u8DataToArray==1)
+	{
+		Local_u8Saving=static_u8StartSavingData;
+		WIFI_voidSaveDataChar();
+		if (Local_u8Saving)
+		{
 			/*We check for end of receiving through the word "CLOSED", we will check for the last two chars of the word*/
 			if (static_u8PreviousChar=='C' && static_u8Response=='L')
 			{
@@ -176,11 +281,6 @@ void callBackRX (void)
 				static_u8PreviousChar=static_u8Response;
 			}
 		}
-		if ((static_u8Response==':') | (static_u8Response=='>'))
-		{
-			static_u8StartSavingData=1;
-		}
-
 	}
 	/*Do the check according to whether send flag is set or reset
 	 * It case it is set, we check for CLOSED, otherwise we check for OK*/
@@ -198,23 +298,493 @@ void callBackRX (void)
 	}
 }
 
+#if WIFI_PASSIVE_RECEIVE
+/*This callback will handle the response of a command sent in passive receiving, it ends on OK or ERROR
+ * The chars read with AT+CIPRECVDATA are counted by the length in their header and go to the data array whatever they are,
+ * so a data char is never taken for the end of the response*/
+void callBackPassiveRX (void)
+{
+	switch (static_u8PassiveState)
+	{
+	case WIFI_PASSIVE_STATE_DATA:
+#if WIFI_LINK_FRAMES
+		if (static_pu8LinkDestination!=NULL)
+		{
+			static_pu8LinkDestination[static_u16PassiveReceived]=static_u8Response;
+		}
+		else
+#endif
+		{
+			WIFI_voidSaveDataChar();
+		}
+		static_u16PassiveReceived++;
+		if (--static_u16PassiveLeft == 0)
+		{
+			static_u8PassiveState=WIFI_PASSIVE_STATE_RESPONSE;
+			static_u8PreviousChar=0;
+		}
+		break;
+	case WIFI_PASSIVE_STATE_SEPARATOR:
+		/*The char between the header and the length (',' or ':' depending on the AT firmware)*/
+		static_u8PassiveState=WIFI_PASSIVE_STATE_LENGTH;
+		break;
+	case WIFI_PASSIVE_STATE_LENGTH:
+		if (static_u8Response>='0' && static_u8Response<='9')
+		{
+			static_u16PassiveLeft=static_u16PassiveLeft*10+(static_u8Response-'0');
+		}
+		else
+		{
+			/*The char after the length comes just before the data*/
+			static_u8PassiveState=(static_u16PassiveLeft!=0)? WIFI_PASSIVE_STATE_DATA : WIFI_PASSIVE_STATE_RESPONSE;
+		}
+		break;
+	default:
+		/*Look for the header of the read data*/
+		if (static_u8Response==WIFI_PASSIVE_DATA_HEADER[static_u8PassiveMatch])
+		{
+			static_u8PassiveMatch++;
+			if (WIFI_PASSIVE_DATA_HEADER[static_u8PassiveMatch]==0)
+			{
+				static_u8PassiveMatch=0;
+				static_u16PassiveLeft=0;
+				static_u8PassiveState=WIFI_PASSIVE_STATE_SEPARATOR;
+				break;
+			}
+		}
+		else
+		{
+			static_u8PassiveMatch=(static_u8Response==WIFI_PASSIVE_DATA_HEADER[0]);
+		}
+		/*OK and ERROR end the response, CLOSED can come in between and means nothing more will come from the server*/
+		if (static_u8PreviousChar=='O' && (static_u8Response=='K' || static_u8Response=='R'))
+		{
+			static_u8PassiveError=(static_u8Response=='R');
+			static_u8ReceiveFlag=0;
+		}
+		else if (static_u8PreviousChar=='C' && static_u8Response=='L')
+		{
+			static_u8LinkClosed=1;
+		}
+		static_u8PreviousChar=static_u8Response;
+		break;
+	}
+}
+#endif
+
+/*This static variable will hold the callback that handles every received char (static_u8Response)*/
+static RXCallback_t static_pfResponseHandler = callBackRX;
+
+/*Description: This static function will be used to handle sending a request made of several parts and receiving its response
+ * The parts go out back to back in one interrupt based sending, they are not copied together first
+ * The response is taken from the rx ring in chunks and every char is handled by the response handler until it ends the exchange,
+ * the chars after the end are dropped with the ones that arrived before the request
+ * parameters: Parts of the request (UART_Segment_t*), number of parts (u8)
+ * Return: void*/
+static void WIFI_voidHandleSegments (const UART_Segment_t* Copy_pSegments, u8 Copy_u8Count)
+{
+	u16 Local_u16Length = 0;
+	u8  Local_u8Iterator;
+	/*This local array will hold the chars taken from the rx ring at once*/
+	u8  Local_u8Chunk[WIFI_RX_CHUNK_SIZE];
+	u16 Local_u16Count;
+	u16 Local_u16Iterator;
+
+	for (Local_u8Iterator=0; Local_u8Iterator<Copy_u8Count; Local_u8Iterator++)
+	{
+		Local_u16Length += Copy_pSegments[Local_u8Iterator].length;
+	}
+
+	TRACE_voidRecord(TRACE_EVENT_WIFI_REQUEST, TRACE_PHASE_BEGIN, Local_u16Length);
+	/*Chars left from a previous exchange are not part of this response*/
+	HUART_voidFlushRX(Static_UART_PERIPHERAL);
+	/*Send data to WIFI peripheral*/
+	HUART_u8SendGatherAsync(Static_UART_PERIPHERAL, Copy_pSegments, Copy_u8Count);
+
+	/*Enter the loop for receiving data from UART*/
+	while(static_u8ReceiveFlag)
+	{
+		Local_u16Count = HUART_u16Read(Static_UART_PERIPHERAL, Local_u8Chunk, WIFI_RX_CHUNK_SIZE);
+		/*If display is specified (address is not null), the chunk is queued for it without waiting*/
+		if ((Local_u16Count != 0) && (Static_OUTPUT_PERIPHERAL.BaseAddress!=NULL))
+		{
+			HUART_u16Write(Static_OUTPUT_PERIPHERAL, Local_u8Chunk, Local_u16Count);
+		}
+		for (Local_u16Iterator=0; (Local_u16Iterator<Local_u16Count) && static_u8ReceiveFlag; Local_u16Iterator++)
+		{
+			/*Null chars were never passed on by the interrupt receiving, they are still skipped*/
+			if (Local_u8Chunk[Local_u16Iterator] == 0) continue;
+			static_u8Response = Local_u8Chunk[Local_u16Iterator];
+			static_pfResponseHandler();
+		}
+	}
+	TRACE_voidRecord(TRACE_EVENT_WIFI_REQUEST, TRACE_PHASE_END, Local_u16Length);
+}
 
 /*Description: This static function will be used to handle sending request and receiving its response
  * parameters: Data to send (u8*)
  * Return: void*/
 static void WIFI_voidHandleRequest (u8* Copy_u8Request)
 {
-	/*Send data to WIFI peripheral*/
-	HUART_u8SendAsync(Static_UART_PERIPHERAL, Copy_u8Request, strlen(Copy_u8Request));
+	UART_Segment_t Local_Segment = {Copy_u8Request, strlen(Copy_u8Request)};
 
-	/*Enter the loop for sending and receiving data from UART*/
-	while(static_u8ReceiveFlag)
+	WIFI_voidHandleSegments(&Local_Segment, 1);
+}
+
+#if WIFI_PASSIVE_RECEIVE
+/*Description: This static function will send a request made of several parts and wait for its response up to OK or ERROR,
+ * reading data if it is a read
+ * parameters: Parts of the request (UART_Segment_t*), number of parts (u8)
+ * Return: Error Status (NOK if the module answered ERROR)*/
+static u8 WIFI_u8PassiveSegments (const UART_Segment_t* Copy_pSegments, u8 Copy_u8Count)
+{
+	static_u8ReceiveFlag=1;
+	static_u8PassiveState=WIFI_PASSIVE_STATE_RESPONSE;
+	static_u8PassiveMatch=0;
+	static_u8PassiveError=0;
+	static_u8PreviousChar=0;
+	static_pfResponseHandler=callBackPassiveRX;
+	WIFI_voidHandleSegments(Copy_pSegments, Copy_u8Count);
+	static_pfResponseHandler=callBackRX;
+
+	return (static_u8PassiveError==0)? STATUS_OK : STATUS_NOK;
+}
+
+/*Description: This static function will send a command and wait for its response up to OK or ERROR, reading data if it is a read
+ * parameters: Command (u8*)
+ * Return: Error Status (NOK if the module answered ERROR)*/
+static u8 WIFI_u8PassiveCommand (u8* Copy_u8Command)
+{
+	UART_Segment_t Local_Segment = {Copy_u8Command, strlen(Copy_u8Command)};
+
+	return WIFI_u8PassiveSegments(&Local_Segment, 1);
+}
+
+/*Description: This static function will give the number of chars to read next : no more than the data array can still take
+ * (with the chars skipped before the required index) and no more than WIFI_PASSIVE_READ_SIZE
+ * parameters: void
+ * Return: number of chars (0 once the data array is full)*/
+static u16 WIFI_u16PassiveRoom (void)
+{
+	u32 Local_u32Room = WIFI_RECEIVE_ARRAY_SIZE-static_u32DataArrayIterator;
+
+	if (static_u8IteratorFlag==0 && static_u32RequiredIndex>static_u32DataToBeSavedIterator)
+	{
+		Local_u32Room += static_u32RequiredIndex-static_u32DataToBeSavedIterator;
+	}
+	return (Local_u32Room>WIFI_PASSIVE_READ_SIZE)? WIFI_PASSIVE_READ_SIZE : (u16)Local_u32Room;
+}
+
+/*Description: This static function will read the data kept by the module until the data array is full or the server is done
+ * The waits between empty reads are scheduler sleeps, the module holds what arrives meanwhile
+ * parameters: void
+ * Return: void*/
+static void WIFI_voidPassiveRead (void)
+{
+	/*This local array will hold the read command*/
+	u8  Local_u8Command[24];
+	u16 Local_u16Size;
+	u8  Local_u8EmptyReads=0;
+
+	static_u8StartSavingData=1;
+	while (Local_u8EmptyReads<WIFI_PASSIVE_EMPTY_READS)
+	{
+		Local_u16Size=WIFI_u16PassiveRoom();
+		if (Local_u16Size==0)
+		{
+			break;
+		}
+		sprintf(Local_u8Command, "AT+CIPRECVDATA=%d\r\n", (int)Local_u16Size);
+		static_u16PassiveReceived=0;
+		WIFI_u8PassiveCommand(Local_u8Command);
+		if (static_u16PassiveReceived!=0)
+		{
+			Local_u8EmptyReads=0;
+			continue;
+		}
+		/*Nothing kept by the module : done if the server closed, otherwise it may still be sending*/
+		if (static_u8LinkClosed)
+		{
+			break;
+		}
+		Local_u8EmptyReads++;
+		SCHED_voidSleep(WIFI_PASSIVE_POLL_MS);
+	}
+}
+#endif
+
+#if WIFI_LINK_FRAMES
+/*Description: This static function will read chars of the link, as many as the module kept up to a count
+ * parameters: destination (u8*), most chars to read (u16, WIFI_PASSIVE_READ_SIZE at most)
+ * Return: number of chars read*/
+static u16 WIFI_u16LinkRead (u8* Copy_pu8Destination, u16 Copy_u16Count)
+{
+	/*This local array will hold the read command*/
+	u8 Local_u8Command[24];
+
+	sprintf(Local_u8Command, "AT+CIPRECVDATA=%s%d\r\n", WIFI_LINK_ID, (int)Copy_u16Count);
+	static_u16PassiveReceived=0;
+	static_pu8LinkDestination=Copy_pu8Destination;
+	WIFI_u8PassiveCommand(Local_u8Command);
+	static_pu8LinkDestination=NULL;
+	/*The chars kept before the other side closed can still be read, nothing more comes after them*/
+	if (static_u8LinkClosed)
+	{
+#if WIFI_LAN_DIRECT
+		/*The host went away, the server takes the next one*/
+		static_u8LinkClosed=0;
+#else
+		static_u8LinkOpen=0;
+#endif
+	}
+	return static_u16PassiveReceived;
+}
+
+/*Description: This static function will read a number of chars of the frame being received, waiting for the ones still on their way
+ * parameters: destination (u8*), number of chars (u16)
+ * Return: Error Status (NOK if they did not all come)*/
+static u8 WIFI_u8LinkReadAll (u8* Copy_pu8Destination, u16 Copy_u16Count)
+{
+	u16 Local_u16Read;
+	u8  Local_u8EmptyReads=0;
+
+	while (Copy_u16Count!=0)
+	{
+		Local_u16Read=WIFI_u16LinkRead(Copy_pu8Destination, (Copy_u16Count>WIFI_PASSIVE_READ_SIZE)? WIFI_PASSIVE_READ_SIZE : Copy_u16Count);
+		if (Local_u16Read==0)
+		{
+			if (!static_u8LinkOpen || ++Local_u8EmptyReads>=WIFI_PASSIVE_EMPTY_READS)
+			{
+				return STATUS_NOK;
+			}
+			SCHED_voidSleep(WIFI_PASSIVE_POLL_MS);
+			continue;
+		}
+		Local_u8EmptyReads=0;
+		Copy_pu8Destination+=Local_u16Read;
+		Copy_u16Count-=Local_u16Read;
+	}
+	return STATUS_OK;
+}
+#endif
+
+/*Description: This static function will drop the connection of the link
+ * Push transport : the connection to the command server is closed and passive receiving left, before an exchange with the
+ * channels (the module has one connection and those exchanges read in active receiving)
+ * LAN direct : the connection of the host is closed (the frames start again on its next one), the server stays
+ * parameters: void
+ * Return: void*/
+static void WIFI_voidLinkClose (void)
+{
+#if WIFI_LAN_DIRECT
+	WIFI_u8PassiveCommand(WIFI_COMMAND_LAN_CLOSE);
+#elif WIFI_PUSH_TRANSPORT
+	if (static_u8LinkPassive)
 	{
-		/*Receive Response*/
-		HUART_u8ReceiveAsync(Static_UART_PERIPHERAL, &static_u8Response, sizeof(static_u8Response));
+		if (static_u8LinkOpen)
+		{
+			WIFI_u8PassiveCommand(WIFI_COMMAND_CLOSE);
+		}
+		WIFI_u8PassiveCommand(WIFI_COMMAND_PASSIVE_MODE_OFF);
+		static_u8LinkPassive=0;
 	}
+	static_u8LinkOpen=0;
+#endif
 }
 
+/*Description: This API will open the link the commands come on, if it is not open yet
+ * Push transport : connects to the command server, LAN direct : starts the server the host connects to
+ * parameters: void
+ * Return: Error Status (NOK if both are off or the link cannot be opened)*/
+u8 WIFI_u8LinkOpen (void)
+{
+	/*This local variable will hold status of function*/
+	u8 Local_u8Status = STATUS_NOK;
+#if WIFI_LAN_DIRECT
+	/*This local array will hold the data that will be sent*/
+	u8 Local_u8SendConnectionType[]="AT+CIPMUX=1\r\n";
+	u8 Local_u8SendMaxConnections[]="AT+CIPSERVERMAXCONN=1\r\n";
+	u8 Local_u8SendStartServer[32];
+	u8 Local_u8SendTimeout[24];
+
+	/*If wifi peripheral has been initialized, proceed with the code*/
+	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
+	{
+		if (static_u8LinkOpen)
+		{
+			return STATUS_OK;
+		}
+		sprintf(Local_u8SendStartServer, "AT+CIPSERVER=1,%d\r\n", (int)WIFI_LAN_PORT);
+		sprintf(Local_u8SendTimeout, "AT+CIPSTO=%d\r\n", (int)WIFI_LAN_IDLE_TIMEOUT_S);
+		/*Many connections must be on before the server starts, and passive receiving before a host connects*/
+		if (WIFI_u8PassiveCommand(Local_u8SendConnectionType)==STATUS_OK &&
+			WIFI_u8PassiveCommand(WIFI_COMMAND_PASSIVE_MODE_ON)==STATUS_OK &&
+			WIFI_u8PassiveCommand(Local_u8SendMaxConnections)==STATUS_OK &&
+			WIFI_u8PassiveCommand(Local_u8SendStartServer)==STATUS_OK)
+		{
+			WIFI_u8PassiveCommand(Local_u8SendTimeout);
+			static_u8LinkClosed=0;
+			static_u8LinkOpen=1;
+			static_u8LinkPassive=1;
+			static_u8LinkWanted=1;
+			Local_u8Status=STATUS_OK;
+		}
+	}
+#elif WIFI_PUSH_TRANSPORT
+	/*This local array will hold the data that will be sent*/
+	u8 Local_u8SendConnectionType[]="AT+CIPMUX=0\r\n";
+	u8 Local_u8SendStartConnection[64];
+
+	/*If wifi peripheral has been initialized, proceed with the code*/
+	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
+	{
+		if (static_u8LinkOpen)
+		{
+			return STATUS_OK;
+		}
+		static_pfResponseHandler=callBackRX;
+		WIFI_u8SendCommand(Local_u8SendConnectionType);
+		/*The frames are kept by the module until they are read, one frame is never read with the next one*/
+		if (WIFI_u8PassiveCommand(WIFI_COMMAND_PASSIVE_MODE_ON)==STATUS_OK)
+		{
+			static_u8LinkClosed=0;
+			sprintf(Local_u8SendStartConnection, "AT+CIPSTART=\"TCP\",\"%s\",%d,%d\r\n", WIFI_PUSH_SERVER, (int)WIFI_PUSH_PORT, (int)WIFI_PUSH_KEEPALIVE_S);
+			/*CONNECT then OK, or ERROR (and CLOSED) when the server cannot be reached*/
+			if (WIFI_u8PassiveCommand(Local_u8SendStartConnection)==STATUS_OK)
+			{
+				static_u8LinkOpen=1;
+				static_u8LinkPassive=1;
+				static_u8LinkWanted=1;
+				Local_u8Status=STATUS_OK;
+			}
+			else
+			{
+				WIFI_u8PassiveCommand(WIFI_COMMAND_PASSIVE_MODE_OFF);
+				static_u8LinkPassive=0;
+			}
+		}
+	}
+#endif
+	return Local_u8Status;
+}
+
+/*Description: This API will tell whether the link the commands come on is open (as far as the module told)
+ * parameters: void
+ * Return: 1 if open, 0 otherwise*/
+u8 WIFI_u8LinkIsOpen (void)
+{
+#if WIFI_LINK_FRAMES
+	return static_u8LinkOpen;
+#else
+	return 0;
+#endif
+}
+
+#if WIFI_LINK_FRAMES
+/*Description: This static function will send chars as one frame on the link, the header goes out with them in the same send
+ * parameters: chars (u8*), number of chars (u16)
+ * Return: Error Status (NOK if the module did not take it, the connection is then dropped)*/
+static u8 WIFI_u8LinkSendFrame (const u8* Copy_pu8Chars, u16 Copy_u16Count)
+{
+	/*This local variable will hold status of function*/
+	u8 Local_u8Status = STATUS_NOK;
+	u8 Local_u8Length[2] = {(u8)(Copy_u16Count>>8), (u8)Copy_u16Count};
+	u8 Local_u8Header[WIFI_LINK_FRAME_HEADER_SIZE];
+	u8 Local_u8SendSize[24];
+	/*This local array will hold the parts of the frame*/
+	UART_Segment_t Local_Segments[2];
+
+	HEX_voidEncode(Local_u8Length, Local_u8Header, 2);
+	Local_Segments[0].data=Local_u8Header;		Local_Segments[0].length=WIFI_LINK_FRAME_HEADER_SIZE;
+	Local_Segments[1].data=Copy_pu8Chars;		Local_Segments[1].length=Copy_u16Count;
+	sprintf(Local_u8SendSize, "AT+CIPSEND=%s%d\r\n", WIFI_LINK_ID, (int)(Copy_u16Count+WIFI_LINK_FRAME_HEADER_SIZE));
+	/*OK then the prompt, the frame is sent once the prompt is surely out*/
+	if (WIFI_u8PassiveCommand(Local_u8SendSize)==STATUS_OK)
+	{
+		SCHED_voidSleep(20);
+		/*Recv ... bytes then SEND OK, or ERROR*/
+		Local_u8Status=WIFI_u8PassiveSegments(Local_Segments, 2);
+	}
+	if (Local_u8Status!=STATUS_OK)
+	{
+		WIFI_voidLinkClose();
+	}
+	return Local_u8Status;
+}
+
+/*Description: This static function will take the next frame of the link, if one came, the chars are ended by a null if there is room
+ * The header is read alone first, so the frames behind this one stay in the module for the next polls
+ * parameters: buffer for the chars (u8*), size of the buffer (u16)
+ * Return: Error Status (NOK if no frame came or the connection broke, the buffer is then left empty)*/
+static u8 WIFI_u8LinkReceiveFrame (u8* Copy_u8Buffer, u16 Copy_u16Size)
+{
+	u8  Local_u8Header[WIFI_LINK_FRAME_HEADER_SIZE];
+	u8  Local_u8Length[2];
+	u16 Local_u16Length;
+	u16 Local_u16Read;
+
+	Local_u16Read=WIFI_u16LinkRead(Local_u8Header, WIFI_LINK_FRAME_HEADER_SIZE);
+	if (Local_u16Read==0)
+	{
+		return STATUS_NOK;
+	}
+	/*A frame is sent at once, the rest of its header is on its way*/
+	if (WIFI_u8LinkReadAll(&Local_u8Header[Local_u16Read], WIFI_LINK_FRAME_HEADER_SIZE-Local_u16Read)!=STATUS_OK ||
+		HEX_u8Decode(Local_u8Header, Local_u8Length, 2)!=STATUS_OK)
+	{
+		WIFI_voidLinkClose();
+		return STATUS_NOK;
+	}
+	Local_u16Length=((u16)Local_u8Length[0]<<8) | Local_u8Length[1];
+	/*A frame that does not fit cannot be skipped for sure, the frames start again on a new connection*/
+	if (Local_u16Length>Copy_u16Size || WIFI_u8LinkReadAll(Copy_u8Buffer, Local_u16Length)!=STATUS_OK)
+	{
+		memset(Copy_u8Buffer, 0, Copy_u16Size);
+		WIFI_voidLinkClose();
+		return STATUS_NOK;
+	}
+	if (Local_u16Length<Copy_u16Size)
+	{
+		Copy_u8Buffer[Local_u16Length]=0;
+	}
+	static_u16LinkFrameLength=Local_u16Length;
+	return STATUS_OK;
+}
+#endif
+
+#if WIFI_LAN_DIRECT
+/*Description: This static function will ask the host for chars of the image text and wait for them
+ * The request is WIFI_LAN_DATA_REQUEST then the first char and the number of chars (8 and 4 hex chars), the answer is the next
+ * frame of the host (it sends no command while a request is pending), the chars past the end of the text are not sent
+ * parameters: first char (u32), number of chars (u16), destination (u8*, number of chars at least)
+ * Return: Error Status (NOK if the host did not answer in time)*/
+static u8 WIFI_u8LanReceiveData (u32 Copy_u32First, u16 Copy_u16Count, u8* Copy_u8Destination)
+{
+	u8  Local_u8Request[1+12];
+	u8  Local_u8Numbers[6]={(u8)(Copy_u32First>>24), (u8)(Copy_u32First>>16), (u8)(Copy_u32First>>8), (u8)Copy_u32First,
+							(u8)(Copy_u16Count>>8), (u8)Copy_u16Count};
+	u32 Local_u32Waited=0;
+
+	Local_u8Request[0]=WIFI_LAN_DATA_REQUEST;
+	HEX_voidEncode(Local_u8Numbers, &Local_u8Request[1], sizeof(Local_u8Numbers));
+	memset(Copy_u8Destination, 0, Copy_u16Count);
+	if (WIFI_u8LinkSendFrame(Local_u8Request, sizeof(Local_u8Request))!=STATUS_OK)
+	{
+		return STATUS_NOK;
+	}
+	while (WIFI_u8LinkReceiveFrame(Copy_u8Destination, Copy_u16Count)!=STATUS_OK)
+	{
+		if (Local_u32Waited>=WIFI_LAN_DATA_TIMEOUT_MS)
+		{
+			return STATUS_NOK;
+		}
+		SCHED_voidSleep(WIFI_LAN_POLL_MS);
+		Local_u32Waited+=WIFI_LAN_POLL_MS;
+	}
+	return STATUS_OK;
+}
+#endif
+
 /*Description: This API will calculate data on site and return the number of chars
  * Parameters: Pointer to variable that will hold the number of chars on site
  * Return: Error Status*/
@@ -222,6 +792,8 @@ u8 WIFI_u8CountData(u32* Copy_u32DataSize)
 {
 	/*This local variable will hold status of function*/
 	u8 Local_u8Status = STATUS_NOK;
+	/*Cycle stamp of the start of the exchange with the server (performance stats)*/
+	u32 Local_u32StartCycles;
 	/*This local array will hold the data that will be sent*/
 	u8 Local_u8SendConnectionType[]="AT+CIPMUX=0\r\n";
 	u8 Local_u8SendStartConnection[]="AT+CIPSTART=\"TCP\",\"api.thingspeak.com\",80\r\n";
@@ -231,23 +803,26 @@ u8 WIFI_u8CountData(u32* Copy_u32DataSize)
 	/*If wifi peripheral has been initialized, proceed with the code*/
 	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
 	{
+		Local_u32StartCycles=STATS_u32Start();
+		/*The module has one connection, the one to the command server is opened again after this exchange*/
+		WIFI_voidLinkClose();
 
 		/*Send first part to WIFI peripheral, which specifies the number of connections we will be using (which is 1)*/
 		WIFI_u8SendCommand(Local_u8SendConnectionType);
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 
 		/*Send second part to WIFI peripheral, which is to connect to specific server*/
 		WIFI_u8SendCommand(Local_u8SendStartConnection);
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 
 		/*Send third part to WIFI peripheral, which is to specify size of command*/
 		WIFI_u8SendCommand(Local_u8SendSize);
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 
 		/*Set data to array flag*/
 		static_u8DataToArray=1;
 		/*Send final part to WIFI peripheral, which is the request*/
-		HUART_u8SetRXCallBack(callBackCountingRX, Static_UART_PERIPHERAL.BaseAddress);
+		static_pfResponseHandler=callBackCountingRX;
 		/*Reset receive flag if it has not been initialized*/
 		static_u8ReceiveFlag=1;
 		/*Send data using static send request*/
@@ -260,6 +835,7 @@ u8 WIFI_u8CountData(u32* Copy_u32DataSize)
 		 * into two*/
 		*Copy_u32DataSize=(static_u32DataSize-2)/2;
 
+		STATS_voidStop(STATS_TIME_NETWORK, Local_u32StartCycles);
 		Local_u8Status=STATUS_OK;
 	}
 	return Local_u8Status;
@@ -275,17 +851,36 @@ u8 WIFI_u8Init (UART_GPIO_t UART_Peripheral)
 	u8 Local_u8Status = STATUS_NOK;
 	/*This local variable will be sent to wifi module so that it will be reset*/
 	u8 Local_u8Send[]="AT+RST\r\n";
-	/*Initialization will be done by calling initialize function of HUART*/
+	/*Initialization will be done by calling initialize function of HUART, the module starts at 115200 after reset*/
 	Local_u8Status= HUART_u8Init(UART_Peripheral, 115200, UART_STOP_BIT1, UART_PARITY_DISABLED);
 	/*If initialization was successful, save uart address in the static variable*/
 	if (Local_u8Status == STATUS_OK)
 	{
 		Static_UART_PERIPHERAL = UART_Peripheral;
+		/*From now on the chars sent by the module are kept in the rx ring until they are read*/
+		HUART_u8StartRXRing(Static_UART_PERIPHERAL);
 		/*Send reset to the Module*/
 		HUART_u8SendSync(Static_UART_PERIPHERAL, Local_u8Send, strlen(Local_u8Send), 1);
 	}
 	/*This delay is needed for initialization to be done*/
-	delay_ms(10000);
+	SCHED_voidSleep(10000);
+#if (WIFI_BAUD_RATE != 115200) || (WIFI_FLOW_CONTROL != 0)
+	if (Local_u8Status == STATUS_OK)
+	{
+		/*The module answers OK with the old settings then moves, so the peripheral follows once the answer is in
+		 * The last field is the flow control of the module, with the same bits (1 RTS, 2 CTS)*/
+		u8 Local_u8SendBaudrate[40];
+		sprintf(Local_u8SendBaudrate, "AT+UART_CUR=%lu,8,1,0,%d\r\n", (unsigned long)WIFI_BAUD_RATE, (int)WIFI_FLOW_CONTROL);
+		WIFI_u8SendCommand(Local_u8SendBaudrate);
+		HUART_u8FlushTX(Static_UART_PERIPHERAL, 10);
+		Local_u8Status= HUART_u8Init(Static_UART_PERIPHERAL, WIFI_BAUD_RATE, UART_STOP_BIT1, UART_PARITY_DISABLED);
+		if (Local_u8Status == STATUS_OK)
+		{
+			Local_u8Status= HUART_u8SetFlowControl(Static_UART_PERIPHERAL, WIFI_FLOW_CONTROL);
+		}
+		HUART_voidFlushRX(Static_UART_PERIPHERAL);
+	}
+#endif
 	/*Return Status*/
 	return Local_u8Status;
 }
@@ -313,7 +908,7 @@ u8 WIFI_u8SendCommand (u8* Copy_u8DesiredCommand)
 	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
 	{
 		/*Set callback function*/
-		HUART_u8SetRXCallBack(callBackRX, Static_UART_PERIPHERAL.BaseAddress);
+		static_pfResponseHandler=callBackRX;
 		/*Send data using static send request*/
 		WIFI_voidHandleRequest(Copy_u8DesiredCommand);
 		/*Return request as OK because the previous function contained while loop*/
@@ -334,6 +929,8 @@ u8 WIFI_u8ConnectToAccessPoint (u8* Copy_u8SSID, u8* Copy_u8Password)
 	u8 Local_u8SendPart1[]="AT+CWJAP_CUR=\"";
 	u8 Local_u8SendPart2[]="\",\"";
 	u8 Local_u8SendPart3[]="\"\r\n";
+	/*This local array will hold the parts of the command*/
+	UART_Segment_t Local_Segments[5];
 	/*Reset receive flag if it has not been initialized*/
 	static_u8ReceiveFlag=1;
 
@@ -341,24 +938,16 @@ u8 WIFI_u8ConnectToAccessPoint (u8* Copy_u8SSID, u8* Copy_u8Password)
 	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
 	{
 		/*Set Callback function*/
-		HUART_u8SetRXCallBack(callBackRX, Static_UART_PERIPHERAL.BaseAddress);
-
-		HUART_u8SendSync(Static_UART_PERIPHERAL, Local_u8SendPart1, strlen(Local_u8SendPart1),1);
-		/*Wait until we reach the point where we should send the name*/
-		HUART_u8SendSync(Static_UART_PERIPHERAL, Copy_u8SSID, strlen(Copy_u8SSID),1);
-		/*Send part between name and password*/
-		HUART_u8SendSync(Static_UART_PERIPHERAL, Local_u8SendPart2, strlen(Local_u8SendPart2),1);
-		/*Send Password*/
-		HUART_u8SendSync(Static_UART_PERIPHERAL, Copy_u8Password, strlen(Copy_u8Password),1);
-		/*Send last part of command*/
-		HUART_u8SendSync(Static_UART_PERIPHERAL, Local_u8SendPart3, strlen(Local_u8SendPart3),1);
-
-		/*Enter the loop for sending and receiving data from UART*/
-		while(static_u8ReceiveFlag)
-		{
-			/*Receive Response*/
-			HUART_u8ReceiveAsync(Static_UART_PERIPHERAL, &static_u8Response, sizeof(static_u8Response));
-		}
+		static_pfResponseHandler=callBackRX;
+
+		/*Command start, name, part between name and password, password and last part of command go out as one command*/
+		Local_Segments[0].data=Local_u8SendPart1;	Local_Segments[0].length=sizeof(Local_u8SendPart1)-1;
+		Local_Segments[1].data=Copy_u8SSID;			Local_Segments[1].length=strlen(Copy_u8SSID);
+		Local_Segments[2].data=Local_u8SendPart2;	Local_Segments[2].length=sizeof(Local_u8SendPart2)-1;
+		Local_Segments[3].data=Copy_u8Password;		Local_Segments[3].length=strlen(Copy_u8Password);
+		Local_Segments[4].data=Local_u8SendPart3;	Local_Segments[4].length=sizeof(Local_u8SendPart3)-1;
+		/*Send the command and wait for its response*/
+		WIFI_voidHandleSegments(Local_Segments, 5);
 		/*Since we reached here, set status as ok*/
 		Local_u8Status=STATUS_OK;
 	}
@@ -374,6 +963,8 @@ u8 WIFI_u8ReceiveData (u16 Copy_u16startByte, u16 Copy_u16TotalSize, u8* Copy_u8
 {
 	/*This local variable will hold status of function*/
 	u8 Local_u8Status = STATUS_NOK;
+	/*Cycle stamp of the start of the exchange with the server (performance stats)*/
+	u32 Local_u32StartCycles;
 	/*This local array will hold the data that will be sent*/
 	u8 Local_u8SendConnectionType[]="AT+CIPMUX=0\r\n";
 	u8 Local_u8SendStartConnection[]="AT+CIPSTART=\"TCP\",\"api.thingspeak.com\",80\r\n";
@@ -384,6 +975,8 @@ u8 WIFI_u8ReceiveData (u16 Copy_u16startByte, u16 Copy_u16TotalSize, u8* Copy_u8
 	u8 Local_u8DataTransferFlag=1;
 	/*This iterator will be used to copy data to passed array*/
 	u16 Local_u16DataToBePassedIterator=0;
+	/*This local variable will be set when the data is read in passive receiving*/
+	u8 Local_u8Passive=0;
 
 	/*Reinitialize array so that we recieve new data successfully*/
 	memset(Global_u8DataReceivedArray,0,sizeof(Global_u8DataReceivedArray));
@@ -412,34 +1005,69 @@ u8 WIFI_u8ReceiveData (u16 Copy_u16startByte, u16 Copy_u16TotalSize, u8* Copy_u8
 	/*If wifi peripheral has been initialized, proceed with the code*/
 	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
 	{
-		HUART_u8SetRXCallBack(callBackRX, Static_UART_PERIPHERAL.BaseAddress);
+		Local_u32StartCycles=STATS_u32Start();
+#if WIFI_LAN_DIRECT
+		/*The host serves the image text itself, the window is asked for on the link*/
+		Local_u8Status=WIFI_u8LanReceiveData(static_u32RequiredIndex, WIFI_RECEIVE_ARRAY_SIZE, Copy_u8DestinationArray);
+		STATS_voidStop(STATS_TIME_NETWORK, Local_u32StartCycles);
+		if (Local_u8Status==STATUS_OK)
+		{
+			STATS_voidCount(STATS_BYTES_RECEIVED, static_u16LinkFrameLength);
+		}
+		return Local_u8Status;
+#endif
+		/*The module has one connection, the one to the command server is opened again after this exchange*/
+		WIFI_voidLinkClose();
+		static_pfResponseHandler=callBackRX;
 		/*Send first part to WIFI peripheral, which specifies the number of connections we will be using (which is 1)*/
 		WIFI_u8SendCommand(Local_u8SendConnectionType);
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
+#if WIFI_PASSIVE_RECEIVE
+		/*The server data is kept by the module until it is read, modules that refuse the command send it as it comes*/
+		Local_u8Passive=(WIFI_u8PassiveCommand(WIFI_COMMAND_PASSIVE_MODE_ON)==STATUS_OK);
+		static_u8LinkClosed=0;
+#endif
 
 		/*Send second part to WIFI peripheral, which is to connect to specific server*/
 		WIFI_u8SendCommand(Local_u8SendStartConnection);
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 
 		/*Send third part to WIFI peripheral, which is to specify size of command*/
 		WIFI_u8SendCommand(Local_u8SendSize);
-		delay_ms(1000);
-
-		/*Set data to array flag*/
-		static_u8DataToArray=1;
-		/*Send final part to WIFI peripheral, which is the request*/
-		WIFI_u8SendCommand(Local_u8SendRequest);
-		/*Set data to array flag*/
-		static_u8DataToArray=0;
+		SCHED_voidSleep(1000);
 
-		/*Check if the last two characters are data or the 'C'&'L' of word closed, if so we need to make them equal to null*/
-		if (Global_u8DataReceivedArray[static_u32DataArrayIterator-1]=='L')
+#if WIFI_PASSIVE_RECEIVE
+		if (Local_u8Passive)
 		{
-			Global_u8DataReceivedArray[static_u32DataArrayIterator-1]=0;
+			/*Send final part to WIFI peripheral, which is the request, its response ends with SEND OK*/
+			WIFI_u8PassiveCommand(Local_u8SendRequest);
+			/*Read the chars the data array can take, then drop the rest with the connection*/
+			WIFI_voidPassiveRead();
+			if (!static_u8LinkClosed)
+			{
+				WIFI_u8PassiveCommand(WIFI_COMMAND_CLOSE);
+			}
+			WIFI_u8PassiveCommand(WIFI_COMMAND_PASSIVE_MODE_OFF);
 		}
-		if (Global_u8DataReceivedArray[static_u32DataArrayIterator-2] == 'C')
+		else
+#endif
 		{
-			Global_u8DataReceivedArray[static_u32DataArrayIterator-2]=0;
+			/*Set data to array flag*/
+			static_u8DataToArray=1;
+			/*Send final part to WIFI peripheral, which is the request*/
+			WIFI_u8SendCommand(Local_u8SendRequest);
+			/*Set data to array flag*/
+			static_u8DataToArray=0;
+
+			/*Check if the last two characters are data or the 'C'&'L' of word closed, if so we need to make them equal to null*/
+			if (Global_u8DataReceivedArray[static_u32DataArrayIterator-1]=='L')
+			{
+				Global_u8DataReceivedArray[static_u32DataArrayIterator-1]=0;
+			}
+			if (Global_u8DataReceivedArray[static_u32DataArrayIterator-2] == 'C')
+			{
+				Global_u8DataReceivedArray[static_u32DataArrayIterator-2]=0;
+			}
 		}
 
 		/*Transfer Data to passed buffer*/
@@ -455,6 +1083,8 @@ u8 WIFI_u8ReceiveData (u16 Copy_u16startByte, u16 Copy_u16TotalSize, u8* Copy_u8
 				Local_u8DataTransferFlag=0;
 			}
 		}
+		STATS_voidStop(STATS_TIME_NETWORK, Local_u32StartCycles);
+		STATS_voidCount(STATS_BYTES_RECEIVED, Local_u16DataToBePassedIterator);
 		/*Since we reached here, set status as ok*/
 		Local_u8Status=STATUS_OK;
 	}
@@ -468,65 +1098,140 @@ u8 WIFI_u8ReceiveData (u16 Copy_u16startByte, u16 Copy_u16TotalSize, u8* Copy_u8
  * Return: Error Status*/
 u8 WIFI_u8SendCommandToServer (u8* Copy_u8commandNumber, u16 Copy_u16Size)
 {
+	/*The chars are already encoded by the caller, they go in the request as they are*/
+	WIFI_voidReplyBegin();
+	if (Copy_u16Size > WIFI_REPLY_MAX_CHARS)
+	{
+		static_u8ReplyOverflow=1;
+		Copy_u16Size=WIFI_REPLY_MAX_CHARS;
+	}
+	memcpy(&static_u8ReplyRequest[static_u16ReplyLength], Copy_u8commandNumber, Copy_u16Size);
+	static_u16ReplyLength+=Copy_u16Size;
+
+	return WIFI_u8ReplySend();
+}
 
+/*Description: This API will start a new reply to the server, dropping whatever was appended before
+ * parameters: void
+ * Return: void*/
+void WIFI_voidReplyBegin (void)
+{
+	/*The prefix never leaves the buffer, only the write position goes back to its end*/
+	static_u16ReplyLength=WIFI_REPLY_PREFIX_LEN;
+	static_u8ReplyOverflow=0;
+}
+
+/*Description: This API will append one byte to the reply, as two hex chars written directly in the request buffer
+ * parameters: Byte to append (u8)
+ * Return: void*/
+void WIFI_voidReplyAppendU8 (u8 Copy_u8Value)
+{
+	WIFI_voidReplyAppendBytes(&Copy_u8Value, 1);
+}
+
+/*Description: This API will append a half word to the reply, least significant byte first
+ * parameters: Half word to append (u16)
+ * Return: void*/
+void WIFI_voidReplyAppendU16 (u16 Copy_u16Value)
+{
+	WIFI_voidReplyAppendU8((u8)Copy_u16Value);
+	WIFI_voidReplyAppendU8((u8)(Copy_u16Value>>8));
+}
+
+/*Description: This API will append a word to the reply, least significant byte first
+ * parameters: Word to append (u32)
+ * Return: void*/
+void WIFI_voidReplyAppendU32 (u32 Copy_u32Value)
+{
+	WIFI_voidReplyAppendU16((u16)Copy_u32Value);
+	WIFI_voidReplyAppendU16((u16)(Copy_u32Value>>16));
+}
+
+/*Description: This API will append bytes to the reply, they are read from their place (RAM or flash) and not copied before
+ * parameters: Bytes to append (u8*), Number of bytes (u16)
+ * Return: void*/
+void WIFI_voidReplyAppendBytes (const u8* Copy_pu8Bytes, u16 Copy_u16Count)
+{
+	if (static_u16ReplyLength+(u32)Copy_u16Count*2 > WIFI_REPLY_PREFIX_LEN+WIFI_REPLY_MAX_CHARS)
+	{
+		static_u8ReplyOverflow=1;
+	}
+	else
+	{
+		HEX_voidEncode(Copy_pu8Bytes, &static_u8ReplyRequest[static_u16ReplyLength], Copy_u16Count);
+		static_u16ReplyLength+=Copy_u16Count*2;
+	}
+}
+
+/*Description: This API will send the reply built so far to our server
+ * parameters: void
+ * Return: Error Status (NOK if the wifi is not initialized or the reply did not fit WIFI_REPLY_MAX_BYTES)*/
+u8 WIFI_u8ReplySend (void)
+{
 	/*This local variable will hold status of function*/
 	u8 Local_u8Status = STATUS_NOK;
+	/*Cycle stamp of the start of the exchange with the server (performance stats)*/
+	u32 Local_u32StartCycles;
 	/*This local array will hold the data that will be sent*/
 	u8 Local_u8SendConnectionType[]="AT+CIPMUX=0\r\n";
 	u8 Local_u8SendStartConnection[]="AT+CIPSTART=\"TCP\",\"api.thingspeak.com\",80\r\n";
-	//u8 Local_u8SendSize[]="AT+CIPSEND=99\r\n";
 	u8 Local_u8SendSize[20]={0};
-	//u8 Local_u8SendSize[]="AT+CIPSEND=118\r\n";
-	/*These local variables will contain the command that we want to send to our server. It is divided as two parts so that we can concatenate command to it*/
-	//u8 Local_u8SendRequest[512]="GET https://api.thingspeak.com/update?api_key=1H61N46CEZA65MTJ&field1=";
-	u8 Local_u8SendRequest[512]="GET https://api.thingspeak.com/update?api_key=PCF4VMCRFW340IZ8&field1=";
-	u8 Local_u8SendRequest2[]="\r\nHost:api.thingspeak.com\r\n\r\n\r\n\r\n\r\n";
-	/*This Local variable will be used as an iterator for concatenating string, we will use it so that we can avoid garbage better*/
-	u16 Local_u16Iterator=0;
-	/*This Local variable will hold the size of data to be sent*/
-	volatile u16 Local_u16DataSize=0;
-
+	/*This local array will hold the parts of the request*/
+	UART_Segment_t Local_Segments[2];
 
-	/*Concatenate command and strings together*/
-	for (Local_u16Iterator=0; Local_u16Iterator<Copy_u16Size;Local_u16Iterator++)
+	/*A reply that did not fit would reach the host cut, it is not sent at all*/
+	if (static_u8ReplyOverflow==1)
 	{
-		/*We will append each character to the string, the length of the original string before the appended one is 70*/
-		Local_u8SendRequest[Local_u16Iterator+70]=Copy_u8commandNumber[Local_u16Iterator];
+		return Local_u8Status;
 	}
-	strcat(Local_u8SendRequest,Local_u8SendRequest2);
 
-	Local_u16DataSize = strlen(Local_u8SendRequest);
-	Local_u16DataSize-=2;
+	/*The request is the prefix and chars built in place, then the suffix straight from flash*/
+	Local_Segments[0].data=static_u8ReplyRequest;						Local_Segments[0].length=static_u16ReplyLength;
+	Local_Segments[1].data=(const u8*)WIFI_REPLY_REQUEST_SUFFIX;		Local_Segments[1].length=WIFI_REPLY_SUFFIX_LEN;
+
 	/*Concatenate size to the string of the size
 	 * we will use sprintf so that int will be concatenated to string*/
-	sprintf(Local_u8SendSize, "AT+CIPSEND=%d\r\n", (int)Local_u16DataSize);
-	//u8 Local_u8SendRequest[]="GET https://api.thingspeak.com/channels/1082594/fields/1/last.txt?api_key=GL3M7JAK48BR8RRA\r\nHost:api.thingspeak.com\r\n\r\n\r\n\r\n\r\n";
+	sprintf(Local_u8SendSize, "AT+CIPSEND=%d\r\n", (int)(static_u16ReplyLength+WIFI_REPLY_SUFFIX_LEN-2));
 
 	/*If wifi peripheral has been initialized, proceed with the code*/
 	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
 	{
-
-		HUART_u8SetRXCallBack(callBackRX, Static_UART_PERIPHERAL.BaseAddress);
+		Local_u32StartCycles=STATS_u32Start();
+#if WIFI_LINK_FRAMES
+		/*Once the link was opened the reply goes on it, the channel takes it only when the link cannot be opened again
+		 * The chars go as they were encoded in the request buffer, without its prefix*/
+		if (static_u8LinkWanted && WIFI_u8LinkOpen()==STATUS_OK &&
+			WIFI_u8LinkSendFrame(&static_u8ReplyRequest[WIFI_REPLY_PREFIX_LEN], static_u16ReplyLength-WIFI_REPLY_PREFIX_LEN)==STATUS_OK)
+		{
+			STATS_voidStop(STATS_TIME_NETWORK, Local_u32StartCycles);
+			return STATUS_OK;
+		}
+#if WIFI_LAN_DIRECT
+		/*The channels are not used in LAN direct mode*/
+		return Local_u8Status;
+#endif
+#endif
+		/*The module has one connection*/
+		WIFI_voidLinkClose();
+
+		static_pfResponseHandler=callBackRX;
 		/*Send first part to WIFI peripheral, which specifies the number of connections we will be using (which is 1)*/
 		WIFI_u8SendCommand(Local_u8SendConnectionType);
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 
-		/*Reset flag again and send following data*/
-		//static_u8ReceiveFlag=1;
 		/*Send second part to WIFI peripheral, which is to connect to specific server*/
 		WIFI_u8SendCommand(Local_u8SendStartConnection);
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 
-		/*Reset flag again and send following data*/
-		//static_u8ReceiveFlag=1;
 		/*Send third part to WIFI peripheral, which is to specify size of command*/
 		WIFI_u8SendCommand(Local_u8SendSize);
 
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 		/*Set data to array flag*/
 		static_u8DataToArray=1;
-		/*Send final part to WIFI peripheral, which is the request*/
-		WIFI_u8SendCommand(Local_u8SendRequest);
+		/*Send final part to WIFI peripheral, which is the request, straight from the buffer the reply was encoded in*/
+		static_u8ReceiveFlag=1;
+		WIFI_voidHandleSegments(Local_Segments, 2);
 		/*Set data to array flag*/
 		static_u8DataToArray=0;
 
@@ -534,11 +1239,11 @@ u8 WIFI_u8SendCommandToServer (u8* Copy_u8commandNumber, u16 Copy_u16Size)
 		Global_u8DataReceivedArray[static_u32DataArrayIterator-1]=0;
 		Global_u8DataReceivedArray[static_u32DataArrayIterator-2]=0;
 
+		STATS_voidStop(STATS_TIME_NETWORK, Local_u32StartCycles);
 		/*Since we reached here, set status as ok*/
 		Local_u8Status=STATUS_OK;
 	}
 	return Local_u8Status;
-
 }
 
 /*Description: This API will be used to receive command passed to server
@@ -548,6 +1253,8 @@ u8 WIFI_u8ReceiveCommand (u8* Copy_u8Buffer)
 {
 	/*This local variable will hold status of function*/
 	u8 Local_u8Status = STATUS_NOK;
+	/*Cycle stamp of the start of the exchange with the server (performance stats)*/
+	u32 Local_u32StartCycles;
 	/*This local array will hold the data that will be sent*/
 	u8 Local_u8SendConnectionType[]="AT+CIPMUX=0\r\n";
 	u8 Local_u8SendStartConnection[]="AT+CIPSTART=\"TCP\",\"api.thingspeak.com\",80\r\n";
@@ -571,24 +1278,48 @@ u8 WIFI_u8ReceiveCommand (u8* Copy_u8Buffer)
 	/*If wifi peripheral has been initialized, proceed with the code*/
 	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
 	{
-
-		HUART_u8SetRXCallBack(callBackRX, Static_UART_PERIPHERAL.BaseAddress);
+#if WIFI_LINK_FRAMES
+		/*The link is tried first, a poll that finds no frame leaves the buffer empty
+		 * The channel is polled only when the link cannot be opened (push transport)*/
+		if (WIFI_u8LinkOpen()==STATUS_OK)
+		{
+			Local_u32StartCycles=STATS_u32Start();
+			if (WIFI_u8LinkReceiveFrame(Copy_u8Buffer, WIFI_RECEIVE_ARRAY_SIZE-1)==STATUS_OK)
+			{
+				STATS_voidStop(STATS_TIME_NETWORK, Local_u32StartCycles);
+				STATS_voidCount(STATS_BYTES_RECEIVED, static_u16LinkFrameLength);
+				return STATUS_OK;
+			}
+			if (static_u8LinkOpen)
+			{
+				return STATUS_OK;
+			}
+		}
+#if WIFI_LAN_DIRECT
+		return Local_u8Status;
+#endif
+#endif
+		Local_u32StartCycles=STATS_u32Start();
+		/*The module has one connection*/
+		WIFI_voidLinkClose();
+
+		static_pfResponseHandler=callBackRX;
 		/*Send first part to WIFI peripheral, which specifies the number of connections we will be using (which is 1)*/
 		WIFI_u8SendCommand(Local_u8SendConnectionType);
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 
 		/*Reset flag again and send following data*/
 		//static_u8ReceiveFlag=1;
 		/*Send second part to WIFI peripheral, which is to connect to specific server*/
 		WIFI_u8SendCommand(Local_u8SendStartConnection);
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 
 		/*Reset flag again and send following data*/
 		//static_u8ReceiveFlag=1;
 		/*Send third part to WIFI peripheral, which is to specify size of command*/
 		WIFI_u8SendCommand(Local_u8SendSize);
 
-		delay_ms(1000);
+		SCHED_voidSleep(1000);
 
 		/*Set data to array flag*/
 		static_u8DataToArray=1;
@@ -614,6 +1345,8 @@ u8 WIFI_u8ReceiveCommand (u8* Copy_u8Buffer)
 				Local_u8Flag=0;
 			}
 		}
+		STATS_voidStop(STATS_TIME_NETWORK, Local_u32StartCycles);
+		STATS_voidCount(STATS_BYTES_RECEIVED, Local_u16Iterator);
 		/*Since we reached here, set status as ok*/
 		Local_u8Status=STATUS_OK;
 	}
@@ -622,6 +1355,167 @@ u8 WIFI_u8ReceiveCommand (u8* Copy_u8Buffer)
 	return Local_u8Status;
 }
 
+/*Header of a datagram given by the module in active receiving ("+IPD,<length>:<chars>")*/
+#define WIFI_MCAST_DATA_HEADER			"+IPD,"
+
+/*Description: This API will open the UDP link of the multicast image download, the link of the commands is closed first
+ * parameters: void
+ * Return: Error Status (NOK without passive receiving, in LAN direct mode or if the module refused the link)*/
+u8 WIFI_u8McastOpen (void)
+{
+	/*This local variable will hold status of function*/
+	u8 Local_u8Status = STATUS_NOK;
+#if WIFI_PASSIVE_RECEIVE && !WIFI_LAN_DIRECT
+	/*This local array will hold the start of the link*/
+	u8 Local_u8SendStart[80];
+
+	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
+	{
+		/*The module has one connection, the datagrams are given as they come (UDP has no passive receiving)*/
+		WIFI_voidLinkClose();
+		WIFI_u8PassiveCommand((u8*)"AT+CIPMUX=0\r\n");
+		WIFI_u8PassiveCommand(WIFI_COMMAND_PASSIVE_MODE_OFF);
+		/*Mode 2 : the answers go to the host that sent the last datagram*/
+		sprintf(Local_u8SendStart, "AT+CIPSTART=\"UDP\",\"%s\",%d,%d,2\r\n", WIFI_MCAST_GROUP, (int)WIFI_MCAST_PORT, (int)WIFI_MCAST_PORT);
+		Local_u8Status=WIFI_u8PassiveCommand(Local_u8SendStart);
+		/*Nothing received before the first wait belongs to the download*/
+		HUART_voidFlushRX(Static_UART_PERIPHERAL);
+	}
+#endif
+	return Local_u8Status;
+}
+
+/*Description: This API will wait for the next datagram of the UDP link and take its chars
+ * The chars are taken from the rx ring as the module sends them : a datagram that comes while the CPU is stalled (flash
+ * operation) loses chars, it is then shorter than its header tells and dropped by the caller
+ * parameters: buffer (u8*), size of the buffer (u16, the chars past it are dropped), longest time with no char in ms (u32)
+ * Return: number of chars of the datagram (0 if the time was over)*/
+u16 WIFI_u16McastReceive (u8* Copy_u8Buffer, u16 Copy_u16Size, u32 Copy_u32TimeoutMs)
+{
+	/*This local array will hold the chars of a datagram that do not fit the buffer*/
+	u8  Local_u8Drop[WIFI_RX_CHUNK_SIZE];
+	u8  Local_u8Char;
+	u8  Local_u8Match=0;
+	u8  Local_u8InLength=0;
+	u16 Local_u16Length=0;
+	u16 Local_u16Taken=0;
+	u16 Local_u16Count;
+	u32 Local_u32Waited=0;
+
+	if (Static_UART_PERIPHERAL.BaseAddress==NULL) return 0;
+	while (1)
+	{
+		/*The chars of the datagram are read straight to the buffer, the header one char at a time*/
+		if (Local_u16Length!=0)
+		{
+			Local_u16Count=Local_u16Length-Local_u16Taken;
+			if (Local_u16Taken<Copy_u16Size)
+			{
+				if (Local_u16Count>Copy_u16Size-Local_u16Taken) Local_u16Count=Copy_u16Size-Local_u16Taken;
+				Local_u16Count=HUART_u16Read(Static_UART_PERIPHERAL, &Copy_u8Buffer[Local_u16Taken], Local_u16Count);
+			}
+			else
+			{
+				if (Local_u16Count>WIFI_RX_CHUNK_SIZE) Local_u16Count=WIFI_RX_CHUNK_SIZE;
+				Local_u16Count=HUART_u16Read(Static_UART_PERIPHERAL, Local_u8Drop, Local_u16Count);
+			}
+			Local_u16Taken+=Local_u16Count;
+			if (Local_u16Taken==Local_u16Length)
+			{
+				STATS_voidCount(STATS_BYTES_RECEIVED, Local_u16Length);
+				return (Local_u16Length<=Copy_u16Size)? Local_u16Length : Copy_u16Size;
+			}
+		}
+		else
+		{
+			Local_u16Count=HUART_u16Read(Static_UART_PERIPHERAL, &Local_u8Char, 1);
+			if (Local_u16Count!=0 && Local_u8Char!=0)
+			{
+				if (Local_u8InLength)
+				{
+					if (Local_u8Char>='0' && Local_u8Char<='9')
+					{
+						Local_u16Taken=Local_u16Taken*10+(Local_u8Char-'0');
+					}
+					else if (Local_u8Char==':')
+					{
+						/*The length was counted in Local_u16Taken, the chars come next*/
+						Local_u16Length=Local_u16Taken;
+						Local_u16Taken=0;
+						Local_u8InLength=0;
+					}
+					else if (Local_u8Char!=',')
+					{
+						Local_u16Taken=0;
+						Local_u8InLength=0;
+					}
+				}
+				else if (Local_u8Char==WIFI_MCAST_DATA_HEADER[Local_u8Match])
+				{
+					Local_u8Match++;
+					if (WIFI_MCAST_DATA_HEADER[Local_u8Match]==0)
+					{
+						Local_u8Match=0;
+						Local_u8InLength=1;
+						Local_u16Taken=0;
+					}
+				}
+				else
+				{
+					Local_u8Match=(Local_u8Char==WIFI_MCAST_DATA_HEADER[0]);
+				}
+			}
+		}
+		if (Local_u16Count!=0)
+		{
+			Local_u32Waited=0;
+			continue;
+		}
+		if (Local_u32Waited>=Copy_u32TimeoutMs) return 0;
+		SCHED_voidSleep(WIFI_MCAST_POLL_MS);
+		Local_u32Waited+=WIFI_MCAST_POLL_MS;
+	}
+}
+
+/*Description: This API will send chars as one datagram on the UDP link, to the host that sent the last datagram
+ * The chars of datagrams coming meanwhile are dropped
+ * parameters: chars (u8*), number of chars (u16)
+ * Return: Error Status*/
+u8 WIFI_u8McastSend (const u8* Copy_pu8Chars, u16 Copy_u16Count)
+{
+	/*This local variable will hold status of function*/
+	u8 Local_u8Status = STATUS_NOK;
+#if WIFI_PASSIVE_RECEIVE && !WIFI_LAN_DIRECT
+	u8 Local_u8SendSize[24];
+	UART_Segment_t Local_Segment = {Copy_pu8Chars, Copy_u16Count};
+
+	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
+	{
+		sprintf(Local_u8SendSize, "AT+CIPSEND=%d\r\n", (int)Copy_u16Count);
+		/*OK then the prompt, the chars are sent once the prompt is surely out*/
+		if (WIFI_u8PassiveCommand(Local_u8SendSize)==STATUS_OK)
+		{
+			SCHED_voidSleep(20);
+			Local_u8Status=WIFI_u8PassiveSegments(&Local_Segment, 1);
+		}
+	}
+#endif
+	return Local_u8Status;
+}
+
+/*Description: This API will close the UDP link of the multicast image download, the link of the commands opens again when needed
+ * parameters: void
+ * Return: void*/
+void WIFI_voidMcastClose (void)
+{
+#if WIFI_PASSIVE_RECEIVE && !WIFI_LAN_DIRECT
+	if (Static_UART_PERIPHERAL.BaseAddress!=NULL)
+	{
+		WIFI_u8PassiveCommand(WIFI_COMMAND_CLOSE);
+	}
+#endif
+}
+
 /*Description: This API will prompt user to enter user name and password for his desired WIFI
  * Parameters: Pointer to variable that will hold username, pointer to variable that will hold password
  * Return: Error Status*/
@@ -663,7 +1557,7 @@ u8 WIFI_u8EnterSSID(u8* Copy_u8SSID, u8* Copy_u8Password)
 	Local_u8ReceiveFlagForInput=1;
 	/*Terminate previous receiving operation*/
 	HUART_voidTerminateReceiving(HUART_USART1.BaseAddress);
-	delay_ms(1000);
+	SCHED_voidSleep(1000);
 
 	HUART_u8SendAsync(HUART_USART1, Local_u8PasswordPrompt, (sizeof(Local_u8PasswordPrompt)-1));
 	HUART_u8ReceiveAsync(HUART_USART1, LocalWIFI_u8Password, sizeof(LocalWIFI_u8Password));
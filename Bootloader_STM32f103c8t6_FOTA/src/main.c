@@ -8,6 +8,7 @@
 #include "Trace.h"
 #include "WIFI_interface.h"
 #include "Delay_interface.h"
+#include "STACK_interface.h"
 
 
 
@@ -16,6 +17,8 @@ int main(void)
 {
 	u8 Bootloader_Request_button_State;
 
+	/*Paint the free RAM first, so the stack high-water mark covers everything the bootloader does*/
+	STACK_voidPaint();
 	RCC_f32GetPLLMultiplierValue();
 	//RCC_voidSetClockStatus(RCC_ENABLE_HSE);
 	//RCC_voidSWSelectClock(RCC_SW_HSE);
@@ -24,6 +27,9 @@ int main(void)
 	RCC_voidEnablePeripheralClock(RCC_PERIPHERALS_PORTC); //Activate clock for on-board led port
 	RCC_voidEnablePeripheralClock(RCC_PERIPHERALS_CRC);   //Activate clock for CRC peripheral
 	RCC_voidEnablePeripheralClock(RCC_PERIPHERALS_FLITF); //Activate clock for Flash driver
+	RCC_voidEnablePeripheralClock(RCC_PERIPHERALS_DMA1);  //Activate clock for DMA feeding the CRC peripheral
+	RCC_voidEnablePeripheralClock(RCC_PERIPHERALS_PWR);   //Activate clock for backup domain access
+	RCC_voidEnablePeripheralClock(RCC_PERIPHERALS_BKP);   //Activate clock for backup registers (validated marker)
 
 	HUART_u8Init(HUART_USART1, 115200, UART_STOP_BIT1, UART_PARITY_DISABLED);
 
@@ -3,6 +3,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include "main.h"
 
@@ -158,50 +159,13 @@ while (clock() < start_time + milli_seconds) ;
 
 }
 
-/* convert (inBuffer) which has (char) elements of double the size of the (outBuffer)
- * merging every two bytes of the (inBuffer) into one byte of (outBuffer)
- * This is done as we had to receive every byte(Hex) as two bytes in their (ASCII) representation
- * for example : (inBuffer) has 1024 bytes
- * 				 (outBuffer) has 512 bytes
- * 				 so we are going to iterate for 512 times*/
-void   char2hex(uint8_t* inBuffer, uint8_t* outBuffer, uint16_t NumOfBytesToBeConverted )
+/*The bootloader is given time to fetch the command from the channel before the responses channel is polled
+ * With the push transport it gets the command at once and HOST_voidReceiveCommand waits for the reply itself*/
+void wait_for_bootloader(int milli_seconds)
 {
-	uint16_t index;
-	uint8_t  Local_u8inBuffer;
-	uint8_t  Local_u8inBuffer1;
-	for(index=0;index<NumOfBytesToBeConverted;index++)
-	{
-		Local_u8inBuffer =inBuffer[index*2];
-		Local_u8inBuffer1=inBuffer[index*2+1];
-		if(Local_u8inBuffer   > 0x60)Local_u8inBuffer  +=9;
-		if(Local_u8inBuffer1  > 0x60)Local_u8inBuffer1 +=9;
-		outBuffer[index]  = ( (Local_u8inBuffer<<4) | (Local_u8inBuffer1&0x0F) );
-	}
-}
-
-void hex2char(uint8_t* inBuffer, uint8_t* outBuffer, uint16_t NumOfBytesToBeConverted)
-{
-    uint16_t index;
-
-    for(index=0;index<NumOfBytesToBeConverted;index++)
+    if(!HOST_u8PushIsActive())
     {
-        outBuffer[index*2] = inBuffer[index] & 0xF0 ;
-        outBuffer[index*2] = outBuffer[index*2] >> 4 ;
-
-        if      ( outBuffer[index*2] >= 0x0 && outBuffer[index*2] <= 0x9 )
-                  outBuffer[index*2] |= 0x30;
-        else if ( outBuffer[index*2] >= 0xA && outBuffer[index*2] <= 0xF ){
-                  outBuffer[index*2] |= 0x60;
-                  outBuffer[index*2] -= 9;}
-
-        outBuffer[index*2+1] = inBuffer[index] & 0x0F ;
-
-        if      ( outBuffer[index*2+1] >= 0x0 && outBuffer[index*2+1] <= 0x9 )
-                  outBuffer[index*2+1] |= 0x30;
-        else if ( outBuffer[index*2+1] >= 0xA && outBuffer[index*2+1] <= 0xF ){
-                  outBuffer[index*2+1] |= 0x60;
-                  outBuffer[index*2+1] -= 9;}
-
+        delay(milli_seconds);
     }
 }
 
@@ -271,7 +235,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_GET_VER_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex!=0x7f)
         {
             /*Get response from bootloader and through WIFI*/
@@ -306,7 +270,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_GET_HELP_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex!=0x7f)
         {
@@ -345,7 +309,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_GET_CID_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex!=0x7f)
         {
             /*Get response from bootloader and through WIFI*/
@@ -400,7 +364,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_GO_TO_ADDR_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
         {
@@ -592,7 +556,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_FLASH_ERASE_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
         {
@@ -634,7 +598,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_MASS_ERASE_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
         {
@@ -667,11 +631,16 @@ void decode_menu_command_code(uint32_t command_code)
 //        uint32_t bytes_so_far_sent = 0;
 //        uint32_t len_to_read       = 0;
         uint32_t base_mem_address  = 0;
+        uint32_t file_crc32        = 0;
+        uint32_t manifest_crc32    = 0;
+        uint32_t chunk_manifest[IMAGE_MAX_CHUNKS];
+        uint32_t number_of_chunks  = 0;
+        uint8_t* file_content      = NULL;
 
         /*Length of packet to be sent
-        /* 1 byte len + 1 byte command code + 4 byte mem base address+ 4 byte CRC=10
+        /* 1 byte len + 1 byte command code + 4 byte mem base address + 4 byte file size + 4 byte file CRC + 4 byte manifest CRC + 4 byte CRC=22
         */
-        uint32_t mem_write_cmd_total_len = 14;
+        uint32_t mem_write_cmd_total_len = COMMAND_BL_MEM_WRITE_START_LEN;
         /*Put command length in first variable*/
         data_buf[0] = mem_write_cmd_total_len-1;
         /*Put command code in index 1*/
@@ -679,6 +648,19 @@ void decode_menu_command_code(uint32_t command_code)
 
 //        //First get the total number of bytes in the .bin file.
         t_len_of_file = calc_file_len();
+        /*CRC of the whole file lets the bootloader resume an interrupted download of the same file and check the result*/
+        file_content  = malloc(t_len_of_file);
+        if(file_content == NULL){printf("\n   Not enough memory!!\r\n");return;}
+        open_the_file();
+        read_the_file(file_content,t_len_of_file);
+        close_the_file();
+        file_crc32 = get_crc_words(file_content,t_len_of_file);
+        /*Manifest of per chunk CRCs is published after the image, so only chunks that arrive corrupted are fetched again*/
+        if(t_len_of_file > IMAGE_MAX_CHUNKS*IMAGE_CHUNK_SIZE){printf("\n   File is larger than the flash!!\r\n");free(file_content);return;}
+        number_of_chunks = build_chunk_manifest(file_content,t_len_of_file,chunk_manifest);
+        manifest_crc32   = get_crc_words((uint8_t*)chunk_manifest,number_of_chunks*4);
+        write_published_image(file_content,t_len_of_file,chunk_manifest,number_of_chunks);
+        free(file_content);
 //
 //        //keep opening the file
 //        open_the_file();
@@ -699,11 +681,21 @@ void decode_menu_command_code(uint32_t command_code)
         data_buf[8]=t_len_of_file>>16;
         data_buf[9]=t_len_of_file>>24;
 
+        data_buf[10] = word_to_byte(file_crc32,1,1);
+        data_buf[11] = word_to_byte(file_crc32,2,1);
+        data_buf[12] = word_to_byte(file_crc32,3,1);
+        data_buf[13] = word_to_byte(file_crc32,4,1);
+
+        data_buf[14] = word_to_byte(manifest_crc32,1,1);
+        data_buf[15] = word_to_byte(manifest_crc32,2,1);
+        data_buf[16] = word_to_byte(manifest_crc32,3,1);
+        data_buf[17] = word_to_byte(manifest_crc32,4,1);
+
         crc32       = get_crc(data_buf,mem_write_cmd_total_len-4);
-        data_buf[10] = word_to_byte(crc32,1,1);
-        data_buf[11] = word_to_byte(crc32,2,1);
-        data_buf[12] = word_to_byte(crc32,3,1);
-        data_buf[13] = word_to_byte(crc32,4,1);
+        data_buf[18] = word_to_byte(crc32,1,1);
+        data_buf[19] = word_to_byte(crc32,2,1);
+        data_buf[20] = word_to_byte(crc32,3,1);
+        data_buf[21] = word_to_byte(crc32,4,1);
 
         /*Convert buffer to char*/
         hex2char(data_buf,commandPacket_TxBuffer,mem_write_cmd_total_len);
@@ -712,9 +704,12 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,mem_write_cmd_total_len*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(15000);
-        HOST_voidSendCommand("EMPTY",5);
-        delay(45000);
+        if(!HOST_u8PushIsActive())
+        {
+            delay(15000);
+            HOST_voidSendCommand("EMPTY",5);
+            delay(45000);
+        }
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
         {
@@ -806,7 +801,150 @@ void decode_menu_command_code(uint32_t command_code)
 
     case 8:
         printf("\n   Command == > BL_MEM_READ\n");
-        printf("\n   This command is not supported");
+        uint32_t read_address      = 0;
+        uint32_t read_length       = 0;
+        uint32_t read_encoding     = BL_MEM_READ_ENCODING_RAW;
+        uint32_t compare_with_file = 0;
+        uint8_t* file_image        = NULL;
+        /*Offset of the next chunk we expect, any chunk after it means the ones in between were missed*/
+        uint32_t expected_offset   = 0;
+        uint32_t chunk_offset      = 0;
+        uint32_t chunk_len         = 0;
+        uint32_t bytes_verified    = 0;
+        uint32_t bytes_missed      = 0;
+        uint32_t mismatches        = 0;
+        uint32_t first_mismatch    = 0;
+        clock_t  read_start_time;
+        double   read_seconds;
+        /*Biggest chunk possible: every payload byte pair expands to a run of 255 bytes*/
+        static uint8_t chunk_buffer[0x10000];
+
+        printf("\n   Compare readback with a .bin file (1) or print it (0) : ");
+        scanf(" %d",&compare_with_file);
+        if(compare_with_file)
+        {
+            read_length = calc_file_len();
+            file_image  = malloc(read_length);
+            if(file_image == NULL){printf("\n   Not enough memory!!\r\n");return;}
+            open_the_file();
+            read_the_file(file_image,read_length);
+            close_the_file();
+        }
+        else
+        {
+            printf("\n   Enter the number of bytes to read here : ");
+            scanf(" %d",&read_length);
+        }
+        printf("\n   Enter the memory read address here : ");
+        scanf(" %x",&read_address);
+        printf("\n   Compress erased (0xFF) runs (1) or send raw bytes (0) : ");
+        scanf(" %d",&read_encoding);
+        read_encoding = read_encoding ? BL_MEM_READ_ENCODING_FF_RUNS : BL_MEM_READ_ENCODING_RAW;
+
+        data_buf[0] = COMMAND_BL_MEM_READ_LEN-1;    //command length macro
+        data_buf[1] = COMMAND_BL_MEM_READ;          //command code macro
+        data_buf[2] = word_to_byte(read_address,1,1);
+        data_buf[3] = word_to_byte(read_address,2,1);
+        data_buf[4] = word_to_byte(read_address,3,1);
+        data_buf[5] = word_to_byte(read_address,4,1);
+        data_buf[6] = word_to_byte(read_length,1,1);
+        data_buf[7] = word_to_byte(read_length,2,1);
+        data_buf[8] = word_to_byte(read_length,3,1);
+        data_buf[9] = word_to_byte(read_length,4,1);
+        data_buf[10]= read_encoding;
+
+        crc32        = get_crc(data_buf,COMMAND_BL_MEM_READ_LEN-4);
+        data_buf[11] = word_to_byte(crc32,1,1);
+        data_buf[12] = word_to_byte(crc32,2,1);
+        data_buf[13] = word_to_byte(crc32,3,1);
+        data_buf[14] = word_to_byte(crc32,4,1);
+
+        /*Convert buffer to char*/
+        hex2char(data_buf,commandPacket_TxBuffer,COMMAND_BL_MEM_READ_LEN);
+        /*Send data to server*/
+        HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_MEM_READ_LEN*2);
+        printf("\n   Waiting for bootloader to stream the memory\n");
+        read_start_time = clock();
+
+        /*Keep polling the responses channel, every new chunk resets the timeout*/
+        while(expected_offset < read_length && timeout_counter < TIMEOUT)
+        {
+            HOST_voidReceiveCommand(replyFromBootloaderChar);
+            char2hex(replyFromBootloaderChar,replyFromBootloaderHex,2);
+
+            if(replyFromBootloaderHex[0] == 0x7f)
+            {
+                printf("\n   CRC: FAIL \n");
+                break;
+            }
+            if(replyFromBootloaderHex[0] != 0xA5)
+            {
+                timeout_counter++;
+                delay(1000);
+                continue;
+            }
+            bl_reply_without_ack = replyFromBootloaderHex[1];
+            char2hex(&replyFromBootloaderChar[4],&replyFromBootloaderHex[2],bl_reply_without_ack);
+            /*A reply without chunk header is the status of a rejected range*/
+            if(bl_reply_without_ack < BL_MEM_READ_HEADER_LEN)
+            {
+                ret_value = read_bootloader_reply(COMMAND_BL_MEM_READ, replyFromBootloaderHex);
+                break;
+            }
+
+            chunk_offset = *((uint32_t*)&replyFromBootloaderHex[2]);
+            chunk_len    = replyFromBootloaderHex[6] | (replyFromBootloaderHex[7]<<8);
+            /*Same chunk as last poll, wait for the next one*/
+            if(chunk_offset < expected_offset || chunk_offset >= read_length)
+            {
+                timeout_counter++;
+                delay(1000);
+                continue;
+            }
+            if(chunk_offset > expected_offset)
+            {
+                printf("\n   Missed %#x to %#x",read_address+expected_offset,read_address+chunk_offset-1);
+                bytes_missed += chunk_offset-expected_offset;
+            }
+            if(chunk_len > read_length-chunk_offset) chunk_len = read_length-chunk_offset;
+
+            if(replyFromBootloaderHex[8] == BL_MEM_READ_ENCODING_FF_RUNS)
+                chunk_len = decode_ff_runs(&replyFromBootloaderHex[2+BL_MEM_READ_HEADER_LEN],bl_reply_without_ack-BL_MEM_READ_HEADER_LEN,chunk_buffer,chunk_len);
+            else
+                memcpy(chunk_buffer,&replyFromBootloaderHex[2+BL_MEM_READ_HEADER_LEN],chunk_len);
+
+            for(Local_u16Iterator=0;Local_u16Iterator<chunk_len;Local_u16Iterator++)
+            {
+                if(compare_with_file)
+                {
+                    if(chunk_buffer[Local_u16Iterator] != file_image[chunk_offset+Local_u16Iterator])
+                    {
+                        if(mismatches == 0) first_mismatch = chunk_offset+Local_u16Iterator;
+                        mismatches++;
+                    }
+                }
+                else
+                {
+                    if(((chunk_offset+Local_u16Iterator)%16) == 0) printf("\n   %#.8x : ",read_address+chunk_offset+Local_u16Iterator);
+                    printf("%02x ",chunk_buffer[Local_u16Iterator]);
+                }
+            }
+            bytes_verified += chunk_len;
+            expected_offset = chunk_offset+chunk_len;
+            timeout_counter = 0;
+            if(compare_with_file) printf("\r   Read back : %d of %d bytes  ",expected_offset,read_length);
+        }
+
+        read_seconds = (double)(clock()-read_start_time)/CLOCKS_PER_SEC;
+        if(expected_offset < read_length && timeout_counter >= TIMEOUT) ret_value = -2;
+        printf("\n\n   Bytes received : %d of %d (%d missed) in %.1f s",bytes_verified,read_length,bytes_missed+(read_length-expected_offset),read_seconds);
+        if(read_seconds > 0) printf(" -> %.1f bytes/s",bytes_verified/read_seconds);
+        if(compare_with_file)
+        {
+            if(mismatches) printf("\n   Compare : %d bytes differ, first at %#x\n",mismatches,read_address+first_mismatch);
+            else           printf("\n   Compare : all received bytes match the file\n");
+            free(file_image);
+        }
         break;
 
     case 9:
@@ -827,7 +965,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_MASS_ERASE_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
         {
@@ -868,7 +1006,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_DIS_R_PROTECT_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
         {
@@ -992,7 +1130,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_EN_W_PROTECT_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
         {
@@ -1110,7 +1248,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_DIS_W_PROTECT_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
         {
@@ -1151,7 +1289,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_GET_RDP_STATUS_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex!=0x7f)
         {
@@ -1191,7 +1329,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_READ_SECTOR_P_STATUS_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
 
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex!=0x7f)
         {
@@ -1231,7 +1369,7 @@ void decode_menu_command_code(uint32_t command_code)
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_MY_SYSTEM_RESET_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex!=0x7f)
         {
             /*Get response from bootloader and through WIFI*/
@@ -1270,7 +1408,7 @@ case 16:
         HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_EXISTING_APPS_LEN*2);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex!=0x7f)
         {
             /*Get response from bootloader and through WIFI*/
@@ -1353,7 +1491,7 @@ case 16:
         HOST_voidSendCommand(commandPacket_TxBuffer,36);
         /*Give bootloader time to receive command and process it*/
         printf("\n   Waiting for bootloader to process request\n");
-        delay(5000);
+        wait_for_bootloader(5000);
         while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex!=0x7f)
         {
             /*Get response from bootloader and through WIFI*/
@@ -1373,6 +1511,243 @@ case 16:
         /*Pass hex array to process it as reply of bootloader*/
         ret_value = read_bootloader_reply(COMMAND_BL_SAVE_APP_INFO, replyFromBootloaderHex);
 
+        break;
+    case 18:
+        printf("\n   Command == > BL_GET_DIGEST\n");
+        uint32_t digest_address   = 0;
+        uint32_t digest_length    = 0;
+        uint32_t digest_algorithm = BL_DIGEST_CRC32;
+        uint32_t digest_len       = BL_DIGEST_CRC32_LEN;
+        uint32_t digest_us        = 0;
+        uint32_t local_crc        = 0;
+        uint8_t  local_digest[BL_DIGEST_SHA256_LEN];
+        uint8_t* digest_image     = NULL;
+
+        /*The digest is computed on the MCU, only the digest comes back instead of the whole image*/
+        digest_length = calc_file_len();
+        digest_image  = malloc(digest_length);
+        if(digest_image == NULL){printf("\n   Not enough memory!!\r\n");return;}
+        open_the_file();
+        read_the_file(digest_image,digest_length);
+        close_the_file();
+        printf("\n   Enter the app base memory address here : ");
+        scanf(" %x",&digest_address);
+        printf("\n   Use SHA-256 (1) or CRC32 (0) : ");
+        scanf(" %d",&digest_algorithm);
+        if(digest_algorithm)
+        {
+            digest_algorithm = BL_DIGEST_SHA256;
+            digest_len       = BL_DIGEST_SHA256_LEN;
+            sha256(digest_image,digest_length,local_digest);
+        }
+        else
+        {
+            local_crc = get_crc_words(digest_image,digest_length);
+            memcpy(local_digest,&local_crc,4);
+        }
+        free(digest_image);
+
+        data_buf[0] = COMMAND_BL_GET_DIGEST_LEN-1;  //command length macro
+        data_buf[1] = COMMAND_BL_GET_DIGEST;        //command code macro
+        data_buf[2] = word_to_byte(digest_address,1,1);
+        data_buf[3] = word_to_byte(digest_address,2,1);
+        data_buf[4] = word_to_byte(digest_address,3,1);
+        data_buf[5] = word_to_byte(digest_address,4,1);
+        data_buf[6] = word_to_byte(digest_length,1,1);
+        data_buf[7] = word_to_byte(digest_length,2,1);
+        data_buf[8] = word_to_byte(digest_length,3,1);
+        data_buf[9] = word_to_byte(digest_length,4,1);
+        data_buf[10]= digest_algorithm;
+
+        crc32        = get_crc(data_buf,COMMAND_BL_GET_DIGEST_LEN-4);
+        data_buf[11] = word_to_byte(crc32,1,1);
+        data_buf[12] = word_to_byte(crc32,2,1);
+        data_buf[13] = word_to_byte(crc32,3,1);
+        data_buf[14] = word_to_byte(crc32,4,1);
+
+        /*Convert buffer to char to be sent through WIFI*/
+        hex2char(data_buf,commandPacket_TxBuffer,COMMAND_BL_GET_DIGEST_LEN);
+        /*Send data to server*/
+        HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_GET_DIGEST_LEN*2);
+        /*Give bootloader time to receive command and process it*/
+        printf("\n   Waiting for bootloader to process request\n");
+        wait_for_bootloader(5000);
+        while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
+        {
+            /*Get response from bootloader and through WIFI*/
+            HOST_voidReceiveCommand(replyFromBootloaderChar);
+            /*Convert 2 variables only from response from char to hex, which represent ack and size of packet*/
+            char2hex(replyFromBootloaderChar,replyFromBootloaderHex,2);
+            /*If we reached timeout threshold, break from loop, otherwise increase variable*/
+            if(timeout_counter==TIMEOUT)break;
+            timeout_counter++;
+        }
+        /*Save the size insize the variable which represents reply without ack size*/
+        bl_reply_without_ack = replyFromBootloaderHex[1];
+        /*Convert rest of array into hex*/
+        char2hex(&replyFromBootloaderChar[4],&replyFromBootloaderHex[2],bl_reply_without_ack);
+
+        /*Pass hex array to process it as reply of bootloader*/
+        ret_value = read_bootloader_reply(COMMAND_BL_GET_DIGEST, replyFromBootloaderHex);
+        if(ret_value == 0 && bl_reply_without_ack == 6+digest_len)
+        {
+            digest_us = *((uint32_t*)&replyFromBootloaderHex[4]);
+            if(memcmp(local_digest,&replyFromBootloaderHex[8],digest_len) == 0)
+                printf("\n   Digest MATCHES the file");
+            else
+                printf("\n   Digest DOES NOT match the file");
+            if(digest_us) printf(" (%d bytes hashed at %d bytes/ms)\n",digest_length,(uint32_t)(((uint64_t)digest_length*1000)/digest_us));
+            else          printf("\n");
+        }
+        break;
+    case 19:
+        printf("\n   Command == > BL_GET_RESUME\n");
+
+        data_buf[0] = COMMAND_BL_GET_RESUME_LEN-1;  //command length macro
+        data_buf[1] = COMMAND_BL_GET_RESUME;        //command code macro
+        crc32       = get_crc(data_buf,COMMAND_BL_GET_RESUME_LEN-4);
+        data_buf[2] = word_to_byte(crc32,1,1);
+        data_buf[3] = word_to_byte(crc32,2,1);
+        data_buf[4] = word_to_byte(crc32,3,1);
+        data_buf[5] = word_to_byte(crc32,4,1);
+
+        /*Convert buffer to char to be sent through WIFI*/
+        hex2char(data_buf,commandPacket_TxBuffer,COMMAND_BL_GET_RESUME_LEN);
+        /*Send data to server*/
+        HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_GET_RESUME_LEN*2);
+        /*Give bootloader time to receive command and process it*/
+        printf("\n   Waiting for bootloader to process request\n");
+        wait_for_bootloader(5000);
+        while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
+        {
+            /*Get response from bootloader and through WIFI*/
+            HOST_voidReceiveCommand(replyFromBootloaderChar);
+            /*Convert 2 variables only from response from char to hex, which represent ack and size of packet*/
+            char2hex(replyFromBootloaderChar,replyFromBootloaderHex,2);
+            /*If we reached timeout threshold, break from loop, otherwise increase variable*/
+            if(timeout_counter==TIMEOUT)break;
+            timeout_counter++;
+        }
+        /*Save the size insize the variable which represents reply without ack size*/
+        bl_reply_without_ack = replyFromBootloaderHex[1];
+        /*Convert rest of array into hex*/
+        char2hex(&replyFromBootloaderChar[4],&replyFromBootloaderHex[2],bl_reply_without_ack);
+
+        /*Pass hex array to process it as reply of bootloader*/
+        ret_value = read_bootloader_reply(COMMAND_BL_GET_RESUME, replyFromBootloaderHex);
+        break;
+    case 20:
+        printf("\n   Command == > Fleet Update\n");
+        fleet_run();
+        break;
+    case 21:
+        printf("\n   Command == > BL_MEM_WRITE_WINDOWED\n");
+        windowed_write_run();
+        break;
+    case 22:
+        printf("\n   Command == > Hex Codec Benchmark\n");
+        hex_codec_benchmark();
+        break;
+    case 23:
+        printf("\n   Command == > BL_GET_STATS\n");
+        uint32_t clear_stats = 0;
+
+        printf("\n   Clear the counters after reading them (1) or keep them (0) : ");
+        scanf(" %u",&clear_stats);
+
+        data_buf[0] = COMMAND_BL_GET_STATS_LEN-1;   //command length macro
+        data_buf[1] = COMMAND_BL_GET_STATS;         //command code macro
+        data_buf[2] = (clear_stats != 0);
+        crc32       = get_crc(data_buf,COMMAND_BL_GET_STATS_LEN-4);
+        data_buf[3] = word_to_byte(crc32,1,1);
+        data_buf[4] = word_to_byte(crc32,2,1);
+        data_buf[5] = word_to_byte(crc32,3,1);
+        data_buf[6] = word_to_byte(crc32,4,1);
+
+        /*Convert buffer to char to be sent through WIFI*/
+        hex2char(data_buf,commandPacket_TxBuffer,COMMAND_BL_GET_STATS_LEN);
+        /*Send data to server*/
+        HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_GET_STATS_LEN*2);
+        /*Give bootloader time to receive command and process it*/
+        printf("\n   Waiting for bootloader to process request\n");
+        wait_for_bootloader(5000);
+        while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
+        {
+            /*Get response from bootloader and through WIFI*/
+            HOST_voidReceiveCommand(replyFromBootloaderChar);
+            /*Convert 2 variables only from response from char to hex, which represent ack and size of packet*/
+            char2hex(replyFromBootloaderChar,replyFromBootloaderHex,2);
+            /*If we reached timeout threshold, break from loop, otherwise increase variable*/
+            if(timeout_counter==TIMEOUT)break;
+            timeout_counter++;
+        }
+        /*Save the size insize the variable which represents reply without ack size*/
+        bl_reply_without_ack = replyFromBootloaderHex[1];
+        /*Convert rest of array into hex*/
+        char2hex(&replyFromBootloaderChar[4],&replyFromBootloaderHex[2],bl_reply_without_ack);
+
+        /*Pass hex array to process it as reply of bootloader*/
+        ret_value = read_bootloader_reply(COMMAND_BL_GET_STATS, replyFromBootloaderHex);
+        break;
+    case 24:
+        printf("\n   Command == > BL_GET_TRACE\n");
+        trace_dump_run();
+        break;
+    case 25:
+        printf("\n   Command == > BL_GET_PROFILE\n");
+        profiler_run();
+        break;
+    case 26:
+        printf("\n   Command == > BL_GET_MEMORY\n");
+
+        data_buf[0] = COMMAND_BL_GET_MEMORY_LEN-1;  //command length macro
+        data_buf[1] = COMMAND_BL_GET_MEMORY;        //command code macro
+        crc32       = get_crc(data_buf,COMMAND_BL_GET_MEMORY_LEN-4);
+        data_buf[2] = word_to_byte(crc32,1,1);
+        data_buf[3] = word_to_byte(crc32,2,1);
+        data_buf[4] = word_to_byte(crc32,3,1);
+        data_buf[5] = word_to_byte(crc32,4,1);
+
+        /*Convert buffer to char to be sent through WIFI*/
+        hex2char(data_buf,commandPacket_TxBuffer,COMMAND_BL_GET_MEMORY_LEN);
+        /*Send data to server*/
+        HOST_voidSendCommand(commandPacket_TxBuffer,COMMAND_BL_GET_MEMORY_LEN*2);
+        /*Give bootloader time to receive command and process it*/
+        printf("\n   Waiting for bootloader to process request\n");
+        wait_for_bootloader(5000);
+        while (replyFromBootloaderHex[0]!=0xA5 && replyFromBootloaderHex[0]!=0x7f)
+        {
+            /*Get response from bootloader and through WIFI*/
+            HOST_voidReceiveCommand(replyFromBootloaderChar);
+            /*Convert 2 variables only from response from char to hex, which represent ack and size of packet*/
+            char2hex(replyFromBootloaderChar,replyFromBootloaderHex,2);
+            /*If we reached timeout threshold, break from loop, otherwise increase variable*/
+            if(timeout_counter==TIMEOUT)break;
+            timeout_counter++;
+        }
+        /*Save the size insize the variable which represents reply without ack size*/
+        bl_reply_without_ack = replyFromBootloaderHex[1];
+        /*Convert rest of array into hex*/
+        char2hex(&replyFromBootloaderChar[4],&replyFromBootloaderHex[2],bl_reply_without_ack);
+
+        /*Pass hex array to process it as reply of bootloader*/
+        ret_value = read_bootloader_reply(COMMAND_BL_GET_MEMORY, replyFromBootloaderHex);
+        break;
+    case 27:
+        printf("\n   Command == > Multicast Simulation\n");
+        mcast_simulate_run();
+        break;
+    case 29:
+        printf("\n   Command == > Fleet Server Stand-in\n");
+        fleet_server_run();
+        break;
+    case 30:
+        printf("\n   Command == > BL_MEM_WRITE (lockstep)\n");
+        lockstep_write_run();
+        break;
+    case 32:
+        printf("\n   Command == > Pushed Command Latency\n");
+        push_latency_run();
         break;
     default:
         printf("\n\n  Please input valid command code\n");
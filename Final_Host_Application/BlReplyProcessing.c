@@ -23,7 +23,7 @@ int read_bootloader_reply(uint8_t command_code, uint8_t* Copy_u8DataBuffer)
         len_to_follow=Copy_u8DataBuffer[1];
         printf("\n\n   CRC : SUCCESS \r\n   BL reply Length : %d\n",len_to_follow);
 
-        switch(0x50 | command_code)
+        switch(command_code)
         {
         case COMMAND_BL_GET_VER:
              process_COMMAND_BL_GET_VER(len_to_follow, Copy_u8DataBuffer);
@@ -53,7 +53,7 @@ int read_bootloader_reply(uint8_t command_code, uint8_t* Copy_u8DataBuffer)
             process_COMMAND_BL_MEM_WRITE(len_to_follow, Copy_u8DataBuffer);
             break;
         case COMMAND_BL_MEM_READ:
-            process_COMMAND_BL_MEM_READ(len_to_follow);
+            process_COMMAND_BL_MEM_READ(len_to_follow, Copy_u8DataBuffer);
             break;
 
 
@@ -86,6 +86,18 @@ int read_bootloader_reply(uint8_t command_code, uint8_t* Copy_u8DataBuffer)
         case COMMAND_BL_SAVE_APP_INFO:
             process_COMMAND_BL_SAVE_APP_INFO(len_to_follow, Copy_u8DataBuffer);
             break;
+        case COMMAND_BL_GET_DIGEST:
+            process_COMMAND_BL_GET_DIGEST(len_to_follow, Copy_u8DataBuffer);
+            break;
+        case COMMAND_BL_GET_RESUME:
+            process_COMMAND_BL_GET_RESUME(len_to_follow, Copy_u8DataBuffer);
+            break;
+        case COMMAND_BL_GET_STATS:
+            process_COMMAND_BL_GET_STATS(len_to_follow, Copy_u8DataBuffer);
+            break;
+        case COMMAND_BL_GET_MEMORY:
+            process_COMMAND_BL_GET_MEMORY(len_to_follow, Copy_u8DataBuffer);
+            break;
         //default:
             //printf("\n  Invalid command code\n");
 
@@ -178,14 +190,31 @@ void process_COMMAND_BL_FLASH_MASS_ERASE(uint32_t len_to_follow, uint8_t* Copy_u
 
 void process_COMMAND_BL_MEM_WRITE(uint32_t len, uint8_t* Copy_u8DataBuffer)
 {
-    uint8_t write_status=0;
-    read_serial_port(&write_status,len);
+    uint8_t  write_status=0;
+    uint32_t resume_offset=0;
+    uint16_t chunk_refetches=0;
+    uint16_t chunks_refetched=0;
+    //read_serial_port(&write_status,len);
+    write_status = Copy_u8DataBuffer[2];
     printf("   Write Status : 0x%x\n",write_status);
+    if(len < 5) return;
+    resume_offset = *((uint32_t*)&Copy_u8DataBuffer[3]);
+    if(resume_offset) printf("   Download resumed from offset %d (earlier pages were already verified)\n",resume_offset);
+    if(write_status == BL_MEM_WRITE_VERIFY_FAIL)    printf("   A page failed verification, send the command again to resume\n");
+    if(write_status == BL_MEM_WRITE_IMAGE_CRC_FAIL) printf("   Image CRC does not match the file\n");
+    if(write_status == BL_MEM_WRITE_CHUNK_FAIL)     printf("   A chunk kept failing its manifest CRC, send the command again to resume\n");
+    if(write_status == BL_MEM_WRITE_MANIFEST_FAIL)  printf("   Published manifest does not match, publish the .txt file again\n");
+    if(write_status == BL_MEM_WRITE_NO_BUFFER)      printf("   Bootloader had no free buffer for the download, check its pools (RAM usage)\n");
+    if(len < 9) return;
+    memcpy(&chunk_refetches,  &Copy_u8DataBuffer[7], 2);
+    memcpy(&chunks_refetched, &Copy_u8DataBuffer[9], 2);
+    printf("   Chunks fetched again : %d (%d extra fetches)\n",chunks_refetched,chunk_refetches);
 }
 
-void process_COMMAND_BL_MEM_READ(uint32_t len)
+//Only a one byte reply reaches here, chunks of the read stream are handled while receiving them
+void process_COMMAND_BL_MEM_READ(uint32_t len, uint8_t* Copy_u8DataBuffer)
 {
-
+    if(len == 1 && Copy_u8DataBuffer[2]) printf("\n   Read Status : Address range Invalid \r\n");
 }
 
 
@@ -309,3 +338,120 @@ void process_COMMAND_BL_SAVE_APP_INFO			(uint32_t len, uint8_t* Copy_u8DataBuffe
      status = Copy_u8DataBuffer[2];
      printf("\n\n   Done!\n");
 }
+
+void process_COMMAND_BL_GET_DIGEST				(uint32_t len, uint8_t* Copy_u8DataBuffer)
+{
+    uint32_t elapsed_us;
+    uint32_t index;
+
+    if(len == 1)
+    {
+        printf("\n   Address range is invalid (must be word aligned and inside one memory)\n");
+        return;
+    }
+    elapsed_us = *((uint32_t*)&Copy_u8DataBuffer[4]);
+    printf("\n   %s computed by the MCU in %d us\n   ",(Copy_u8DataBuffer[3]==BL_DIGEST_SHA256)? "SHA-256" : "CRC32",elapsed_us);
+    for(index=0;index<len-6;index++) printf("%02x",Copy_u8DataBuffer[8+index]);
+    printf("\n");
+}
+
+void process_COMMAND_BL_GET_RESUME				(uint32_t len, uint8_t* Copy_u8DataBuffer)
+{
+    uint32_t base_address;
+    uint32_t size_in_bytes;
+    uint32_t bytes_done;
+
+    if(!Copy_u8DataBuffer[2])
+    {
+        printf("\n   No interrupted download\n");
+        return;
+    }
+    base_address  = *((uint32_t*)&Copy_u8DataBuffer[3]);
+    size_in_bytes = *((uint32_t*)&Copy_u8DataBuffer[7]);
+    bytes_done    = *((uint32_t*)&Copy_u8DataBuffer[11]);
+    printf("\n   Interrupted download at %#x : %d of %d bytes verified",base_address,bytes_done,size_in_bytes);
+    printf("\n   Flash the same file at the same address to resume from offset %d\n",bytes_done);
+}
+
+void process_COMMAND_BL_GET_STATS				(uint32_t len, uint8_t* Copy_u8DataBuffer)
+{
+    //record : 6 counters, 5 timers (us), time since the counters were cleared (us)
+    static const char* counter_names[] = {"Chars received", "Bytes programmed", "Pages erased",
+                                          "CRC failures", "NACKs sent", "Network fetches repeated"};
+    static const char* timer_names[]   = {"Network wait", "Hex decode", "Flash erase", "Flash program", "Logging"};
+    uint32_t values[12];
+    uint32_t accounted = 0;
+    uint32_t total;
+    uint32_t index;
+
+    if(len < sizeof(values))
+    {
+        printf("\n   Statistics record too short (%u bytes)\n", len);
+        return;
+    }
+    memcpy(values, &Copy_u8DataBuffer[2], sizeof(values));
+    total = values[11] ? values[11] : 1;
+
+    printf("\n   Counters :");
+    for(index=0; index<6; index++)
+        printf("\n     %-26s %u", counter_names[index], values[index]);
+
+    printf("\n\n   Time since the counters were cleared : %.3f s", values[11]/1000000.0);
+    for(index=0; index<5; index++)
+    {
+        printf("\n     %-26s %10.3f ms  %5.1f %%", timer_names[index], values[6+index]/1000.0, 100.0*values[6+index]/total);
+        accounted += values[6+index];
+    }
+    printf("\n     %-26s %10.3f ms  %5.1f %%", "Other (delays, CRC, ...)",
+           (accounted < values[11] ? values[11]-accounted : 0)/1000.0,
+           (accounted < values[11] ? 100.0*(values[11]-accounted)/total : 0.0));
+    if(values[1] && (values[8]+values[9]))
+        printf("\n\n   Flash rate : %.0f bytes/s of erase and program time", values[1]*1000000.0/(values[8]+values[9]));
+    printf("\n");
+}
+
+void process_COMMAND_BL_GET_MEMORY				(uint32_t len, uint8_t* Copy_u8DataBuffer)
+{
+    //record : RAM, static, heap, stack peak, stack now, free, stack reserved by the linker script, then the buffer pools
+    uint32_t values[7];
+    uint8_t* pool;
+    uint32_t pools = 0;
+    uint32_t index;
+
+    if(len < sizeof(values))
+    {
+        printf("\n   RAM usage record too short (%u bytes)\n", len);
+        return;
+    }
+    memcpy(values, &Copy_u8DataBuffer[2], sizeof(values));
+
+    printf("\n   RAM                        %6u bytes", values[0]);
+    printf("\n     Static (data, bss)       %6u bytes  %5.1f %%", values[1], 100.0*values[1]/values[0]);
+    printf("\n     Heap in use              %6u bytes  %5.1f %%", values[2], 100.0*values[2]/values[0]);
+    printf("\n     Stack high-water mark    %6u bytes  %5.1f %%  (%u in use now, %u reserved by the linker script)",
+           values[3], 100.0*values[3]/values[0], values[4], values[6]);
+    printf("\n     Never used               %6u bytes  %5.1f %%", values[5], 100.0*values[5]/values[0]);
+    if(values[3] > values[6])
+        printf("\n\n   The stack went %u bytes past the size reserved for it", values[3]-values[6]);
+    /*Keep some margin for interrupt frames and paths that were not exercised yet*/
+    if(values[5] > BL_RAM_SAFETY_MARGIN)
+        printf("\n   Buffers can grow by about %u bytes in total (%u bytes kept as margin)\n", values[5]-BL_RAM_SAFETY_MARGIN, BL_RAM_SAFETY_MARGIN);
+    else
+        printf("\n   Less than %u bytes left, buffers should not grow\n", BL_RAM_SAFETY_MARGIN);
+
+    /*Pool records : block size (2), largest request (2), requests that found the pool full (2), blocks, in use, peak in use*/
+    if(len > sizeof(values)) pools = Copy_u8DataBuffer[2+sizeof(values)];
+    if(len < sizeof(values)+1+pools*BL_POOL_RECORD_LEN) pools = 0;
+    if(pools) printf("\n   %-8s %8s %8s %8s %8s %10s %10s", "Pool", "Block", "Blocks", "In use", "Peak", "Largest", "Full");
+    for(index=0; index<pools; index++)
+    {
+        pool = &Copy_u8DataBuffer[2+sizeof(values)+1+index*BL_POOL_RECORD_LEN];
+        printf("\n   %-8u %8u %8u %8u %8u %10u %10u", index, pool[0] | (pool[1]<<8), pool[6], pool[7], pool[8],
+               pool[2] | (pool[3]<<8), pool[4] | (pool[5]<<8));
+        if(pool[4] | pool[5])
+            printf("  <- add a block");
+        else if(pool[8] < pool[6])
+            printf("  <- %u block(s) never used", pool[6]-pool[8]);
+    }
+    if(pools) printf("\n");
+}
@@ -32,6 +32,19 @@
 /*This macro will activate debug mode (debug messages will be displayed on terminal)*/
 #define         HTTP_DEBUG_MODE         0
 
+/*Push transport (push_server.c) : the bootloader keeps a connection open to the host, frames are the length as 4 hex chars then the chars
+ * While it is on, HOST_voidSendCommand and HOST_voidReceiveCommand use it instead of the channels*/
+#define         HTTP_PUSH_DEFAULT_PORT          5050
+#define         HTTP_PUSH_FRAME_HEADER_SIZE     4
+/*Time the bootloader is given to connect (it tries before every poll of the channel, 15 s apart)*/
+#define         HTTP_PUSH_CONNECT_TIMEOUT_MS    60000
+/*Longest wait for one reply, the commands that download an image reply once it is all written*/
+#define         HTTP_PUSH_REPLY_TIMEOUT_MS      30000
+#define         HTTP_PUSH_BUFFER_SIZE           2000
+/*LAN direct mode (push_server.c too) : the module is the server and this application connects to it, same frames,
+ * the image windows are asked for by the bootloader and read from the published text file*/
+#define         HTTP_LAN_DEFAULT_PORT           3333
+
 /*Description: This API will be used to send new command to the server
 Parameters: New Command (u8*), Desired Size (u16)
 Return: Error Status (u8)*/
@@ -48,4 +61,57 @@ Return: Error Status (u8)*/
 extern u8 HOST_voidSendCommandToResponses (u8* Copy_u8UserCommand, u16 Copy_u16Size);
 
 
+/*The next APIs are used by the fleet mode, they may be called from many threads at the same time.
+ * Every call opens its own socket, the channel keys are passed by the caller instead of the keys above*/
+
+/*Description: This API will be used to initialize Winsock once and select the server used by the fleet APIs
+ * (api.thingspeak.com or the local stand-in of fleet_server.c)
+Parameters: Server name or IP (u8*), Port (u16)
+Return: Error Status (u8)*/
+extern u8 HOST_u8InitFleetNetwork (u8* Copy_u8Server, u16 Copy_u16Port);
+
+/*Description: This API will be used to post data to the first field of a channel
+Parameters: Channel write key (u8*), Data (u8*), Size of data (u16)
+Return: Error Status (u8), NOK too if the server dropped the update (entry id 0, the channel was updated less than 15 s ago)*/
+extern u8 HOST_u8PostToChannel (u8* Copy_u8WriteKey, u8* Copy_u8Data, u16 Copy_u16Size);
+
+/*Description: This API will be used to read the last value of the first field of a channel
+Parameters: Channel ID (u8*), Channel read key (u8*), Buffer to receive data (u8*), Size of buffer (u16)
+Return: Error Status (u8)*/
+extern u8 HOST_u8ReadChannel (u8* Copy_u8ChannelId, u8* Copy_u8ReadKey, u8* Copy_u8Buffer, u16 Copy_u16BufferSize);
+
+
+/*The next APIs are the push transport, see push_server.c*/
+
+/*Description: This API will be used to listen for the bootloader on a port and wait for its first connection
+Parameters: Port (u16), Time to wait for the bootloader in ms (u32)
+Return: Error Status (u8), NOK if the port cannot be taken or the bootloader did not connect, the push transport is then off*/
+extern u8 HOST_u8StartPushServer (u16 Copy_u16Port, u32 Copy_u32TimeoutMs);
+
+/*Description: This API will be used to connect to the bootloader in LAN direct mode, trying again until the time is over
+Parameters: IP address of the module (u8*), Port (u16), Time to wait for the bootloader in ms (u32)
+Return: Error Status (u8), NOK if the address is wrong or the bootloader could not be reached, the LAN direct mode is then off*/
+extern u8 HOST_u8ConnectToBootloader (u8* Copy_u8Address, u16 Copy_u16Port, u32 Copy_u32TimeoutMs);
+
+/*Description: This API will be used to stop the push transport or the LAN direct mode, the channels are used again
+Parameters: void
+Return: void*/
+extern void HOST_voidStopPushServer (void);
+
+/*Description: This API will tell whether the push transport or the LAN direct mode is on
+Parameters: void
+Return: 1 if on, 0 otherwise (u8)*/
+extern u8 HOST_u8PushIsActive (void);
+
+/*Description: This API will be used to send a frame to the bootloader, waiting for it to connect if it is not connected
+Parameters: Chars (u8*), Number of chars (u16), Time to wait for the bootloader in ms (u32)
+Return: Error Status (u8)*/
+extern u8 HOST_u8PushSendFrame (u8* Copy_u8Chars, u16 Copy_u16Size, u32 Copy_u32TimeoutMs);
+
+/*Description: This API will be used to receive the next frame from the bootloader, the chars are ended by a null
+Parameters: Buffer (u8*), Size of buffer (u16), Time to wait in ms (u32)
+Return: Error Status (u8), NOK if no whole frame came in time, the buffer is then empty*/
+extern u8 HOST_u8PushReceiveFrame (u8* Copy_u8Buffer, u16 Copy_u16BufferSize, u32 Copy_u32TimeoutMs);
+
+
 #endif // HTTP_INTERFACE_H_INCLUDED
@@ -1,4 +1,5 @@
 #include<stdio.h>
+#include<stdlib.h>
 #include<winsock2.h>
 
 #include "HTTP_interface.h"
@@ -99,6 +100,12 @@ u8 HOST_voidSendCommand (u8* Copy_u8UserCommand, u16 Copy_u16Size)
     /*This variable will be used as an iterator to fill up data variable with proper data*/
     u16 Local_u16Iterator=0;
 
+    /*With the push transport the command goes straight to the bootloader*/
+    if (HOST_u8PushIsActive())
+    {
+        return HOST_u8PushSendFrame(Copy_u8UserCommand,Copy_u16Size,HTTP_PUSH_CONNECT_TIMEOUT_MS);
+    }
+
     /*Fill up data array with proper data by receiving data from incoming buffer until we reach desired size passed*/
     for (Local_u16Iterator=0; Local_u16Iterator<Copy_u16Size; Local_u16Iterator++)
     {
@@ -170,6 +177,11 @@ u8 HOST_voidReceiveCommand (u8* Copy_u8Buffer)
     /*This local variable will be used as a flag for the while loop which will be used to pass the received buffer to passed buffer*/
     u8 Local_u8TransferFlag=1;
 
+    /*With the push transport the reply is the next frame of the bootloader, it is waited for instead of polled*/
+    if (HOST_u8PushIsActive())
+    {
+        return HOST_u8PushReceiveFrame(Copy_u8Buffer,HTTP_PUSH_BUFFER_SIZE,HTTP_PUSH_REPLY_TIMEOUT_MS);
+    }
 
     /*Connect to server*/
     Local_u8ConnectionStatus=HOST_voidConnectToServer(HTTP_SERVER_NAME);
@@ -292,3 +304,100 @@ u8 HOST_voidSendCommandToResponses (u8* Copy_u8UserCommand, u16 Copy_u16Size)
     return Local_u8Status;
 }
 
+/*Server used by the fleet APIs, resolved once by (HOST_u8InitFleetNetwork)*/
+static struct sockaddr_in static_FleetServer;
+static u8 static_u8FleetServerName[64]={0};
+
+/*Description: This function will be used to open a socket connected to the fleet server, every caller gets its own socket
+Parameters: void
+Return: Connected socket or INVALID_SOCKET*/
+static SOCKET HOST_FleetConnect(void)
+{
+    SOCKET Local_Socket = socket(AF_INET , SOCK_STREAM , IPPROTO_TCP);
+
+    if (Local_Socket == INVALID_SOCKET) return INVALID_SOCKET;
+    if (connect(Local_Socket , (struct sockaddr *)&static_FleetServer , sizeof(static_FleetServer)) < 0)
+    {
+        closesocket(Local_Socket);
+        return INVALID_SOCKET;
+    }
+    return Local_Socket;
+}
+
+/*Description: This function will be used to send a request and copy the body of the reply (after the HTTP headers)
+Parameters: Request (u8*), Buffer to receive body (u8*) or NULL, Size of buffer (u16)
+Return: Error Status (u8)*/
+static u8 HOST_u8FleetRequest(u8* Copy_u8Request, u8* Copy_u8Buffer, u16 Copy_u16BufferSize)
+{
+    SOCKET Local_Socket;
+    u8  server_reply[2000];
+    int recv_size;
+    int total_size=0;
+    u8* Local_u8Body;
+
+    Local_Socket = HOST_FleetConnect();
+    if (Local_Socket == INVALID_SOCKET) return STATUS_NOK;
+
+    if (send(Local_Socket , Copy_u8Request , strlen(Copy_u8Request) , 0) < 0)
+    {
+        closesocket(Local_Socket);
+        return STATUS_NOK;
+    }
+    /*HTTP/1.0, server closes the connection after the reply*/
+    while ((total_size < (int)sizeof(server_reply)-1) &&
+           ((recv_size = recv(Local_Socket , &server_reply[total_size] , sizeof(server_reply)-1-total_size , 0)) > 0))
+    {
+        total_size += recv_size;
+    }
+    closesocket(Local_Socket);
+    server_reply[total_size] = '\0';
+
+    if (strncmp(server_reply, "HTTP/1.", 7) != 0 || strncmp(&server_reply[9], "200", 3) != 0) return STATUS_NOK;
+    if (Copy_u8Buffer != NULL && Copy_u16BufferSize != 0)
+    {
+        Local_u8Body = strstr(server_reply, "\r\n\r\n");
+        Local_u8Body = (Local_u8Body != NULL)? Local_u8Body+4 : &server_reply[total_size];
+        strncpy(Copy_u8Buffer, Local_u8Body, Copy_u16BufferSize-1);
+        Copy_u8Buffer[Copy_u16BufferSize-1] = '\0';
+    }
+    return STATUS_OK;
+}
+
+u8 HOST_u8InitFleetNetwork (u8* Copy_u8Server, u16 Copy_u16Port)
+{
+    struct hostent *Local_RemoteHost;
+
+    if (WSAStartup(MAKEWORD(2,2),&wsa) != 0) return STATUS_NOK;
+
+    Local_RemoteHost = gethostbyname(Copy_u8Server);
+    if (Local_RemoteHost == NULL || Local_RemoteHost->h_addr_list[0] == NULL) return STATUS_NOK;
+
+    memset(&static_FleetServer, 0, sizeof(static_FleetServer));
+    static_FleetServer.sin_addr.s_addr = *(u_long *) Local_RemoteHost->h_addr_list[0];
+    static_FleetServer.sin_family      = AF_INET;
+    static_FleetServer.sin_port        = htons(Copy_u16Port);
+    strncpy(static_u8FleetServerName, Copy_u8Server, sizeof(static_u8FleetServerName)-1);
+    return STATUS_OK;
+}
+
+u8 HOST_u8PostToChannel (u8* Copy_u8WriteKey, u8* Copy_u8Data, u16 Copy_u16Size)
+{
+    u8 Local_u8Request[1024];
+    /*The body of the reply is the entry id of the update, 0 if the server dropped it*/
+    u8 Local_u8EntryId[16];
+
+    if (Copy_u16Size > 900) return STATUS_NOK;
+    snprintf(Local_u8Request, sizeof(Local_u8Request), "GET /update?api_key=%s&field1=%.*s HTTP/1.0\r\nHost: %s\r\n\r\n",
+             Copy_u8WriteKey, Copy_u16Size, Copy_u8Data, static_u8FleetServerName);
+    if (HOST_u8FleetRequest(Local_u8Request, Local_u8EntryId, sizeof(Local_u8EntryId)) != STATUS_OK) return STATUS_NOK;
+    return (atoi((char*)Local_u8EntryId) > 0)? STATUS_OK : STATUS_NOK;
+}
+
+u8 HOST_u8ReadChannel (u8* Copy_u8ChannelId, u8* Copy_u8ReadKey, u8* Copy_u8Buffer, u16 Copy_u16BufferSize)
+{
+    u8 Local_u8Request[256];
+
+    snprintf(Local_u8Request, sizeof(Local_u8Request), "GET /channels/%s/fields/1/last.txt?api_key=%s HTTP/1.0\r\nHost: %s\r\n\r\n",
+             Copy_u8ChannelId, Copy_u8ReadKey, static_u8FleetServerName);
+    return HOST_u8FleetRequest(Local_u8Request, Copy_u8Buffer, Copy_u16BufferSize);
+}
@@ -0,0 +1,470 @@
+/* This file implements the serial port on Linux, with the same functions as WindowsSerialPort.c
+ * The port is opened non blocking and its reads and writes are multiplexed with epoll : a write goes to the transmit
+ * queue and returns at once, the queue drains while read_serial_port waits for the replies, so the UART keeps
+ * transmitting while the host waits for the bootloader (windowed write).
+ * The baud rate is set with termios2 (BOTHER), any rate the USB serial adapter can make works, 2-4 Mbaud included.
+ * The loopback benchmark runs the same path against a pseudo terminal, no board needed.
+ * This file is Linux only
+ */
+
+#define _GNU_SOURCE
+#include "main.h"
+#include "LinuxSerialPort.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <asm/ioctls.h>
+#include <asm/termbits.h>               //termios2, <termios.h> and <sys/ioctl.h> can not be included with it
+
+int ioctl(int fd, unsigned long request, ...);
+
+#define SERIAL_DEFAULT_PORT             "/dev/ttyUSB0"  //may change, BL_SERIAL_PORT overrides it
+#define SERIAL_DEFAULT_BAUDRATE         115200          //BL_SERIAL_BAUD overrides it
+#define SERIAL_DEFAULT_READ_TIMEOUT_MS  300
+#define SERIAL_TX_QUEUE_SIZE            8192            //power of two
+#define SERIAL_TX_STALL_MS              2000            //transmit queue full and not draining for this long : data dropped
+
+#define LOOPBACK_BYTES                  65536   //bulk transfer, cut to LOOPBACK_WIRE_MS on the wire for slow links
+#define LOOPBACK_BLOCK                  1024
+#define LOOPBACK_ROUND_TRIPS            200
+#define LOOPBACK_WIRE_MS                10000
+#define LOOPBACK_MARGIN_MS              2000    //bulk timeout : twice the time on the wire and this
+
+static int      serial_fd    = -1;
+static int      serial_epoll = -1;
+static uint32_t serial_events;                          //events epoll watches on the port now
+static uint32_t serial_baudrate;
+static uint32_t serial_read_timeout_ms = SERIAL_DEFAULT_READ_TIMEOUT_MS;
+
+//Transmit queue, head and tail run freely and wrap with the size
+static uint8_t  serial_tx_queue[SERIAL_TX_QUEUE_SIZE];
+static uint32_t serial_tx_head;
+static uint32_t serial_tx_tail;
+
+
+//Win32 calls used by the files common to both hosts
+void Sleep(uint32_t ms)
+{
+    struct timespec delay = {ms/1000, (ms%1000)*1000000L};
+    while(nanosleep(&delay, &delay) != 0 && errno == EINTR);
+}
+
+uint32_t GetTickCount(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec*1000 + now.tv_nsec/1000000);
+}
+
+static uint64_t serial_now_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec*1000000 + now.tv_nsec/1000;
+}
+
+//Sets the events epoll watches on the port
+static void serial_watch(uint32_t events)
+{
+    struct epoll_event event;
+
+    if(events == serial_events) return;
+    event.events  = events;
+    event.data.fd = serial_fd;
+    if(epoll_ctl(serial_epoll, EPOLL_CTL_MOD, serial_fd, &event) == 0) serial_events = events;
+}
+
+//Writes as much of the transmit queue as the driver takes, EPOLLOUT is watched only while something is left
+static void serial_push_tx(void)
+{
+    uint32_t offset;
+    uint32_t chunk;
+    ssize_t  written;
+
+    while(serial_tx_head != serial_tx_tail)
+    {
+        offset = serial_tx_tail % SERIAL_TX_QUEUE_SIZE;
+        chunk  = serial_tx_head - serial_tx_tail;
+        if(chunk > SERIAL_TX_QUEUE_SIZE-offset) chunk = SERIAL_TX_QUEUE_SIZE-offset;
+        written = write(serial_fd, &serial_tx_queue[offset], chunk);
+        if(written < 0)
+        {
+            if(errno == EINTR) continue;
+            if(errno == EAGAIN) break;
+            printf("\n  Error %d in Writing to Serial Port", errno);
+            serial_tx_tail = serial_tx_head;
+            break;
+        }
+        serial_tx_tail += written;
+    }
+    serial_watch(EPOLLIN | ((serial_tx_head != serial_tx_tail)? EPOLLOUT : 0));
+}
+
+//Waits up to (ms) for the port, the transmit queue is pushed when the driver has room. Returns the events seen
+static uint32_t serial_poll(uint32_t ms)
+{
+    struct epoll_event event;
+    int ready = epoll_wait(serial_epoll, &event, 1, (int)ms);
+
+    if(ready <= 0) return 0;
+    if(event.events & EPOLLOUT) serial_push_tx();
+    return event.events;
+}
+
+//Opens the port in raw 8N1 at any baud rate, returns 0 on success
+int Serial_Port_Open(const char *name, uint32_t baudrate)
+{
+    struct termios2    settings;
+    struct epoll_event event;
+
+    serial_fd = open(name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(serial_fd < 0) return -1;
+    if(ioctl(serial_fd, TCGETS2, &settings) < 0)
+    {
+        close(serial_fd);
+        serial_fd = -1;
+        return -1;
+    }
+    //no echo, no line editing, no char translation, no flow control. epoll does the waiting (VMIN = VTIME = 0)
+    settings.c_iflag  = 0;
+    settings.c_oflag  = 0;
+    settings.c_lflag  = 0;
+    settings.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT) | CSIZE | PARENB | CSTOPB | CRTSCTS);
+    settings.c_cflag |= BOTHER | (BOTHER << IBSHIFT) | CS8 | CLOCAL | CREAD;
+    settings.c_ispeed = baudrate;
+    settings.c_ospeed = baudrate;
+    settings.c_cc[VMIN]  = 0;
+    settings.c_cc[VTIME] = 0;
+    if(ioctl(serial_fd, TCSETS2, &settings) < 0 || ioctl(serial_fd, TCGETS2, &settings) < 0)
+    {
+        close(serial_fd);
+        serial_fd = -1;
+        return -1;
+    }
+    //the driver rounds the rate to what its clock can make
+    serial_baudrate = settings.c_ospeed ? settings.c_ospeed : baudrate;
+
+    serial_epoll  = epoll_create1(0);
+    event.events  = EPOLLIN;
+    event.data.fd = serial_fd;
+    if(serial_epoll < 0 || epoll_ctl(serial_epoll, EPOLL_CTL_ADD, serial_fd, &event) < 0)
+    {
+        if(serial_epoll >= 0) close(serial_epoll);
+        close(serial_fd);
+        serial_fd = serial_epoll = -1;
+        return -1;
+    }
+    serial_events  = EPOLLIN;
+    serial_tx_head = serial_tx_tail = 0;
+    serial_read_timeout_ms = SERIAL_DEFAULT_READ_TIMEOUT_MS;
+    return 0;
+}
+
+void Serial_Port_Configuration(void)
+{
+    const char* name     = getenv("BL_SERIAL_PORT");
+    const char* baudrate = getenv("BL_SERIAL_BAUD");
+
+    if(name == NULL) name = SERIAL_DEFAULT_PORT;
+    if(Serial_Port_Open(name, baudrate ? (uint32_t)strtoul(baudrate, NULL, 10) : SERIAL_DEFAULT_BAUDRATE) != 0)
+    {
+         printf("\n   Error! - Port %s can't be opened", name);
+         printf("\n   Check board connection and Port Name (BL_SERIAL_PORT)\n");
+         exit(-1);
+    }
+    printf("\n   Port %s Opened\n ", name);
+    printf("\n       Baudrate = %u", serial_baudrate);
+    printf("\n       ByteSize = 8");
+    printf("\n       StopBits = 1");
+    printf("\n       Parity   = None");
+}
+
+/* This function reads from the serial port and returns count of bytes read, it returns as soon as some bytes are
+ * received or after the read timeout if nothing comes. The transmit queue drains meanwhile */
+uint32_t read_serial_port(uint8_t *pBuffer, uint32_t len)
+{
+    uint32_t start = GetTickCount();
+    uint32_t elapsed;
+    ssize_t  received;
+
+    if(len == 0) return 0;
+    while(1)
+    {
+        received = read(serial_fd, pBuffer, len);
+        if(received > 0) return received;
+        if(received < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            printf("\n  Error %d in Reading from Serial Port", errno);
+            return 0;
+        }
+        elapsed = GetTickCount()-start;
+        if(elapsed >= serial_read_timeout_ms) return 0;
+        serial_poll(serial_read_timeout_ms-elapsed);
+    }
+}
+
+//closes the serial port once the transmit queue is sent
+void Close_serial_port(void)
+{
+    uint32_t start = GetTickCount();
+
+    if(serial_fd < 0) return;
+    serial_watch(EPOLLOUT);
+    while(serial_tx_head != serial_tx_tail && (GetTickCount()-start) < SERIAL_TX_STALL_MS)
+    {
+        serial_poll(SERIAL_TX_STALL_MS);
+        serial_watch(EPOLLOUT);
+    }
+    ioctl(serial_fd, TCSBRK, 1);        //tcdrain : waits for the UART to shift the last byte out
+    close(serial_epoll);
+    close(serial_fd);
+    serial_fd = serial_epoll = -1;
+}
+
+//drops the transmit queue and what the driver holds in both directions
+void purge_serial_port(void)
+{
+    if(serial_fd < 0) return;
+    serial_tx_tail = serial_tx_head;
+    serial_watch(EPOLLIN);
+    ioctl(serial_fd, TCFLSH, TCIOFLUSH);
+}
+
+//Same as Write_to_serial_port without printing every byte, used for bulk data.
+//Returns once the data is queued, waits only when the queue is full
+void Write_to_serial_port_quiet(uint8_t *data_buf, uint32_t len)
+{
+    uint32_t offset;
+    uint32_t chunk;
+    uint32_t stall_start = 0;
+    uint32_t tail;
+
+    while(len)
+    {
+        chunk = SERIAL_TX_QUEUE_SIZE - (serial_tx_head-serial_tx_tail);
+        if(chunk == 0)
+        {
+            //only the room in the driver matters here, replies waiting to be read would wake epoll for nothing
+            if(stall_start == 0) stall_start = GetTickCount();
+            if((GetTickCount()-stall_start) > SERIAL_TX_STALL_MS)
+            {
+                printf("\n  Error in Writing to Serial Port, %u bytes dropped", len);
+                return;
+            }
+            tail = serial_tx_tail;
+            serial_watch(EPOLLOUT);
+            serial_poll(SERIAL_TX_STALL_MS);
+            if(serial_tx_tail != tail) stall_start = 0;
+            continue;
+        }
+        offset = serial_tx_head % SERIAL_TX_QUEUE_SIZE;
+        if(chunk > len) chunk = len;
+        if(chunk > SERIAL_TX_QUEUE_SIZE-offset) chunk = SERIAL_TX_QUEUE_SIZE-offset;
+        memcpy(&serial_tx_queue[offset], data_buf, chunk);
+        serial_tx_head += chunk;
+        data_buf       += chunk;
+        len            -= chunk;
+        serial_push_tx();
+    }
+    serial_watch(EPOLLIN | ((serial_tx_head != serial_tx_tail)? EPOLLOUT : 0));
+}
+
+//This fun is used to Send data over the serial port of "len" bytes
+void Write_to_serial_port(uint8_t *data_buf, uint32_t len)
+{
+    printf("\n   Sending: ");
+    for(uint32_t i = 0 ; i < len ; i++)
+    {
+        printf("   0x%2.2x ",data_buf[i]);
+        if( i % 8 == 7)
+        {
+            printf("\n");
+        }
+    }
+    Write_to_serial_port_quiet(data_buf, len);
+}
+
+//read_serial_port returns as soon as some bytes are received, or after "ms" if nothing comes
+void Set_serial_port_read_timeout(uint32_t ms)
+{
+    serial_read_timeout_ms = ms;
+}
+
+uint32_t Get_serial_port_baudrate(void)
+{
+    return serial_baudrate;
+}
+
+//Bytes written but not taken by the driver yet
+uint32_t serial_port_pending_tx(void)
+{
+    return serial_tx_head - serial_tx_tail;
+}
+
+
+/*--------------------------------- Loopback benchmark ---------------------------------*/
+
+typedef struct
+{
+    int          master;
+    uint32_t     baudrate;
+    volatile int stop;
+} serial_echo_t;
+
+//Other end of the pseudo terminal : sends back every byte once it would have crossed a UART at (baudrate), 10 bits per byte
+static void* serial_echo_thread(void* param)
+{
+    serial_echo_t*     echo = (serial_echo_t*)param;
+    struct epoll_event event;
+    uint8_t  buffer[256];
+    uint64_t link_free_us = 0;          //the bytes received so far are all on the wire by then
+    uint64_t now_us;
+    ssize_t  received;
+    ssize_t  written;
+    ssize_t  count;
+    int      poller = epoll_create1(0);
+
+    event.events  = EPOLLIN;
+    event.data.fd = echo->master;
+    epoll_ctl(poller, EPOLL_CTL_ADD, echo->master, &event);
+    while(!echo->stop)
+    {
+        if(epoll_wait(poller, &event, 1, 50) <= 0) continue;
+        received = read(echo->master, buffer, sizeof(buffer));
+        if(received <= 0) continue;
+        now_us = serial_now_us();
+        if(link_free_us < now_us) link_free_us = now_us;
+        link_free_us += received*10*1000000ULL/echo->baudrate;
+        now_us = serial_now_us();
+        if(link_free_us > now_us) usleep((useconds_t)(link_free_us-now_us));
+        for(written = 0; written < received; )
+        {
+            count = write(echo->master, &buffer[written], received-written);
+            if(count > 0) written += count;
+            else if(errno != EAGAIN && errno != EINTR) break;
+        }
+    }
+    close(poller);
+    return NULL;
+}
+
+static int serial_compare_us(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+//Runs the serial path of this file against an echo on a pseudo terminal : round trip latency of one byte,
+//then a bulk transfer in blocks (as the windowed write sends) checked byte by byte
+void serial_loopback_benchmark(void)
+{
+    serial_echo_t echo;
+    pthread_t     echo_thread;
+    uint8_t*      sent;
+    uint8_t*      echoed;
+    uint8_t       byte;
+    uint32_t      latencies[LOOPBACK_ROUND_TRIPS];
+    uint32_t      baudrate = 2000000;
+    uint32_t      bulk_bytes;
+    uint32_t      timeout_ms;
+    uint32_t      queued   = 0;
+    uint32_t      received = 0;
+    uint32_t      index;
+    uint32_t      count;
+    uint64_t      start_us;
+    uint64_t      write_us = 0;
+    uint64_t      stamp_us;
+    uint64_t      elapsed_us;
+    uint32_t      start_ms;
+
+    printf("\n   Enter the baud rate of the emulated link : ");
+    scanf(" %u", &baudrate);
+    if(baudrate < 1200) baudrate = 1200;
+
+    echo.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(echo.master < 0 || grantpt(echo.master) != 0 || unlockpt(echo.master) != 0 || Serial_Port_Open(ptsname(echo.master), baudrate) != 0)
+    {
+        printf("\n   Pseudo terminal could not be opened : %d\n", errno);
+        if(echo.master >= 0) close(echo.master);
+        return;
+    }
+    fcntl(echo.master, F_SETFL, fcntl(echo.master, F_GETFL) | O_NONBLOCK);
+    echo.baudrate = baudrate;
+    echo.stop     = 0;
+    sent   = malloc(LOOPBACK_BYTES);
+    echoed = malloc(LOOPBACK_BYTES);
+    if(sent == NULL || echoed == NULL || pthread_create(&echo_thread, NULL, serial_echo_thread, &echo) != 0)
+    {
+        printf("\n   Not enough memory!!\r\n");
+        free(sent); free(echoed);
+        Close_serial_port(); close(echo.master);
+        return;
+    }
+    //the time of the bulk transfer follows the baud rate, 1200 baud takes 546 s for the full size
+    bulk_bytes = (uint32_t)(((uint64_t)baudrate*LOOPBACK_WIRE_MS/10000)/LOOPBACK_BLOCK)*LOOPBACK_BLOCK;
+    if(bulk_bytes > LOOPBACK_BYTES) bulk_bytes = LOOPBACK_BYTES;
+    if(bulk_bytes < LOOPBACK_BLOCK) bulk_bytes = LOOPBACK_BLOCK;
+    timeout_ms = (uint32_t)((uint64_t)bulk_bytes*10*1000*2/baudrate) + LOOPBACK_MARGIN_MS;
+    printf("\n   Loopback on %s at %u baud", ptsname(echo.master), serial_baudrate);
+
+    //one byte out, the same byte back
+    Set_serial_port_read_timeout(1000);
+    for(index = 0; index < LOOPBACK_ROUND_TRIPS; index++)
+    {
+        byte     = (uint8_t)index;
+        stamp_us = serial_now_us();
+        Write_to_serial_port_quiet(&byte, 1);
+        if(read_serial_port(&byte, 1) != 1 || byte != (uint8_t)index) break;
+        latencies[index] = (uint32_t)(serial_now_us()-stamp_us);
+    }
+    if(index == LOOPBACK_ROUND_TRIPS)
+    {
+        qsort(latencies, LOOPBACK_ROUND_TRIPS, sizeof(uint32_t), serial_compare_us);
+        printf("\n   Round trip of one byte : p50 %u us, p99 %u us (one byte on the wire : %u us)",
+               latencies[LOOPBACK_ROUND_TRIPS/2], latencies[LOOPBACK_ROUND_TRIPS*99/100], 10*1000000/baudrate);
+    }
+    else
+    {
+        printf("\n   Round trip %u failed", index);
+    }
+
+    //blocks are queued while less than one block is waiting, the replies are read in between
+    for(index = 0; index < bulk_bytes; index++) sent[index] = (uint8_t)(index*7+(index>>8));
+    Set_serial_port_read_timeout(1);
+    start_ms = GetTickCount();
+    start_us = serial_now_us();
+    while(received < bulk_bytes && (GetTickCount()-start_ms) < timeout_ms)
+    {
+        if(queued < bulk_bytes && serial_port_pending_tx() < LOOPBACK_BLOCK)
+        {
+            stamp_us = serial_now_us();
+            Write_to_serial_port_quiet(&sent[queued], LOOPBACK_BLOCK);
+            write_us += serial_now_us()-stamp_us;
+            queued   += LOOPBACK_BLOCK;
+        }
+        received += read_serial_port(&echoed[received], bulk_bytes-received);
+    }
+    elapsed_us = serial_now_us()-start_us;
+    if(elapsed_us == 0) elapsed_us = 1;
+
+    for(index = 0, count = 0; index < received; index++)
+    {
+        if(echoed[index] != sent[index]) count++;
+    }
+    printf("\n   Bulk : %u of %u bytes back in %.3f s (timeout %.1f s), %u bytes wrong", received, bulk_bytes, elapsed_us/1000000.0,
+           timeout_ms/1000.0, count);
+    printf("\n   %.0f bytes/s each way, link use %.0f %%, %.1f ms spent in writes\n", received*1000000.0/elapsed_us,
+           100.0*received*10.0*1000000.0/((double)baudrate*elapsed_us), write_us/1000.0);
+
+    echo.stop = 1;
+    pthread_join(echo_thread, NULL);
+    Close_serial_port();
+    close(echo.master);
+    free(sent);
+    free(echoed);
+}
@@ -0,0 +1,20 @@
+#ifndef LINUX_SERIAL_H_INCLUDED
+#define LINUX_SERIAL_H_INCLUDED
+
+//Serial port related prototypes, same as WindowsSerialPort.h
+void Serial_Port_Configuration(void);
+uint32_t read_serial_port(uint8_t *pBuffer, uint32_t len);
+void Close_serial_port(void);
+void purge_serial_port(void);
+void Write_to_serial_port(uint8_t *data_buf, uint32_t len);
+void Write_to_serial_port_quiet(uint8_t *data_buf, uint32_t len);
+void Set_serial_port_read_timeout(uint32_t ms);
+uint32_t Get_serial_port_baudrate(void);
+
+//Linux only
+int  Serial_Port_Open(const char *name, uint32_t baudrate);
+uint32_t serial_port_pending_tx(void);
+void serial_loopback_benchmark(void);
+
+
+#endif // LINUX_SERIAL_H_INCLUDED
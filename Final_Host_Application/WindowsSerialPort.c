@@ -1,6 +1,7 @@
 #include "main.h"
 
 HANDLE hComm;                          // Handle to the Serial port
+static DWORD BaudRate = 115200;        // Baud rate set in the DCB
 
 void Serial_Port_Configuration(void)
 {
@@ -50,6 +51,7 @@ void Serial_Port_Configuration(void)
     }
     else
     {
+        BaudRate = dcbSerialParams.BaudRate;
         printf("\n   Setting DCB Structure Successfull\n");
         printf("\n       Baudrate = %ld", dcbSerialParams.BaudRate);
         printf("\n       ByteSize = %d", dcbSerialParams.ByteSize);
@@ -135,3 +137,32 @@ void Write_to_serial_port(uint8_t *data_buf, uint32_t len)
         printf("\n  Error %ld in Writing to Serial Port",GetLastError());
 }
 
+//Same as Write_to_serial_port without printing every byte, used for bulk data
+void Write_to_serial_port_quiet(uint8_t *data_buf, uint32_t len)
+{
+    DWORD  dNoOfBytesWritten = 0;          // No of bytes written to the port
+
+    if (WriteFile(hComm, data_buf, len, &dNoOfBytesWritten, NULL) == FALSE || dNoOfBytesWritten != len)
+        printf("\n  Error %ld in Writing to Serial Port",GetLastError());
+}
+
+//read_serial_port returns as soon as some bytes are received, or after "ms" if nothing comes
+void Set_serial_port_read_timeout(uint32_t ms)
+{
+    COMMTIMEOUTS timeouts = { 0 };
+
+    timeouts.ReadIntervalTimeout         = MAXDWORD;
+    timeouts.ReadTotalTimeoutMultiplier  = MAXDWORD;
+    timeouts.ReadTotalTimeoutConstant    = ms;
+    timeouts.WriteTotalTimeoutConstant   = 50;
+    timeouts.WriteTotalTimeoutMultiplier = 10;
+
+    if (SetCommTimeouts(hComm, &timeouts) == FALSE)
+        printf("\n   Error! in Setting Time Outs");
+}
+
+//Baud rate the port was set to, for the link use of the windowed write
+uint32_t Get_serial_port_baudrate(void)
+{
+    return BaudRate;
+}
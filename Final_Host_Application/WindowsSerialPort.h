@@ -7,6 +7,9 @@ uint32_t read_serial_port(uint8_t *pBuffer, uint32_t len);
 void Close_serial_port(void);
 void purge_serial_port(void);
 void Write_to_serial_port(uint8_t *data_buf, uint32_t len);
+void Write_to_serial_port_quiet(uint8_t *data_buf, uint32_t len);
+void Set_serial_port_read_timeout(uint32_t ms);
+uint32_t Get_serial_port_baudrate(void);
 
 
 #endif // WINDOWS_SERIAL_H_INCLUDED
@@ -72,3 +72,59 @@ void close_the_file(void)
 {
     fclose(file);
 }
+
+//Writes the text that has to be published on the image server next to the binary file (<file>.txt) :
+//every 1 KB chunk as 2048 hex chars (the last one padded with erased flash "ff"), then the manifest window
+//holding the CRC32 of every chunk. Returns 0 on success
+int write_published_image(uint8_t *image, uint32_t len, uint32_t *manifest, uint32_t chunks)
+{
+    FILE*    published;
+    char     path[310];
+    uint8_t  chunk_bytes[IMAGE_CHUNK_SIZE];
+    uint8_t  chunk_chars[IMAGE_CHUNK_SIZE*2];
+    uint32_t chunk;
+    uint32_t chunk_len;
+
+    sprintf(path, "%s.txt", user_app);
+    published = fopen(path, "w");
+    if(! published){
+        perror("\n   Could not write the published image");
+        return -1;
+    }
+    for(chunk = 0 ; chunk < chunks ; chunk++)
+    {
+        chunk_len = ((len-chunk*IMAGE_CHUNK_SIZE) >= IMAGE_CHUNK_SIZE)? IMAGE_CHUNK_SIZE : (len-chunk*IMAGE_CHUNK_SIZE);
+        memset(chunk_bytes, 0xFF, IMAGE_CHUNK_SIZE);
+        memcpy(chunk_bytes, &image[chunk*IMAGE_CHUNK_SIZE], chunk_len);
+        hex2char(chunk_bytes, chunk_chars, IMAGE_CHUNK_SIZE);
+        fwrite(chunk_chars, 1, IMAGE_CHUNK_SIZE*2, published);
+    }
+    hex2char((uint8_t*)manifest, chunk_chars, chunks*4);
+    fwrite(chunk_chars, 1, chunks*8, published);
+    fclose(published);
+    printf("\n   Publish %s on the image server before the bootloader fetches it", path);
+    return 0;
+}
+
+//Reads (count) chars of the published text (<file>.txt) from char (offset), for the LAN direct mode where the
+//bootloader asks this application for the image windows. Returns the number of chars read, 0 past the end or on error
+uint32_t read_published_image(uint32_t offset, uint8_t *chars, uint32_t count)
+{
+    FILE*    published;
+    char     path[310];
+    uint32_t read;
+
+    sprintf(path, "%s.txt", user_app);
+    published = fopen(path, "rb");
+    if(! published){
+        perror("\n   Could not read the published image");
+        return 0;
+    }
+    if(fseek(published, offset, SEEK_SET) != 0){
+        fclose(published);
+        return 0;
+    }
+    read = fread(chars, 1, count, published);
+    fclose(published);
+    return read;
+}
@@ -0,0 +1,578 @@
+/* This file implements the fleet mode : the same application is flashed on many boards at the same time.
+ * Every board has its own pair of channels on the server (commands and responses) and its own update session.
+ * A session is a state machine (version check, erase, write, verify, save app info, jump), every step goes through
+ * three phases : clear the responses channel, post the command, poll the responses channel.
+ * A pool of worker threads runs the phases of the sessions that are due, so a few threads drive many boards,
+ * and a semaphore bounds the number of requests in flight toward the server.
+ * With multicast on, the first try of the write step is BL_MEM_MULTICAST : one sender thread sends the image once
+ * to all the boards on the LAN (see multicast.c), the retries fall back to BL_MEM_WRITE from the published image.
+ * This file is Windows only (threads and winsock)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "main.h"
+#include "HTTP_interface.h"
+
+#define FLEET_MAX_DEVICES               256
+#define FLEET_MAX_WORKERS               64      //WaitForMultipleObjects limit
+#define FLEET_MAX_RETRIES               2       //every step is tried (1 + FLEET_MAX_RETRIES) times
+
+#define FLEET_CHANNEL_POST_INTERVAL_MS  15000   //server accepts one update per channel every 15 s
+#define FLEET_FIRST_POLL_DELAY_MS       5000    //bootloader needs some time to fetch and process the command
+#define FLEET_POLL_INTERVAL_MS          3000
+#define FLEET_STEP_TIMEOUT_MS           120000
+#define FLEET_WRITE_TIMEOUT_PER_PAGE_MS 20000   //bootloader fetches every 1 KB page from the server
+#define FLEET_MCAST_JOIN_TIMEOUT_MS     300000  //boards reach the write step up to a few minutes apart
+
+#define FLEET_REPLY_CHARS               600
+
+//Steps of an update session, in order
+#define FLEET_STEP_VERSION              0
+#define FLEET_STEP_ERASE                1
+#define FLEET_STEP_WRITE                2
+#define FLEET_STEP_VERIFY               3
+#define FLEET_STEP_SAVE_INFO            4
+#define FLEET_STEP_JUMP                 5
+#define FLEET_STEP_DONE                 6
+
+//Phases of every step
+#define FLEET_PHASE_CLEAR               0
+#define FLEET_PHASE_SEND                1
+#define FLEET_PHASE_WAIT                2
+
+#define FLEET_RESULT_PENDING            0
+#define FLEET_RESULT_DONE               1
+#define FLEET_RESULT_FAILED             2
+
+typedef struct
+{
+    char     name[32];
+    char     commands_write_key[24];
+    char     responses_write_key[24];
+    char     responses_channel[16];
+    char     responses_read_key[24];
+
+    uint8_t  step;
+    uint8_t  phase;
+    uint8_t  retries;
+    uint8_t  busy;                  //a worker is running a phase of this session
+    uint8_t  result;
+    uint8_t  bl_version;
+    uint32_t next_action_ms;        //the session is not touched before this time
+    uint32_t step_deadline_ms;
+    uint32_t last_command_post_ms;
+    uint32_t last_response_post_ms;
+    uint32_t start_ms;
+    uint32_t end_ms;
+} fleet_session_t;
+
+static const char* fleet_step_names[] = {"version", "erase", "write", "verify", "save info", "jump", "done"};
+
+static fleet_session_t  fleet_sessions[FLEET_MAX_DEVICES];
+static uint32_t         fleet_number_of_sessions;
+static uint32_t         fleet_sessions_left;
+static CRITICAL_SECTION fleet_lock;
+static HANDLE           fleet_server_slots;
+
+//Image that is flashed on every board
+static uint32_t fleet_image_len;
+static uint32_t fleet_image_crc;
+static uint32_t fleet_manifest_crc;
+static uint32_t fleet_base_address;
+static uint8_t* fleet_image;
+static char     fleet_app_name[9];
+
+//Multicast write step
+static uint8_t        fleet_multicast;
+static mcast_config_t fleet_mcast_config;
+static mcast_result_t fleet_mcast_result;
+
+
+//Builds a command packet [len-1][code][payload][crc32] and converts it to chars, returns number of chars
+static uint16_t fleet_build_packet(uint8_t code, uint8_t* payload, uint8_t payload_len, uint8_t* out_chars)
+{
+    uint8_t  packet[64];
+    uint8_t  len = payload_len+6;
+    uint32_t crc;
+
+    packet[0] = len-1;
+    packet[1] = code;
+    memcpy(&packet[2], payload, payload_len);
+    crc = get_crc(packet, len-4);
+    packet[len-4] = word_to_byte(crc,1,1);
+    packet[len-3] = word_to_byte(crc,2,1);
+    packet[len-2] = word_to_byte(crc,3,1);
+    packet[len-1] = word_to_byte(crc,4,1);
+    hex2char(packet, out_chars, len);
+    return len*2;
+}
+
+//Builds the BL_SAVE_APP_INFO packet, the name goes as it is between the hex chars (see option 17 of the menu), returns number of chars
+static uint16_t fleet_build_save_info_packet(uint8_t* out_chars)
+{
+    uint8_t  packet[COMMAND_BL_SAVE_APP_INFO_LEN];
+    uint32_t crc;
+    uint8_t  index;
+
+    packet[0] = COMMAND_BL_SAVE_APP_INFO_LEN-1;
+    packet[1] = COMMAND_BL_SAVE_APP_INFO;
+    memcpy(&packet[2], &fleet_base_address, 4);
+    memcpy(&packet[6], &fleet_image_len, 4);
+    for(index=0; index<8; index++)
+    {
+        //the name is padded with ascii zeros, the bootloader takes it as it comes
+        packet[10+index] = (fleet_app_name[index] != 0)? fleet_app_name[index] : 0x30;
+    }
+    crc = get_crc(packet, COMMAND_BL_SAVE_APP_INFO_LEN-4);
+    packet[18] = word_to_byte(crc,1,1);
+    packet[19] = word_to_byte(crc,2,1);
+    packet[20] = word_to_byte(crc,3,1);
+    packet[21] = word_to_byte(crc,4,1);
+    hex2char(packet, out_chars, 10);
+    memcpy(&out_chars[20], &packet[10], 8);
+    hex2char(&packet[18], &out_chars[28], 4);
+    return 36;
+}
+
+//Converts the reply read from the responses channel, returns length to follow, -1 if there is no complete reply yet, -2 on NACK
+static int fleet_parse_reply(uint8_t* reply_chars, uint8_t* reply_hex)
+{
+    uint32_t chars = strlen((char*)reply_chars);
+
+    //a NACK is one byte
+    if(chars < 2) return -1;
+    char2hex(reply_chars, reply_hex, 1);
+    if(reply_hex[0] == 0x7F) return -2;
+    if(chars < 4) return -1;
+    char2hex(reply_chars, reply_hex, 2);
+    if(reply_hex[0] != 0xA5) return -1;
+    if(chars < 4+(uint32_t)reply_hex[1]*2) return -1;
+    char2hex(&reply_chars[4], &reply_hex[2], reply_hex[1]);
+    return reply_hex[1];
+}
+
+//Every request toward the server takes one of the server slots
+static uint8_t fleet_post(char* write_key, uint8_t* data, uint16_t size)
+{
+    uint8_t status;
+    WaitForSingleObject(fleet_server_slots, INFINITE);
+    status = HOST_u8PostToChannel((u8*)write_key, data, size);
+    ReleaseSemaphore(fleet_server_slots, 1, NULL);
+    return status;
+}
+
+static uint8_t fleet_read(fleet_session_t* session, uint8_t* buffer, uint16_t size)
+{
+    uint8_t status;
+    WaitForSingleObject(fleet_server_slots, INFINITE);
+    status = HOST_u8ReadChannel((u8*)session->responses_channel, (u8*)session->responses_read_key, buffer, size);
+    ReleaseSemaphore(fleet_server_slots, 1, NULL);
+    return status;
+}
+
+//Builds the command of the current step of a session
+static uint16_t fleet_step_command(fleet_session_t* session, uint8_t* out_chars)
+{
+    uint8_t  payload[16];
+    uint32_t address;
+
+    switch(session->step)
+    {
+    case FLEET_STEP_VERSION:
+        return fleet_build_packet(COMMAND_BL_GET_VER, payload, 0, out_chars);
+    case FLEET_STEP_ERASE:
+        memcpy(&payload[0], &fleet_base_address, 4);
+        payload[4] = (fleet_image_len+1023)/1024;
+        return fleet_build_packet(COMMAND_BL_FLASH_ERASE, payload, 5, out_chars);
+    case FLEET_STEP_WRITE:
+        memcpy(&payload[0], &fleet_base_address, 4);
+        memcpy(&payload[4], &fleet_image_len, 4);
+        memcpy(&payload[8], &fleet_image_crc, 4);
+        if(fleet_multicast && session->retries == 0) return fleet_build_packet(COMMAND_BL_MEM_MULTICAST, payload, 12, out_chars);
+        memcpy(&payload[12], &fleet_manifest_crc, 4);
+        return fleet_build_packet(COMMAND_BL_MEM_WRITE, payload, 16, out_chars);
+    case FLEET_STEP_VERIFY:
+        memcpy(&payload[0], &fleet_base_address, 4);
+        memcpy(&payload[4], &fleet_image_len, 4);
+        payload[8] = BL_DIGEST_CRC32;
+        return fleet_build_packet(COMMAND_BL_GET_DIGEST, payload, 9, out_chars);
+    case FLEET_STEP_SAVE_INFO:
+        //the record of the app is written once its image is checked, so the bootloader checks it at every boot
+        return fleet_build_save_info_packet(out_chars);
+    case FLEET_STEP_JUMP:
+        //GO_TO_ADDR jumps to the address stored at the given address, which is the reset vector of the app
+        address = fleet_base_address+4;
+        memcpy(&payload[0], &address, 4);
+        return fleet_build_packet(COMMAND_BL_GO_TO_ADDR, payload, 4, out_chars);
+    }
+    return 0;
+}
+
+//Checks the reply of the current step, returns 1 if the step succeeded
+static uint8_t fleet_step_reply_ok(fleet_session_t* session, uint8_t* reply_hex, int len)
+{
+    uint32_t crc;
+
+    switch(session->step)
+    {
+    case FLEET_STEP_VERSION:
+        session->bl_version = reply_hex[2];
+        return (len >= 1);
+    case FLEET_STEP_ERASE:
+        return (len >= 1 && reply_hex[2] == 1);     //erase replies with ErrorStatus (OK = 1)
+    case FLEET_STEP_WRITE:
+        return (len >= 1 && reply_hex[2] == BL_MEM_WRITE_OK);
+    case FLEET_STEP_VERIFY:
+        if(len != 6+BL_DIGEST_CRC32_LEN || reply_hex[2] != 0) return 0;
+        memcpy(&crc, &reply_hex[8], 4);
+        return (crc == fleet_image_crc);
+    case FLEET_STEP_SAVE_INFO:
+        return (len >= 1 && reply_hex[2] == 0);     //STATUS_OK of the bootloader
+    case FLEET_STEP_JUMP:
+        return (len >= 1 && reply_hex[2] == 0);
+    }
+    return 0;
+}
+
+static uint32_t fleet_step_timeout(fleet_session_t* session)
+{
+    if(session->step == FLEET_STEP_WRITE && fleet_multicast && session->retries == 0)
+        return FLEET_STEP_TIMEOUT_MS + mcast_worst_case_ms(&fleet_mcast_config, fleet_image_len);
+    if(session->step == FLEET_STEP_WRITE)
+        return FLEET_STEP_TIMEOUT_MS + ((fleet_image_len+1023)/1024)*FLEET_WRITE_TIMEOUT_PER_PAGE_MS;
+    return FLEET_STEP_TIMEOUT_MS;
+}
+
+//Called with the lock held
+static void fleet_finish(fleet_session_t* session, uint8_t result)
+{
+    session->result = result;
+    session->end_ms = GetTickCount();
+    fleet_sessions_left--;
+    printf("\n   [%s] %s after %.1f s (%s step)", session->name, (result==FLEET_RESULT_DONE)? "DONE" : "FAILED",
+           (session->end_ms-session->start_ms)/1000.0, fleet_step_names[session->step]);
+}
+
+//Called with the lock held, step failed : try it again from the beginning or give up
+static void fleet_retry(fleet_session_t* session, uint32_t now)
+{
+    if(session->retries >= FLEET_MAX_RETRIES)
+    {
+        fleet_finish(session, FLEET_RESULT_FAILED);
+        return;
+    }
+    session->retries++;
+    session->phase          = FLEET_PHASE_CLEAR;
+    session->next_action_ms = now;
+}
+
+//Runs one phase of a session, without the lock. Posts wait for the rate limit of their channel by rescheduling
+static void fleet_run_phase(fleet_session_t* session)
+{
+    uint8_t  command_chars[128];
+    uint8_t  reply_chars[FLEET_REPLY_CHARS];
+    uint8_t  reply_hex[FLEET_REPLY_CHARS/2];
+    uint16_t command_len;
+    uint32_t now = GetTickCount();
+    uint32_t wait;
+    uint8_t  status;
+    int      reply_len;
+
+    switch(session->phase)
+    {
+    case FLEET_PHASE_CLEAR:
+        wait = now - session->last_response_post_ms;
+        if(session->last_response_post_ms && wait < FLEET_CHANNEL_POST_INTERVAL_MS)
+        {
+            EnterCriticalSection(&fleet_lock);
+            session->next_action_ms = now + (FLEET_CHANNEL_POST_INTERVAL_MS-wait);
+            LeaveCriticalSection(&fleet_lock);
+            return;
+        }
+        status = fleet_post(session->responses_write_key, (uint8_t*)"EMPTY", 5);
+        EnterCriticalSection(&fleet_lock);
+        if(status == STATUS_OK)
+        {
+            session->last_response_post_ms = GetTickCount();
+            session->phase = FLEET_PHASE_SEND;
+        }
+        session->next_action_ms = GetTickCount() + ((status == STATUS_OK)? 0 : FLEET_POLL_INTERVAL_MS);
+        LeaveCriticalSection(&fleet_lock);
+        break;
+
+    case FLEET_PHASE_SEND:
+        //the reply of the board is an update of the responses channel, which takes none for a while after the clear,
+        //so the command waits for both channels (the reply would be dropped by the server otherwise)
+        wait = now - session->last_response_post_ms;
+        if(session->last_command_post_ms && now - session->last_command_post_ms < wait) wait = now - session->last_command_post_ms;
+        if(wait < FLEET_CHANNEL_POST_INTERVAL_MS)
+        {
+            EnterCriticalSection(&fleet_lock);
+            session->next_action_ms = now + (FLEET_CHANNEL_POST_INTERVAL_MS-wait);
+            LeaveCriticalSection(&fleet_lock);
+            return;
+        }
+        command_len = fleet_step_command(session, command_chars);
+        status = fleet_post(session->commands_write_key, command_chars, command_len);
+        EnterCriticalSection(&fleet_lock);
+        now = GetTickCount();
+        if(status == STATUS_OK)
+        {
+            session->last_command_post_ms = now;
+            session->phase            = FLEET_PHASE_WAIT;
+            session->step_deadline_ms = now + fleet_step_timeout(session);
+            session->next_action_ms   = now + FLEET_FIRST_POLL_DELAY_MS;
+        }
+        else
+        {
+            session->next_action_ms   = now + FLEET_POLL_INTERVAL_MS;
+        }
+        LeaveCriticalSection(&fleet_lock);
+        break;
+
+    case FLEET_PHASE_WAIT:
+        memset(reply_chars, 0, sizeof(reply_chars));
+        status    = fleet_read(session, reply_chars, sizeof(reply_chars));
+        reply_len = (status == STATUS_OK)? fleet_parse_reply(reply_chars, reply_hex) : -1;
+        EnterCriticalSection(&fleet_lock);
+        now = GetTickCount();
+        if(reply_len >= 0 && fleet_step_reply_ok(session, reply_hex, reply_len))
+        {
+            session->step++;
+            session->retries = 0;
+            session->phase   = FLEET_PHASE_CLEAR;
+            session->next_action_ms = now;
+            if(session->step == FLEET_STEP_DONE) fleet_finish(session, FLEET_RESULT_DONE);
+        }
+        else if(reply_len != -1 || (int32_t)(now - session->step_deadline_ms) >= 0)
+        {
+            //NACK, bad reply or no reply in time
+            fleet_retry(session, now);
+        }
+        else
+        {
+            session->next_action_ms = now + FLEET_POLL_INTERVAL_MS;
+        }
+        LeaveCriticalSection(&fleet_lock);
+        break;
+    }
+}
+
+//Worker thread : picks the pending session whose next action is the oldest due one, runs one phase of it, repeats
+static DWORD WINAPI fleet_worker(LPVOID param)
+{
+    fleet_session_t* session;
+    uint32_t index;
+    uint32_t now;
+    uint32_t sleep_ms;
+
+    while(1)
+    {
+        session  = NULL;
+        sleep_ms = FLEET_POLL_INTERVAL_MS;
+        EnterCriticalSection(&fleet_lock);
+        if(fleet_sessions_left == 0)
+        {
+            LeaveCriticalSection(&fleet_lock);
+            break;
+        }
+        now = GetTickCount();
+        for(index=0; index<fleet_number_of_sessions; index++)
+        {
+            fleet_session_t* candidate = &fleet_sessions[index];
+            if(candidate->result != FLEET_RESULT_PENDING || candidate->busy) continue;
+            if((int32_t)(now - candidate->next_action_ms) >= 0)
+            {
+                if(session == NULL || (int32_t)(candidate->next_action_ms - session->next_action_ms) < 0) session = candidate;
+            }
+            else if(candidate->next_action_ms - now < sleep_ms)
+            {
+                sleep_ms = candidate->next_action_ms - now;
+            }
+        }
+        if(session != NULL)
+        {
+            session->busy = 1;
+            if(session->start_ms == 0) session->start_ms = now;
+        }
+        LeaveCriticalSection(&fleet_lock);
+
+        if(session == NULL)
+        {
+            Sleep(sleep_ms ? sleep_ms : 1);
+            continue;
+        }
+        fleet_run_phase(session);
+        EnterCriticalSection(&fleet_lock);
+        session->busy = 0;
+        LeaveCriticalSection(&fleet_lock);
+    }
+    return 0;
+}
+
+//Sender thread : sends the image to the boards that are in their multicast write step
+static DWORD WINAPI fleet_mcast_sender(LPVOID param)
+{
+    mcast_send_image(fleet_image, fleet_image_len, fleet_image_crc, &fleet_mcast_config, &fleet_mcast_result);
+    return 0;
+}
+
+static int fleet_compare_latency(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+//Nearest rank percentile of a sorted array
+static uint32_t fleet_percentile(uint32_t* sorted, uint32_t count, uint32_t percent)
+{
+    uint32_t rank = (percent*count+99)/100;
+    if(rank == 0) rank = 1;
+    return sorted[rank-1];
+}
+
+//Reads the device list, one board per line : name commands_write_key responses_write_key responses_channel responses_read_key
+static uint32_t fleet_read_device_list(char* path)
+{
+    FILE*    list = fopen(path, "r");
+    char     line[256];
+    uint32_t count = 0;
+    fleet_session_t* session;
+
+    if(list == NULL)
+    {
+        perror("\n   Device list not found");
+        return 0;
+    }
+    while(count < FLEET_MAX_DEVICES && fgets(line, sizeof(line), list) != NULL)
+    {
+        if(line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+        session = &fleet_sessions[count];
+        memset(session, 0, sizeof(*session));
+        if(sscanf(line, "%31s %23s %23s %15s %23s", session->name, session->commands_write_key, session->responses_write_key,
+                  session->responses_channel, session->responses_read_key) == 5)
+        {
+            count++;
+        }
+        else
+        {
+            printf("\n   Skipping invalid line : %s", line);
+        }
+    }
+    fclose(list);
+    return count;
+}
+
+//Asks for the fleet settings, runs all update sessions and prints throughput and latency percentiles
+void fleet_run(void)
+{
+    char     device_list[300];
+    char     server[64];
+    uint32_t port          = 80;
+    uint32_t workers       = 8;
+    uint32_t server_slots  = 4;
+    uint32_t multicast     = 0;
+    uint32_t manifest[IMAGE_MAX_CHUNKS];
+    uint32_t chunks;
+    HANDLE   threads[FLEET_MAX_WORKERS];
+    HANDLE   sender = NULL;
+    uint32_t latencies[FLEET_MAX_DEVICES];
+    uint32_t done = 0;
+    uint32_t index;
+    uint32_t start_ms;
+    uint32_t elapsed_ms;
+
+    printf("\n   Enter full path of the device list : ");
+    scanf(" %299s", device_list);
+    fleet_number_of_sessions = fleet_read_device_list(device_list);
+    if(fleet_number_of_sessions == 0){printf("\n   No devices!!\r\n");return;}
+
+    fleet_image_len = calc_file_len();
+    if(fleet_image_len > IMAGE_MAX_CHUNKS*IMAGE_CHUNK_SIZE){printf("\n   File is larger than the flash!!\r\n");return;}
+    fleet_image = malloc(fleet_image_len);
+    if(fleet_image == NULL){printf("\n   Not enough memory!!\r\n");return;}
+    open_the_file();
+    read_the_file(fleet_image, fleet_image_len);
+    close_the_file();
+    fleet_image_crc = get_crc_words(fleet_image, fleet_image_len);
+    //all boards fetch the same published image, so one manifest serves the whole fleet
+    chunks = build_chunk_manifest(fleet_image, fleet_image_len, manifest);
+    fleet_manifest_crc = get_crc_words((uint8_t*)manifest, chunks*4);
+    write_published_image(fleet_image, fleet_image_len, manifest, chunks);
+
+    printf("\n   Enter the app base memory address here : ");
+    scanf(" %x", &fleet_base_address);
+    printf("\n   Enter the app name here : ");
+    memset(fleet_app_name, 0, sizeof(fleet_app_name));
+    scanf(" %8s", fleet_app_name);
+    printf("\n   Enter server (api.thingspeak.com, or 127.0.0.1 for the stand-in of option 29) : ");
+    scanf(" %63s", server);
+    printf("\n   Enter server port : ");
+    scanf(" %u", &port);
+    printf("\n   Enter number of worker threads (1-%d) : ", FLEET_MAX_WORKERS);
+    scanf(" %u", &workers);
+    printf("\n   Enter maximum requests in flight toward the server : ");
+    scanf(" %u", &server_slots);
+    if(workers == 0) workers = 1;
+    if(workers > FLEET_MAX_WORKERS) workers = FLEET_MAX_WORKERS;
+    if(server_slots == 0) server_slots = 1;
+    printf("\n   Send the image by multicast (0 no, 1 yes) : ");
+    scanf(" %u", &multicast);
+    fleet_multicast = (multicast != 0);
+    if(fleet_multicast)
+    {
+        memset(&fleet_mcast_config, 0, sizeof(fleet_mcast_config));
+        printf("\n   Enter multicast group or LAN broadcast address (%s) : ", MCAST_DEFAULT_GROUP);
+        scanf(" %15s", fleet_mcast_config.group);
+        //the boards reach their write step at different times, the rate limit of the channels spreads them
+        fleet_mcast_config.devices         = fleet_number_of_sessions;
+        fleet_mcast_config.join_timeout_ms = FLEET_MCAST_JOIN_TIMEOUT_MS;
+        fleet_mcast_config.part_gap_ms     = MCAST_DEFAULT_PART_GAP_MS;
+        fleet_mcast_config.chunk_gap_ms    = MCAST_DEFAULT_CHUNK_GAP_MS;
+    }
+
+    if(HOST_u8InitFleetNetwork((u8*)server, port) != STATUS_OK){printf("\n   Server not found!!\r\n");free(fleet_image);return;}
+
+    InitializeCriticalSection(&fleet_lock);
+    fleet_server_slots  = CreateSemaphore(NULL, server_slots, server_slots, NULL);
+    fleet_sessions_left = fleet_number_of_sessions;
+
+    printf("\n   Updating %u boards with %u workers, %u requests in flight at most\n", fleet_number_of_sessions, workers, server_slots);
+    start_ms = GetTickCount();
+    if(fleet_multicast) sender = CreateThread(NULL, 0, fleet_mcast_sender, NULL, 0, NULL);
+    for(index=0; index<workers; index++) threads[index] = CreateThread(NULL, 0, fleet_worker, NULL, 0, NULL);
+    WaitForMultipleObjects(workers, threads, TRUE, INFINITE);
+    elapsed_ms = GetTickCount() - start_ms;
+    if(sender != NULL)
+    {
+        WaitForSingleObject(sender, INFINITE);
+        CloseHandle(sender);
+    }
+    free(fleet_image);
+    for(index=0; index<workers; index++) CloseHandle(threads[index]);
+    CloseHandle(fleet_server_slots);
+    DeleteCriticalSection(&fleet_lock);
+
+    for(index=0; index<fleet_number_of_sessions; index++)
+    {
+        if(fleet_sessions[index].result == FLEET_RESULT_DONE)
+            latencies[done++] = fleet_sessions[index].end_ms - fleet_sessions[index].start_ms;
+    }
+    if(fleet_multicast)
+    {
+        printf("\n\n   Multicast : %u boards joined, %u with the whole image, %u rounds, %u datagrams, %u chunks repaired, %.1f s",
+               fleet_mcast_result.joined, fleet_mcast_result.complete, fleet_mcast_result.rounds, fleet_mcast_result.datagrams,
+               fleet_mcast_result.repaired_chunks, fleet_mcast_result.elapsed_ms/1000.0);
+    }
+    printf("\n\n   Fleet : %u of %u boards updated in %.1f s", done, fleet_number_of_sessions, elapsed_ms/1000.0);
+    if(elapsed_ms) printf(" -> %.1f devices/hour", done*3600000.0/elapsed_ms);
+    if(done)
+    {
+        qsort(latencies, done, sizeof(uint32_t), fleet_compare_latency);
+        printf("\n   Per device latency : p50 %.1f s, p90 %.1f s, p99 %.1f s, max %.1f s\n",
+               fleet_percentile(latencies,done,50)/1000.0, fleet_percentile(latencies,done,90)/1000.0,
+               fleet_percentile(latencies,done,99)/1000.0, latencies[done-1]/1000.0);
+    }
+}
@@ -0,0 +1,405 @@
+/* This file implements a local stand-in of the channel server with simulated boards behind it, so the fleet mode (option 20)
+ * can be run and measured on this PC without the cloud service and without boards.
+ * It answers the two requests of the fleet APIs (HTTP/1.0, one request per connection) :
+ *   GET /update?api_key=<write key>&field1=<value>              post to a channel, the body is the entry id (0 if dropped)
+ *   GET /channels/<channel>/fields/1/last.txt?api_key=<key>     last value of a channel
+ * Like the real server, a channel takes one update every FLEET_SERVER_RATE_LIMIT_MS, a faster update is dropped.
+ * Every board of the device list is simulated the way the bootloader works : every poll period it fetches its commands channel,
+ * a new command is checked (packet CRC) and takes the time of the real one, then the reply is posted to the responses channel.
+ * A board remembers the image it was given (base address, size, CRC) so its digest is the one of what was written.
+ * BL_MEM_MULTICAST is answered with BL_MEM_WRITE_NO_LINK (no UDP link here), so the fleet falls back to BL_MEM_WRITE.
+ * This file is Windows only (threads and winsock)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <winsock2.h>
+#include "main.h"
+#include "HTTP_interface.h"
+
+#define FLEET_SERVER_MAX_BOARDS         256
+#define FLEET_SERVER_VALUE_CHARS        1000    //longest value of a channel
+#define FLEET_SERVER_REQUEST_CHARS      1400
+#define FLEET_SERVER_RATE_LIMIT_MS      15000   //one update per channel every 15 s
+#define FLEET_SERVER_TICK_MS            20
+
+//Times of the bootloader, the AT exchanges of a command fetch and of a reply take three waits of 1 s each
+#define FLEET_SERVER_FETCH_MS           3000
+#define FLEET_SERVER_REPLY_MS           3000
+#define FLEET_SERVER_ERASE_PAGE_MS      20      //page erase of the STM32F103 (datasheet typical)
+#define FLEET_SERVER_DEFAULT_POLL_MS    15000   //BL_POLL_PERIOD_MS
+#define FLEET_SERVER_DEFAULT_PAGE_MS    3200    //fetch of one 1 KB window (three waits of 1 s and 2 KB of chars at 115200 baud)
+
+typedef struct
+{
+    char     name[32];
+    char     commands_write_key[24];
+    char     responses_write_key[24];
+    char     responses_channel[16];
+    char     responses_read_key[24];
+
+    char     command[FLEET_SERVER_VALUE_CHARS+1];
+    char     response[FLEET_SERVER_VALUE_CHARS+1];
+    char     reply[64];                 //reply of the command being run
+    uint32_t command_entry;             //entry id of the last update of the commands channel
+    uint32_t response_entry;
+    uint32_t handled_entry;             //entry id of the last command run
+    uint32_t last_command_post_ms;
+    uint32_t last_response_post_ms;
+    uint32_t next_poll_ms;
+    uint32_t reply_ms;                  //the reply is posted at this time
+    uint8_t  running;                   //a command is being run
+    uint32_t image_base;
+    uint32_t image_len;
+    uint32_t image_crc;
+} fleet_server_board_t;
+
+static fleet_server_board_t fleet_server_boards[FLEET_SERVER_MAX_BOARDS];
+static uint32_t         fleet_server_number_of_boards;
+static CRITICAL_SECTION fleet_server_lock;
+static SOCKET           fleet_server_socket = INVALID_SOCKET;
+static HANDLE           fleet_server_threads[2];
+static volatile uint8_t fleet_server_running;
+static uint32_t         fleet_server_poll_ms;
+static uint32_t         fleet_server_page_ms;
+
+//Counters printed when the stand-in is stopped
+static uint32_t fleet_server_requests;
+static uint32_t fleet_server_dropped_updates;
+static uint32_t fleet_server_dropped_replies;
+static uint32_t fleet_server_commands;
+static uint32_t fleet_server_nacks;
+
+
+//Reads the device list, same format as the one of the fleet mode
+static uint32_t fleet_server_read_device_list(char* path)
+{
+    FILE*    list = fopen(path, "r");
+    char     line[256];
+    uint32_t count = 0;
+    fleet_server_board_t* board;
+
+    if(list == NULL)
+    {
+        perror("\n   Device list not found");
+        return 0;
+    }
+    while(count < FLEET_SERVER_MAX_BOARDS && fgets(line, sizeof(line), list) != NULL)
+    {
+        if(line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+        board = &fleet_server_boards[count];
+        memset(board, 0, sizeof(*board));
+        if(sscanf(line, "%31s %23s %23s %15s %23s", board->name, board->commands_write_key, board->responses_write_key,
+                  board->responses_channel, board->responses_read_key) == 5)
+        {
+            strcpy(board->command,  "EMPTY");
+            strcpy(board->response, "EMPTY");
+            count++;
+        }
+    }
+    fclose(list);
+    return count;
+}
+
+//Builds the chars of a reply : ack, length to follow and the bytes
+static void fleet_server_reply(fleet_server_board_t* board, uint8_t* bytes, uint8_t len)
+{
+    uint8_t packet[32];
+
+    packet[0] = 0xA5;
+    packet[1] = len;
+    memcpy(&packet[2], bytes, len);
+    hex2char(packet, (uint8_t*)board->reply, len+2);
+    board->reply[(len+2)*2] = '\0';
+}
+
+//Called with the lock held : checks the command of a board like the bootloader does, returns the time it takes to run it
+static uint32_t fleet_server_run_command(fleet_server_board_t* board)
+{
+    uint8_t  packet[FLEET_SERVER_VALUE_CHARS/2];
+    uint8_t  bytes[12];
+    uint32_t chars = strlen(board->command);
+    uint32_t len;
+    uint32_t crc;
+    uint32_t base;
+    uint32_t size;
+
+    if(chars < 4 || char2hex((uint8_t*)board->command, packet, 2) < 0) return 0;
+    len = packet[0]+1;
+    //the name of BL_SAVE_APP_INFO is plain chars between the hex chars, one char a byte
+    if(len < 6 || chars < ((packet[1] == COMMAND_BL_SAVE_APP_INFO)? len*2-8 : len*2)) return 0;
+    fleet_server_commands++;
+    if(packet[1] == COMMAND_BL_SAVE_APP_INFO && len == COMMAND_BL_SAVE_APP_INFO_LEN)
+    {
+        if(char2hex((uint8_t*)board->command, packet, 10) < 0 || char2hex((uint8_t*)&board->command[28], &packet[18], 4) < 0) len = 0;
+        memcpy(&packet[10], &board->command[20], 8);
+    }
+    else if(char2hex((uint8_t*)board->command, packet, len) < 0)
+    {
+        len = 0;
+    }
+    if(len != 0) memcpy(&crc, &packet[len-4], 4);
+    if(len == 0 || get_crc(packet, len-4) != crc)
+    {
+        fleet_server_nacks++;
+        strcpy(board->reply, "7F");
+        return 0;
+    }
+
+    switch(packet[1])
+    {
+    case COMMAND_BL_GET_VER:
+        bytes[0] = 0x10;
+        fleet_server_reply(board, bytes, 1);
+        return 0;
+    case COMMAND_BL_FLASH_ERASE:
+        bytes[0] = 1;                   //ErrorStatus, OK is 1
+        fleet_server_reply(board, bytes, 1);
+        return packet[6]*FLEET_SERVER_ERASE_PAGE_MS;
+    case COMMAND_BL_MEM_WRITE:
+        memcpy(&board->image_base, &packet[2],  4);
+        memcpy(&board->image_len,  &packet[6],  4);
+        memcpy(&board->image_crc,  &packet[10], 4);
+        bytes[0] = BL_MEM_WRITE_OK;
+        fleet_server_reply(board, bytes, 1);
+        return ((board->image_len+1023)/1024)*fleet_server_page_ms;
+    case COMMAND_BL_MEM_MULTICAST:
+        bytes[0] = BL_MEM_WRITE_NO_LINK;
+        fleet_server_reply(board, bytes, 1);
+        return 0;
+    case COMMAND_BL_GET_DIGEST:
+        memcpy(&base, &packet[2], 4);
+        memcpy(&size, &packet[6], 4);
+        //status, algorithm, time of the digest in us, CRC (of what was written, the erased value otherwise)
+        memset(bytes, 0, sizeof(bytes));
+        bytes[1] = BL_DIGEST_CRC32;
+        crc = (base == board->image_base && size == board->image_len)? board->image_crc : 0xFFFFFFFF;
+        memcpy(&bytes[6], &crc, 4);
+        fleet_server_reply(board, bytes, 6+BL_DIGEST_CRC32_LEN);
+        return 0;
+    case COMMAND_BL_SAVE_APP_INFO:
+    case COMMAND_BL_GO_TO_ADDR:
+        bytes[0] = 0;
+        fleet_server_reply(board, bytes, 1);
+        return 0;
+    }
+    fleet_server_nacks++;
+    strcpy(board->reply, "7F");
+    return 0;
+}
+
+//Board thread : runs the simulated boards, every board polls its commands channel and posts the reply of a new command
+static DWORD WINAPI fleet_server_boards_thread(LPVOID param)
+{
+    fleet_server_board_t* board;
+    uint32_t index;
+    uint32_t now;
+
+    while(fleet_server_running)
+    {
+        EnterCriticalSection(&fleet_server_lock);
+        now = GetTickCount();
+        for(index=0; index<fleet_server_number_of_boards; index++)
+        {
+            board = &fleet_server_boards[index];
+            if(board->running && (int32_t)(now - board->reply_ms) >= 0)
+            {
+                //the bootloader posts its reply once, a reply too close to the last update of the channel is lost
+                if(board->last_response_post_ms && now - board->last_response_post_ms < FLEET_SERVER_RATE_LIMIT_MS)
+                {
+                    fleet_server_dropped_replies++;
+                }
+                else
+                {
+                    strcpy(board->response, board->reply);
+                    board->response_entry++;
+                    board->last_response_post_ms = now;
+                }
+                board->running      = 0;
+                board->next_poll_ms = now + fleet_server_poll_ms;
+            }
+            else if(!board->running && (int32_t)(now - board->next_poll_ms) >= 0)
+            {
+                //the fetch takes FLEET_SERVER_FETCH_MS, the value read is the one of now
+                if(board->command_entry != board->handled_entry)
+                {
+                    board->handled_entry = board->command_entry;
+                    board->reply[0]      = '\0';
+                    board->reply_ms      = now + FLEET_SERVER_FETCH_MS + fleet_server_run_command(board) + FLEET_SERVER_REPLY_MS;
+                    board->running       = (board->reply[0] != '\0');
+                }
+                if(!board->running) board->next_poll_ms = now + FLEET_SERVER_FETCH_MS + fleet_server_poll_ms;
+            }
+        }
+        LeaveCriticalSection(&fleet_server_lock);
+        Sleep(FLEET_SERVER_TICK_MS);
+    }
+    return 0;
+}
+
+//Called with the lock held : handles the path of one request, fills the body, returns 0 if nothing matches it
+static uint8_t fleet_server_handle(char* path, char* body)
+{
+    fleet_server_board_t* board;
+    char     key[24];
+    char     channel[16];
+    char*    value;
+    uint32_t index;
+    uint32_t now = GetTickCount();
+    uint32_t length;
+
+    if(sscanf(path, "/update?api_key=%23[^&]&field1=", key) == 1 && (value = strstr(path, "&field1=")) != NULL)
+    {
+        value += 8;
+        length = strcspn(value, " \r\n");
+        if(length > FLEET_SERVER_VALUE_CHARS) return 0;
+        for(index=0; index<fleet_server_number_of_boards; index++)
+        {
+            board = &fleet_server_boards[index];
+            if(strcmp(key, board->commands_write_key) == 0)
+            {
+                if(board->last_command_post_ms && now - board->last_command_post_ms < FLEET_SERVER_RATE_LIMIT_MS) break;
+                memcpy(board->command, value, length);
+                board->command[length] = '\0';
+                board->last_command_post_ms = now;
+                sprintf(body, "%u", ++board->command_entry);
+                return 1;
+            }
+            if(strcmp(key, board->responses_write_key) == 0)
+            {
+                if(board->last_response_post_ms && now - board->last_response_post_ms < FLEET_SERVER_RATE_LIMIT_MS) break;
+                memcpy(board->response, value, length);
+                board->response[length] = '\0';
+                board->last_response_post_ms = now;
+                sprintf(body, "%u", ++board->response_entry);
+                return 1;
+            }
+        }
+        if(index == fleet_server_number_of_boards) return 0;
+        fleet_server_dropped_updates++;
+        strcpy(body, "0");
+        return 1;
+    }
+    if(sscanf(path, "/channels/%15[^/]/fields/1/last.txt?api_key=%23[^ \r\n]", channel, key) == 2)
+    {
+        for(index=0; index<fleet_server_number_of_boards; index++)
+        {
+            board = &fleet_server_boards[index];
+            if(strcmp(channel, board->responses_channel) == 0 && strcmp(key, board->responses_read_key) == 0)
+            {
+                strcpy(body, board->response);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+//Server thread : answers the requests one connection at a time
+static DWORD WINAPI fleet_server_thread(LPVOID param)
+{
+    SOCKET   client;
+    char     request[FLEET_SERVER_REQUEST_CHARS+1];
+    char     body[FLEET_SERVER_VALUE_CHARS+1];
+    char     reply[FLEET_SERVER_VALUE_CHARS+100];
+    int      received;
+    int      total;
+    uint8_t  found;
+
+    while(fleet_server_running)
+    {
+        client = accept(fleet_server_socket, NULL, NULL);
+        if(client == INVALID_SOCKET) continue;
+        total = 0;
+        request[0] = '\0';
+        while(total < FLEET_SERVER_REQUEST_CHARS && strstr(request, "\r\n\r\n") == NULL &&
+              (received = recv(client, &request[total], FLEET_SERVER_REQUEST_CHARS-total, 0)) > 0)
+        {
+            total += received;
+            request[total] = '\0';
+        }
+        found = 0;
+        EnterCriticalSection(&fleet_server_lock);
+        fleet_server_requests++;
+        if(strncmp(request, "GET ", 4) == 0) found = fleet_server_handle(&request[4], body);
+        LeaveCriticalSection(&fleet_server_lock);
+        if(found) sprintf(reply, "HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\n\r\n%s", body);
+        else      strcpy(reply, "HTTP/1.0 404 Not Found\r\n\r\n");
+        send(client, reply, strlen(reply), 0);
+        closesocket(client);
+    }
+    return 0;
+}
+
+//Stops the stand-in and prints its counters
+static void fleet_server_stop(void)
+{
+    fleet_server_running = 0;
+    //accept is left by closing the listening socket
+    closesocket(fleet_server_socket);
+    fleet_server_socket = INVALID_SOCKET;
+    WaitForMultipleObjects(2, fleet_server_threads, TRUE, INFINITE);
+    CloseHandle(fleet_server_threads[0]);
+    CloseHandle(fleet_server_threads[1]);
+    DeleteCriticalSection(&fleet_server_lock);
+    printf("\n   Stand-in stopped : %u requests, %u commands run (%u NACKs), %u updates and %u replies dropped by the rate limit\n",
+           fleet_server_requests, fleet_server_commands, fleet_server_nacks, fleet_server_dropped_updates, fleet_server_dropped_replies);
+}
+
+//Starts the stand-in in the background (the menu stays usable, run the fleet against 127.0.0.1), or stops it if it runs
+void fleet_server_run(void)
+{
+    char     device_list[300];
+    uint32_t port = 8080;
+    uint32_t index;
+    uint32_t now;
+    struct sockaddr_in address;
+    WSADATA  wsa_data;
+
+    if(fleet_server_running)
+    {
+        fleet_server_stop();
+        return;
+    }
+    printf("\n   Enter full path of the device list : ");
+    scanf(" %299s", device_list);
+    fleet_server_number_of_boards = fleet_server_read_device_list(device_list);
+    if(fleet_server_number_of_boards == 0){printf("\n   No devices!!\r\n");return;}
+    printf("\n   Enter port to listen on : ");
+    scanf(" %u", &port);
+    fleet_server_poll_ms = FLEET_SERVER_DEFAULT_POLL_MS;
+    printf("\n   Enter poll period of the boards in ms (%u for the bootloader) : ", FLEET_SERVER_DEFAULT_POLL_MS);
+    scanf(" %u", &fleet_server_poll_ms);
+    fleet_server_page_ms = FLEET_SERVER_DEFAULT_PAGE_MS;
+    printf("\n   Enter download time of one 1 KB page in ms (%u for the bootloader over HTTP) : ", FLEET_SERVER_DEFAULT_PAGE_MS);
+    scanf(" %u", &fleet_server_page_ms);
+
+    if(WSAStartup(MAKEWORD(2,2), &wsa_data) != 0){printf("\n   Winsock failed!!\r\n");return;}
+    fleet_server_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port        = htons(port);
+    if(fleet_server_socket == INVALID_SOCKET || bind(fleet_server_socket, (struct sockaddr*)&address, sizeof(address)) == SOCKET_ERROR ||
+       listen(fleet_server_socket, SOMAXCONN) == SOCKET_ERROR)
+    {
+        printf("\n   Port %u is not free!!\r\n", port);
+        if(fleet_server_socket != INVALID_SOCKET) closesocket(fleet_server_socket);
+        fleet_server_socket = INVALID_SOCKET;
+        return;
+    }
+
+    //the boards were started at different times, their polls are spread over one period
+    now = GetTickCount();
+    for(index=0; index<fleet_server_number_of_boards; index++)
+        fleet_server_boards[index].next_poll_ms = now + (uint32_t)(((uint64_t)index*fleet_server_poll_ms)/fleet_server_number_of_boards);
+    fleet_server_requests = fleet_server_commands = fleet_server_nacks = 0;
+    fleet_server_dropped_updates = fleet_server_dropped_replies = 0;
+
+    InitializeCriticalSection(&fleet_server_lock);
+    fleet_server_running    = 1;
+    fleet_server_threads[0] = CreateThread(NULL, 0, fleet_server_thread, NULL, 0, NULL);
+    fleet_server_threads[1] = CreateThread(NULL, 0, fleet_server_boards_thread, NULL, 0, NULL);
+    printf("\n   Stand-in of the server for %u boards on 127.0.0.1:%u, run the fleet update (20) against it,"
+           "\n   choose this option again to stop it\n", fleet_server_number_of_boards, port);
+}
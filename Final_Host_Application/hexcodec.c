@@ -0,0 +1,309 @@
+/* This file implements the hex codec used for every packet and image exchanged with the bootloader
+ * every byte travels as two chars, encoded with lower case letters and decoded from either case
+ * Tables do the scalar work, SSE2 (and AVX2 when the CPU has it) convert 16/32 bytes per step
+ * This file is common across win/linux/mac (x86 for the vector paths)
+ */
+
+#include "main.h"
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define HEX_X86
+#include <immintrin.h>
+#include <x86intrin.h>
+#endif
+
+#define HEX_INVALID 0xFF
+
+//Nibble value of every char, HEX_INVALID for chars that are not hex digits (filled on first use)
+static uint8_t hex_decode_table[256];
+static const uint8_t hex_encode_table[16] = {'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
+static int hex_tables_ready = 0;
+static int hex_has_avx2 = -1;
+
+static void hex_init(void)
+{
+    int c;
+
+    memset(hex_decode_table, HEX_INVALID, sizeof(hex_decode_table));
+    for(c='0'; c<='9'; c++) hex_decode_table[c] = c-'0';
+    for(c='a'; c<='f'; c++) hex_decode_table[c] = c-'a'+10;
+    for(c='A'; c<='F'; c++) hex_decode_table[c] = c-'A'+10;
+#ifdef HEX_X86
+    __builtin_cpu_init();
+    hex_has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+    hex_has_avx2 = 0;
+#endif
+    hex_tables_ready = 1;
+}
+
+//Scalar paths : one table lookup per char, a valid nibble never sets the upper 4 bits so errors are checked once at the end
+static int hex_decode_scalar(const uint8_t* in, uint8_t* out, uint32_t count)
+{
+    uint8_t check = 0;
+    uint8_t hi, lo;
+    uint32_t index;
+
+    for(index=0; index<count; index++)
+    {
+        hi = hex_decode_table[in[index*2]];
+        lo = hex_decode_table[in[index*2+1]];
+        check |= hi | lo;
+        out[index] = (uint8_t)((hi<<4) | lo);
+    }
+    return (check & 0xF0) ? -1 : 0;
+}
+
+static void hex_encode_scalar(const uint8_t* in, uint8_t* out, uint32_t count)
+{
+    uint32_t index;
+
+    for(index=0; index<count; index++)
+    {
+        out[index*2]   = hex_encode_table[in[index] >> 4];
+        out[index*2+1] = hex_encode_table[in[index] & 0x0F];
+    }
+}
+
+#ifdef HEX_X86
+/*SSE2 : 32 chars -> 16 bytes per step
+ * c-'0' below 10 is a digit, (c|0x20)-'a' below 6 is a letter (unsigned compares done with min), anything else is invalid*/
+static __attribute__((target("sse2"))) __m128i hex_sse2_nibbles(__m128i chars, __m128i* valid)
+{
+    __m128i digit_value  = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i letter_value = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i digit        = _mm_cmpeq_epi8(_mm_min_epu8(digit_value,  _mm_set1_epi8(9)), digit_value);
+    __m128i letter       = _mm_cmpeq_epi8(_mm_min_epu8(letter_value, _mm_set1_epi8(5)), letter_value);
+
+    *valid = _mm_and_si128(*valid, _mm_or_si128(digit, letter));
+    return _mm_or_si128(_mm_and_si128(digit, digit_value), _mm_and_si128(letter, _mm_add_epi8(letter_value, _mm_set1_epi8(10))));
+}
+
+//Pairs of nibbles (n0 in the low byte of every 16-bit lane) -> (n0<<4)|n1 in the low byte
+static __attribute__((target("sse2"))) __m128i hex_sse2_pairs(__m128i nibbles)
+{
+    return _mm_and_si128(_mm_or_si128(_mm_slli_epi16(nibbles, 4), _mm_srli_epi16(nibbles, 8)), _mm_set1_epi16(0x00FF));
+}
+
+static __attribute__((target("sse2"))) int hex_decode_sse2(const uint8_t* in, uint8_t* out, uint32_t count)
+{
+    __m128i valid = _mm_set1_epi8(-1);
+    __m128i low, high;
+    uint32_t index;
+
+    for(index=0; index+16<=count; index+=16)
+    {
+        low  = hex_sse2_pairs(hex_sse2_nibbles(_mm_loadu_si128((const __m128i*)&in[index*2]),    &valid));
+        high = hex_sse2_pairs(hex_sse2_nibbles(_mm_loadu_si128((const __m128i*)&in[index*2+16]), &valid));
+        _mm_storeu_si128((__m128i*)&out[index], _mm_packus_epi16(low, high));
+    }
+    if(_mm_movemask_epi8(valid) != 0xFFFF) return -1;
+    return hex_decode_scalar(&in[index*2], &out[index], count-index);
+}
+
+//nibble -> '0'..'9' or 'a'..'f'
+static __attribute__((target("sse2"))) __m128i hex_sse2_chars(__m128i nibbles)
+{
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a'-'0'-10));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letter);
+}
+
+static __attribute__((target("sse2"))) void hex_encode_sse2(const uint8_t* in, uint8_t* out, uint32_t count)
+{
+    __m128i bytes, hi, lo;
+    uint32_t index;
+
+    for(index=0; index+16<=count; index+=16)
+    {
+        bytes = _mm_loadu_si128((const __m128i*)&in[index]);
+        hi    = hex_sse2_chars(_mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F)));
+        lo    = hex_sse2_chars(_mm_and_si128(bytes, _mm_set1_epi8(0x0F)));
+        _mm_storeu_si128((__m128i*)&out[index*2],    _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i*)&out[index*2+16], _mm_unpackhi_epi8(hi, lo));
+    }
+    hex_encode_scalar(&in[index], &out[index*2], count-index);
+}
+
+/*AVX2 : same steps on 32 bytes, pack and unpack work inside 128-bit lanes so the lanes are put back in order*/
+static __attribute__((target("avx2"))) __m256i hex_avx2_nibbles(__m256i chars, __m256i* valid)
+{
+    __m256i digit_value  = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    __m256i letter_value = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i digit        = _mm256_cmpeq_epi8(_mm256_min_epu8(digit_value,  _mm256_set1_epi8(9)), digit_value);
+    __m256i letter       = _mm256_cmpeq_epi8(_mm256_min_epu8(letter_value, _mm256_set1_epi8(5)), letter_value);
+
+    *valid = _mm256_and_si256(*valid, _mm256_or_si256(digit, letter));
+    return _mm256_or_si256(_mm256_and_si256(digit, digit_value), _mm256_and_si256(letter, _mm256_add_epi8(letter_value, _mm256_set1_epi8(10))));
+}
+
+static __attribute__((target("avx2"))) __m256i hex_avx2_pairs(__m256i nibbles)
+{
+    return _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi16(nibbles, 4), _mm256_srli_epi16(nibbles, 8)), _mm256_set1_epi16(0x00FF));
+}
+
+static __attribute__((target("avx2"))) int hex_decode_avx2(const uint8_t* in, uint8_t* out, uint32_t count)
+{
+    __m256i valid = _mm256_set1_epi8(-1);
+    __m256i low, high;
+    uint32_t index;
+
+    for(index=0; index+32<=count; index+=32)
+    {
+        low  = hex_avx2_pairs(hex_avx2_nibbles(_mm256_loadu_si256((const __m256i*)&in[index*2]),    &valid));
+        high = hex_avx2_pairs(hex_avx2_nibbles(_mm256_loadu_si256((const __m256i*)&in[index*2+32]), &valid));
+        _mm256_storeu_si256((__m256i*)&out[index], _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8));
+    }
+    if(_mm256_movemask_epi8(valid) != -1) return -1;
+    return hex_decode_sse2(&in[index*2], &out[index], count-index);
+}
+
+static __attribute__((target("avx2"))) void hex_encode_avx2(const uint8_t* in, uint8_t* out, uint32_t count)
+{
+    __m256i bytes, hi, lo, first, second;
+    uint32_t index;
+
+    for(index=0; index+32<=count; index+=32)
+    {
+        bytes  = _mm256_loadu_si256((const __m256i*)&in[index]);
+        hi     = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+        lo     = _mm256_and_si256(bytes, _mm256_set1_epi8(0x0F));
+        hi     = _mm256_add_epi8(_mm256_add_epi8(hi, _mm256_set1_epi8('0')), _mm256_and_si256(_mm256_cmpgt_epi8(hi, _mm256_set1_epi8(9)), _mm256_set1_epi8('a'-'0'-10)));
+        lo     = _mm256_add_epi8(_mm256_add_epi8(lo, _mm256_set1_epi8('0')), _mm256_and_si256(_mm256_cmpgt_epi8(lo, _mm256_set1_epi8(9)), _mm256_set1_epi8('a'-'0'-10)));
+        first  = _mm256_unpacklo_epi8(hi, lo);
+        second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i*)&out[index*2],    _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i*)&out[index*2+32], _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    hex_encode_sse2(&in[index], &out[index*2], count-index);
+}
+#endif
+
+/* convert (inBuffer) which has (char) elements of double the size of the (outBuffer)
+ * merging every two bytes of the (inBuffer) into one byte of (outBuffer)
+ * This is done as we had to receive every byte(Hex) as two bytes in their (ASCII) representation
+ * for example : (inBuffer) has 1024 bytes
+ * 				 (outBuffer) has 512 bytes
+ * 				 so we are going to iterate for 512 times
+ * returns 0, or -1 when (inBuffer) holds a char that is not a hex digit (outBuffer is then not to be trusted)*/
+int char2hex(uint8_t* inBuffer, uint8_t* outBuffer, uint16_t NumOfBytesToBeConverted)
+{
+    if(!hex_tables_ready) hex_init();
+#ifdef HEX_X86
+    if(hex_has_avx2) return hex_decode_avx2(inBuffer, outBuffer, NumOfBytesToBeConverted);
+    return hex_decode_sse2(inBuffer, outBuffer, NumOfBytesToBeConverted);
+#else
+    return hex_decode_scalar(inBuffer, outBuffer, NumOfBytesToBeConverted);
+#endif
+}
+
+//Splits every byte of (inBuffer) into two chars in (outBuffer), lower case letters
+void hex2char(uint8_t* inBuffer, uint8_t* outBuffer, uint16_t NumOfBytesToBeConverted)
+{
+    if(!hex_tables_ready) hex_init();
+#ifdef HEX_X86
+    if(hex_has_avx2) { hex_encode_avx2(inBuffer, outBuffer, NumOfBytesToBeConverted); return; }
+    hex_encode_sse2(inBuffer, outBuffer, NumOfBytesToBeConverted);
+#else
+    hex_encode_scalar(inBuffer, outBuffer, NumOfBytesToBeConverted);
+#endif
+}
+
+//Per-nibble conversions the host used before the tables, kept only to compare against them
+static void hex_reference_char2hex(uint8_t* inBuffer, uint8_t* outBuffer, uint32_t NumOfBytesToBeConverted)
+{
+    uint32_t index;
+    uint8_t  high, low;
+
+    for(index=0;index<NumOfBytesToBeConverted;index++)
+    {
+        high = inBuffer[index*2];
+        low  = inBuffer[index*2+1];
+        if(high > 0x60) high += 9;
+        if(low  > 0x60) low  += 9;
+        outBuffer[index] = (uint8_t)((high<<4) | (low&0x0F));
+    }
+}
+
+static void hex_reference_hex2char(uint8_t* inBuffer, uint8_t* outBuffer, uint32_t NumOfBytesToBeConverted)
+{
+    uint32_t index;
+    uint8_t  nibble;
+
+    for(index=0;index<NumOfBytesToBeConverted*2;index++)
+    {
+        nibble = (index&1) ? (inBuffer[index/2]&0x0F) : (inBuffer[index/2]>>4);
+        if(nibble <= 0x9) outBuffer[index] = nibble|0x30;
+        else              outBuffer[index] = (nibble|0x60)-9;
+    }
+}
+
+#define HEX_BENCH_BYTES     65536
+#define HEX_BENCH_ROUNDS    200
+
+#ifdef HEX_X86
+#define HEX_BENCH(result, call) \
+    do { uint64_t start_tsc = __rdtsc(); int round_; \
+         for(round_=0; round_<HEX_BENCH_ROUNDS; round_++) { call; } \
+         result = (double)(__rdtsc()-start_tsc)/((double)HEX_BENCH_BYTES*HEX_BENCH_ROUNDS); } while(0)
+#else
+#define HEX_BENCH(result, call) \
+    do { clock_t start_clk = clock(); int round_; \
+         for(round_=0; round_<HEX_BENCH_ROUNDS; round_++) { call; } \
+         result = (double)(clock()-start_clk)*1e9/CLOCKS_PER_SEC/((double)HEX_BENCH_BYTES*HEX_BENCH_ROUNDS); } while(0)
+#endif
+
+//Prints cycles (TSC ticks) per byte of every path of the codec, on random bytes
+void hex_codec_benchmark(void)
+{
+    uint8_t* bytes = malloc(HEX_BENCH_BYTES);
+    uint8_t* chars = malloc(HEX_BENCH_BYTES*2);
+    uint8_t* check = malloc(HEX_BENCH_BYTES);
+    double   encode[4] = {0}, decode[4] = {0};
+    uint32_t index;
+    int      status = 0;
+
+    if(bytes == NULL || chars == NULL || check == NULL)
+    {
+        printf("\n   Not enough memory!!\r\n");
+        free(bytes); free(chars); free(check);
+        return;
+    }
+    if(!hex_tables_ready) hex_init();
+    for(index=0; index<HEX_BENCH_BYTES; index++) bytes[index] = (uint8_t)rand();
+
+    HEX_BENCH(encode[0], hex_reference_hex2char(bytes, chars, HEX_BENCH_BYTES));
+    HEX_BENCH(decode[0], hex_reference_char2hex(chars, check, HEX_BENCH_BYTES));
+    HEX_BENCH(encode[1], hex_encode_scalar(bytes, chars, HEX_BENCH_BYTES));
+    HEX_BENCH(decode[1], status |= hex_decode_scalar(chars, check, HEX_BENCH_BYTES));
+#ifdef HEX_X86
+    HEX_BENCH(encode[2], hex_encode_sse2(bytes, chars, HEX_BENCH_BYTES));
+    HEX_BENCH(decode[2], status |= hex_decode_sse2(chars, check, HEX_BENCH_BYTES));
+    if(hex_has_avx2)
+    {
+        HEX_BENCH(encode[3], hex_encode_avx2(bytes, chars, HEX_BENCH_BYTES));
+        HEX_BENCH(decode[3], status |= hex_decode_avx2(chars, check, HEX_BENCH_BYTES));
+    }
+#endif
+
+    printf("\n   Hex codec, %u bytes x %u rounds (%s per byte)\n", HEX_BENCH_BYTES, HEX_BENCH_ROUNDS,
+#ifdef HEX_X86
+           "TSC ticks");
+#else
+           "ns");
+#endif
+    printf("\n   %-22s %10s %10s", "path", "encode", "decode");
+    printf("\n   %-22s %10.2f %10.2f", "per nibble (old)", encode[0], decode[0]);
+    printf("\n   %-22s %10.2f %10.2f", "tables", encode[1], decode[1]);
+#ifdef HEX_X86
+    printf("\n   %-22s %10.2f %10.2f", "SSE2", encode[2], decode[2]);
+    if(hex_has_avx2) printf("\n   %-22s %10.2f %10.2f", "AVX2", encode[3], decode[3]);
+    else             printf("\n   %-22s %10s %10s", "AVX2", "n/a", "n/a");
+#endif
+    printf("\n   Round trip : %s\n", (status == 0 && memcmp(bytes, check, HEX_BENCH_BYTES) == 0) ? "ok" : "MISMATCH");
+
+    free(bytes);
+    free(chars);
+    free(check);
+}
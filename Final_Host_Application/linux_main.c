@@ -0,0 +1,66 @@
+/* This file implements the entry point of the host application on Linux : the serial path of the wired bootloader
+ * (windowed and lockstep writes, a stand-in of the wired bootloader to run them against) and the benchmarks.
+ * The WIFI transports (server channels, push server, fleet, multicast) stay Windows only.
+ * Built by the Linux target of Final_Host_Application.cbp, or by hand :
+ *   gcc -O2 -std=c99 -o STM32_Programmer_V1 linux_main.c LinuxSerialPort.c windowed_write.c wired_server.c fileops.c utilities.c hexcodec.c -lpthread
+ * The port is /dev/ttyUSB0 at 115200 baud unless BL_SERIAL_PORT and BL_SERIAL_BAUD say otherwise
+ */
+
+#include "main.h"
+#include "LinuxSerialPort.h"
+
+int main()
+{
+    uint32_t command_code;
+
+    printf("\n\n |==========================================|");
+    printf("\n |    STM32F103C8T6 BootLoader v1 (Linux)   |");
+    printf("\n |==========================================|\n");
+
+    while(1)
+    {
+        printf("\n\n +==========================================+");
+        printf("\n |                   Menu                   |");
+        printf("\n +==========================================+\n");
+        printf("\n\n   Which command do you want to run ??\n");
+
+        printf("\n   Windowed Serial Write          --> 21");
+        printf("\n   Hex Codec Benchmark            --> 22");
+        printf("\n   Serial Loopback Benchmark      --> 28");
+        printf("\n   Lockstep Serial Write          --> 30");
+        printf("\n   Wired Bootloader Stand-in      --> 31");
+        printf("\n------------------------------------------");
+        printf("\n   MENU_EXIT                      --> 0");
+
+        printf("\n\n   Type the command code here : ");
+        if(scanf(" %u",&command_code) != 1 || command_code == 0) break;
+
+        switch(command_code)
+        {
+        case 21:
+            printf("\n   Command == > BL_MEM_WRITE_WINDOWED\n");
+            windowed_write_run();
+            break;
+        case 22:
+            printf("\n   Command == > Hex Codec Benchmark\n");
+            hex_codec_benchmark();
+            break;
+        case 28:
+            printf("\n   Command == > Serial Loopback Benchmark\n");
+            serial_loopback_benchmark();
+            break;
+        case 30:
+            printf("\n   Command == > BL_MEM_WRITE (lockstep)\n");
+            lockstep_write_run();
+            break;
+        case 31:
+            printf("\n   Command == > Wired Bootloader Stand-in\n");
+            wired_server_run();
+            break;
+        default:
+            printf("\n\n  Please input valid command code\n");
+            break;
+        }
+    }
+    return 0;
+}
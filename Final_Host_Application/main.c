@@ -10,10 +10,54 @@ int main()
     printf("\n |           STM32F103C8T6 BootLoader v1    |");
     printf("\n |==========================================|\n");
             //Serial_Port_Configuration();
-    printf("   INITIALIZING SERVER, Please Wait");
-    HOST_voidSendCommand("EMPTY",5);
-    HOST_voidSendCommandToResponses("EMPTY",5);
-    delay(15000);
+    /*With the push transport the bootloader connects to this application, in LAN direct mode this application connects to
+      the bootloader, the channels are not used for commands in both*/
+    uint32_t transport;
+    uint32_t port;
+    uint32_t simulated = 0;
+    uint8_t  address[16] = "127.0.0.1";
+    printf("\n   Commands over : 0 the channels, 1 the push server, 2 LAN direct : ");
+    scanf(" %d",&transport);
+    /*The stand-in of the bootloader (push_board.c) lets the push transport and LAN direct be tried without a board*/
+    if(transport == 1 || transport == 2)
+    {
+        printf("   Bootloader simulated on this PC (0 no, 1 yes) : ");
+        scanf(" %d",&simulated);
+    }
+    if(transport == 1)
+    {
+        printf("   Push server port (%d) : ",HTTP_PUSH_DEFAULT_PORT);
+        scanf(" %d",&port);
+        if(simulated) push_board_start(0,(uint16_t)port);
+        printf("   Waiting for the bootloader to connect\n");
+        if(HOST_u8StartPushServer((u16)port,HTTP_PUSH_CONNECT_TIMEOUT_MS) != STATUS_OK)
+        {
+            printf("   Bootloader did not connect, the channels are polled\n");
+        }
+    }
+    else if(transport == 2)
+    {
+        if(!simulated)
+        {
+            printf("   Bootloader IP address : ");
+            scanf(" %15s",address);
+        }
+        printf("   Bootloader port (%d) : ",HTTP_LAN_DEFAULT_PORT);
+        scanf(" %d",&port);
+        if(simulated) push_board_start(1,(uint16_t)port);
+        printf("   Connecting to the bootloader\n");
+        if(HOST_u8ConnectToBootloader(address,(u16)port,HTTP_PUSH_CONNECT_TIMEOUT_MS) != STATUS_OK)
+        {
+            printf("   Bootloader could not be reached, the channels are polled\n");
+        }
+    }
+    if(!HOST_u8PushIsActive())
+    {
+        printf("   INITIALIZING SERVER, Please Wait");
+        HOST_voidSendCommand("EMPTY",5);
+        HOST_voidSendCommandToResponses("EMPTY",5);
+        delay(15000);
+    }
     printf("   INITIALIZATION Complete");
     printf("\n +==========================================+\n");
 
@@ -51,6 +95,19 @@ int main()
         printf("\n   System Reset                   --> 15");
 		printf("\n   Existing Apps Details          --> 16");
 		printf("\n   Save App information           --> 17");
+		printf("\n   Verify App Digest              --> 18");
+		printf("\n   Interrupted Download Progress  --> 19");
+		printf("\n   Fleet Update                   --> 20");
+		printf("\n   Windowed Serial Write          --> 21");
+		printf("\n   Hex Codec Benchmark            --> 22");
+		printf("\n   Bootloader Statistics          --> 23");
+		printf("\n   Bootloader Event Trace         --> 24");
+		printf("\n   Bootloader Profiler            --> 25");
+		printf("\n   Bootloader RAM Usage           --> 26");
+		printf("\n   Multicast Simulation           --> 27");
+		printf("\n   Fleet Server Stand-in          --> 29");
+		printf("\n   Lockstep Serial Write          --> 30");
+		printf("\n   Pushed Command Latency         --> 32");
         printf("\n------------------------------------------");
         printf("\n   MENU_EXIT                      --> 0");
 
@@ -60,11 +117,15 @@ int main()
         scanf(" %d",&command_code);
 
         decode_menu_command_code(command_code);
-        printf("\n   Waiting for server to be ready again\n");
-        delay(15000);
-        HOST_voidSendCommand("EMPTY",5);
-        HOST_voidSendCommandToResponses("EMPTY",5);
-        delay(15000);
+        /*A pushed command is taken once, there is no channel to clear*/
+        if(!HOST_u8PushIsActive())
+        {
+            printf("\n   Waiting for server to be ready again\n");
+            delay(15000);
+            HOST_voidSendCommand("EMPTY",5);
+            HOST_voidSendCommandToResponses("EMPTY",5);
+            delay(15000);
+        }
 
 
 #if 0
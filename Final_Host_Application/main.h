@@ -1,13 +1,22 @@
 #ifndef MAIN_H_INCLUDED
 #define MAIN_H_INCLUDED
 
-#include <Windows.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+//Win32 calls used by the files common to both hosts, see LinuxSerialPort.c
+void     Sleep        (uint32_t ms);
+uint32_t GetTickCount (void);
+#endif
 
 //Bl commands prototypes
 void decode_menu_command_code(uint32_t command_code);
+void delay                   (int number_of_seconds);
+void wait_for_bootloader     (int milli_seconds);
 
 //BL Reply Process prototypes
 void process_COMMAND_BL_GET_VER					(uint32_t len, uint8_t* Copy_u8DataBuffer);
@@ -20,7 +29,7 @@ void process_COMMAND_BL_FLASH_ERASE				(uint32_t len, uint8_t* Copy_u8DataBuffer
 void process_COMMAND_BL_FLASH_MASS_ERASE		(uint32_t len, uint8_t* Copy_u8DataBuffer);
 
 void process_COMMAND_BL_MEM_WRITE				(uint32_t len, uint8_t* Copy_u8DataBuffer);
-void process_COMMAND_BL_MEM_READ				(uint32_t len);
+void process_COMMAND_BL_MEM_READ				(uint32_t len, uint8_t* Copy_u8DataBuffer);
 
 void process_COMMAND_BL_EN_R_PROTECT			(uint32_t len, uint8_t* Copy_u8DataBuffer);
 void process_COMMAND_BL_DIS_R_PROTECT			(uint32_t len, uint8_t* Copy_u8DataBuffer);
@@ -32,6 +41,10 @@ void process_COMMAND_BL_READ_SECTOR_P_STATUS	(uint32_t len, uint8_t* Copy_u8Data
 void process_COMMAND_BL_MY_SYSTEM_RESET			(uint32_t len);
 void process_COMMAND_BL_EXISTING_APPS			(uint32_t len, uint8_t* Copy_u8DataBuffer);
 void process_COMMAND_BL_SAVE_APP_INFO			(uint32_t len, uint8_t* Copy_u8DataBuffer);
+void process_COMMAND_BL_GET_DIGEST				(uint32_t len, uint8_t* Copy_u8DataBuffer);
+void process_COMMAND_BL_GET_RESUME				(uint32_t len, uint8_t* Copy_u8DataBuffer);
+void process_COMMAND_BL_GET_STATS				(uint32_t len, uint8_t* Copy_u8DataBuffer);
+void process_COMMAND_BL_GET_MEMORY				(uint32_t len, uint8_t* Copy_u8DataBuffer);
 
 int read_bootloader_reply						(uint8_t command_code, uint8_t* Copy_u8DataBuffer);
 //int check_flash_status						(void);
@@ -40,13 +53,69 @@ int read_bootloader_reply						(uint8_t command_code, uint8_t* Copy_u8DataBuffer
 uint32_t get_crc		(uint8_t *buff, uint32_t len);
 uint8_t  word_to_byte	(uint32_t addr, uint8_t index, uint8_t lowerfirst);
 void hex2char           (uint8_t* inBuffer, uint8_t* outBuffer, uint16_t NumOfBytesToBeConverted);
-void char2hex           (uint8_t* inBuffer, uint8_t* outBuffer, uint16_t NumOfBytesToBeConverted );
+int  char2hex           (uint8_t* inBuffer, uint8_t* outBuffer, uint16_t NumOfBytesToBeConverted );
+void hex_codec_benchmark(void);
+uint32_t decode_ff_runs (uint8_t* in, uint32_t in_len, uint8_t* out, uint32_t out_max);
+uint32_t get_crc_words  (uint8_t *buff, uint32_t len);
+void     sha256         (uint8_t *buff, uint32_t len, uint8_t *digest);
+uint32_t build_chunk_manifest(uint8_t *image, uint32_t len, uint32_t *manifest);
 
 //file ops
 void 		close_the_file	(void);
 uint32_t 	read_the_file	(uint8_t *buffer, uint32_t len);
 void 		open_the_file	(void);
 uint32_t 	calc_file_len	(void);
+int         write_published_image(uint8_t *image, uint32_t len, uint32_t *manifest, uint32_t chunks);
+uint32_t    read_published_image (uint32_t offset, uint8_t *chars, uint32_t count);
+
+//fleet update
+void fleet_run               (void);
+void fleet_server_run        (void);
+
+//windowed serial write, and the lockstep one it is measured against
+void windowed_write_run      (void);
+void lockstep_write_run      (void);
+void wired_server_run        (void);   //stand-in of the wired bootloader, Linux only
+
+//push transport and LAN direct : stand-in of the bootloader and command latency
+void push_board_start        (uint8_t lan_direct, uint16_t port);
+void push_latency_run        (void);
+
+//bootloader event trace
+void trace_dump_run          (void);
+
+//bootloader sampling profiler
+void profiler_run            (void);
+
+//multicast image distribution, see multicast.c
+#define MCAST_DEFAULT_GROUP                 "239.255.0.1"   //WIFI_MCAST_GROUP of the bootloader
+#define MCAST_DEFAULT_PART_GAP_MS           50      //a 256 byte part is 531 chars, 46 ms at 115200 baud
+#define MCAST_DEFAULT_CHUNK_GAP_MS          40      //page erase and write on the board
+
+typedef struct
+{
+    char     group[16];             //multicast group, or the broadcast address of the LAN
+    uint32_t devices;               //boards expected to join, the join phase ends early when all of them answered
+    uint32_t join_timeout_ms;
+    uint32_t part_gap_ms;
+    uint32_t chunk_gap_ms;
+    uint8_t  loopback;              //send on 127.0.0.1 (simulated boards)
+} mcast_config_t;
+
+typedef struct
+{
+    uint32_t joined;                //boards that answered the first query
+    uint32_t complete;              //boards that reported no missing chunk
+    uint32_t rounds;
+    uint32_t datagrams;
+    uint32_t repaired_chunks;       //chunks sent again in the repair rounds
+    uint32_t elapsed_ms;
+    uint32_t first_round_ms;
+} mcast_result_t;
+
+int      mcast_send_image    (uint8_t* image, uint32_t len, uint32_t image_crc, mcast_config_t* config, mcast_result_t* result);
+uint32_t mcast_worst_case_ms (mcast_config_t* config, uint32_t len);
+void     mcast_simulate_run  (void);
 
 //BL Commands
 #define COMMAND_BL_GET_VER                  0x51
@@ -71,6 +140,14 @@ uint32_t 	calc_file_len	(void);
 #define COMMAND_BL_MY_SYSTEM_RESET          0x5D
 #define COMMAND_BL_EXISTING_APPS            0x5E
 #define COMMAND_BL_SAVE_APP_INFO			0x61
+#define COMMAND_BL_GET_DIGEST				0x62
+#define COMMAND_BL_GET_RESUME				0x63
+#define COMMAND_BL_MEM_WRITE_WINDOWED       0x64    //wired bootloader only, see windowed_write.c
+#define COMMAND_BL_GET_STATS				0x65
+#define COMMAND_BL_GET_TRACE				0x66
+#define COMMAND_BL_GET_PROFILE				0x67
+#define COMMAND_BL_GET_MEMORY				0x68
+#define COMMAND_BL_MEM_MULTICAST			0x69    //WIFI bootloader only, see multicast.c
 
 //len details of the command
 #define COMMAND_BL_GET_VER_LEN				6
@@ -83,7 +160,30 @@ uint32_t 	calc_file_len	(void);
 #define COMMAND_BL_MASS_ERASE_LEN			6       //8 //10
 
 #define COMMAND_BL_MEM_WRITE_LEN(x)			(11+x+8)//(11+x+8)//(11+x+4) //(7+x+4)
-#define COMMAND_BL_MEM_READ_LEN				11
+#define COMMAND_BL_MEM_WRITE_START_LEN		22      //addr(4) + file size(4) + file CRC32(4) + manifest CRC32(4)
+
+//BL_MEM_WRITE status
+#define BL_MEM_WRITE_OK                     0
+#define BL_MEM_WRITE_ADDR_INVALID           1
+#define BL_MEM_WRITE_VERIFY_FAIL            2       //a page did not read back as written, send the command again to resume
+#define BL_MEM_WRITE_IMAGE_CRC_FAIL         3
+#define BL_MEM_WRITE_CHUNK_FAIL             4       //a chunk kept failing its manifest CRC, send the command again to resume
+#define BL_MEM_WRITE_MANIFEST_FAIL          5       //the published manifest does not match the CRC in the command
+#define BL_MEM_WRITE_NO_BUFFER              6       //the bootloader pools had no free block for the download
+#define BL_MEM_WRITE_NO_LINK                7       //BL_MEM_MULTICAST could not open its UDP link
+#define IMAGE_CHUNK_SIZE                    1024    //bootloader fetches the published image one chunk (2048 chars) at a time
+#define IMAGE_MAX_CHUNKS                    128     //128 KB of flash
+#define COMMAND_BL_MEM_READ_LEN				15      //addr(4) + length(4) + encoding(1)
+
+//BL_MEM_READ stream details
+#define BL_MEM_READ_HEADER_LEN              7       //offset(4) + chunk length(2) + encoding(1)
+#define BL_GET_TRACE_HEADER_LEN             7       //first record(4) + records left(2) + records in reply(1)
+#define BL_GET_PROFILE_HEADER_LEN           16      //rate(2) + samples(4) + outside(4) + shift(1) + first entry(2) + entries left(2) + entries in reply(1)
+#define BL_PROFILE_RATE_KEEP                0xFFFF  //keep the profiler sampling (or stopped) as it is
+#define BL_RAM_SAFETY_MARGIN                512     //RAM left unused by BL_GET_MEMORY advice (interrupt frames, untested paths)
+#define BL_POOL_RECORD_LEN                  9       //usage of one bootloader buffer pool in the BL_GET_MEMORY reply
+#define BL_MEM_READ_ENCODING_RAW            0
+#define BL_MEM_READ_ENCODING_FF_RUNS        1       //every run of 0xFF is sent as (0xFF, run length)
 
 #define COMMAND_BL_EN_R_PROTECT_LEN			6      //10
 #define COMMAND_BL_DIS_R_PROTECT_LEN		6       //10
@@ -95,6 +195,19 @@ uint32_t 	calc_file_len	(void);
 #define COMMAND_BL_MY_SYSTEM_RESET_LEN		6      //10
 #define COMMAND_BL_EXISTING_APPS_LEN		6
 #define COMMAND_BL_SAVE_APP_INFO_LEN        22//34//42
+#define COMMAND_BL_GET_DIGEST_LEN           15      //addr(4) + length(4) + algorithm(1)
+#define COMMAND_BL_GET_RESUME_LEN           6
+#define COMMAND_BL_GET_STATS_LEN            7       //clear after read(1)
+#define COMMAND_BL_GET_TRACE_LEN            7       //clear after read(1)
+#define COMMAND_BL_GET_PROFILE_LEN          9       //new rate(2) + clear after read(1)
+#define COMMAND_BL_GET_MEMORY_LEN           6
+#define COMMAND_BL_MEM_MULTICAST_LEN        18      //addr(4) + file size(4) + file CRC32(4)
+
+//BL_GET_DIGEST details
+#define BL_DIGEST_CRC32                     0       //STM32 CRC unit fed with one 32-bit word per write
+#define BL_DIGEST_SHA256                    1
+#define BL_DIGEST_CRC32_LEN                 4
+#define BL_DIGEST_SHA256_LEN                32
 
 /* Values to be used with WRP */
 #define FLASH_WRProt_AllPages          ((uint32_t)0xFFFFFFFF)
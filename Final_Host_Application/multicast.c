@@ -0,0 +1,509 @@
+/* This file implements the multicast image distribution : the image is sent once to all the boards of the LAN
+ * instead of once per board. The boards run BL_MEM_MULTICAST and listen on a UDP link of their WIFI module.
+ * The host sends every 1 KB chunk in parts of 256 bytes (one datagram each, hex chars like everything else),
+ * then asks every board for the bitmap of the chunks it is missing and sends the union of them again (a repair round),
+ * until no board misses anything or MCAST_MAX_ROUNDS is reached, then it ends the download.
+ * With a loss rate p, a repair round holds about p of the chunks for one board and a bit more for many boards,
+ * so the time for the whole fleet stays close to the time for one board.
+ * The datagrams are paced for the 115200 baud link between the module and the MCU, and every chunk is followed
+ * by a pause for the boards to write their page (the MCU stalls while it writes and the chars coming then are lost).
+ * Datagram formats are described with BL_MEM_MULTICAST in the bootloader (Bootloader.c).
+ * The simulation runs the download against simulated boards on this PC (loopback) that drop datagrams at random.
+ * This file is Windows only (threads and winsock)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include "main.h"
+#include "HTTP_interface.h"
+
+#define MCAST_PORT                  5051
+#define MCAST_PART_SIZE             256
+#define MCAST_PARTS_PER_CHUNK       (IMAGE_CHUNK_SIZE/MCAST_PART_SIZE)
+#define MCAST_SESSION_LEN           5       //type char + session (4 chars)
+#define MCAST_DATA_HEADER_LEN       19      //+ chunk (4 chars) + part (2 chars) + chunk CRC32 (8 chars)
+#define MCAST_UID_CHARS             24
+#define MCAST_BITMAP_BYTES          (IMAGE_MAX_CHUNKS/8)
+#define MCAST_MAX_DEVICES           256
+#define MCAST_MAX_ROUNDS            8       //first round + repair rounds
+#define MCAST_QUERY_INTERVAL_MS     500
+#define MCAST_REPORT_TIMEOUT_MS     5000    //longest wait for the bitmaps after a round
+#define MCAST_END_REPEATS           3
+#define MCAST_SIM_IDLE_TIMEOUT_MS   60000
+#define MCAST_SIM_MAX_BOARDS        64
+
+#define MCAST_DATA                  'F'
+#define MCAST_QUERY                 'Q'
+#define MCAST_BITMAP                'B'
+#define MCAST_END                   'E'
+
+//Board that answered at least one query
+typedef struct
+{
+    char     uid[MCAST_UID_CHARS+1];
+    uint8_t  missing[MCAST_BITMAP_BYTES];
+    uint8_t  answered;              //answered the query of the current round
+} mcast_device_t;
+
+static mcast_device_t mcast_devices[MCAST_MAX_DEVICES];
+static uint32_t       mcast_number_of_devices;
+
+
+//Sends one datagram : type char, session, then the hex chars of (bytes)
+static void mcast_send(SOCKET sock, struct sockaddr_in* group, uint8_t type, uint16_t session, uint8_t* bytes, uint16_t len, uint8_t* chars)
+{
+    uint8_t session_bytes[2] = {(uint8_t)(session>>8), (uint8_t)session};
+
+    chars[0] = type;
+    hex2char(session_bytes, &chars[1], 2);
+    if(len) hex2char(bytes, &chars[MCAST_SESSION_LEN], len);
+    sendto(sock, (char*)chars, MCAST_SESSION_LEN+len*2, 0, (struct sockaddr*)group, sizeof(*group));
+}
+
+//Sends every part of a chunk, then pauses for the boards to write the page
+static uint32_t mcast_send_chunk(SOCKET sock, struct sockaddr_in* group, uint16_t session, uint8_t* image, uint32_t len, uint32_t chunk, mcast_config_t* config)
+{
+    uint8_t  header[9+MCAST_PART_SIZE];
+    uint8_t  chars[MCAST_DATA_HEADER_LEN+MCAST_PART_SIZE*2];
+    uint32_t chunk_len = ((len-chunk*IMAGE_CHUNK_SIZE) >= IMAGE_CHUNK_SIZE)? IMAGE_CHUNK_SIZE : (len-chunk*IMAGE_CHUNK_SIZE);
+    uint32_t chunk_crc = get_crc_words(&image[chunk*IMAGE_CHUNK_SIZE], chunk_len);
+    uint32_t part;
+    uint32_t part_len;
+    uint32_t datagrams = 0;
+
+    //the part bytes follow the header in the same buffer, so the datagram is encoded at once
+    for(part = 0 ; part*MCAST_PART_SIZE < chunk_len ; part++)
+    {
+        part_len  = ((chunk_len-part*MCAST_PART_SIZE) >= MCAST_PART_SIZE)? MCAST_PART_SIZE : (chunk_len-part*MCAST_PART_SIZE);
+        header[0] = (uint8_t)(chunk>>8);
+        header[1] = (uint8_t)chunk;
+        header[2] = (uint8_t)part;
+        header[3] = (uint8_t)(chunk_crc>>24);
+        header[4] = (uint8_t)(chunk_crc>>16);
+        header[5] = (uint8_t)(chunk_crc>>8);
+        header[6] = (uint8_t)chunk_crc;
+        memcpy(&header[7], &image[chunk*IMAGE_CHUNK_SIZE+part*MCAST_PART_SIZE], part_len);
+        mcast_send(sock, group, MCAST_DATA, session, header, 7+part_len, chars);
+        datagrams++;
+        Sleep(config->part_gap_ms);
+    }
+    Sleep(config->chunk_gap_ms);
+    return datagrams;
+}
+
+//Takes the bitmaps that come for (wait_ms), returns the number of boards that answered the query of (round) for the first time
+static uint32_t mcast_collect(SOCKET sock, uint16_t session, uint8_t round, uint32_t chunks, uint32_t wait_ms)
+{
+    uint8_t   chars[256];
+    uint8_t   bytes[3];
+    fd_set    read_set;
+    struct timeval timeout;
+    uint32_t  start = GetTickCount();
+    uint32_t  elapsed;
+    uint32_t  answers = 0;
+    uint32_t  index;
+    int       received;
+    mcast_device_t* device;
+
+    while((elapsed = GetTickCount()-start) < wait_ms)
+    {
+        FD_ZERO(&read_set);
+        FD_SET(sock, &read_set);
+        timeout.tv_sec  = (wait_ms-elapsed)/1000;
+        timeout.tv_usec = ((wait_ms-elapsed)%1000)*1000;
+        if(select(sock+1, &read_set, NULL, NULL, &timeout) <= 0) break;
+        received = recv(sock, (char*)chars, sizeof(chars), 0);
+        if(received < (int)(MCAST_SESSION_LEN+2+MCAST_UID_CHARS+4+((chunks+7)/8)*2) || chars[0] != MCAST_BITMAP) continue;
+        if(char2hex(&chars[1], bytes, 3) != 0 || ((bytes[0]<<8)|bytes[1]) != session || bytes[2] != round) continue;
+
+        //a board is known by the unique ID of its MCU
+        device = NULL;
+        for(index = 0 ; index < mcast_number_of_devices ; index++)
+        {
+            if(memcmp(mcast_devices[index].uid, &chars[MCAST_SESSION_LEN+2], MCAST_UID_CHARS) == 0) device = &mcast_devices[index];
+        }
+        if(device == NULL)
+        {
+            if(mcast_number_of_devices == MCAST_MAX_DEVICES) continue;
+            device = &mcast_devices[mcast_number_of_devices++];
+            memset(device, 0, sizeof(*device));
+            memcpy(device->uid, &chars[MCAST_SESSION_LEN+2], MCAST_UID_CHARS);
+        }
+        if(char2hex(&chars[MCAST_SESSION_LEN+2+MCAST_UID_CHARS+4], device->missing, (chunks+7)/8) != 0) continue;
+        if(!device->answered) answers++;
+        device->answered = 1;
+    }
+    return answers;
+}
+
+//Asks all the boards for their bitmap until all the known ones (and at least (expected)) answered or the time is over
+static void mcast_query(SOCKET sock, struct sockaddr_in* group, uint16_t session, uint8_t round, uint32_t chunks, uint32_t expected, uint32_t timeout_ms)
+{
+    uint8_t  chars[MCAST_SESSION_LEN+2];
+    uint32_t start = GetTickCount();
+    uint32_t answered = 0;
+    uint32_t index;
+
+    for(index = 0 ; index < mcast_number_of_devices ; index++) mcast_devices[index].answered = 0;
+    while(GetTickCount()-start < timeout_ms)
+    {
+        mcast_send(sock, group, MCAST_QUERY, session, &round, 1, chars);
+        answered += mcast_collect(sock, session, round, chunks, MCAST_QUERY_INTERVAL_MS);
+        if(answered >= mcast_number_of_devices && answered >= expected) break;
+    }
+}
+
+//Sends an image to all the boards listening on the group (they run BL_MEM_MULTICAST for the same image CRC)
+//returns 0 if every board that answered has the whole image, -1 otherwise
+int mcast_send_image(uint8_t* image, uint32_t len, uint32_t image_crc, mcast_config_t* config, mcast_result_t* result)
+{
+    WSADATA  wsa;
+    SOCKET   sock;
+    struct sockaddr_in group;
+    struct in_addr loopback;
+    uint8_t  chars[MCAST_SESSION_LEN];
+    uint8_t  wanted[MCAST_BITMAP_BYTES];
+    uint16_t session = (uint16_t)image_crc;
+    uint32_t chunks  = (len+IMAGE_CHUNK_SIZE-1)/IMAGE_CHUNK_SIZE;
+    uint32_t start;
+    uint32_t chunk;
+    uint32_t index;
+    uint32_t byte;
+    uint32_t missing;
+    int      option = 1;
+    uint8_t  ttl    = 1;
+    uint8_t  round;
+
+    memset(result, 0, sizeof(*result));
+    if(chunks == 0 || chunks > IMAGE_MAX_CHUNKS) return -1;
+    if(WSAStartup(MAKEWORD(2,2), &wsa) != 0) return -1;
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if(sock == INVALID_SOCKET)
+    {
+        printf("\n   Could not create socket : %d", WSAGetLastError());
+        WSACleanup();
+        return -1;
+    }
+    //the group may be the broadcast address of the LAN for modules that do not join multicast groups
+    setsockopt(sock, SOL_SOCKET, SO_BROADCAST, (char*)&option, sizeof(option));
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, (char*)&ttl, sizeof(ttl));
+    if(config->loopback)
+    {
+        loopback.s_addr = inet_addr("127.0.0.1");
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, (char*)&loopback, sizeof(loopback));
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, (char*)&option, sizeof(option));
+    }
+    group.sin_family      = AF_INET;
+    group.sin_addr.s_addr = inet_addr(config->group);
+    group.sin_port        = htons(MCAST_PORT);
+    mcast_number_of_devices = 0;
+    start = GetTickCount();
+
+    //round 0 : the boards join, every one of them misses everything
+    printf("\n   Waiting for %u boards to join %s:%d", config->devices, config->group, MCAST_PORT);
+    mcast_query(sock, &group, session, 0, chunks, config->devices, config->join_timeout_ms);
+    result->joined = mcast_number_of_devices;
+    printf("\n   %u boards joined", result->joined);
+
+    for(round = 1 ; round <= MCAST_MAX_ROUNDS && mcast_number_of_devices ; round++)
+    {
+        //the chunks missed by any board are sent to all of them
+        memset(wanted, 0, sizeof(wanted));
+        for(index = 0 ; index < mcast_number_of_devices ; index++)
+        {
+            for(byte = 0 ; byte < MCAST_BITMAP_BYTES ; byte++) wanted[byte] |= mcast_devices[index].missing[byte];
+        }
+        missing = 0;
+        for(chunk = 0 ; chunk < chunks ; chunk++)
+        {
+            if(wanted[chunk/8] & (1<<(chunk%8))) missing++;
+        }
+        if(missing == 0) break;
+        printf("\n   Round %u : %u of %u chunks", round, missing, chunks);
+        for(chunk = 0 ; chunk < chunks ; chunk++)
+        {
+            if(wanted[chunk/8] & (1<<(chunk%8))) result->datagrams += mcast_send_chunk(sock, &group, session, image, len, chunk, config);
+        }
+        if(round == 1) result->first_round_ms = GetTickCount()-start;
+        else           result->repaired_chunks += missing;
+        result->rounds = round;
+        mcast_query(sock, &group, session, round, chunks, mcast_number_of_devices, MCAST_REPORT_TIMEOUT_MS);
+    }
+
+    for(index = 0 ; index < MCAST_END_REPEATS ; index++)
+    {
+        mcast_send(sock, &group, MCAST_END, session, NULL, 0, chars);
+        Sleep(config->part_gap_ms);
+    }
+    closesocket(sock);
+    WSACleanup();
+
+    for(index = 0 ; index < mcast_number_of_devices ; index++)
+    {
+        missing = 0;
+        for(byte = 0 ; byte < MCAST_BITMAP_BYTES ; byte++) missing |= mcast_devices[index].missing[byte];
+        if(missing == 0) result->complete++;
+    }
+    result->elapsed_ms = GetTickCount()-start;
+    return (result->joined && result->complete == result->joined)? 0 : -1;
+}
+
+//Longest time a board can spend in BL_MEM_MULTICAST for an image of (len) bytes
+uint32_t mcast_worst_case_ms(mcast_config_t* config, uint32_t len)
+{
+    uint32_t chunks = (len+IMAGE_CHUNK_SIZE-1)/IMAGE_CHUNK_SIZE;
+
+    return config->join_timeout_ms + (MCAST_MAX_ROUNDS+1)*MCAST_REPORT_TIMEOUT_MS +
+           MCAST_MAX_ROUNDS*chunks*(MCAST_PARTS_PER_CHUNK*config->part_gap_ms+config->chunk_gap_ms);
+}
+
+
+/*--------------------------------- Simulated boards ---------------------------------*/
+
+//Simulated board : does what BL_MEM_MULTICAST does, with its flash in RAM and a random loss on every datagram it gets or sends
+typedef struct
+{
+    uint32_t id;
+    uint32_t loss_percent;
+    uint32_t random;
+    uint8_t* flash;
+    uint32_t len;
+    uint16_t session;
+    uint32_t image_crc;
+    uint8_t  missing[MCAST_BITMAP_BYTES];
+    uint32_t taken;
+    uint32_t dropped;
+    uint8_t  ok;
+} mcast_sim_board_t;
+
+static char mcast_sim_group[16];
+
+//Drops with the loss rate of the board (xorshift, one generator per board)
+static uint8_t mcast_sim_lost(mcast_sim_board_t* board)
+{
+    board->random ^= board->random << 13;
+    board->random ^= board->random >> 17;
+    board->random ^= board->random << 5;
+    return (board->random % 100) < board->loss_percent;
+}
+
+static DWORD WINAPI mcast_sim_board(LPVOID param)
+{
+    mcast_sim_board_t* board = (mcast_sim_board_t*)param;
+    SOCKET   sock;
+    struct sockaddr_in local;
+    struct sockaddr_in host;
+    struct ip_mreq membership;
+    fd_set   read_set;
+    struct timeval timeout;
+    int      host_len;
+    int      received;
+    int      option = 1;
+    uint8_t  chars[MCAST_DATA_HEADER_LEN+MCAST_PART_SIZE*2+8];
+    uint8_t  header[9];
+    uint8_t  chunk_buffer[IMAGE_CHUNK_SIZE];
+    uint8_t  answer[2+MCAST_UID_CHARS/2+2+MCAST_BITMAP_BYTES];
+    uint8_t  answer_chars[MCAST_SESSION_LEN+(2+MCAST_UID_CHARS/2+2+MCAST_BITMAP_BYTES)*2];
+    uint32_t chunks = (board->len+IMAGE_CHUNK_SIZE-1)/IMAGE_CHUNK_SIZE;
+    uint32_t assembling = 0xFFFFFFFF;
+    uint32_t assembling_crc = 0;
+    uint32_t parts_in = 0;
+    uint32_t chunk, part, parts, chunk_len, part_len, chunk_crc;
+    uint32_t index;
+
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if(sock == INVALID_SOCKET) return 1;
+    //all the boards listen on the same port, every one of them gets every datagram of the group
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (char*)&option, sizeof(option));
+    local.sin_family      = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port        = htons(MCAST_PORT);
+    membership.imr_multiaddr.s_addr = inet_addr(mcast_sim_group);
+    membership.imr_interface.s_addr = inet_addr("127.0.0.1");
+    if(bind(sock, (struct sockaddr*)&local, sizeof(local)) == SOCKET_ERROR ||
+       setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char*)&membership, sizeof(membership)) == SOCKET_ERROR)
+    {
+        printf("\n   Simulated board %u could not join the group : %d", board->id, WSAGetLastError());
+        closesocket(sock);
+        return 1;
+    }
+    memset(board->missing, 0, sizeof(board->missing));
+    for(chunk = 0 ; chunk < chunks ; chunk++) board->missing[chunk/8] |= (uint8_t)(1<<(chunk%8));
+
+    while(1)
+    {
+        FD_ZERO(&read_set);
+        FD_SET(sock, &read_set);
+        timeout.tv_sec  = MCAST_SIM_IDLE_TIMEOUT_MS/1000;
+        timeout.tv_usec = 0;
+        if(select(sock+1, &read_set, NULL, NULL, &timeout) <= 0) break;
+        host_len = sizeof(host);
+        received = recvfrom(sock, (char*)chars, sizeof(chars), 0, (struct sockaddr*)&host, &host_len);
+        if(received <= 0 || mcast_sim_lost(board)) continue;
+        if(received < MCAST_SESSION_LEN || char2hex(&chars[1], header, 2) != 0 || ((header[0]<<8)|header[1]) != board->session)
+        {
+            board->dropped++;
+            continue;
+        }
+        if(chars[0] == MCAST_END) break;
+        if(chars[0] == MCAST_QUERY)
+        {
+            if(received < MCAST_SESSION_LEN+2 || char2hex(&chars[MCAST_SESSION_LEN], &answer[0], 1) != 0) continue;
+            //a query ends the chunk being put together, like the page jobs of the bootloader
+            assembling = 0xFFFFFFFF;
+            memset(&answer[1], 0, MCAST_UID_CHARS/2);
+            memcpy(&answer[1], &board->id, 4);
+            answer[1+MCAST_UID_CHARS/2] = (uint8_t)(chunks>>8);
+            answer[2+MCAST_UID_CHARS/2] = (uint8_t)chunks;
+            memcpy(&answer[3+MCAST_UID_CHARS/2], board->missing, (chunks+7)/8);
+            if(mcast_sim_lost(board)) continue;
+            answer_chars[0] = MCAST_BITMAP;
+            hex2char(&header[0], &answer_chars[1], 2);
+            hex2char(answer, &answer_chars[MCAST_SESSION_LEN], 3+MCAST_UID_CHARS/2+(chunks+7)/8);
+            sendto(sock, (char*)answer_chars, MCAST_SESSION_LEN+(3+MCAST_UID_CHARS/2+(chunks+7)/8)*2, 0, (struct sockaddr*)&host, host_len);
+            continue;
+        }
+        if(chars[0] != MCAST_DATA || received < MCAST_DATA_HEADER_LEN || char2hex(&chars[1], header, 9) != 0)
+        {
+            board->dropped++;
+            continue;
+        }
+        chunk     = (header[2]<<8)|header[3];
+        part      = header[4];
+        chunk_crc = ((uint32_t)header[5]<<24)|((uint32_t)header[6]<<16)|((uint32_t)header[7]<<8)|header[8];
+        if(chunk >= chunks)
+        {
+            board->dropped++;
+            continue;
+        }
+        chunk_len = ((board->len-chunk*IMAGE_CHUNK_SIZE) >= IMAGE_CHUNK_SIZE)? IMAGE_CHUNK_SIZE : (board->len-chunk*IMAGE_CHUNK_SIZE);
+        parts     = (chunk_len+MCAST_PART_SIZE-1)/MCAST_PART_SIZE;
+        part_len  = ((part+1)*MCAST_PART_SIZE <= chunk_len)? MCAST_PART_SIZE : (chunk_len-part*MCAST_PART_SIZE);
+        if(part >= parts || received != (int)(MCAST_DATA_HEADER_LEN+part_len*2))
+        {
+            board->dropped++;
+            continue;
+        }
+        if(!(board->missing[chunk/8] & (1<<(chunk%8)))) continue;
+        if(chunk != assembling)
+        {
+            assembling     = chunk;
+            assembling_crc = chunk_crc;
+            parts_in       = 0;
+        }
+        if(chunk_crc != assembling_crc || char2hex(&chars[MCAST_DATA_HEADER_LEN], &chunk_buffer[part*MCAST_PART_SIZE], part_len) != 0)
+        {
+            board->dropped++;
+            continue;
+        }
+        board->taken++;
+        parts_in |= 1<<part;
+        if(parts_in != (1u<<parts)-1) continue;
+        assembling = 0xFFFFFFFF;
+        if(get_crc_words(chunk_buffer, chunk_len) != chunk_crc) continue;
+        memcpy(&board->flash[chunk*IMAGE_CHUNK_SIZE], chunk_buffer, chunk_len);
+        board->missing[chunk/8] &= (uint8_t)~(1<<(chunk%8));
+    }
+    closesocket(sock);
+    for(index = 0, board->ok = 1 ; index < chunks ; index++)
+    {
+        if(board->missing[index/8] & (1<<(index%8))) board->ok = 0;
+    }
+    if(board->ok) board->ok = (get_crc_words(board->flash, board->len) == board->image_crc);
+    return 0;
+}
+
+//Runs one download against (boards) simulated boards, returns the number of boards that have the whole image
+static uint32_t mcast_simulate(uint8_t* image, uint32_t len, uint32_t image_crc, uint32_t boards, uint32_t loss_percent, mcast_config_t* config, mcast_result_t* result)
+{
+    static mcast_sim_board_t sim_boards[MCAST_SIM_MAX_BOARDS];
+    HANDLE   threads[MCAST_SIM_MAX_BOARDS];
+    WSADATA  wsa;
+    uint32_t index;
+    uint32_t ok = 0;
+
+    if(WSAStartup(MAKEWORD(2,2), &wsa) != 0) return 0;
+    strcpy(mcast_sim_group, config->group);
+    for(index = 0 ; index < boards ; index++)
+    {
+        memset(&sim_boards[index], 0, sizeof(sim_boards[index]));
+        sim_boards[index].id           = index+1;
+        sim_boards[index].loss_percent = loss_percent;
+        sim_boards[index].random       = 2654435761u*(index+1) ^ GetTickCount();
+        if(sim_boards[index].random == 0) sim_boards[index].random = 1;
+        sim_boards[index].flash        = malloc(len);
+        sim_boards[index].len          = len;
+        sim_boards[index].session      = (uint16_t)image_crc;
+        sim_boards[index].image_crc    = image_crc;
+        if(sim_boards[index].flash) memset(sim_boards[index].flash, 0xFF, len);
+        threads[index] = sim_boards[index].flash? CreateThread(NULL, 0, mcast_sim_board, &sim_boards[index], 0, NULL) : NULL;
+    }
+    //the boards are listening before the first query
+    Sleep(200);
+    config->devices  = boards;
+    config->loopback = 1;
+    mcast_send_image(image, len, image_crc, config, result);
+    for(index = 0 ; index < boards ; index++)
+    {
+        if(threads[index] == NULL) continue;
+        WaitForSingleObject(threads[index], INFINITE);
+        CloseHandle(threads[index]);
+        if(sim_boards[index].ok) ok++;
+        free(sim_boards[index].flash);
+    }
+    WSACleanup();
+    return ok;
+}
+
+static void mcast_print_result(const char* name, uint32_t boards, uint32_t ok, mcast_result_t* result)
+{
+    printf("\n   %-10s : %u/%u boards with the whole image in %.1f s, %u rounds (first one %.1f s), %u datagrams, %u chunks repaired",
+           name, ok, boards, result->elapsed_ms/1000.0, result->rounds, result->first_round_ms/1000.0, result->datagrams, result->repaired_chunks);
+}
+
+//Asks for the image, the number of simulated boards and the loss rate, then runs the download for one board and for all of them
+void mcast_simulate_run(void)
+{
+    mcast_config_t config;
+    mcast_result_t single;
+    mcast_result_t fleet;
+    uint8_t* image;
+    uint32_t len;
+    uint32_t image_crc;
+    uint32_t boards = 50;
+    uint32_t loss_percent = 5;
+    uint32_t ok;
+
+    len = calc_file_len();
+    if(len == 0 || len > IMAGE_MAX_CHUNKS*IMAGE_CHUNK_SIZE){printf("\n   File is larger than the flash!!\r\n");return;}
+    image = malloc(len);
+    if(image == NULL){printf("\n   Not enough memory!!\r\n");return;}
+    open_the_file();
+    read_the_file(image, len);
+    close_the_file();
+    image_crc = get_crc_words(image, len);
+
+    printf("\n   Enter number of simulated boards (1-%d) : ", MCAST_SIM_MAX_BOARDS);
+    scanf(" %u", &boards);
+    printf("\n   Enter datagram loss in percent : ");
+    scanf(" %u", &loss_percent);
+    if(boards == 0) boards = 1;
+    if(boards > MCAST_SIM_MAX_BOARDS) boards = MCAST_SIM_MAX_BOARDS;
+    if(loss_percent > 100) loss_percent = 100;
+
+    memset(&config, 0, sizeof(config));
+    strcpy(config.group, MCAST_DEFAULT_GROUP);
+    config.join_timeout_ms = 5000;
+    config.part_gap_ms     = MCAST_DEFAULT_PART_GAP_MS;
+    config.chunk_gap_ms    = MCAST_DEFAULT_CHUNK_GAP_MS;
+
+    //the same image and loss for one board first : the time the whole fleet should stay close to
+    ok = mcast_simulate(image, len, image_crc, 1, loss_percent, &config, &single);
+    mcast_print_result("1 board", 1, ok, &single);
+    ok = mcast_simulate(image, len, image_crc, boards, loss_percent, &config, &fleet);
+    mcast_print_result("fleet", boards, ok, &fleet);
+    if(single.elapsed_ms) printf("\n   Fleet time / one board time : %.2f\n", (double)fleet.elapsed_ms/single.elapsed_ms);
+    free(image);
+}
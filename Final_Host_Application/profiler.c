@@ -0,0 +1,230 @@
+/* This file implements the profiler view : the PC sampling histogram of the bootloader (BL_GET_PROFILE) is read
+ * and every bucket is matched with the functions of the bootloader image, taken from the .map file that the
+ * Eclipse build writes in Debug/ (the bootloader is built with one section per function).
+ * A bucket shared by several functions is split between them by the number of bytes each one has in it,
+ * so small functions next to a hot one may get a few samples that are not theirs.
+ * Reading the histogram is Windows only (winsock), the map parsing is common across win/linux/mac
+ */
+
+#include "main.h"
+#include "HTTP_interface.h"
+#include <stdlib.h>
+
+#define PROFILE_CODE_START          0x08000000
+#define PROFILE_MAX_ENTRIES         4096
+#define PROFILE_MAX_FUNCTIONS       2048
+#define PROFILE_TOP_FUNCTIONS       25
+#define PROFILE_POLL_MS             1000
+#define PROFILE_TIMEOUT_POLLS       100     //no new reply for this many polls : give up
+#define PROFILE_DEFAULT_MAP         "..\\Bootloader_STM32f103c8t6_FOTA\\Debug\\Bootloader_STM32f103c8t6_FOTA.map"
+
+typedef struct
+{
+    char     name[64];
+    uint32_t address;
+    uint32_t size;
+    double   samples;
+}profile_function_t;
+
+static profile_function_t profile_functions[PROFILE_MAX_FUNCTIONS];
+
+//Reads the code sections of the map file, returns the number of functions found or -1 if the file can not be opened
+static int profile_read_map(const char* map_name)
+{
+    FILE*    map;
+    char     line[512];
+    char     section[256];
+    char     object[256];
+    char*    name;
+    uint32_t address;
+    uint32_t size;
+    int      fields;
+    int      count = 0;
+
+    map = fopen(map_name, "r");
+    if(map == NULL) return -1;
+
+    /*Sections are listed as " .text.function address size object", the address goes on the next line when the name is long*/
+    while(fgets(line, sizeof(line), map) != NULL && count < PROFILE_MAX_FUNCTIONS)
+    {
+        if(strncmp(line, " .text", 6) != 0) continue;
+        object[0] = 0;
+        fields = sscanf(line, " %255s %x %x %255s", section, &address, &size, object);
+        if(fields == 1)
+        {
+            if(fgets(line, sizeof(line), map) == NULL) break;
+            fields = 1 + sscanf(line, " %x %x %255s", &address, &size, object);
+        }
+        if(fields < 3 || size == 0 || address < PROFILE_CODE_START) continue;
+
+        /*".text.name" is one function, a plain ".text" is named after its object file*/
+        name = (strncmp(section, ".text.", 6) == 0)? &section[6] : object;
+        if(strrchr(name, '/'))  name = strrchr(name, '/')+1;
+        if(strrchr(name, '\\')) name = strrchr(name, '\\')+1;
+        snprintf(profile_functions[count].name, sizeof(profile_functions[count].name), "%s", name);
+        profile_functions[count].address = address;
+        profile_functions[count].size    = size;
+        profile_functions[count].samples = 0;
+        count++;
+    }
+    fclose(map);
+    return count;
+}
+
+static int profile_compare_samples(const void* a, const void* b)
+{
+    double diff = ((const profile_function_t*)b)->samples - ((const profile_function_t*)a)->samples;
+    return (diff > 0) - (diff < 0);
+}
+
+//Asks the bootloader for its histogram (and the new sampling rate), then prints where the samples fall
+void profiler_run(void)
+{
+    uint8_t  command[COMMAND_BL_GET_PROFILE_LEN];
+    uint8_t  command_chars[COMMAND_BL_GET_PROFILE_LEN*2];
+    static uint8_t  reply_chars[2000];
+    static uint8_t  reply[1000];
+    static uint16_t buckets[PROFILE_MAX_ENTRIES];
+    static uint32_t bucket_samples[PROFILE_MAX_ENTRIES];
+    char     map_name[260];
+    uint32_t new_rate    = BL_PROFILE_RATE_KEEP;
+    uint32_t clear       = 0;
+    uint32_t crc32;
+    uint32_t rate        = 0;
+    uint32_t samples     = 0;
+    uint32_t outside     = 0;
+    uint32_t shift       = 0;
+    uint32_t first;
+    uint32_t left        = 1;
+    uint32_t in_reply;
+    uint32_t entries     = 0;
+    uint32_t polls       = 0;
+    uint32_t index;
+    uint32_t function;
+    uint32_t bucket_start;
+    uint32_t bucket_end;
+    uint32_t overlap_start;
+    uint32_t overlap_end;
+    uint32_t covered;
+    double   unresolved  = 0;
+    int      functions;
+    int      started     = 0;
+
+    printf("\n   New sampling rate in Hz (%d-%d, 0 to stop, %d to keep as it is) : ", 5, 10000, BL_PROFILE_RATE_KEEP);
+    scanf(" %u",&new_rate);
+    if(new_rate != BL_PROFILE_RATE_KEEP && new_rate != 0 && (new_rate < 5 || new_rate > 10000))
+    {
+        printf("\n   Rate not supported\n");
+        return;
+    }
+    printf("\n   Clear the histogram after reading it (1) or keep it (0) : ");
+    scanf(" %u",&clear);
+    printf("\n   Bootloader map file (. for %s) : ", PROFILE_DEFAULT_MAP);
+    scanf(" %259s",map_name);
+    if(strcmp(map_name, ".") == 0) strcpy(map_name, PROFILE_DEFAULT_MAP);
+
+    command[0] = COMMAND_BL_GET_PROFILE_LEN-1;
+    command[1] = COMMAND_BL_GET_PROFILE;
+    command[2] = word_to_byte(new_rate,1,1);
+    command[3] = word_to_byte(new_rate,2,1);
+    command[4] = (clear != 0);
+    crc32      = get_crc(command,COMMAND_BL_GET_PROFILE_LEN-4);
+    command[5] = word_to_byte(crc32,1,1);
+    command[6] = word_to_byte(crc32,2,1);
+    command[7] = word_to_byte(crc32,3,1);
+    command[8] = word_to_byte(crc32,4,1);
+    hex2char(command,command_chars,COMMAND_BL_GET_PROFILE_LEN);
+    HOST_voidSendCommand(command_chars,COMMAND_BL_GET_PROFILE_LEN*2);
+    printf("\n   Waiting for bootloader to stream its histogram\n");
+
+    /*Keep polling the responses channel, every new reply resets the timeout*/
+    while(left && polls < PROFILE_TIMEOUT_POLLS)
+    {
+        HOST_voidReceiveCommand(reply_chars);
+        if(char2hex(reply_chars,reply,2) != 0 || reply[0] != 0xA5 ||
+           reply[1] < BL_GET_PROFILE_HEADER_LEN || char2hex(&reply_chars[4],&reply[2],reply[1]) != 0)
+        {
+            if(reply[0] == 0x7F)
+            {
+                printf("\n   CRC: FAIL \n");
+                return;
+            }
+            polls++;
+            Sleep(PROFILE_POLL_MS);
+            continue;
+        }
+        first    = reply[13] | (reply[14]<<8);
+        in_reply = reply[17];
+        /*Same reply as last poll, wait for the next one*/
+        if(started && first < entries)
+        {
+            polls++;
+            Sleep(PROFILE_POLL_MS);
+            continue;
+        }
+        started = 1;
+        rate    = reply[2] | (reply[3]<<8);
+        samples = *((uint32_t*)&reply[4]);
+        outside = *((uint32_t*)&reply[8]);
+        shift   = reply[12];
+        left    = reply[15] | (reply[16]<<8);
+        if(first > entries) printf("\n   Missed histogram entries %u to %u", entries, first-1);
+        for(index=0; index<in_reply && entries<PROFILE_MAX_ENTRIES; index++)
+        {
+            buckets[entries]        = reply[2+BL_GET_PROFILE_HEADER_LEN+index*6] | (reply[3+BL_GET_PROFILE_HEADER_LEN+index*6]<<8);
+            bucket_samples[entries] = *((uint32_t*)&reply[4+BL_GET_PROFILE_HEADER_LEN+index*6]);
+            entries++;
+        }
+        polls = 0;
+        printf("\r   Histogram : %u buckets received, %u left  ", entries, left);
+    }
+    if(!started)
+    {
+        printf("\n   No reply from bootloader\n");
+        return;
+    }
+    if(left) printf("\n   Bootloader stopped streaming, %u buckets were not received", left);
+
+    printf("\n\n   %u samples (%s at %u Hz), %u outside the bootloader code", samples, rate? "sampling" : "stopped", rate, outside);
+    if(samples == 0)
+    {
+        printf("\n");
+        return;
+    }
+
+    functions = profile_read_map(map_name);
+    if(functions < 0)
+    {
+        printf("\n   Could not open %s, raw buckets :", map_name);
+        for(index=0; index<entries; index++)
+            printf("\n     %#.8x  %8u  %5.1f %%", PROFILE_CODE_START+(buckets[index]<<shift), bucket_samples[index], 100.0*bucket_samples[index]/samples);
+        printf("\n");
+        return;
+    }
+
+    /*Split every bucket between the functions it holds*/
+    for(index=0; index<entries; index++)
+    {
+        bucket_start = PROFILE_CODE_START+(buckets[index]<<shift);
+        bucket_end   = bucket_start+(1u<<shift);
+        covered      = 0;
+        for(function=0; function<(uint32_t)functions; function++)
+        {
+            overlap_start = (profile_functions[function].address > bucket_start)? profile_functions[function].address : bucket_start;
+            overlap_end   = (profile_functions[function].address+profile_functions[function].size < bucket_end)?
+                            profile_functions[function].address+profile_functions[function].size : bucket_end;
+            if(overlap_end <= overlap_start) continue;
+            profile_functions[function].samples += (double)bucket_samples[index]*(overlap_end-overlap_start)/(1u<<shift);
+            covered += overlap_end-overlap_start;
+        }
+        if(covered < (1u<<shift)) unresolved += (double)bucket_samples[index]*((1u<<shift)-covered)/(1u<<shift);
+    }
+    qsort(profile_functions, functions, sizeof(profile_functions[0]), profile_compare_samples);
+
+    printf("\n\n   %-40s %10s %8s", "Function", "Samples", "Share");
+    for(function=0; function<PROFILE_TOP_FUNCTIONS && function<(uint32_t)functions && profile_functions[function].samples > 0; function++)
+        printf("\n   %-40s %10.0f %7.1f %%", profile_functions[function].name, profile_functions[function].samples, 100.0*profile_functions[function].samples/samples);
+    if(unresolved > 0) printf("\n   %-40s %10.0f %7.1f %%", "(not in map)", unresolved, 100.0*unresolved/samples);
+    if(outside)        printf("\n   %-40s %10u %7.1f %%", "(outside the bootloader)", outside, 100.0*outside/samples);
+    printf("\n");
+}
@@ -0,0 +1,440 @@
+/* This file implements a stand-in of the bootloader on the push transport and in LAN direct mode, so the commands sent with
+ * HOST_voidSendCommand / HOST_voidReceiveCommand (push_server.c) can be run and timed on this PC without a board.
+ * Push transport : the board connects to 127.0.0.1 like the module does (AT+CIPSTART), again every second while nobody listens.
+ * LAN direct : the board listens on 127.0.0.1 like the module server (AT+CIPSERVER) and the host connects to it.
+ * The frames are the ones of the bootloader (length as 4 hex chars then the chars), and the board works the way the bootloader does :
+ * it reads the module every BL_LINK_POLL_MS, a read is one AT+CIPRECVDATA of WIFI_PASSIVE_READ_SIZE chars at most and a reply
+ * is AT+CIPSEND, the 20 ms wait for the prompt and the frame, every char of these exchanges takes its time on the 115200 baud
+ * UART of the module.
+ * A command is checked (packet CRC) like the bootloader does, BL_GET_VER, BL_FLASH_ERASE and BL_MEM_WRITE are run, the others
+ * are answered with a NACK. In LAN direct mode BL_MEM_WRITE fetches the published text of the image from the host with data
+ * requests ('D' frames) and checks the manifest, every chunk and the whole image, like the bootloader.
+ * With the push transport the image comes from the channels, the board drops the connection for the time of the download
+ * (one 1 KB page every PUSH_BOARD_CHANNEL_PAGE_MS) and connects again to send its reply, as the bootloader does.
+ * This file is Windows only (threads and winsock)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <winsock2.h>
+#include "main.h"
+#include "HTTP_interface.h"
+
+//Times of the bootloader and of its module
+#define PUSH_BOARD_POLL_MS              100     //BL_LINK_POLL_MS
+#define PUSH_BOARD_READ_SIZE            192     //WIFI_PASSIVE_READ_SIZE
+#define PUSH_BOARD_LAN_POLL_MS          10      //WIFI_LAN_POLL_MS, reads while the answer to a data request is on its way
+#define PUSH_BOARD_LAN_DATA_TIMEOUT_MS  5000    //WIFI_LAN_DATA_TIMEOUT_MS
+#define PUSH_BOARD_WINDOW_CHARS         2048    //WIFI_RECEIVE_ARRAY_SIZE, chars asked for by one data request
+#define PUSH_BOARD_PROMPT_MS            20      //wait for the prompt of AT+CIPSEND
+#define PUSH_BOARD_MODULE_US            2000    //turnaround of the module for one AT command
+#define PUSH_BOARD_CHAR_US              87      //one char (10 bits) at 115200 baud
+#define PUSH_BOARD_READ_AT_CHARS        60      //AT+CIPRECVDATA=0,192 then +CIPRECVDATA:192, and OK
+#define PUSH_BOARD_SEND_AT_CHARS        50      //AT+CIPSEND=0,n then OK and the prompt, Recv n bytes and SEND OK
+#define PUSH_BOARD_ERASE_PAGE_MS        20      //page erase of the STM32F103 (datasheet typical)
+#define PUSH_BOARD_PROGRAM_PAGE_US      26880   //512 half words of 52.5 us
+#define PUSH_BOARD_CHANNEL_PAGE_MS      3200    //fetch of one 1 KB window from the channels (three waits of 1 s and 2 KB of chars)
+#define PUSH_BOARD_RETRY_MS             1000    //time between two connections of the module to the push server
+
+#define PUSH_BOARD_FRAME_CHARS          HTTP_PUSH_BUFFER_SIZE
+#define PUSH_BOARD_DATA_REQUEST_CHARS   13      //'D', first char (8 hex chars), number of chars (4 hex chars)
+#define PUSH_BOARD_VERSION              0x10
+
+static SOCKET           push_board_listen_socket = INVALID_SOCKET;
+static SOCKET           push_board_socket = INVALID_SOCKET;
+static HANDLE           push_board_thread_handle;
+static volatile uint8_t push_board_running;
+static uint8_t          push_board_lan_direct;
+static uint16_t         push_board_port;
+static uint32_t         push_board_debt_us;    //time of the module not slept yet, Sleep takes whole ms
+static uint8_t          push_board_image[IMAGE_MAX_CHUNKS*IMAGE_CHUNK_SIZE];
+
+//Counters printed with the latency
+static uint32_t push_board_connections;
+static uint32_t push_board_polls;
+static uint32_t push_board_commands;
+static uint32_t push_board_nacks;
+static uint32_t push_board_data_requests;
+
+
+//Takes the time the module and the UART of the bootloader take
+static void push_board_wait(uint32_t micro_seconds)
+{
+    push_board_debt_us += micro_seconds;
+    if(push_board_debt_us >= 1000)
+    {
+        Sleep(push_board_debt_us/1000);
+        push_board_debt_us %= 1000;
+    }
+}
+
+//Time of one AT+CIPRECVDATA that returns (chars)
+static uint32_t push_board_read_us(uint32_t chars)
+{
+    return PUSH_BOARD_MODULE_US + (PUSH_BOARD_READ_AT_CHARS+chars)*PUSH_BOARD_CHAR_US;
+}
+
+//Drops the connection, the frames start again on the next one
+static void push_board_drop(void)
+{
+    if(push_board_socket != INVALID_SOCKET)
+    {
+        closesocket(push_board_socket);
+        push_board_socket = INVALID_SOCKET;
+    }
+}
+
+//Opens the link like WIFI_u8LinkOpen : connects to the push server, or takes the connection of the host in LAN direct mode
+static void push_board_open(void)
+{
+    struct sockaddr_in address;
+    struct timeval     timeout = {0, PUSH_BOARD_POLL_MS*1000};
+    fd_set             read_set;
+    SOCKET             link;
+
+    if(push_board_lan_direct)
+    {
+        FD_ZERO(&read_set);
+        FD_SET(push_board_listen_socket, &read_set);
+        if(select(push_board_listen_socket+1, &read_set, NULL, NULL, &timeout) <= 0) return;
+        push_board_socket = accept(push_board_listen_socket, NULL, NULL);
+    }
+    else
+    {
+        memset(&address, 0, sizeof(address));
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port        = htons(push_board_port);
+        link = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if(link == INVALID_SOCKET) return;
+        if(connect(link, (struct sockaddr*)&address, sizeof(address)) == SOCKET_ERROR)
+        {
+            closesocket(link);
+            Sleep(PUSH_BOARD_RETRY_MS);
+            return;
+        }
+        push_board_socket = link;
+    }
+    if(push_board_socket != INVALID_SOCKET) push_board_connections++;
+}
+
+//Reads (count) chars the way WIFI_u8LinkReadAll does, one read of the module for every PUSH_BOARD_READ_SIZE chars
+//returns 0 if the connection broke
+static uint8_t push_board_read_all(uint8_t* chars, uint32_t count)
+{
+    uint32_t part;
+    int      received;
+
+    while(count != 0)
+    {
+        part = (count > PUSH_BOARD_READ_SIZE)? PUSH_BOARD_READ_SIZE : count;
+        count -= part;
+        push_board_wait(push_board_read_us(part));
+        while(part != 0)
+        {
+            received = recv(push_board_socket, chars, part, 0);
+            if(received <= 0) return 0;
+            chars += received;
+            part  -= received;
+        }
+    }
+    return 1;
+}
+
+//Takes the next frame like WIFI_u8LinkReceiveFrame if one came, waits at most (timeout) ms for its first char
+//returns the number of chars (ended by a null), -1 if no frame came
+static int32_t push_board_receive_frame(uint8_t* chars, uint32_t size, uint32_t timeout_ms)
+{
+    struct timeval timeout = {timeout_ms/1000, (timeout_ms%1000)*1000};
+    fd_set         read_set;
+    uint8_t        header[HTTP_PUSH_FRAME_HEADER_SIZE+1] = {0};
+    uint32_t       length;
+
+    FD_ZERO(&read_set);
+    FD_SET(push_board_socket, &read_set);
+    if(select(push_board_socket+1, &read_set, NULL, NULL, &timeout) <= 0)
+    {
+        //the empty read of the poll
+        push_board_wait(push_board_read_us(0));
+        return -1;
+    }
+    if(!push_board_read_all(header, HTTP_PUSH_FRAME_HEADER_SIZE))
+    {
+        push_board_drop();
+        return -1;
+    }
+    length = strtoul((char*)header, NULL, 16);
+    if(length >= size || !push_board_read_all(chars, length))
+    {
+        push_board_drop();
+        return -1;
+    }
+    chars[length] = '\0';
+    return length;
+}
+
+//Sends one frame like WIFI_u8LinkSendFrame, returns 0 if the connection broke
+static uint8_t push_board_send_frame(uint8_t* chars, uint32_t count)
+{
+    uint8_t header[HTTP_PUSH_FRAME_HEADER_SIZE+1];
+
+    sprintf((char*)header, "%04X", count);
+    push_board_wait(PUSH_BOARD_MODULE_US + PUSH_BOARD_SEND_AT_CHARS*PUSH_BOARD_CHAR_US);
+    push_board_wait(PUSH_BOARD_PROMPT_MS*1000 + (HTTP_PUSH_FRAME_HEADER_SIZE+count)*PUSH_BOARD_CHAR_US);
+    if(send(push_board_socket, header, HTTP_PUSH_FRAME_HEADER_SIZE, 0) != HTTP_PUSH_FRAME_HEADER_SIZE ||
+       send(push_board_socket, chars, count, 0) != (int)count)
+    {
+        push_board_drop();
+        return 0;
+    }
+    return 1;
+}
+
+//Builds the chars of a reply : ack, length to follow and the bytes
+static void push_board_reply(uint8_t* reply, uint8_t* bytes, uint8_t len)
+{
+    uint8_t packet[16];
+
+    packet[0] = 0xA5;
+    packet[1] = len;
+    memcpy(&packet[2], bytes, len);
+    hex2char(packet, reply, len+2);
+    reply[(len+2)*2] = '\0';
+}
+
+//Asks the host for chars of the image text like WIFI_u8LanReceiveData, returns the number of chars that came, -1 if none did
+static int32_t push_board_data_request(uint32_t first, uint32_t count, uint8_t* chars)
+{
+    uint8_t  request[PUSH_BOARD_DATA_REQUEST_CHARS+1];
+    uint32_t waited;
+    int32_t  received;
+
+    sprintf((char*)request, "D%08X%04X", first, count);
+    push_board_data_requests++;
+    if(!push_board_send_frame(request, PUSH_BOARD_DATA_REQUEST_CHARS)) return -1;
+    for(waited=0; waited<PUSH_BOARD_LAN_DATA_TIMEOUT_MS && push_board_socket!=INVALID_SOCKET; waited+=PUSH_BOARD_LAN_POLL_MS)
+    {
+        received = push_board_receive_frame(chars, PUSH_BOARD_WINDOW_CHARS+1, PUSH_BOARD_LAN_POLL_MS);
+        if(received >= 0) return received;
+    }
+    return -1;
+}
+
+//LAN direct BL_MEM_WRITE : fetches the manifest and the windows of the image from the host, every chunk is checked against
+//the manifest and programmed, then the whole image is checked, returns the BL_MEM_WRITE status
+static uint8_t push_board_lan_mem_write(uint32_t len, uint32_t image_crc, uint32_t manifest_crc)
+{
+    static uint8_t chars[PUSH_BOARD_WINDOW_CHARS+1];
+    uint32_t manifest[IMAGE_MAX_CHUNKS];
+    uint32_t chunks = (len+IMAGE_CHUNK_SIZE-1)/IMAGE_CHUNK_SIZE;
+    uint32_t chunk;
+    uint32_t chunk_len;
+
+    if(len == 0 || chunks > IMAGE_MAX_CHUNKS) return BL_MEM_WRITE_ADDR_INVALID;
+    //the manifest is published after the chunks, every chunk takes 2 KB of chars
+    if(push_board_data_request(chunks*IMAGE_CHUNK_SIZE*2, chunks*8, chars) != (int32_t)(chunks*8) ||
+       char2hex(chars, (uint8_t*)manifest, chunks*4) < 0 || get_crc_words((uint8_t*)manifest, chunks*4) != manifest_crc)
+    {
+        return BL_MEM_WRITE_MANIFEST_FAIL;
+    }
+    for(chunk=0; chunk<chunks; chunk++)
+    {
+        chunk_len = (len-chunk*IMAGE_CHUNK_SIZE >= IMAGE_CHUNK_SIZE)? IMAGE_CHUNK_SIZE : len-chunk*IMAGE_CHUNK_SIZE;
+        if(push_board_data_request(chunk*PUSH_BOARD_WINDOW_CHARS, PUSH_BOARD_WINDOW_CHARS, chars) != PUSH_BOARD_WINDOW_CHARS ||
+           char2hex(chars, &push_board_image[chunk*IMAGE_CHUNK_SIZE], IMAGE_CHUNK_SIZE) < 0 ||
+           get_crc_words(&push_board_image[chunk*IMAGE_CHUNK_SIZE], chunk_len) != manifest[chunk])
+        {
+            return BL_MEM_WRITE_CHUNK_FAIL;
+        }
+        push_board_wait(PUSH_BOARD_ERASE_PAGE_MS*1000 + PUSH_BOARD_PROGRAM_PAGE_US);
+    }
+    return (get_crc_words(push_board_image, len) == image_crc)? BL_MEM_WRITE_OK : BL_MEM_WRITE_IMAGE_CRC_FAIL;
+}
+
+//Checks a command like the bootloader does and runs it, fills the chars of the reply
+static void push_board_run_command(uint8_t* command, uint32_t chars, uint8_t* reply)
+{
+    uint8_t  packet[PUSH_BOARD_FRAME_CHARS/2];
+    uint8_t  status;
+    uint32_t len;
+    uint32_t crc;
+    uint32_t image_len;
+    uint32_t image_crc;
+    uint32_t manifest_crc;
+
+    strcpy((char*)reply, "7F");
+    if(chars < 4 || char2hex(command, packet, 1) < 0) return;
+    len = packet[0]+1;
+    push_board_commands++;
+    if(len < 6 || chars < len*2 || char2hex(command, packet, len) < 0)
+    {
+        push_board_nacks++;
+        return;
+    }
+    memcpy(&crc, &packet[len-4], 4);
+    if(get_crc(packet, len-4) != crc)
+    {
+        push_board_nacks++;
+        return;
+    }
+
+    switch(packet[1])
+    {
+    case COMMAND_BL_GET_VER:
+        status = PUSH_BOARD_VERSION;
+        push_board_reply(reply, &status, 1);
+        return;
+    case COMMAND_BL_FLASH_ERASE:
+        push_board_wait(packet[6]*PUSH_BOARD_ERASE_PAGE_MS*1000);
+        status = 1;                     //ErrorStatus, OK is 1
+        push_board_reply(reply, &status, 1);
+        return;
+    case COMMAND_BL_MEM_WRITE:
+        if(len != COMMAND_BL_MEM_WRITE_START_LEN) break;
+        memcpy(&image_len,    &packet[6],  4);
+        memcpy(&image_crc,    &packet[10], 4);
+        memcpy(&manifest_crc, &packet[14], 4);
+        if(push_board_lan_direct)
+        {
+            status = push_board_lan_mem_write(image_len, image_crc, manifest_crc);
+        }
+        else
+        {
+            //the module has one connection, the one to the push server is opened again after the download
+            push_board_drop();
+            Sleep(((image_len+IMAGE_CHUNK_SIZE-1)/IMAGE_CHUNK_SIZE)*(PUSH_BOARD_CHANNEL_PAGE_MS+PUSH_BOARD_ERASE_PAGE_MS));
+            status = BL_MEM_WRITE_OK;
+        }
+        push_board_reply(reply, &status, 1);
+        return;
+    }
+    push_board_nacks++;
+}
+
+//Board thread : polls the link every PUSH_BOARD_POLL_MS and answers the commands on it
+static DWORD WINAPI push_board_thread(LPVOID param)
+{
+    static uint8_t command[PUSH_BOARD_FRAME_CHARS+1];
+    uint8_t  reply[64];
+    int32_t  chars;
+
+    while(push_board_running)
+    {
+        if(push_board_socket == INVALID_SOCKET)
+        {
+            push_board_open();
+            continue;
+        }
+        Sleep(PUSH_BOARD_POLL_MS);
+        push_board_polls++;
+        chars = push_board_receive_frame(command, sizeof(command), 0);
+        if(chars < 0) continue;
+        push_board_run_command(command, chars, reply);
+        while(push_board_running && push_board_socket == INVALID_SOCKET) push_board_open();
+        if(push_board_socket != INVALID_SOCKET) push_board_send_frame(reply, strlen((char*)reply));
+    }
+    return 0;
+}
+
+//Starts the stand-in in the background, before the push server is started or the bootloader is connected to (main)
+//lan_direct : 0 the board connects to the push server on (port), 1 the board listens on (port)
+void push_board_start(uint8_t lan_direct, uint16_t port)
+{
+    struct sockaddr_in address;
+    WSADATA  wsa_data;
+
+    if(push_board_running) return;
+    if(WSAStartup(MAKEWORD(2,2), &wsa_data) != 0){printf("\n   Winsock failed!!\r\n");return;}
+    push_board_lan_direct = lan_direct;
+    push_board_port       = port;
+    if(lan_direct)
+    {
+        push_board_listen_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        memset(&address, 0, sizeof(address));
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port        = htons(port);
+        if(push_board_listen_socket == INVALID_SOCKET ||
+           bind(push_board_listen_socket, (struct sockaddr*)&address, sizeof(address)) == SOCKET_ERROR ||
+           listen(push_board_listen_socket, 1) == SOCKET_ERROR)
+        {
+            printf("\n   Port %u is not free!!\r\n", port);
+            if(push_board_listen_socket != INVALID_SOCKET) closesocket(push_board_listen_socket);
+            push_board_listen_socket = INVALID_SOCKET;
+            return;
+        }
+    }
+    push_board_connections = push_board_polls = push_board_commands = push_board_nacks = push_board_data_requests = 0;
+    push_board_debt_us = 0;
+    push_board_running = 1;
+    push_board_thread_handle = CreateThread(NULL, 0, push_board_thread, NULL, 0, NULL);
+    printf("   Simulated bootloader %s 127.0.0.1:%u\n", lan_direct? "listening on" : "connecting to", port);
+}
+
+static int push_board_compare(const void* first, const void* second)
+{
+    uint32_t a = *(const uint32_t*)first;
+    uint32_t b = *(const uint32_t*)second;
+    return (a > b) - (a < b);
+}
+
+//Sends BL_GET_VER a number of times over the push transport or LAN direct and prints the time from the command to its reply
+void push_latency_run(void)
+{
+    uint8_t   data_buf[COMMAND_BL_GET_VER_LEN];
+    uint8_t   command[COMMAND_BL_GET_VER_LEN*2+1];
+    uint8_t   reply[HTTP_PUSH_BUFFER_SIZE];
+    uint8_t   ack[2];
+    uint32_t* times;
+    uint32_t  count = 50;
+    uint32_t  done = 0;
+    uint32_t  failed = 0;
+    uint32_t  total = 0;
+    uint32_t  start;
+    uint32_t  crc32;
+
+    if(!HOST_u8PushIsActive()){printf("\n   Choose the push server or LAN direct at startup!!\r\n");return;}
+    printf("\n   Enter number of commands : ");
+    scanf(" %u", &count);
+    if(count == 0) return;
+    times = malloc(count*sizeof(uint32_t));
+    if(times == NULL){printf("\n   Not enough memory!!\r\n");return;}
+
+    data_buf[0] = COMMAND_BL_GET_VER_LEN-1;
+    data_buf[1] = COMMAND_BL_GET_VER;
+    crc32       = get_crc(data_buf, COMMAND_BL_GET_VER_LEN-4);
+    memcpy(&data_buf[2], &crc32, 4);
+    hex2char(data_buf, command, COMMAND_BL_GET_VER_LEN);
+
+    while(done+failed < count)
+    {
+        start = GetTickCount();
+        if(HOST_voidSendCommand(command, COMMAND_BL_GET_VER_LEN*2) == STATUS_OK &&
+           HOST_voidReceiveCommand(reply) == STATUS_OK &&
+           char2hex(reply, ack, 2) >= 0 && ack[0] == 0xA5)
+        {
+            times[done] = GetTickCount()-start;
+            total += times[done++];
+        }
+        else
+        {
+            failed++;
+        }
+    }
+    if(done != 0)
+    {
+        qsort(times, done, sizeof(uint32_t), push_board_compare);
+        printf("\n   %u commands answered, %u failed : mean %u ms, min %u ms, median %u ms, p99 %u ms, max %u ms\n",
+               done, failed, total/done, times[0], times[done/2], times[(done*99)/100], times[done-1]);
+    }
+    else
+    {
+        printf("\n   No command answered!!\r\n");
+    }
+    if(push_board_running)
+    {
+        printf("   Simulated bootloader : %u connections, %u polls, %u commands (%u NACKs), %u data requests\n",
+               push_board_connections, push_board_polls, push_board_commands, push_board_nacks, push_board_data_requests);
+    }
+    free(times);
+}
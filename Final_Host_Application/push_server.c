@@ -0,0 +1,399 @@
+/* This file implements the push transport : the host listens on a TCP port and the bootloader keeps one connection open to it,
+ * so a command reaches the bootloader on its next poll of the module (about 100 ms) instead of its next poll of the channel (15 s),
+ * and the reply comes back on the same connection as soon as it is sent.
+ * A frame is its length as 4 hex chars (most significant first) followed by that many chars, the same hex chars as on the channels.
+ * The bootloader drops the connection while it talks to the channels (image data) and connects again after,
+ * so a new connection always replaces the previous one and a frame cut by a drop is discarded.
+ * The listener takes connections on every interface, so a stand-in of the bootloader on the same PC (127.0.0.1)
+ * can be used to test the host alone.
+ * In LAN direct mode the bootloader is the server (on the module) and this application connects to it, the frames are the same
+ * and the image is served from here too : the bootloader asks for a window of the image text with a data request frame
+ * ('D', the first char as 8 hex chars, the number of chars as 4 hex chars) and gets the chars of the published text file back.
+ * This file is Windows only (winsock)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <winsock2.h>
+
+#include "main.h"
+#include "HTTP_interface.h"
+
+/*Data request of the LAN direct mode : 'D' then 8 hex chars (first char) and 4 hex chars (number of chars)*/
+#define HOST_LAN_DATA_REQUEST       'D'
+#define HOST_LAN_DATA_REQUEST_SIZE  13
+#define HOST_LAN_DATA_MAX_CHARS     4096
+/*Time between two connection attempts to the bootloader*/
+#define HOST_LAN_RETRY_MS           1000
+
+/*Listening socket of the push transport, INVALID_SOCKET while the push transport is off*/
+static SOCKET static_ListenSocket=INVALID_SOCKET;
+/*Connection of the bootloader, INVALID_SOCKET while it is not connected*/
+static SOCKET static_DeviceSocket=INVALID_SOCKET;
+/*Set in LAN direct mode, the bootloader is then connected to at static_LanAddress instead of listened for*/
+static u8 static_u8LanDirect=0;
+static struct sockaddr_in static_LanAddress;
+
+/*Description: This function will drop the connection of the bootloader
+Parameters: void
+Return: void*/
+static void HOST_voidPushDrop (void)
+{
+    if (static_DeviceSocket!=INVALID_SOCKET)
+    {
+        closesocket(static_DeviceSocket);
+        static_DeviceSocket=INVALID_SOCKET;
+    }
+}
+
+/*Description: This function will try once to connect to the bootloader (LAN direct mode)
+Parameters: void
+Return: Error Status (u8)*/
+static u8 HOST_u8LanConnect (void)
+{
+    SOCKET Local_Socket=socket(AF_INET,SOCK_STREAM,IPPROTO_TCP);
+
+    if (Local_Socket==INVALID_SOCKET)
+    {
+        return STATUS_NOK;
+    }
+    if (connect(Local_Socket,(struct sockaddr *)&static_LanAddress,sizeof(static_LanAddress))==SOCKET_ERROR)
+    {
+        closesocket(Local_Socket);
+        return STATUS_NOK;
+    }
+    static_DeviceSocket=Local_Socket;
+    #if HTTP_DEBUG_MODE==1
+    printf("\n   Connected to the bootloader\n");
+    #endif
+    return STATUS_OK;
+}
+
+/*Description: This function will wait until the bootloader connects or sends something
+ * In LAN direct mode the connection is made again from here when the bootloader dropped it
+Parameters: Time to wait in ms (u32)
+Return: 0 if the time is over, 1 if chars are waiting on the connection, 2 if a new connection replaced the previous one*/
+static u8 HOST_u8PushWait (u32 Copy_u32TimeoutMs)
+{
+    fd_set Local_ReadSet;
+    struct timeval Local_Timeout;
+    SOCKET Local_Socket;
+
+    if (static_u8LanDirect && static_DeviceSocket==INVALID_SOCKET)
+    {
+        if (HOST_u8LanConnect()==STATUS_OK)
+        {
+            return 2;
+        }
+        Sleep((Copy_u32TimeoutMs<HOST_LAN_RETRY_MS)? Copy_u32TimeoutMs : HOST_LAN_RETRY_MS);
+        return 0;
+    }
+    FD_ZERO(&Local_ReadSet);
+    if (static_ListenSocket!=INVALID_SOCKET)
+    {
+        FD_SET(static_ListenSocket,&Local_ReadSet);
+    }
+    if (static_DeviceSocket!=INVALID_SOCKET)
+    {
+        FD_SET(static_DeviceSocket,&Local_ReadSet);
+    }
+    Local_Timeout.tv_sec=Copy_u32TimeoutMs/1000;
+    Local_Timeout.tv_usec=(Copy_u32TimeoutMs%1000)*1000;
+
+    /*The first argument is ignored by winsock*/
+    if (select(0,&Local_ReadSet,NULL,NULL,&Local_Timeout)<=0)
+    {
+        return 0;
+    }
+    if (static_ListenSocket!=INVALID_SOCKET && FD_ISSET(static_ListenSocket,&Local_ReadSet))
+    {
+        Local_Socket=accept(static_ListenSocket,NULL,NULL);
+        if (Local_Socket!=INVALID_SOCKET)
+        {
+            HOST_voidPushDrop();
+            static_DeviceSocket=Local_Socket;
+            #if HTTP_DEBUG_MODE==1
+            printf("\n   Bootloader connected to the push server\n");
+            #endif
+            return 2;
+        }
+    }
+    if (static_DeviceSocket!=INVALID_SOCKET && FD_ISSET(static_DeviceSocket,&Local_ReadSet))
+    {
+        return 1;
+    }
+    return 0;
+}
+
+/*Description: This API will be used to listen for the bootloader on a port and wait for its first connection
+Parameters: Port (u16), Time to wait for the bootloader in ms (u32)
+Return: Error Status (u8), NOK if the port cannot be taken or the bootloader did not connect, the push transport is then off*/
+u8 HOST_u8StartPushServer (u16 Copy_u16Port, u32 Copy_u32TimeoutMs)
+{
+    WSADATA Local_Wsa;
+    struct sockaddr_in Local_Address;
+    u32 Local_u32Start;
+
+    if (static_ListenSocket!=INVALID_SOCKET)
+    {
+        return STATUS_OK;
+    }
+    if (WSAStartup(MAKEWORD(2,2),&Local_Wsa)!=0)
+    {
+        return STATUS_NOK;
+    }
+    static_ListenSocket=socket(AF_INET,SOCK_STREAM,IPPROTO_TCP);
+    if (static_ListenSocket==INVALID_SOCKET)
+    {
+        printf("Could not create socket : %d",WSAGetLastError());
+        WSACleanup();
+        return STATUS_NOK;
+    }
+    Local_Address.sin_family=AF_INET;
+    Local_Address.sin_addr.s_addr=htonl(INADDR_ANY);
+    Local_Address.sin_port=htons(Copy_u16Port);
+    if (bind(static_ListenSocket,(struct sockaddr *)&Local_Address,sizeof(Local_Address))==SOCKET_ERROR ||
+        listen(static_ListenSocket,1)==SOCKET_ERROR)
+    {
+        printf("Could not listen on port %u : %d",Copy_u16Port,WSAGetLastError());
+        HOST_voidStopPushServer();
+        return STATUS_NOK;
+    }
+
+    /*The bootloader tries the push server before every poll of the channel*/
+    Local_u32Start=GetTickCount();
+    while (static_DeviceSocket==INVALID_SOCKET)
+    {
+        u32 Local_u32Elapsed=GetTickCount()-Local_u32Start;
+        if (Local_u32Elapsed>=Copy_u32TimeoutMs)
+        {
+            HOST_voidStopPushServer();
+            return STATUS_NOK;
+        }
+        HOST_u8PushWait(Copy_u32TimeoutMs-Local_u32Elapsed);
+    }
+    return STATUS_OK;
+}
+
+/*Description: This API will be used to connect to the bootloader in LAN direct mode (its module is the server), the connection
+ * is tried again until the time is over, the bootloader starts its server on its first poll
+Parameters: IP address of the module (u8*), Port (u16), Time to wait for the bootloader in ms (u32)
+Return: Error Status (u8), NOK if the address is wrong or the bootloader could not be reached, the LAN direct mode is then off*/
+u8 HOST_u8ConnectToBootloader (u8* Copy_u8Address, u16 Copy_u16Port, u32 Copy_u32TimeoutMs)
+{
+    WSADATA Local_Wsa;
+    u32 Local_u32Start;
+
+    if (HOST_u8PushIsActive())
+    {
+        return STATUS_OK;
+    }
+    static_LanAddress.sin_family=AF_INET;
+    static_LanAddress.sin_addr.s_addr=inet_addr(Copy_u8Address);
+    static_LanAddress.sin_port=htons(Copy_u16Port);
+    if (static_LanAddress.sin_addr.s_addr==INADDR_NONE)
+    {
+        printf("Wrong address %s",Copy_u8Address);
+        return STATUS_NOK;
+    }
+    if (WSAStartup(MAKEWORD(2,2),&Local_Wsa)!=0)
+    {
+        return STATUS_NOK;
+    }
+    static_u8LanDirect=1;
+
+    Local_u32Start=GetTickCount();
+    while (static_DeviceSocket==INVALID_SOCKET)
+    {
+        u32 Local_u32Elapsed=GetTickCount()-Local_u32Start;
+        if (Local_u32Elapsed>=Copy_u32TimeoutMs)
+        {
+            HOST_voidStopPushServer();
+            return STATUS_NOK;
+        }
+        HOST_u8PushWait(Copy_u32TimeoutMs-Local_u32Elapsed);
+    }
+    return STATUS_OK;
+}
+
+/*Description: This API will be used to stop the push transport or the LAN direct mode, the channels are used again
+Parameters: void
+Return: void*/
+void HOST_voidStopPushServer (void)
+{
+    if (static_ListenSocket!=INVALID_SOCKET)
+    {
+        HOST_voidPushDrop();
+        closesocket(static_ListenSocket);
+        static_ListenSocket=INVALID_SOCKET;
+        WSACleanup();
+    }
+    if (static_u8LanDirect)
+    {
+        HOST_voidPushDrop();
+        static_u8LanDirect=0;
+        WSACleanup();
+    }
+}
+
+/*Description: This API will tell whether the push transport or the LAN direct mode is on
+Parameters: void
+Return: 1 if on, 0 otherwise (u8)*/
+u8 HOST_u8PushIsActive (void)
+{
+    return (static_ListenSocket!=INVALID_SOCKET || static_u8LanDirect);
+}
+
+/*Description: This API will be used to send a frame to the bootloader, waiting for it to connect if it is not connected
+ * Replies left from earlier commands (late or not waited for) are dropped first, so they are never taken for the reply of this one
+Parameters: Chars (u8*), Number of chars (u16), Time to wait for the bootloader in ms (u32)
+Return: Error Status (u8)*/
+u8 HOST_u8PushSendFrame (u8* Copy_u8Chars, u16 Copy_u16Size, u32 Copy_u32TimeoutMs)
+{
+    u8  Local_u8Header[HTTP_PUSH_FRAME_HEADER_SIZE+1];
+    u8  Local_u8Stale[256];
+    u32 Local_u32Start=GetTickCount();
+    u32 Local_u32Elapsed;
+
+    if (!HOST_u8PushIsActive())
+    {
+        return STATUS_NOK;
+    }
+    while (static_DeviceSocket!=INVALID_SOCKET && HOST_u8PushWait(0)!=0)
+    {
+        if (static_DeviceSocket!=INVALID_SOCKET && recv(static_DeviceSocket,Local_u8Stale,sizeof(Local_u8Stale),0)<=0)
+        {
+            HOST_voidPushDrop();
+        }
+    }
+    while (static_DeviceSocket==INVALID_SOCKET)
+    {
+        Local_u32Elapsed=GetTickCount()-Local_u32Start;
+        if (Local_u32Elapsed>=Copy_u32TimeoutMs)
+        {
+            return STATUS_NOK;
+        }
+        HOST_u8PushWait(Copy_u32TimeoutMs-Local_u32Elapsed);
+    }
+
+    sprintf(Local_u8Header,"%04X",Copy_u16Size);
+    if (send(static_DeviceSocket,Local_u8Header,HTTP_PUSH_FRAME_HEADER_SIZE,0)!=HTTP_PUSH_FRAME_HEADER_SIZE ||
+        send(static_DeviceSocket,Copy_u8Chars,Copy_u16Size,0)!=Copy_u16Size)
+    {
+        puts("Send failed");
+        HOST_voidPushDrop();
+        return STATUS_NOK;
+    }
+    return STATUS_OK;
+}
+
+/*Description: This function will answer a data request of the bootloader (LAN direct mode) with the chars of the published image text
+Parameters: Request chars after the 'D' (u8*, 12 hex chars)
+Return: void*/
+static void HOST_voidServeDataRequest (u8* Copy_u8Request)
+{
+    static u8 Local_u8Chars[HOST_LAN_DATA_MAX_CHARS];
+    u8  Local_u8Number[9]={0};
+    u32 Local_u32First;
+    u32 Local_u32Count;
+
+    memcpy(Local_u8Number,Copy_u8Request,8);
+    Local_u32First=strtoul(Local_u8Number,NULL,16);
+    memset(Local_u8Number,0,sizeof(Local_u8Number));
+    memcpy(Local_u8Number,&Copy_u8Request[8],4);
+    Local_u32Count=strtoul(Local_u8Number,NULL,16);
+    if (Local_u32Count>HOST_LAN_DATA_MAX_CHARS)
+    {
+        Local_u32Count=HOST_LAN_DATA_MAX_CHARS;
+    }
+    /*Past the end of the text the frame is shorter (empty), the bootloader keeps its array erased there*/
+    Local_u32Count=read_published_image(Local_u32First,Local_u8Chars,Local_u32Count);
+    #if HTTP_DEBUG_MODE==1
+    printf("\n   Bootloader asked for %lu chars from %lu\n",(unsigned long)Local_u32Count,(unsigned long)Local_u32First);
+    #endif
+    HOST_u8PushSendFrame(Local_u8Chars,(u16)Local_u32Count,HTTP_PUSH_REPLY_TIMEOUT_MS);
+}
+
+/*Description: This API will be used to receive the next frame from the bootloader, the chars are ended by a null
+ * In LAN direct mode the data requests of the bootloader are answered meanwhile and the time starts again after each one
+Parameters: Buffer (u8*), Size of buffer (u16), Time to wait in ms (u32)
+Return: Error Status (u8), NOK if no whole frame came in time, the buffer is then empty*/
+u8 HOST_u8PushReceiveFrame (u8* Copy_u8Buffer, u16 Copy_u16BufferSize, u32 Copy_u32TimeoutMs)
+{
+    u8  Local_u8Header[HTTP_PUSH_FRAME_HEADER_SIZE+1]={0};
+    u16 Local_u16Have=0;
+    u16 Local_u16Target=HTTP_PUSH_FRAME_HEADER_SIZE;
+    u16 Local_u16Length=0;
+    u32 Local_u32Start=GetTickCount();
+    u32 Local_u32Elapsed;
+    int Local_s32Received;
+    u8  Local_u8Event;
+
+    Copy_u8Buffer[0]=0;
+    if (!HOST_u8PushIsActive())
+    {
+        return STATUS_NOK;
+    }
+    while (Local_u16Have<Local_u16Target)
+    {
+        Local_u32Elapsed=GetTickCount()-Local_u32Start;
+        if (Local_u32Elapsed>=Copy_u32TimeoutMs)
+        {
+            Copy_u8Buffer[0]=0;
+            return STATUS_NOK;
+        }
+        Local_u8Event=HOST_u8PushWait(Copy_u32TimeoutMs-Local_u32Elapsed);
+        if (Local_u8Event!=1)
+        {
+            /*A new connection starts with a new frame*/
+            if (Local_u8Event==2)
+            {
+                Local_u16Have=0;
+                Local_u16Target=HTTP_PUSH_FRAME_HEADER_SIZE;
+            }
+            continue;
+        }
+
+        if (Local_u16Have<HTTP_PUSH_FRAME_HEADER_SIZE)
+        {
+            Local_s32Received=recv(static_DeviceSocket,&Local_u8Header[Local_u16Have],HTTP_PUSH_FRAME_HEADER_SIZE-Local_u16Have,0);
+        }
+        else
+        {
+            Local_s32Received=recv(static_DeviceSocket,&Copy_u8Buffer[Local_u16Have-HTTP_PUSH_FRAME_HEADER_SIZE],Local_u16Target-Local_u16Have,0);
+        }
+        /*The bootloader dropped the connection (a channel exchange), the frame it was sending is lost*/
+        if (Local_s32Received<=0)
+        {
+            HOST_voidPushDrop();
+            Local_u16Have=0;
+            Local_u16Target=HTTP_PUSH_FRAME_HEADER_SIZE;
+            continue;
+        }
+        Local_u16Have+=Local_s32Received;
+
+        if (Local_u16Have==HTTP_PUSH_FRAME_HEADER_SIZE && Local_u16Target==HTTP_PUSH_FRAME_HEADER_SIZE)
+        {
+            Local_u16Length=(u16)strtoul(Local_u8Header,NULL,16);
+            /*A frame that does not fit cannot be skipped for sure, the frames start again on a new connection*/
+            if (Local_u16Length>=Copy_u16BufferSize)
+            {
+                HOST_voidPushDrop();
+                Local_u16Have=0;
+                continue;
+            }
+            Local_u16Target+=Local_u16Length;
+        }
+
+        if (static_u8LanDirect && Local_u16Have==Local_u16Target && Local_u16Length==HOST_LAN_DATA_REQUEST_SIZE &&
+            Copy_u8Buffer[0]==HOST_LAN_DATA_REQUEST)
+        {
+            HOST_voidServeDataRequest(&Copy_u8Buffer[1]);
+            Local_u16Have=0;
+            Local_u16Target=HTTP_PUSH_FRAME_HEADER_SIZE;
+            Local_u32Start=GetTickCount();
+        }
+    }
+    Copy_u8Buffer[Local_u16Length]=0;
+    return STATUS_OK;
+}
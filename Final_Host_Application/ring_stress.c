@@ -0,0 +1,180 @@
+/* This file implements the stress test of the SPSC byte rings of the bootloader (RING_program.c) on the PC :
+ * one thread is the producer (the interrupt on the board) and one thread is the consumer (the main loop), both run freely.
+ * The producer puts a running sequence with RING_u8Put and RING_u16Write, the consumer takes it with RING_u8Get and
+ * RING_u16Read, both in bursts of random length so the ring goes through empty, full and the wrap of the indices.
+ * A byte the ring refuses is not sent again, so the consumer must see the sequence without a gap, in order,
+ * and the dropped counter of the ring must match the puts that were refused.
+ * Built by the RingStress target of Final_Host_Application.cbp, or by hand :
+ *   gcc -O2 -std=c99 -I../Bootloader_STM32f103c8t6_FOTA/include -o ring_stress ring_stress.c ../Bootloader_STM32f103c8t6_FOTA/src/RING_program.c -lpthread
+ * Usage : ring_stress [ring size (power of two, 2 ... 32768)] [millions of bytes]
+ */
+
+#define _GNU_SOURCE
+
+#include "RING_interface.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <sched.h>
+
+#define RING_STRESS_DEFAULT_SIZE        64
+#define RING_STRESS_DEFAULT_MBYTES      50
+#define RING_STRESS_MAX_BURST           100     //longer than the default ring, so a write is often cut short
+
+static RING_t           ring_stress_ring;
+static u8               ring_stress_storage[32768];
+static uint64_t         ring_stress_total;              //bytes the producer puts in the ring
+static volatile uint8_t ring_stress_producer_done;
+static uint64_t         ring_stress_refused;            //RING_u8Put that found the ring full
+static uint64_t         ring_stress_cut;                //RING_u16Write that put less than asked
+static uint64_t         ring_stress_received;
+static uint64_t         ring_stress_errors;
+static uint64_t         ring_stress_first_error;
+static uint64_t         ring_stress_overfull;           //times the ring was seen holding more than its size
+
+//xorshift, one generator per thread
+static uint32_t ring_stress_random(uint32_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static double ring_stress_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec/1e9;
+}
+
+//Producer thread : the sequence only moves on with the bytes the ring took
+static void* ring_stress_producer(void* param)
+{
+    uint32_t seed = 0x12345678;
+    uint64_t sent = 0;
+    uint64_t before;
+    uint8_t  burst[RING_STRESS_MAX_BURST];
+    uint16_t length;
+    uint16_t put;
+    uint16_t index;
+
+    (void)param;
+    while(sent < ring_stress_total)
+    {
+        before = sent;
+        length = 1 + ring_stress_random(&seed)%RING_STRESS_MAX_BURST;
+        if(length > ring_stress_total-sent) length = (uint16_t)(ring_stress_total-sent);
+        if(ring_stress_random(&seed) & 1)
+        {
+            for(index=0; index<length; index++)
+            {
+                if(RING_u8Put(&ring_stress_ring, (u8)sent) == STATUS_OK) sent++;
+                else                                                    ring_stress_refused++;
+            }
+        }
+        else
+        {
+            for(index=0; index<length; index++) burst[index] = (uint8_t)(sent+index);
+            put = RING_u16Write(&ring_stress_ring, burst, length);
+            if(put < length) ring_stress_cut++;
+            sent += put;
+        }
+        //a full ring waits for the consumer, which may share the core
+        if(sent == before) sched_yield();
+    }
+    ring_stress_producer_done = 1;
+    return NULL;
+}
+
+//Checks the bytes taken against the sequence
+static void ring_stress_check(uint8_t* bytes, uint16_t count)
+{
+    uint16_t index;
+
+    for(index=0; index<count; index++)
+    {
+        if(bytes[index] != (uint8_t)ring_stress_received)
+        {
+            if(ring_stress_errors == 0) ring_stress_first_error = ring_stress_received;
+            ring_stress_errors++;
+        }
+        ring_stress_received++;
+    }
+}
+
+//Consumer thread : takes bytes until the producer is done and the ring is empty
+static void* ring_stress_consumer(void* param)
+{
+    uint32_t seed = 0x9E3779B9;
+    uint8_t  burst[RING_STRESS_MAX_BURST];
+    uint8_t  byte;
+    uint16_t length;
+    uint16_t index;
+    uint8_t  done;
+    uint64_t before;
+
+    (void)param;
+    while(1)
+    {
+        before = ring_stress_received;
+        //read before the ring is checked, so no byte put before the end can be left in it
+        done   = ring_stress_producer_done;
+        length = 1 + ring_stress_random(&seed)%RING_STRESS_MAX_BURST;
+        if(RING_u16Count(&ring_stress_ring) > ring_stress_ring.mask+1) ring_stress_overfull++;
+        if(ring_stress_random(&seed) & 1)
+        {
+            for(index=0; index<length && RING_u8Get(&ring_stress_ring, &byte) == STATUS_OK; index++) ring_stress_check(&byte, 1);
+        }
+        else
+        {
+            index = RING_u16Read(&ring_stress_ring, burst, length);
+            ring_stress_check(burst, index);
+        }
+        if(done && RING_u16Count(&ring_stress_ring) == 0) break;
+        if(ring_stress_received == before) sched_yield();
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t  size   = (argc > 1)? (uint32_t)atoi(argv[1]) : RING_STRESS_DEFAULT_SIZE;
+    uint32_t  mbytes = (argc > 2)? (uint32_t)atoi(argv[2]) : RING_STRESS_DEFAULT_MBYTES;
+    pthread_t producer;
+    pthread_t consumer;
+    double    start;
+    double    elapsed;
+    uint8_t   passed;
+
+    if(size > sizeof(ring_stress_storage) || RING_u8Init(&ring_stress_ring, ring_stress_storage, (u16)size) != STATUS_OK)
+    {
+        printf("\n   Ring size must be a power of two (2 ... %u)\n", (unsigned)sizeof(ring_stress_storage));
+        return 2;
+    }
+    ring_stress_total = (uint64_t)mbytes*1000000;
+    printf("\n   SPSC ring of %u bytes, %llu bytes from one producer thread to one consumer thread\n", size,
+           (unsigned long long)ring_stress_total);
+
+    start = ring_stress_now();
+    pthread_create(&consumer, NULL, ring_stress_consumer, NULL);
+    pthread_create(&producer, NULL, ring_stress_producer, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    elapsed = ring_stress_now() - start;
+
+    //the counter of the ring is 16 bits and wraps
+    passed = (ring_stress_errors == 0 && ring_stress_overfull == 0 && ring_stress_received == ring_stress_total &&
+              ring_stress_ring.dropped == (u16)ring_stress_refused);
+    printf("\n   Received %llu bytes in %.2f s (%.1f MB/s), %llu out of order",
+           (unsigned long long)ring_stress_received, elapsed, ring_stress_received/elapsed/1e6, (unsigned long long)ring_stress_errors);
+    if(ring_stress_errors)   printf(" (first at byte %llu)", (unsigned long long)ring_stress_first_error);
+    if(ring_stress_overfull) printf(", ring seen holding more than its size %llu times", (unsigned long long)ring_stress_overfull);
+    printf("\n   Puts refused %llu, dropped counter of the ring %u (expected %u), writes cut short %llu",
+           (unsigned long long)ring_stress_refused, (unsigned)ring_stress_ring.dropped, (unsigned)(u16)ring_stress_refused,
+           (unsigned long long)ring_stress_cut);
+    printf("\n   %s\n", passed? "PASSED" : "FAILED");
+    return passed? 0 : 1;
+}
@@ -0,0 +1,209 @@
+/* This file implements the trace dump : the event trace recorded by the bootloader (BL_GET_TRACE) is read
+ * and written as a Chrome trace (JSON), which chrome://tracing and ui.perfetto.dev open as a timeline.
+ * Every record is 8 bytes : time in us since the trace was started (4), event, phase, argument (2)
+ * Commands, WIFI requests, flash operations and hex decoding get one track each, so the time spent by every
+ * kind of work (and the gaps between them) can be seen along the whole update.
+ * Reading the trace is Windows only (winsock), the JSON export is common across win/linux/mac
+ */
+
+#include "main.h"
+#include "HTTP_interface.h"
+#include <stdlib.h>
+
+#define TRACE_MAX_RECORDS           4096
+#define TRACE_RECORD_SIZE           8
+#define TRACE_POLL_MS               1000
+#define TRACE_TIMEOUT_POLLS         100     //no new reply for this many polls : give up
+#define TRACE_FILE_NAME             "bootloader_trace.json"
+
+//Events and phases, as recorded by the bootloader (TRACE_interface.h)
+#define TRACE_EVENT_COMMAND         1
+#define TRACE_EVENT_WIFI_REQUEST    2
+#define TRACE_EVENT_FLASH_ERASE     3
+#define TRACE_EVENT_FLASH_PROGRAM   4
+#define TRACE_EVENT_HEX_DECODE      5
+#define TRACE_EVENT_CHUNK_REFETCH   6
+#define TRACE_EVENT_LAST            TRACE_EVENT_CHUNK_REFETCH
+
+#define TRACE_PHASE_BEGIN           0
+#define TRACE_PHASE_END             1
+#define TRACE_PHASE_INSTANT         2
+
+typedef struct
+{
+    uint32_t time_us;
+    uint8_t  event;
+    uint8_t  phase;
+    uint16_t arg;
+}trace_record_t;
+
+//Name, track and argument name of every event (index is the event number)
+static const char* trace_event_names[] = {"?", "Command", "WIFI request", "Flash erase", "Flash program", "Hex decode", "Chunk refetch"};
+static const char* trace_track_names[] = {"?", "Commands", "WIFI", "Flash", "Flash", "Hex decode", "Commands"};
+static const int   trace_event_tracks[]= {0, 1, 2, 3, 3, 4, 1};
+static const char* trace_arg_names[]   = {"arg", "code", "length", "page", "bytes", "bytes", "chunk"};
+
+static const char* trace_command_name(uint16_t code)
+{
+    switch(code)
+    {
+    case COMMAND_BL_GET_VER:                return "BL_GET_VER";
+    case COMMAND_BL_GET_HELP:               return "BL_GET_HELP";
+    case COMMAND_BL_GET_CID:                return "BL_GET_CID";
+    case COMMAND_BL_GO_TO_ADDR:             return "BL_GO_TO_ADDR";
+    case COMMAND_BL_FLASH_ERASE:            return "BL_FLASH_ERASE";
+    case COMMAND_BL_MASS_ERASE:             return "BL_FLASH_MASS_ERASE";
+    case COMMAND_BL_MEM_WRITE:              return "BL_MEM_WRITE";
+    case COMMAND_BL_MEM_READ:               return "BL_MEM_READ";
+    case COMMAND_BL_MY_SYSTEM_RESET:        return "BL_SYSTEM_RESET";
+    case COMMAND_BL_EXISTING_APPS:          return "BL_EXISTING_APPS";
+    case COMMAND_BL_SAVE_APP_INFO:          return "BL_SAVE_APP_INFO";
+    case COMMAND_BL_GET_DIGEST:             return "BL_GET_DIGEST";
+    case COMMAND_BL_GET_RESUME:             return "BL_GET_RESUME";
+    case COMMAND_BL_GET_STATS:              return "BL_GET_STATS";
+    case COMMAND_BL_GET_TRACE:              return "BL_GET_TRACE";
+    default:                                return "Command";
+    }
+}
+
+//Writes the records as a Chrome trace, returns 0 or -1 if the file could not be written
+static int trace_write_chrome_json(const char* file_name, trace_record_t* records, uint32_t count)
+{
+    FILE*       out;
+    uint32_t    index;
+    int         track;
+    const char* name;
+    const char* ph;
+
+    out = fopen(file_name, "w");
+    if(out == NULL) return -1;
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"STM32 bootloader\"}}");
+    for(track=1; track<=4; track++)
+    {
+        for(index=1; index<=TRACE_EVENT_LAST && trace_event_tracks[index]!=track; index++);
+        fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", track, trace_track_names[index]);
+        fprintf(out, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}", track, track);
+    }
+
+    for(index=0; index<count; index++)
+    {
+        if(records[index].event == 0 || records[index].event > TRACE_EVENT_LAST) continue;
+        switch(records[index].phase)
+        {
+        case TRACE_PHASE_BEGIN: ph = "B"; break;
+        case TRACE_PHASE_END:   ph = "E"; break;
+        default:                ph = "i"; break;
+        }
+        name = (records[index].event == TRACE_EVENT_COMMAND)? trace_command_name(records[index].arg) : trace_event_names[records[index].event];
+        fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%u,\"pid\":1,\"tid\":%d,%s\"args\":{\"%s\":%u}}",
+                name, ph, records[index].time_us, trace_event_tracks[records[index].event],
+                (records[index].phase == TRACE_PHASE_INSTANT)? "\"s\":\"t\"," : "",
+                trace_arg_names[records[index].event], records[index].arg);
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    return 0;
+}
+
+//Asks the bootloader for its trace, collects the streamed replies and writes them to TRACE_FILE_NAME
+void trace_dump_run(void)
+{
+    uint8_t  command[COMMAND_BL_GET_TRACE_LEN];
+    uint8_t  command_chars[COMMAND_BL_GET_TRACE_LEN*2];
+    static uint8_t reply_chars[2000];
+    static uint8_t reply[1000];
+    static trace_record_t records[TRACE_MAX_RECORDS];
+    uint32_t clear_trace = 0;
+    uint32_t crc32;
+    uint32_t count       = 0;
+    uint32_t first_seq   = 0;           //sequence number of the first record of the trace
+    uint32_t expected    = 0;           //sequence number of the next record we wait for
+    uint32_t seq;
+    uint32_t left        = 1;
+    uint32_t polls       = 0;
+    uint32_t index;
+    uint8_t  in_reply;
+    int      started     = 0;
+
+    printf("\n   Empty the trace after reading it (1) or keep it (0) : ");
+    scanf(" %u",&clear_trace);
+
+    command[0] = COMMAND_BL_GET_TRACE_LEN-1;
+    command[1] = COMMAND_BL_GET_TRACE;
+    command[2] = (clear_trace != 0);
+    crc32      = get_crc(command,COMMAND_BL_GET_TRACE_LEN-4);
+    command[3] = word_to_byte(crc32,1,1);
+    command[4] = word_to_byte(crc32,2,1);
+    command[5] = word_to_byte(crc32,3,1);
+    command[6] = word_to_byte(crc32,4,1);
+    hex2char(command,command_chars,COMMAND_BL_GET_TRACE_LEN);
+    HOST_voidSendCommand(command_chars,COMMAND_BL_GET_TRACE_LEN*2);
+    printf("\n   Waiting for bootloader to stream its trace\n");
+
+    /*Keep polling the responses channel, every new reply resets the timeout*/
+    while(left && polls < TRACE_TIMEOUT_POLLS)
+    {
+        HOST_voidReceiveCommand(reply_chars);
+        if(char2hex(reply_chars,reply,2) != 0 || reply[0] != 0xA5)
+        {
+            if(reply[0] == 0x7F)
+            {
+                printf("\n   CRC: FAIL \n");
+                return;
+            }
+            polls++;
+            Sleep(TRACE_POLL_MS);
+            continue;
+        }
+        if(reply[1] < BL_GET_TRACE_HEADER_LEN || char2hex(&reply_chars[4],&reply[2],reply[1]) != 0)
+        {
+            polls++;
+            Sleep(TRACE_POLL_MS);
+            continue;
+        }
+        seq      = *((uint32_t*)&reply[2]);
+        in_reply = reply[8];
+        /*Same reply as last poll, wait for the next one*/
+        if(started && seq < expected)
+        {
+            polls++;
+            Sleep(TRACE_POLL_MS);
+            continue;
+        }
+        if(!started)
+        {
+            first_seq = expected = seq;
+            started   = 1;
+        }
+        if(seq > expected) printf("\n   Missed records %u to %u", expected, seq-1);
+
+        for(index=0; index<in_reply && count<TRACE_MAX_RECORDS; index++)
+        {
+            memcpy(&records[count].time_us, &reply[2+BL_GET_TRACE_HEADER_LEN+index*TRACE_RECORD_SIZE], 4);
+            records[count].event = reply[2+BL_GET_TRACE_HEADER_LEN+index*TRACE_RECORD_SIZE+4];
+            records[count].phase = reply[2+BL_GET_TRACE_HEADER_LEN+index*TRACE_RECORD_SIZE+5];
+            memcpy(&records[count].arg, &reply[2+BL_GET_TRACE_HEADER_LEN+index*TRACE_RECORD_SIZE+6], 2);
+            count++;
+        }
+        expected = seq+in_reply;
+        left     = reply[6] | (reply[7]<<8);
+        polls    = 0;
+        printf("\r   Trace : %u records received, %u left  ", count, left);
+    }
+
+    if(!started)
+    {
+        printf("\n   No reply from bootloader\n");
+        return;
+    }
+    if(left) printf("\n   Bootloader stopped streaming, %u records were not received", left);
+    if(first_seq) printf("\n   The trace ring wrapped, the first %u records were overwritten", first_seq);
+    if(count) printf("\n   Trace covers %.3f s", (records[count-1].time_us-records[0].time_us)/1000000.0);
+
+    if(trace_write_chrome_json(TRACE_FILE_NAME, records, count) == 0)
+        printf("\n   %u records written to %s (open it in chrome://tracing or ui.perfetto.dev)\n", count, TRACE_FILE_NAME);
+    else
+        printf("\n   Could not write %s\n", TRACE_FILE_NAME);
+}
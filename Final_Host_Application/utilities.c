@@ -43,3 +43,145 @@ uint32_t get_crc(uint8_t *buff, uint32_t len)
 
   return(Crc);
 }
+
+//Expands a BL_MEM_READ payload sent with BL_MEM_READ_ENCODING_FF_RUNS, every pair (0xFF, n) becomes n bytes of 0xFF
+//returns the number of bytes written in "out", never more than "out_max"
+uint32_t decode_ff_runs(uint8_t* in, uint32_t in_len, uint8_t* out, uint32_t out_max)
+{
+    uint32_t in_index  = 0;
+    uint32_t out_index = 0;
+    uint32_t run_len;
+
+    while(in_index < in_len && out_index < out_max)
+    {
+        if(in[in_index] == 0xFF && (in_index+1) < in_len)
+        {
+            run_len = in[in_index+1];
+            in_index += 2;
+            while(run_len-- && out_index < out_max) out[out_index++] = 0xFF;
+        }
+        else
+        {
+            out[out_index++] = in[in_index++];
+        }
+    }
+    return out_index;
+}
+
+//Same CRC32 as get_crc, but the data is taken as little endian 32-bit words like the MCU reads them from memory
+//the last 1 to 3 bytes (if any) are taken one byte per word, this matches BL_GET_DIGEST with BL_DIGEST_CRC32
+uint32_t get_crc_words(uint8_t *buff, uint32_t len)
+{
+    uint32_t i;
+    uint32_t n;
+    uint32_t data;
+    uint32_t Crc = 0XFFFFFFFF;
+
+    for(n = 0 ; n < len ; )
+    {
+        if((len-n) >= 4)
+        {
+            data = buff[n] | (buff[n+1]<<8) | (buff[n+2]<<16) | ((uint32_t)buff[n+3]<<24);
+            n += 4;
+        }
+        else
+        {
+            data = buff[n++];
+        }
+        Crc = Crc ^ data;
+        for(i=0; i<32; i++)
+        {
+            if (Crc & 0x80000000)
+                Crc = (Crc << 1) ^ 0x04C11DB7; // Polynomial used in STM32
+            else
+                Crc = (Crc << 1);
+        }
+    }
+
+    return(Crc);
+}
+
+//SHA-256 (FIPS 180-4) of "len" bytes, the 32 bytes digest is written in "digest"
+//used to check the digest returned by BL_GET_DIGEST with BL_DIGEST_SHA256
+#define SHA_ROTR(X,N)   (((X)>>(N)) | ((X)<<(32-(N))))
+
+static void sha256_block(uint32_t *state, uint8_t *block)
+{
+    static const uint32_t k[64] =
+    {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+    uint32_t w[64];
+    uint32_t a,b,c,d,e,f,g,h,t1,t2;
+    uint32_t i;
+
+    for(i=0; i<16; i++)
+        w[i] = ((uint32_t)block[i*4]<<24) | (block[i*4+1]<<16) | (block[i*4+2]<<8) | block[i*4+3];
+    for(i=16; i<64; i++)
+        w[i] = (SHA_ROTR(w[i-2],17) ^ SHA_ROTR(w[i-2],19) ^ (w[i-2]>>10)) + w[i-7] +
+               (SHA_ROTR(w[i-15],7) ^ SHA_ROTR(w[i-15],18) ^ (w[i-15]>>3)) + w[i-16];
+
+    a=state[0]; b=state[1]; c=state[2]; d=state[3]; e=state[4]; f=state[5]; g=state[6]; h=state[7];
+    for(i=0; i<64; i++)
+    {
+        t1 = h + (SHA_ROTR(e,6) ^ SHA_ROTR(e,11) ^ SHA_ROTR(e,25)) + ((e&f) ^ (~e&g)) + k[i] + w[i];
+        t2 = (SHA_ROTR(a,2) ^ SHA_ROTR(a,13) ^ SHA_ROTR(a,22)) + ((a&b) ^ (a&c) ^ (b&c));
+        h=g; g=f; f=e; e=d+t1; d=c; c=b; b=a; a=t1+t2;
+    }
+    state[0]+=a; state[1]+=b; state[2]+=c; state[3]+=d; state[4]+=e; state[5]+=f; state[6]+=g; state[7]+=h;
+}
+
+void sha256(uint8_t *buff, uint32_t len, uint8_t *digest)
+{
+    uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    uint8_t  block[64];
+    uint32_t n;
+    uint32_t rest;
+    uint64_t bit_len = (uint64_t)len*8;
+
+    for(n = 0 ; (len-n) >= 64 ; n += 64) sha256_block(state, &buff[n]);
+
+    rest = len-n;
+    memset(block, 0, 64);
+    memcpy(block, &buff[n], rest);
+    block[rest] = 0x80;
+    if(rest >= 56)
+    {
+        sha256_block(state, block);
+        memset(block, 0, 64);
+    }
+    for(n = 0 ; n < 8 ; n++) block[63-n] = (uint8_t)(bit_len >> (8*n));
+    sha256_block(state, block);
+
+    for(n = 0 ; n < 8 ; n++)
+    {
+        digest[n*4]   = state[n]>>24;
+        digest[n*4+1] = state[n]>>16;
+        digest[n*4+2] = state[n]>>8;
+        digest[n*4+3] = state[n];
+    }
+}
+
+//Per chunk manifest : CRC32 (as get_crc_words) of every 1 KB chunk of the image, the last chunk may be shorter
+//the bootloader checks every chunk it fetches against it and fetches again only the chunks that do not match
+//returns the number of chunks
+uint32_t build_chunk_manifest(uint8_t *image, uint32_t len, uint32_t *manifest)
+{
+    uint32_t chunk;
+    uint32_t chunks = (len+IMAGE_CHUNK_SIZE-1)/IMAGE_CHUNK_SIZE;
+    uint32_t chunk_len;
+
+    for(chunk = 0 ; chunk < chunks ; chunk++)
+    {
+        chunk_len       = ((len-chunk*IMAGE_CHUNK_SIZE) >= IMAGE_CHUNK_SIZE)? IMAGE_CHUNK_SIZE : (len-chunk*IMAGE_CHUNK_SIZE);
+        manifest[chunk] = get_crc_words(&image[chunk*IMAGE_CHUNK_SIZE], chunk_len);
+    }
+    return chunks;
+}
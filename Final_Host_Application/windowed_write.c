@@ -0,0 +1,347 @@
+/* This file implements the windowed write over the serial port (wired bootloader, BL_MEM_WRITE_WINDOWED).
+ * Instead of waiting for the reply of every packet, the image is sent in numbered frames and up to (window) frames are kept
+ * unacknowledged, so the UART keeps transmitting while the bootloader programs flash.
+ * The bootloader acknowledges cumulatively (next expected sequence number), a NACK or a silent link makes the host go back
+ * to the first unacknowledged frame and send again from there.
+ * The lockstep write (BL_MEM_WRITE, one 64 bytes packet and its reply at a time) is kept here to measure the windowed one
+ * against, both print the CRC of the image to check what the stand-in of the bootloader (wired_server.c) programmed.
+ * This file is common across win/linux (serial port of the host, WindowsSerialPort.c or LinuxSerialPort.c)
+ */
+
+#include "main.h"
+#ifdef _WIN32
+#include "WindowsSerialPort.h"
+#else
+#include "LinuxSerialPort.h"
+#endif
+
+#define WINDOW_MIN                  4
+#define WINDOW_MAX                  16
+#define WINDOW_DEFAULT              8
+
+#define WINDOW_FRAME_SOF            0x7E
+#define WINDOW_FRAME_PAYLOAD        128     //multiple of 4, bootloader programs and verifies words
+#define WINDOW_FRAME_MAX_LEN        (3+WINDOW_FRAME_PAYLOAD+4)
+
+#define WINDOW_REPLY_ACK            0xA5
+#define WINDOW_REPLY_NACK           0x7F
+#define WINDOW_REPLY_END            0xE0
+
+#define WINDOW_POLL_MS              20      //longest wait for replies before sending more frames
+#define WINDOW_RETRANSMIT_MS        500     //no progress for this long : go back to the first unacknowledged frame
+#define WINDOW_ERASE_TIMEOUT_MS     5000    //bootloader erases the destination pages before replying
+#define WINDOW_END_TIMEOUT_MS       2000
+
+//Status sent by the bootloader
+#define WINDOW_OK                   0
+#define WINDOW_ADDR_INVALID         1
+#define WINDOW_ERASE_FAIL           2
+#define WINDOW_VERIFY_FAIL          3
+#define WINDOW_TIMEOUT              4
+
+#define LOCKSTEP_PAYLOAD            64      //bytes programmed by one BL_MEM_WRITE packet of the wired bootloader
+#define LOCKSTEP_PACKET_LEN         (11+LOCKSTEP_PAYLOAD*2+8)
+#define LOCKSTEP_REPLY_LEN          3       //ack, length to follow, address status
+#define LOCKSTEP_REPLY_TIMEOUT_MS   1000    //the bootloader prints its debug messages (1 ms a char) before replying
+#define LOCKSTEP_RETRIES            5
+
+static const char* window_status_names[] = {"OK", "address invalid", "erase failed", "flash verify failed", "bootloader timed out"};
+
+//The wired bootloader decodes only the low nibble of every char : digits are sent as 0x30|n and A..F as 0x40|n
+static void wired_hex2char(uint8_t* inBuffer, uint8_t* outBuffer, uint16_t NumOfBytesToBeConverted)
+{
+    uint16_t index;
+    uint8_t  nibble;
+
+    for(index=0;index<NumOfBytesToBeConverted*2;index++)
+    {
+        nibble = (index & 1)? (inBuffer[index/2] & 0x0F) : (inBuffer[index/2] >> 4);
+        outBuffer[index] = (nibble <= 9)? (0x30|nibble) : (0x40|nibble);
+    }
+}
+
+//Builds data frame number "frame" of the image in "out" : SOF, seq, len, payload (padded with 0xFF to words), CRC32 of (seq, len, payload)
+static uint16_t build_window_frame(uint8_t* image, uint32_t image_len, uint32_t frame, uint8_t* out)
+{
+    uint32_t offset = frame*WINDOW_FRAME_PAYLOAD;
+    uint32_t len    = ((image_len-offset) >= WINDOW_FRAME_PAYLOAD)? WINDOW_FRAME_PAYLOAD : (image_len-offset);
+    uint8_t  padded = (len+3) & ~3;
+    uint32_t crc32;
+
+    out[0] = WINDOW_FRAME_SOF;
+    out[1] = (uint8_t)frame;
+    out[2] = padded;
+    memset(&out[3], 0xFF, padded);
+    memcpy(&out[3], &image[offset], len);
+    crc32  = get_crc(&out[1], 2+padded);
+    out[3+padded] = word_to_byte(crc32,1,1);
+    out[4+padded] = word_to_byte(crc32,2,1);
+    out[5+padded] = word_to_byte(crc32,3,1);
+    out[6+padded] = word_to_byte(crc32,4,1);
+    return 7+padded;
+}
+
+//Frame number of a cumulative ACK/NACK : the sequence number is the low byte, the window is far smaller than 256
+static uint32_t window_acked_frame(uint32_t base, uint8_t seq)
+{
+    return base + (uint8_t)(seq - (uint8_t)base);
+}
+
+//Asks for the image, address and window, streams the image and prints throughput and retransmissions
+void windowed_write_run(void)
+{
+    uint8_t  command[27];
+    uint8_t  field[4];
+    uint8_t  reply[4];
+    uint8_t  rx[64];
+    uint8_t  tx[WINDOW_MAX*WINDOW_FRAME_MAX_LEN];
+    uint8_t  empty_frame = 0;
+    uint8_t* image;
+    uint32_t image_len;
+    uint32_t address;
+    uint32_t window = WINDOW_DEFAULT;
+    uint32_t total_frames;
+    uint32_t base = 0;                  //first unacknowledged frame
+    uint32_t next = 0;                  //next frame to send
+    uint32_t acked;
+    uint32_t tx_len;
+    uint32_t rx_len;
+    uint32_t index;
+    uint32_t crc32;
+    uint32_t start_ms;
+    uint32_t last_progress_ms;
+    uint32_t elapsed_ms;
+    uint32_t wire_bytes  = 0;
+    uint32_t resent      = 0;
+    uint32_t nacks       = 0;
+    uint32_t timeouts    = 0;
+    uint8_t  reply_type  = 0;           //first byte of a reply pair, 0 while waiting for one
+    int      status      = -1;
+
+    image_len = calc_file_len();
+    image     = malloc(image_len);
+    if(image == NULL){printf("\n   Not enough memory!!\r\n");return;}
+    open_the_file();
+    read_the_file(image, image_len);
+    close_the_file();
+
+    printf("\n\n   Enter the memory write address here (page aligned) : ");
+    scanf(" %x",&address);
+    printf("\n   Enter the window size (%d-%d) : ", WINDOW_MIN, WINDOW_MAX);
+    scanf(" %u",&window);
+    if(window < WINDOW_MIN) window = WINDOW_MIN;
+    if(window > WINDOW_MAX) window = WINDOW_MAX;
+
+    Serial_Port_Configuration();
+    purge_serial_port();
+
+    /*Start command : len, code, address (8 chars), size (8 chars), window, CRC (8 chars)*/
+    command[0] = sizeof(command)-1;
+    command[1] = COMMAND_BL_MEM_WRITE_WINDOWED;
+    memcpy(field, &address, 4);
+    wired_hex2char(field, &command[2], 4);
+    memcpy(field, &image_len, 4);
+    wired_hex2char(field, &command[10], 4);
+    command[18] = window;
+    crc32 = get_crc(command, sizeof(command)-8);
+    memcpy(field, &crc32, 4);
+    wired_hex2char(field, &command[19], 4);
+
+    /*Length first, then the rest once the bootloader is ready for it (as every wired command)*/
+    Write_to_serial_port_quiet(&command[0],1);
+    Write_to_serial_port_quiet(&empty_frame,1);
+    Sleep(20);
+    Write_to_serial_port_quiet(&command[1],sizeof(command)-1);
+
+    Set_serial_port_read_timeout(WINDOW_ERASE_TIMEOUT_MS);
+    for(index=0; index<4; index+=rx_len)
+    {
+        rx_len = read_serial_port(&reply[index], 4-index);
+        if(rx_len == 0) break;
+    }
+    if(index < 4 || reply[0] != WINDOW_REPLY_ACK)
+    {
+        printf("\n   No reply from bootloader (or NACK)!!\n");
+        free(image); Close_serial_port(); return;
+    }
+    if(reply[2] != WINDOW_OK)
+    {
+        printf("\n   Bootloader refused the write : %s\n", window_status_names[reply[2] <= WINDOW_TIMEOUT ? reply[2] : 0]);
+        free(image); Close_serial_port(); return;
+    }
+    window       = reply[3];
+    total_frames = (image_len+WINDOW_FRAME_PAYLOAD-1)/WINDOW_FRAME_PAYLOAD;
+    printf("\n   Streaming %u bytes in %u frames, window %u, image CRC 0x%08X\n", image_len, total_frames, window, get_crc(image, image_len));
+
+    Set_serial_port_read_timeout(WINDOW_POLL_MS);
+    start_ms = last_progress_ms = GetTickCount();
+    while(status < 0)
+    {
+        /*Fill the window, all frames that may be sent now go in one write*/
+        tx_len = 0;
+        while(next < total_frames && (next-base) < window)
+        {
+            tx_len += build_window_frame(image, image_len, next, &tx[tx_len]);
+            next++;
+        }
+        if(tx_len)
+        {
+            Write_to_serial_port_quiet(tx, tx_len);
+            wire_bytes += tx_len;
+        }
+
+        /*Replies are pairs (type, value)*/
+        rx_len = read_serial_port(rx, sizeof(rx));
+        for(index=0; index<rx_len; index++)
+        {
+            if(reply_type == 0)
+            {
+                reply_type = rx[index];
+                continue;
+            }
+            if(reply_type == WINDOW_REPLY_END)
+            {
+                status = rx[index];
+            }
+            else if(reply_type == WINDOW_REPLY_ACK || reply_type == WINDOW_REPLY_NACK)
+            {
+                acked = window_acked_frame(base, rx[index]);
+                if(acked > next) acked = base;          //stale reply
+                if(acked > base)
+                {
+                    base = acked;
+                    last_progress_ms = GetTickCount();
+                }
+                if(reply_type == WINDOW_REPLY_NACK)
+                {
+                    nacks++;
+                    resent += next-base;
+                    next    = base;
+                    last_progress_ms = GetTickCount();
+                }
+            }
+            reply_type = 0;
+        }
+
+        if(base == total_frames && status < 0)
+        {
+            /*Everything acknowledged, only the end reply is missing*/
+            if((GetTickCount()-last_progress_ms) > WINDOW_END_TIMEOUT_MS) break;
+        }
+        else if((GetTickCount()-last_progress_ms) > WINDOW_RETRANSMIT_MS)
+        {
+            timeouts++;
+            resent += next-base;
+            next    = base;
+            last_progress_ms = GetTickCount();
+        }
+    }
+    elapsed_ms = GetTickCount()-start_ms;
+    if(elapsed_ms == 0) elapsed_ms = 1;
+
+    printf("\n   Windowed write : %s", (status < 0)? "no end reply" : window_status_names[status <= WINDOW_TIMEOUT ? status : 0]);
+    printf("\n   %u of %u frames acknowledged in %.2f s -> %.0f bytes/s of image",
+           base, total_frames, elapsed_ms/1000.0, (double)image_len*1000.0/elapsed_ms);
+    printf("\n   Link use %.0f %% (%u bytes sent, %u frames sent again, %u NACKs, %u timeouts)\n",
+           100.0*wire_bytes*10.0/((double)Get_serial_port_baudrate()*elapsed_ms/1000.0), wire_bytes, resent, nacks, timeouts);
+
+    free(image);
+    Close_serial_port();
+}
+
+//Asks for the image and address and writes it with BL_MEM_WRITE the way the wired bootloader takes it : one packet of 64 bytes
+//(the last one padded with 0xFF), then its reply before the next packet. The destination pages must be erased
+void lockstep_write_run(void)
+{
+    uint8_t  packet[LOCKSTEP_PACKET_LEN];
+    uint8_t  chunk[LOCKSTEP_PAYLOAD];
+    uint8_t  field[4];
+    uint8_t  reply[LOCKSTEP_REPLY_LEN];
+    uint8_t  empty_frame = 0;
+    uint8_t* image;
+    uint32_t image_len;
+    uint32_t address;
+    uint32_t packet_address;
+    uint32_t offset = 0;
+    uint32_t chunk_len;
+    uint32_t index;
+    uint32_t rx_len;
+    uint32_t crc32;
+    uint32_t start_ms;
+    uint32_t elapsed_ms;
+    uint32_t wire_bytes = 0;
+    uint32_t retries    = 0;
+    uint32_t attempts   = 0;
+
+    image_len = calc_file_len();
+    image     = malloc(image_len);
+    if(image == NULL){printf("\n   Not enough memory!!\r\n");return;}
+    open_the_file();
+    read_the_file(image, image_len);
+    close_the_file();
+
+    printf("\n\n   Enter the memory write address here (erased pages) : ");
+    scanf(" %x",&address);
+
+    Serial_Port_Configuration();
+    purge_serial_port();
+    Set_serial_port_read_timeout(LOCKSTEP_REPLY_TIMEOUT_MS);
+    printf("\n   Writing %u bytes in %u packets, image CRC 0x%08X\n", image_len, (image_len+LOCKSTEP_PAYLOAD-1)/LOCKSTEP_PAYLOAD, get_crc(image, image_len));
+
+    start_ms = GetTickCount();
+    while(offset < image_len && attempts <= LOCKSTEP_RETRIES)
+    {
+        /*Packet : len, code, address (8 chars), payload length in chars, payload (2 chars a byte), CRC (8 chars)*/
+        chunk_len = ((image_len-offset) >= LOCKSTEP_PAYLOAD)? LOCKSTEP_PAYLOAD : (image_len-offset);
+        memset(chunk, 0xFF, LOCKSTEP_PAYLOAD);
+        memcpy(chunk, &image[offset], chunk_len);
+        packet[0]  = LOCKSTEP_PACKET_LEN-1;
+        packet[1]  = COMMAND_BL_MEM_WRITE;
+        packet_address = address+offset;
+        memcpy(field, &packet_address, 4);
+        wired_hex2char(field, &packet[2], 4);
+        packet[10] = LOCKSTEP_PAYLOAD*2;
+        wired_hex2char(chunk, &packet[11], LOCKSTEP_PAYLOAD);
+        crc32 = get_crc(packet, LOCKSTEP_PACKET_LEN-8);
+        memcpy(field, &crc32, 4);
+        wired_hex2char(field, &packet[LOCKSTEP_PACKET_LEN-8], 4);
+
+        /*The bootloader arms its receiver 10 ms after the last reply byte (delay of its send), then the length, an empty frame,
+         *the rest once it printed the length, and an empty frame to clear its data register*/
+        Sleep(20);
+        Write_to_serial_port_quiet(&packet[0],1);
+        Write_to_serial_port_quiet(&empty_frame,1);
+        Sleep(20);
+        Write_to_serial_port_quiet(&packet[1],LOCKSTEP_PACKET_LEN-1);
+        Write_to_serial_port_quiet(&empty_frame,1);
+        wire_bytes += LOCKSTEP_PACKET_LEN+2;
+
+        for(index=0; index<LOCKSTEP_REPLY_LEN; index+=rx_len)
+        {
+            rx_len = read_serial_port(&reply[index], LOCKSTEP_REPLY_LEN-index);
+            if(rx_len == 0) break;
+        }
+        if(index == LOCKSTEP_REPLY_LEN && reply[0] == WINDOW_REPLY_ACK && reply[2] == 0)
+        {
+            offset  += LOCKSTEP_PAYLOAD;
+            attempts = 0;
+            continue;
+        }
+        /*NACK, refused address or no reply : the same packet again*/
+        retries++;
+        attempts++;
+        purge_serial_port();
+    }
+    elapsed_ms = GetTickCount()-start_ms;
+    if(elapsed_ms == 0) elapsed_ms = 1;
+    if(offset > image_len) offset = image_len;
+
+    printf("\n   Lockstep write : %s", (offset < image_len)? "gave up" : "OK");
+    printf("\n   %u of %u bytes written in %.2f s -> %.0f bytes/s of image",
+           offset, image_len, elapsed_ms/1000.0, (double)offset*1000.0/elapsed_ms);
+    printf("\n   Link use %.0f %% (%u bytes sent, %u packets sent again)\n",
+           100.0*wire_bytes*10.0/((double)Get_serial_port_baudrate()*elapsed_ms/1000.0), wire_bytes, retries);
+
+    free(image);
+    Close_serial_port();
+}
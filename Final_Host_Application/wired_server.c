@@ -0,0 +1,719 @@
+/* This file implements a local stand-in of the wired bootloader (Bootloader_STM32f103c8t6) on a pseudo terminal, so the
+ * serial writes (windowed write, option 21, and lockstep write, option 30) can be run and measured on this PC without a board.
+ * Starting it points BL_SERIAL_PORT and BL_SERIAL_BAUD at the pseudo terminal. It answers BL_MEM_WRITE (one 64 bytes packet,
+ * then its reply) and BL_MEM_WRITE_WINDOWED the way the bootloader does, on a clock of its own :
+ *  - every byte takes 10 bits at the baud rate to arrive, a reply is written when its last bit would reach the host
+ *  - printmsg1 and the replies are sent with a delay_ms after every char (1 ms for UART1 and the window replies, 10 ms for
+ *    the command replies), the main loop waits meanwhile
+ *  - a half word takes WIRED_SERVER_HALF_WORD_US to program and a page WIRED_SERVER_PAGE_ERASE_US to erase (datasheet typical),
+ *    the CPU stalls while a half word is programmed, a second byte coming in the same stall overruns the receiver and is lost
+ *  - a byte that comes while no receive is armed waits in the data register, the next one overruns it
+ *  - the windowed write polls its ring every 1 ms when it is empty, a frame that finds the ring full is dropped
+ * The flash is erased when the stand-in starts, programming a half word that is not erased fails like on the chip.
+ * Other commands are answered as unknown (debug message, no reply).
+ * This file is Linux only
+ */
+
+#define _GNU_SOURCE
+#include "main.h"
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+#define WIRED_SERVER_FLASH_START        0x08000000
+#define WIRED_SERVER_FLASH_SIZE         (128*1024)
+#define WIRED_SERVER_FLASH_END          (WIRED_SERVER_FLASH_START+WIRED_SERVER_FLASH_SIZE-1)
+#define WIRED_SERVER_APP_BASE           0x08008000
+#define WIRED_SERVER_RAM_START          0x20000000
+#define WIRED_SERVER_RAM_END            (WIRED_SERVER_RAM_START+20*1024-1)
+#define WIRED_SERVER_PAGE_SIZE          1024
+
+//Times of the board in us
+#define WIRED_SERVER_HALF_WORD_US       52.5        //half word programming of the STM32F103 (datasheet typical)
+#define WIRED_SERVER_PAGE_ERASE_US      20000.0     //page erase (datasheet typical)
+#define WIRED_SERVER_DEBUG_CHAR_US      1000.0      //printmsg1 : HUART_u8SendSync(HUART_USART1,..,1)
+#define WIRED_SERVER_REPLY_CHAR_US      10000.0     //command replies : HUART_u8SendSync(HUART_USART2,..,10)
+#define WIRED_SERVER_WINDOW_CHAR_US     1000.0      //window replies : HUART_u8SendSync(HUART_USART2,..,1)
+#define WIRED_SERVER_POLL_US            1000.0      //delay_ms(1) of the windowed write while its ring is empty
+#define WIRED_SERVER_IDLE_POLLS         2000        //BL_WINDOW_IDLE_TIMEOUT_MS
+#define WIRED_SERVER_NEVER              1e300
+
+#define WIRED_SERVER_ACK                0xA5
+#define WIRED_SERVER_NACK               0x7F
+#define WIRED_SERVER_WINDOW_END         0xE0
+#define WIRED_SERVER_WINDOW_MIN         4
+#define WIRED_SERVER_WINDOW_MAX         16
+#define WIRED_SERVER_WINDOW_SLOTS       (WIRED_SERVER_WINDOW_MAX+1)
+#define WIRED_SERVER_FRAME_SOF          0x7E
+#define WIRED_SERVER_FRAME_PAYLOAD      128
+
+//Status of the windowed write, as the bootloader
+#define WIRED_SERVER_WINDOW_OK              0
+#define WIRED_SERVER_WINDOW_ADDR_INVALID    1
+#define WIRED_SERVER_WINDOW_ERASE_FAIL      2
+#define WIRED_SERVER_WINDOW_VERIFY_FAIL     3
+#define WIRED_SERVER_WINDOW_TIMEOUT         4
+
+//Receiver of the main loop
+#define WIRED_SERVER_RX_LENGTH          0       //HUART_u8ReceiveAsync(HUART_USART2,bl_rx_buffer,1)
+#define WIRED_SERVER_RX_PACKET          1       //HUART_u8ReceiveAsync(HUART_USART2,(bl_rx_buffer+1),rcv_len)
+#define WIRED_SERVER_RX_STREAM          2       //HUART_u8StartStreamReceive of the windowed write
+
+//States of the frame receiver, as bootloader_window_rx_byte
+#define WIRED_SERVER_FRAME_RX_SOF       0
+#define WIRED_SERVER_FRAME_RX_SEQ       1
+#define WIRED_SERVER_FRAME_RX_LEN       2
+#define WIRED_SERVER_FRAME_RX_PAYLOAD   3
+#define WIRED_SERVER_FRAME_RX_CRC       4
+
+#define WIRED_SERVER_REPLY_QUEUE        4096    //power of two
+#define WIRED_SERVER_STALLS             32      //last flash programmings, for the overrun check
+
+typedef struct
+{
+    double  due_us;                     //last bit reaches the host
+    uint8_t byte;
+} wired_server_reply_t;
+
+typedef struct
+{
+    double start_us;
+    double end_us;
+} wired_server_stall_t;
+
+static int          wired_server_master = -1;
+static pthread_t    wired_server_thread_id;
+static volatile int wired_server_running;
+static uint64_t     wired_server_origin_us;     //clock of the board starts here
+static double       wired_server_byte_us;
+static uint8_t      wired_server_flash[WIRED_SERVER_FLASH_SIZE];
+static uint32_t     wired_server_written_low;   //range programmed since the start
+static uint32_t     wired_server_written_high;
+
+//Main loop and receiver
+static double   wired_server_line_us;           //the bytes received so far are all in by then
+static double   wired_server_cpu_us;            //main loop is busy till then
+static double   wired_server_armed_us;          //the receiver takes bytes from then
+static uint8_t  wired_server_rx_state;
+static uint8_t  wired_server_dr_full;           //a byte waits in the data register
+static uint8_t  wired_server_dr_byte;
+static double   wired_server_dr_us;
+static uint8_t  wired_server_packet[280];       //bl_rx_buffer, the CRC of BL_MEM_WRITE is read at 11+payload length
+static uint16_t wired_server_packet_index;
+
+//Windowed write
+static uint32_t wired_server_window_address;
+static uint32_t wired_server_window_size;
+static uint32_t wired_server_window_done;
+static uint8_t  wired_server_expected_seq;
+static uint8_t  wired_server_nack_sent;
+static uint8_t  wired_server_frame_state;
+static uint16_t wired_server_frame_index;
+static uint8_t  wired_server_frame[2+WIRED_SERVER_FRAME_PAYLOAD];  //seq, len, payload
+static uint8_t  wired_server_frame_crc[4];
+static double   wired_server_stream_stop_us;    //stream receive stopped at this time, WIRED_SERVER_NEVER while it runs
+static double   wired_server_ring_free_us[WIRED_SERVER_WINDOW_SLOTS];  //a frame leaves its slot at this time
+static uint32_t wired_server_ring_frames;
+static wired_server_stall_t wired_server_stalls[WIRED_SERVER_STALLS];
+static uint32_t wired_server_stall_count;
+static double   wired_server_last_stall_us;     //stall and half word of the last byte received in a stall
+static int32_t  wired_server_last_stall_slot;
+
+//Replies waiting for their time
+static wired_server_reply_t wired_server_replies[WIRED_SERVER_REPLY_QUEUE];
+static uint32_t wired_server_reply_head;
+static uint32_t wired_server_reply_tail;
+static double   wired_server_tx_free_us;        //shift register of USART2 is free from then
+static double   wired_server_tx_last_start_us;  //the last byte written starts shifting at this time
+
+//Counters printed when the stand-in is stopped
+static uint32_t wired_server_commands;
+static uint32_t wired_server_crc_fails;
+static uint32_t wired_server_unknown;
+static uint32_t wired_server_frames;
+static uint32_t wired_server_frames_rejected;
+static uint32_t wired_server_frames_dropped;
+static uint32_t wired_server_overruns;
+static uint32_t wired_server_tx_lost;
+static uint32_t wired_server_program_errors;
+
+
+static double wired_server_now_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)((uint64_t)now.tv_sec*1000000 + now.tv_nsec/1000 - wired_server_origin_us);
+}
+
+//Low nibble of every char makes a half byte, as char2hex of the bootloader
+static void wired_server_char2hex(uint8_t* inBuffer, uint8_t* outBuffer, uint16_t NumOfBytesToBeConverted)
+{
+    uint16_t index;
+
+    for(index=0;index<NumOfBytesToBeConverted;index++)
+        outBuffer[index] = (uint8_t)((inBuffer[index*2]<<4) | (inBuffer[index*2+1]&0x0F));
+}
+
+static uint32_t wired_server_field(uint8_t* chars)
+{
+    uint8_t  bytes[4];
+    uint32_t value;
+
+    wired_server_char2hex(chars, bytes, 4);
+    memcpy(&value, bytes, 4);
+    return value;
+}
+
+//printmsg1 : every char of the message is written to USART1 followed by delay_ms(1). Returns the time it ends
+static double wired_server_print(double at_us, const char* format, ...)
+{
+    char    buffer[200];
+    va_list ap;
+
+    va_start(ap, format);
+    vsnprintf(buffer, sizeof(buffer), format, ap);
+    va_end(ap);
+    return at_us + strlen(buffer)*WIRED_SERVER_DEBUG_CHAR_US;
+}
+
+//HUART_u8SendSync on USART2 : every byte goes to the data register followed by a delay, TXE is not checked, so a byte
+//written while the one before still waits for the shift register replaces it. Returns the time it ends
+static double wired_server_send(uint8_t* bytes, uint8_t len, double char_us, double at_us)
+{
+    wired_server_reply_t* reply;
+    uint8_t index;
+    double  start_us;
+
+    for(index=0; index<len; index++, at_us += char_us)
+    {
+        if(wired_server_tx_last_start_us > at_us && wired_server_reply_head != wired_server_reply_tail)
+        {
+            wired_server_replies[(wired_server_reply_head-1) % WIRED_SERVER_REPLY_QUEUE].byte = bytes[index];
+            wired_server_tx_lost++;
+            continue;
+        }
+        if(wired_server_reply_head-wired_server_reply_tail == WIRED_SERVER_REPLY_QUEUE)
+        {
+            wired_server_tx_lost++;
+            continue;
+        }
+        start_us = (at_us > wired_server_tx_free_us)? at_us : wired_server_tx_free_us;
+        wired_server_tx_last_start_us = start_us;
+        wired_server_tx_free_us       = start_us + wired_server_byte_us;
+        reply = &wired_server_replies[wired_server_reply_head % WIRED_SERVER_REPLY_QUEUE];
+        reply->due_us = wired_server_tx_free_us;
+        reply->byte   = bytes[index];
+        wired_server_reply_head++;
+    }
+    return at_us;
+}
+
+//bootloader_send_ack : ack and length to follow, then two debug messages
+static double wired_server_send_ack(uint8_t follow_len, double at_us)
+{
+    uint8_t ack[2] = {WIRED_SERVER_ACK, follow_len};
+
+    at_us = wired_server_send(ack, 2, WIRED_SERVER_REPLY_CHAR_US, at_us);
+    at_us = wired_server_print(at_us, "Sending BL_ACK: 0x%x\r\n", ack[0]);
+    return wired_server_print(at_us, "reply length= %d bytes\r\n", ack[1]);
+}
+
+//FLASH_WriteProgram : half words one after the other, a half word that is not erased is not programmed and the verify fails.
+//The CPU is stalled meanwhile. Returns 0 if the data reads back
+static uint8_t wired_server_program(uint32_t address, uint8_t* data, uint32_t len, double at_us)
+{
+    wired_server_stall_t* stall = &wired_server_stalls[wired_server_stall_count++ % WIRED_SERVER_STALLS];
+    uint32_t offset;
+    uint32_t index;
+    uint8_t  failed = 0;
+
+    stall->start_us = at_us;
+    stall->end_us   = at_us + (len/2)*WIRED_SERVER_HALF_WORD_US;
+    if(address < WIRED_SERVER_FLASH_START || address+len-1 > WIRED_SERVER_FLASH_END) return 1;
+    offset = address-WIRED_SERVER_FLASH_START;
+    for(index=0; index+1<len; index+=2)
+    {
+        if(wired_server_flash[offset+index] != 0xFF || wired_server_flash[offset+index+1] != 0xFF)
+        {
+            wired_server_program_errors++;
+            failed = 1;
+            continue;
+        }
+        wired_server_flash[offset+index]   = data[index];
+        wired_server_flash[offset+index+1] = data[index+1];
+    }
+    if(address < wired_server_written_low) wired_server_written_low = address;
+    if(address+len > wired_server_written_high) wired_server_written_high = address+len;
+    return failed;
+}
+
+//A byte coming while the CPU is stalled by flash programming waits in the data register, the ISR runs once the half word
+//is written. A second byte in the same half word overruns it. Returns 1 if the byte is lost
+static uint8_t wired_server_overrun(double at_us)
+{
+    wired_server_stall_t* stall;
+    uint32_t index;
+    int32_t  slot;
+
+    for(index=0; index<wired_server_stall_count && index<WIRED_SERVER_STALLS; index++)
+    {
+        stall = &wired_server_stalls[(wired_server_stall_count-1-index) % WIRED_SERVER_STALLS];
+        if(at_us >= stall->start_us && at_us < stall->end_us)
+        {
+            slot = (int32_t)((at_us-stall->start_us)/WIRED_SERVER_HALF_WORD_US);
+            if(stall->start_us == wired_server_last_stall_us && slot == wired_server_last_stall_slot) return 1;
+            wired_server_last_stall_us   = stall->start_us;
+            wired_server_last_stall_slot = slot;
+            return 0;
+        }
+    }
+    wired_server_last_stall_slot = -1;
+    return 0;
+}
+
+//End of the windowed write at (at_us) : stream receive stopped, end reply, debug message, back to the command loop
+static void wired_server_window_end(uint8_t status, double at_us)
+{
+    uint8_t reply[2] = {WIRED_SERVER_WINDOW_END, status};
+
+    wired_server_stream_stop_us = at_us;
+    if(status != WIRED_SERVER_WINDOW_ADDR_INVALID && status != WIRED_SERVER_WINDOW_ERASE_FAIL)
+        at_us = wired_server_send(reply, 2, WIRED_SERVER_WINDOW_CHAR_US, at_us);
+    at_us = wired_server_print(at_us, "BL_DEBUG_MSG: windowed write done, status %d, %d bytes\r\n", status, wired_server_window_done);
+    wired_server_cpu_us = wired_server_armed_us = at_us;
+}
+
+//Main loop of the windowed write takes the frame completed at (at_us) once it is free and the ones before it are programmed
+static void wired_server_window_frame(double at_us)
+{
+    uint8_t  reply[2];
+    uint8_t  len = wired_server_frame[1];
+    uint32_t crc;
+    uint32_t polls;
+    double   start_us;
+
+    if(wired_server_stream_stop_us != WIRED_SERVER_NEVER) return;
+    if(wired_server_cpu_us >= at_us)
+    {
+        start_us = wired_server_cpu_us;
+    }
+    else
+    {
+        polls = (uint32_t)((at_us-wired_server_cpu_us+WIRED_SERVER_POLL_US-1)/WIRED_SERVER_POLL_US);
+        if(polls >= WIRED_SERVER_IDLE_POLLS)
+        {
+            wired_server_window_end(WIRED_SERVER_WINDOW_TIMEOUT, wired_server_cpu_us+WIRED_SERVER_IDLE_POLLS*WIRED_SERVER_POLL_US);
+            return;
+        }
+        start_us = wired_server_cpu_us + polls*WIRED_SERVER_POLL_US;
+    }
+    wired_server_frames++;
+
+    memcpy(&crc, wired_server_frame_crc, 4);
+    if(get_crc(wired_server_frame, 2+len) == crc && wired_server_frame[0] == wired_server_expected_seq &&
+       len <= ((wired_server_window_size-wired_server_window_done+3) & ~3))
+    {
+        if(wired_server_program(wired_server_window_address+wired_server_window_done, &wired_server_frame[2], len, start_us))
+        {
+            wired_server_window_end(WIRED_SERVER_WINDOW_VERIFY_FAIL, start_us+(len/2)*WIRED_SERVER_HALF_WORD_US);
+            return;
+        }
+        wired_server_window_done += len;
+        wired_server_expected_seq++;
+        wired_server_nack_sent = 0;
+        reply[0] = WIRED_SERVER_ACK;
+        reply[1] = wired_server_expected_seq;
+        start_us = wired_server_send(reply, 2, WIRED_SERVER_WINDOW_CHAR_US, start_us+(len/2)*WIRED_SERVER_HALF_WORD_US);
+    }
+    else
+    {
+        wired_server_frames_rejected++;
+        if(!wired_server_nack_sent)
+        {
+            wired_server_nack_sent = 1;
+            reply[0] = WIRED_SERVER_NACK;
+            reply[1] = wired_server_expected_seq;
+            start_us = wired_server_send(reply, 2, WIRED_SERVER_WINDOW_CHAR_US, start_us);
+        }
+    }
+    wired_server_cpu_us = start_us;
+    wired_server_ring_free_us[wired_server_ring_frames++ % WIRED_SERVER_WINDOW_SLOTS] = start_us;
+    if(wired_server_window_done >= wired_server_window_size) wired_server_window_end(WIRED_SERVER_WINDOW_OK, start_us);
+}
+
+//Frames that are in the ring at (at_us), completed and not programmed yet
+static uint32_t wired_server_ring_used(double at_us)
+{
+    uint32_t index;
+    uint32_t used = 0;
+
+    for(index=0; index<WIRED_SERVER_WINDOW_SLOTS && index<wired_server_ring_frames; index++)
+    {
+        if(wired_server_ring_free_us[index] > at_us) used++;
+    }
+    return used;
+}
+
+//bootloader_window_rx_byte : rebuilds the frames byte by byte, a frame that finds the ring full is dropped
+static void wired_server_window_rx_byte(uint8_t byte, double at_us)
+{
+    switch(wired_server_frame_state)
+    {
+    case WIRED_SERVER_FRAME_RX_SOF:
+        if(byte == WIRED_SERVER_FRAME_SOF) wired_server_frame_state = WIRED_SERVER_FRAME_RX_SEQ;
+        break;
+    case WIRED_SERVER_FRAME_RX_SEQ:
+        wired_server_frame[0]    = byte;
+        wired_server_frame_state = WIRED_SERVER_FRAME_RX_LEN;
+        break;
+    case WIRED_SERVER_FRAME_RX_LEN:
+        if(byte == 0 || byte > WIRED_SERVER_FRAME_PAYLOAD || (byte & 3))
+        {
+            wired_server_frame_state = WIRED_SERVER_FRAME_RX_SOF;
+        }
+        else if(wired_server_ring_used(at_us) >= WIRED_SERVER_WINDOW_SLOTS-1)
+        {
+            wired_server_frames_dropped++;
+            wired_server_frame_state = WIRED_SERVER_FRAME_RX_SOF;
+        }
+        else
+        {
+            wired_server_frame[1]    = byte;
+            wired_server_frame_index = 0;
+            wired_server_frame_state = WIRED_SERVER_FRAME_RX_PAYLOAD;
+        }
+        break;
+    case WIRED_SERVER_FRAME_RX_PAYLOAD:
+        wired_server_frame[2+wired_server_frame_index++] = byte;
+        if(wired_server_frame_index == wired_server_frame[1])
+        {
+            wired_server_frame_index = 0;
+            wired_server_frame_state = WIRED_SERVER_FRAME_RX_CRC;
+        }
+        break;
+    case WIRED_SERVER_FRAME_RX_CRC:
+        wired_server_frame_crc[wired_server_frame_index++] = byte;
+        if(wired_server_frame_index == 4)
+        {
+            wired_server_frame_state = WIRED_SERVER_FRAME_RX_SOF;
+            wired_server_window_frame(at_us);
+        }
+        break;
+    }
+}
+
+//bootloader_handle_mem_write_cmd : one packet of 64 bytes, programmed without erase
+static double wired_server_mem_write(double at_us)
+{
+    uint32_t len_to_read = wired_server_packet[10];
+    uint32_t crc_host    = wired_server_field(&wired_server_packet[11+len_to_read]);
+    uint32_t address;
+    uint8_t  data[64];
+    uint8_t  reply;
+
+    at_us = wired_server_print(at_us, "------------------------------------------------\r\nBL_DEBUG_MSG: bootloader_handle_mem_write_cmd \r\n");
+    if(get_crc(wired_server_packet, wired_server_packet[0]+1-8) != crc_host)
+    {
+        wired_server_crc_fails++;
+        at_us = wired_server_print(at_us, "BL_DEBUG_MSG: checksum fail !! \r\n");
+        reply = WIRED_SERVER_NACK;
+        return wired_server_send(&reply, 1, WIRED_SERVER_REPLY_CHAR_US, at_us);
+    }
+    at_us   = wired_server_print(at_us, "BL_DEBUG_MSG: checksum success !! \r\n");
+    address = wired_server_field(&wired_server_packet[2]);
+    at_us   = wired_server_print(at_us, "BL_DEBUG_MSG: destination address: 0x%08x\r\n", address);
+    if((address >= WIRED_SERVER_RAM_START && address <= WIRED_SERVER_RAM_END) ||
+       (address >= WIRED_SERVER_FLASH_START && address <= WIRED_SERVER_FLASH_END))
+    {
+        wired_server_char2hex(&wired_server_packet[11], data, 64);
+        if(address >= WIRED_SERVER_FLASH_START)
+        {
+            wired_server_program(address, data, 64, at_us);
+            at_us += 32*WIRED_SERVER_HALF_WORD_US;
+        }
+        at_us = wired_server_send_ack(1, at_us);
+        reply = 0;                      //ADDR_VALID
+    }
+    else
+    {
+        at_us = wired_server_print(at_us, "BL_DEBUG_MSG:GO addr invalid ! \n");
+        reply = 1;                      //ADDR_INVALID
+    }
+    return wired_server_send(&reply, 1, WIRED_SERVER_REPLY_CHAR_US, at_us);
+}
+
+//bootloader_handle_mem_write_windowed_cmd up to the stream : pages erased, stream receive armed, reply sent
+static double wired_server_mem_write_windowed(double at_us)
+{
+    uint8_t  reply[2];
+    uint8_t  window = wired_server_packet[18];
+    uint8_t  status = WIRED_SERVER_WINDOW_OK;
+    uint32_t pages;
+
+    at_us = wired_server_print(at_us, "------------------------------------------------\r\nBL_DEBUG_MSG: bootloader_handle_mem_write_windowed_cmd \r\n");
+    if(get_crc(wired_server_packet, wired_server_packet[0]+1-8) != wired_server_field(&wired_server_packet[19]))
+    {
+        wired_server_crc_fails++;
+        at_us = wired_server_print(at_us, "BL_DEBUG_MSG: checksum fail !! \r\n");
+        reply[0] = WIRED_SERVER_NACK;
+        return wired_server_send(reply, 1, WIRED_SERVER_REPLY_CHAR_US, at_us);
+    }
+    wired_server_window_address = wired_server_field(&wired_server_packet[2]);
+    wired_server_window_size    = wired_server_field(&wired_server_packet[10]);
+    wired_server_window_done    = 0;
+    if(window < WIRED_SERVER_WINDOW_MIN) window = WIRED_SERVER_WINDOW_MIN;
+    if(window > WIRED_SERVER_WINDOW_MAX) window = WIRED_SERVER_WINDOW_MAX;
+
+    if((wired_server_window_address & 0x3FF) || wired_server_window_size == 0 || wired_server_window_address < WIRED_SERVER_APP_BASE ||
+       wired_server_window_size > WIRED_SERVER_FLASH_END-wired_server_window_address+1)
+    {
+        status = WIRED_SERVER_WINDOW_ADDR_INVALID;
+    }
+    else
+    {
+        pages = (wired_server_window_size+WIRED_SERVER_PAGE_SIZE-1)/WIRED_SERVER_PAGE_SIZE;
+        memset(&wired_server_flash[wired_server_window_address-WIRED_SERVER_FLASH_START], 0xFF, pages*WIRED_SERVER_PAGE_SIZE);
+        at_us += pages*WIRED_SERVER_PAGE_ERASE_US;
+    }
+
+    if(status == WIRED_SERVER_WINDOW_OK)
+    {
+        wired_server_rx_state       = WIRED_SERVER_RX_STREAM;
+        wired_server_stream_stop_us = WIRED_SERVER_NEVER;
+        wired_server_frame_state    = WIRED_SERVER_FRAME_RX_SOF;
+        wired_server_expected_seq   = 0;
+        wired_server_nack_sent      = 0;
+        wired_server_ring_frames    = 0;
+    }
+    at_us    = wired_server_send_ack(2, at_us);
+    reply[0] = status;
+    reply[1] = window;
+    at_us    = wired_server_send(reply, 2, WIRED_SERVER_WINDOW_CHAR_US, at_us);
+    if(status != WIRED_SERVER_WINDOW_OK)
+    {
+        wired_server_window_end(status, at_us);
+        return wired_server_cpu_us;
+    }
+    return at_us;
+}
+
+//A byte taken by the receiver of the main loop at (at_us), the ISR drops the zeros (empty frames of the host)
+static void wired_server_deliver(uint8_t byte, double at_us)
+{
+    if(byte == 0) return;
+    if(wired_server_rx_state == WIRED_SERVER_RX_LENGTH)
+    {
+        memset(wired_server_packet, 0, sizeof(wired_server_packet));
+        wired_server_packet[0]     = byte;
+        wired_server_packet_index  = 1;
+        wired_server_rx_state      = WIRED_SERVER_RX_PACKET;
+        wired_server_armed_us      = wired_server_print(at_us, "rcv_len = %d\r\n", byte);
+        return;
+    }
+    wired_server_packet[wired_server_packet_index++] = byte;
+    if(wired_server_packet_index < wired_server_packet[0]+1) return;
+
+    wired_server_commands++;
+    wired_server_rx_state = WIRED_SERVER_RX_LENGTH;
+    switch(wired_server_packet[1])
+    {
+    case COMMAND_BL_MEM_WRITE:
+        at_us = wired_server_mem_write(at_us);
+        break;
+    case COMMAND_BL_MEM_WRITE_WINDOWED:
+        at_us = wired_server_mem_write_windowed(at_us);
+        break;
+    default:
+        wired_server_unknown++;
+        at_us = wired_server_print(at_us, "BL_DEBUG_MSG: Invalid command code received from host \r\n");
+        break;
+    }
+    wired_server_cpu_us = wired_server_armed_us = at_us;
+}
+
+//A byte reaches USART2 at (at_us)
+static void wired_server_rx(uint8_t byte, double at_us)
+{
+    if(wired_server_rx_state == WIRED_SERVER_RX_STREAM)
+    {
+        if(at_us < wired_server_stream_stop_us)
+        {
+            wired_server_window_rx_byte(byte, at_us);
+            return;
+        }
+        wired_server_rx_state = WIRED_SERVER_RX_LENGTH;
+    }
+    //the byte waiting in the data register is taken first once the receive is armed
+    if(wired_server_dr_full && wired_server_armed_us <= at_us)
+    {
+        wired_server_dr_full = 0;
+        wired_server_deliver(wired_server_dr_byte, (wired_server_dr_us > wired_server_armed_us)? wired_server_dr_us : wired_server_armed_us);
+        wired_server_rx(byte, at_us);
+        return;
+    }
+    if(at_us < wired_server_armed_us)
+    {
+        if(wired_server_dr_full)
+        {
+            wired_server_overruns++;
+            return;
+        }
+        wired_server_dr_full = 1;
+        wired_server_dr_byte = byte;
+        wired_server_dr_us   = at_us;
+        return;
+    }
+    wired_server_deliver(byte, at_us);
+}
+
+//Board thread : gives every byte read from the pseudo terminal its time on the wire, writes the replies at their time
+static void* wired_server_thread(void* param)
+{
+    struct epoll_event event;
+    wired_server_reply_t* reply;
+    uint8_t  buffer[256];
+    uint8_t  out[64];
+    uint32_t count;
+    ssize_t  received;
+    ssize_t  index;
+    double   now_us;
+    double   wait_us;
+    int      poller = epoll_create1(0);
+
+    (void)param;
+    event.events  = EPOLLIN;
+    event.data.fd = wired_server_master;
+    epoll_ctl(poller, EPOLL_CTL_ADD, wired_server_master, &event);
+    while(wired_server_running)
+    {
+        wait_us = 50000;
+        if(wired_server_reply_head != wired_server_reply_tail)
+        {
+            wait_us = wired_server_replies[wired_server_reply_tail % WIRED_SERVER_REPLY_QUEUE].due_us - wired_server_now_us();
+            if(wait_us > 50000) wait_us = 50000;
+        }
+        if(wait_us > 0 && epoll_wait(poller, &event, 1, (int)(wait_us/1000)+1) > 0)
+        {
+            received = read(wired_server_master, buffer, sizeof(buffer));
+            now_us   = wired_server_now_us();
+            for(index=0; index<received; index++)
+            {
+                if(wired_server_line_us < now_us) wired_server_line_us = now_us;
+                wired_server_line_us += wired_server_byte_us;
+                if(wired_server_overrun(wired_server_line_us)) wired_server_overruns++;
+                else wired_server_rx(buffer[index], wired_server_line_us);
+            }
+        }
+
+        now_us = wired_server_now_us();
+        //the windowed write gives up when no frame comes for BL_WINDOW_IDLE_TIMEOUT_MS
+        if(wired_server_rx_state == WIRED_SERVER_RX_STREAM && wired_server_stream_stop_us == WIRED_SERVER_NEVER &&
+           now_us >= wired_server_cpu_us+WIRED_SERVER_IDLE_POLLS*WIRED_SERVER_POLL_US)
+        {
+            wired_server_window_end(WIRED_SERVER_WINDOW_TIMEOUT, wired_server_cpu_us+WIRED_SERVER_IDLE_POLLS*WIRED_SERVER_POLL_US);
+        }
+        for(count=0; count<sizeof(out) && wired_server_reply_head != wired_server_reply_tail; count++, wired_server_reply_tail++)
+        {
+            reply = &wired_server_replies[wired_server_reply_tail % WIRED_SERVER_REPLY_QUEUE];
+            if(reply->due_us > now_us) break;
+            out[count] = reply->byte;
+        }
+        for(index=0; index<(ssize_t)count; )
+        {
+            received = write(wired_server_master, &out[index], count-index);
+            if(received > 0) index += received;
+            else if(errno != EAGAIN && errno != EINTR) break;
+        }
+    }
+    close(poller);
+    return NULL;
+}
+
+//Stops the stand-in and prints its counters and what it programmed
+static void wired_server_stop(void)
+{
+    wired_server_running = 0;
+    pthread_join(wired_server_thread_id, NULL);
+    close(wired_server_master);
+    wired_server_master = -1;
+    unsetenv("BL_SERIAL_PORT");
+    unsetenv("BL_SERIAL_BAUD");
+
+    printf("\n   Stand-in stopped : %u commands (%u CRC fails, %u unknown), %u frames (%u rejected, %u dropped on a full ring)",
+           wired_server_commands, wired_server_crc_fails, wired_server_unknown, wired_server_frames, wired_server_frames_rejected, wired_server_frames_dropped);
+    printf("\n   %u bytes lost by overrun, %u reply bytes lost, %u half words programmed over data", wired_server_overruns,
+           wired_server_tx_lost, wired_server_program_errors);
+    if(wired_server_written_high > wired_server_written_low)
+    {
+        printf("\n   Programmed 0x%08X - 0x%08X, CRC 0x%08X\n", wired_server_written_low, wired_server_written_high-1,
+               get_crc(&wired_server_flash[wired_server_written_low-WIRED_SERVER_FLASH_START], wired_server_written_high-wired_server_written_low));
+    }
+    else
+    {
+        printf("\n   Nothing programmed\n");
+    }
+}
+
+//Starts the stand-in in the background (the menu stays usable, the serial writes go to it), or stops it if it runs
+void wired_server_run(void)
+{
+    struct timespec now;
+    char     baudrate_text[16];
+    uint32_t baudrate = 115200;
+
+    if(wired_server_running)
+    {
+        wired_server_stop();
+        return;
+    }
+    printf("\n   Enter the baud rate of the emulated link : ");
+    scanf(" %u", &baudrate);
+    if(baudrate < 1200) baudrate = 1200;
+
+    wired_server_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(wired_server_master < 0 || grantpt(wired_server_master) != 0 || unlockpt(wired_server_master) != 0)
+    {
+        printf("\n   Pseudo terminal could not be opened : %d\n", errno);
+        if(wired_server_master >= 0) close(wired_server_master);
+        wired_server_master = -1;
+        return;
+    }
+    fcntl(wired_server_master, F_SETFL, fcntl(wired_server_master, F_GETFL) | O_NONBLOCK);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    wired_server_origin_us    = (uint64_t)now.tv_sec*1000000 + now.tv_nsec/1000;
+    wired_server_byte_us      = 10*1000000.0/baudrate;
+    memset(wired_server_flash, 0xFF, sizeof(wired_server_flash));
+    wired_server_written_low  = WIRED_SERVER_FLASH_END+1;
+    wired_server_written_high = 0;
+    wired_server_line_us = wired_server_cpu_us = wired_server_armed_us = 0;
+    wired_server_tx_free_us = wired_server_tx_last_start_us = 0;
+    wired_server_reply_head = wired_server_reply_tail = 0;
+    wired_server_stall_count     = 0;
+    wired_server_last_stall_slot = -1;
+    wired_server_rx_state        = WIRED_SERVER_RX_LENGTH;
+    wired_server_dr_full         = 0;
+    wired_server_commands = wired_server_crc_fails = wired_server_unknown = 0;
+    wired_server_frames = wired_server_frames_rejected = wired_server_frames_dropped = 0;
+    wired_server_overruns = wired_server_tx_lost = wired_server_program_errors = 0;
+
+    wired_server_running = 1;
+    if(pthread_create(&wired_server_thread_id, NULL, wired_server_thread, NULL) != 0)
+    {
+        printf("\n   Thread could not be started!!\r\n");
+        wired_server_running = 0;
+        close(wired_server_master);
+        wired_server_master = -1;
+        return;
+    }
+    sprintf(baudrate_text, "%u", baudrate);
+    setenv("BL_SERIAL_PORT", ptsname(wired_server_master), 1);
+    setenv("BL_SERIAL_BAUD", baudrate_text, 1);
+    printf("\n   Stand-in of the wired bootloader on %s at %u baud, run the serial writes (21, 30) against it,"
+           "\n   choose this option again to stop it\n", ptsname(wired_server_master), baudrate);
+}